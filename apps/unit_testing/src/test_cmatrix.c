@@ -0,0 +1,181 @@
+/** 
+\file    test_cmatrix.c
+\brief   unit tests for cmatrix.c/.h
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "Basic.h"     // CUnit/Basic.h
+#include "cmatrix.h"
+#include "test_cmatrix.h"
+
+#define TEST_CMATRIX_COLUMNAR_PATH "test_columnar.mtc"
+
+int init_suite_CMATRIX(void)
+{
+  if( !MTX_Initialize_MTXEngine() )
+    return -1;
+  return 0;
+}
+
+int clean_suite_CMATRIX(void)
+{
+  return 0;
+}
+
+
+/// \brief  Check that the rows [firstRow, firstRow+B->nrows) and the given columns of A equal B.
+static BOOL test_cmatrix_IsSubsetEqual( 
+  const MTX *A, 
+  const MTX *B, 
+  const unsigned firstRow, 
+  const unsigned *columns, 
+  const unsigned nrColumns )
+{
+  unsigned i = 0;
+  unsigned j = 0;
+  
+  if( B->ncols != nrColumns || firstRow + B->nrows > A->nrows )
+    return FALSE;
+  for( j = 0; j < nrColumns; j++ )
+  {
+    for( i = 0; i < B->nrows; i++ )
+    {
+      if( B->data[j][i] != A->data[columns[j]][firstRow+i] )
+        return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+void test_MTX_SaveColumnar_ReadColumnar(void)
+{
+  MTX A;
+  MTX B;
+  unsigned i = 0;
+  unsigned j = 0;
+  unsigned k = 0;
+  unsigned nrows = 0;
+  unsigned ncols = 0;
+  char header[128];
+  unsigned all[5] = { 0, 1, 2, 3, 4 };
+  unsigned subset[2] = { 3, 0 };
+  BOOL compress = FALSE;
+  BOOL result;
+
+  MTX_Init( &A );
+  MTX_Init( &B );
+
+  // 100 epochs at 1 Hz, the first column is the GPS time of week. The values are
+  // not smooth so that the compression does not remove all of the column bytes.
+  result = MTX_Malloc( &A, 100, 5, TRUE );
+  CU_ASSERT_FATAL( result );
+  for( i = 0; i < A.nrows; i++ )
+  {
+    A.data[0][i] = 345600.0 + i;
+    A.data[1][i] = 51.0 + 1.0e-7 * (i*i % 17);
+    A.data[2][i] = -114.0 - 3.3e-8 * i;
+    A.data[3][i] = 1100.0 + 0.001 * (i*7919 % 101);
+    A.data[4][i] = i % 3 == 0 ? 0.0 : 1.0/(i+1.0);
+  }
+
+  for( k = 0; k < 2; k++ )
+  {
+    compress = k == 1 ? TRUE : FALSE;
+
+    // Chunks of 16 rows so that the row range crosses chunk boundaries.
+    result = MTX_SaveColumnar( &A, TEST_CMATRIX_COLUMNAR_PATH, "time (s),lat (deg),lon (deg),hgt (m),x", 16, compress, FALSE );
+    CU_ASSERT_FATAL( result );
+
+    result = MTX_GetColumnarFileAttributes( TEST_CMATRIX_COLUMNAR_PATH, &nrows, &ncols, header, 128 );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( nrows == 100 );
+    CU_ASSERT( ncols == 5 );
+    CU_ASSERT( strcmp( header, "time (s),lat (deg),lon (deg),hgt (m),x" ) == 0 );
+
+    // All rows and columns.
+    result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, NULL, 0, FALSE, 0.0, 0.0 );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( B.nrows == 100 );
+    CU_ASSERT( test_cmatrix_IsSubsetEqual( &A, &B, 0, all, 5 ) );
+
+    // A row range, rows 20 to 50 inclusive.
+    result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, NULL, 0, TRUE, 345620.0, 345650.0 );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( B.nrows == 31 );
+    CU_ASSERT( test_cmatrix_IsSubsetEqual( &A, &B, 20, all, 5 ) );
+
+    // A column subset, in a different order, with a row range.
+    result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, subset, 2, TRUE, 345640.5, 345699.0 );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( B.nrows == 59 );
+    CU_ASSERT( test_cmatrix_IsSubsetEqual( &A, &B, 41, subset, 2 ) );
+
+    // A row range outside of the data.
+    result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, NULL, 0, TRUE, 350000.0, 350100.0 );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( B.nrows == 0 );
+
+    // An invalid column index.
+    subset[0] = 5;
+    result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, subset, 2, FALSE, 0.0, 0.0 );
+    CU_ASSERT( result == FALSE );
+    subset[0] = 3;
+  }
+
+  // Appended rows are new chunks.
+  for( i = 0; i < A.nrows; i++ )
+    A.data[0][i] += 100.0;
+  result = MTX_SaveColumnar( &A, TEST_CMATRIX_COLUMNAR_PATH, NULL, 16, TRUE, TRUE );
+  CU_ASSERT_FATAL( result );
+  result = MTX_ReadColumnar( &B, TEST_CMATRIX_COLUMNAR_PATH, NULL, 0, TRUE, 345690.0, 345709.0 );
+  CU_ASSERT_FATAL( result );
+  CU_ASSERT( B.nrows == 20 );
+  if( B.nrows == 20 )
+  {
+    for( j = 0; j < 5; j++ )
+    {
+      for( i = 0; i < 10; i++ )
+      {
+        CU_ASSERT( B.data[j][10+i] == A.data[j][i] );
+      }
+    }
+  }
+
+  remove( TEST_CMATRIX_COLUMNAR_PATH );
+  MTX_Free( &A );
+  MTX_Free( &B );
+}
+
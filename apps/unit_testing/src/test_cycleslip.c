@@ -35,6 +35,7 @@ SUCH DAMAGE.
 */
 
 #include <stdio.h>
+#include <math.h>
 #include "Basic.h"     // CUnit/Basic.h
 #include "cycle_slip.h"
 #include "constants.h"
@@ -260,6 +261,14 @@ void test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(void)
     current_tow,
     previous_week, 
     previous_tow,  
+    21858108.109, // the C1 pseudoranges are used as the ranges
+    21857854.102,
+    21729679.164,
+    21729246.461,
+    24607188.367,
+    24606655.953,
+    24478756.125,
+    24478043.883,
     adr_reference_rx_base_sat,
     adr_reference_rx,
     adr_rover_rx_base_sat,
@@ -275,4 +284,168 @@ void test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(void)
 
   CU_ASSERT_FATAL( result );
 
-}
\ No newline at end of file
+}
+
+void test_CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(void)
+{
+  /* from file nw2_3240.07o (see above), D1 and L1 of the eight satellites at 3.0 and 4.0 s */
+  double previous_Doppler[8] = { 4451.949, -3336.293, 3139.113, -1867.191, -2016.617, 405.156, -2742.875, -1263.844 };
+  double previous_adr[8]     = { -563066.531, 365976.457, -403936.914, 222912.895, 217326.695, -63101.598, 299220.691, 148802.059 };
+  double current_Doppler[8]  = { 4451.164, -3336.891, 3137.965, -1868.238, -2017.457, 404.039, -2743.551, -1264.723 };
+  double current_adr[8]      = { -567517.695, 369313.348, -407074.879, 224781.133, 219344.152, -63505.637, 301964.242, 150066.781 };
+  BOOL   wasSlipDetected[8];
+  double sizeOfSlipInCycles[8];
+  BOOL   wasSlipDetected_single = FALSE;
+  double sizeOfSlipInCycles_single = 0;
+  unsigned i;
+  BOOL result;
+
+  result = CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+    1.0, previous_Doppler, previous_adr, current_Doppler, current_adr, 8, 1.0, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT_FATAL( result );
+
+  // Compare with the single channel function.
+  for( i = 0; i < 8; i++ )
+  {
+    result = CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction(
+      1454, 240543, previous_Doppler[i], previous_adr[i],
+      1454, 240544, current_Doppler[i], current_adr[i],
+      1.0, &wasSlipDetected_single, &sizeOfSlipInCycles_single );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT( wasSlipDetected[i] == wasSlipDetected_single );
+    CU_ASSERT( wasSlipDetected[i] == FALSE );
+    CU_ASSERT_DOUBLE_EQUAL( sizeOfSlipInCycles[i], previous_adr[i] - (previous_Doppler[i] + current_Doppler[i])/2.0 - current_adr[i], 1.0e-06 );
+  }
+
+  // A 5 cycle slip on the fourth channel.
+  current_adr[3] += 5.0;
+  result = CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+    1.0, previous_Doppler, previous_adr, current_Doppler, current_adr, 8, 1.0, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT_FATAL( result );
+  for( i = 0; i < 8; i++ )
+  {
+    CU_ASSERT( wasSlipDetected[i] == (i == 3 ? TRUE : FALSE) );
+  }
+  CU_ASSERT( sizeOfSlipInCycles[3] < -4.0 && sizeOfSlipInCycles[3] > -6.0 );
+
+  // The prediction is not used over long intervals.
+  result = CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+    61.0, previous_Doppler, previous_adr, current_Doppler, current_adr, 8, 1.0, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT_FATAL( result );
+  CU_ASSERT( wasSlipDetected[3] == FALSE );
+
+  // Invalid elapsed time.
+  result = CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+    0.0, previous_Doppler, previous_adr, current_Doppler, current_adr, 8, 1.0, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT( result == FALSE );
+}
+
+
+void test_CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(void)
+{
+  /* from file nw2_3240.07o (see above), L1 and L2 of the eight satellites at 3.0 and 4.0 s */
+  double previous_adr_L1[8] = { -563066.531, 365976.457, -403936.914, 222912.895, 217326.695, -63101.598, 299220.691, 148802.059 };
+  double previous_adr_L2[8] = { -398459.531, 263239.902, -284542.168, 158091.508, 157787.914, -43712.340, 216571.602, 105388.020 };
+  double current_adr_L1[8]  = { -567517.695, 369313.348, -407074.879, 224781.133, 219344.152, -63505.637, 301964.242, 150066.781 };
+  double current_adr_L2[8]  = { -401927.969, 265840.059, -286987.336, 159547.266, 159359.941, -44027.176, 218709.430, 106373.520 };
+  double wavelength1 = 0.19029367279836488; // L1 wavelength
+  double wavelength2 = 0.24421021342456825; // L2 wavelength
+  BOOL   wasSlipDetected[8];
+  double sizeOfSlipInMeters[8];
+  unsigned i;
+  BOOL result;
+
+  result = CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(
+    previous_adr_L1, previous_adr_L2, current_adr_L1, current_adr_L2, 8, 
+    wavelength1, wavelength2, 0.05, wasSlipDetected, sizeOfSlipInMeters );
+  CU_ASSERT_FATAL( result );
+  for( i = 0; i < 8; i++ )
+  {
+    CU_ASSERT( wasSlipDetected[i] == FALSE );
+    CU_ASSERT( fabs(sizeOfSlipInMeters[i]) < 0.05 );
+  }
+
+  // A one cycle slip on L2 of the second satellite.
+  current_adr_L2[1] += 1.0;
+  result = CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(
+    previous_adr_L1, previous_adr_L2, current_adr_L1, current_adr_L2, 8, 
+    wavelength1, wavelength2, 0.05, wasSlipDetected, sizeOfSlipInMeters );
+  CU_ASSERT_FATAL( result );
+  for( i = 0; i < 8; i++ )
+  {
+    CU_ASSERT( wasSlipDetected[i] == (i == 1 ? TRUE : FALSE) );
+  }
+  CU_ASSERT_DOUBLE_EQUAL( sizeOfSlipInMeters[1], -wavelength2, 0.05 );
+
+  // Invalid wavelength.
+  result = CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(
+    previous_adr_L1, previous_adr_L2, current_adr_L1, current_adr_L2, 8, 
+    wavelength1, 0.0, 0.05, wasSlipDetected, sizeOfSlipInMeters );
+  CU_ASSERT( result == FALSE );
+}
+
+
+void test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(void)
+{
+  /* PRN26 and PRN28 (the base satellite) L1 at 30.0 and 31.0 s (see test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase), 
+  the C1 pseudoranges are used as the ranges */
+  double rover_range[2]           = { 24607188.367, 21858108.109 };
+  double prev_rover_range[2]      = { 24606655.953, 21857854.102 };
+  double reference_range[2]       = { 24478756.125, 21729679.164 };
+  double prev_reference_range[2]  = { 24478043.883, 21729246.461 };
+  double adr_rover_rx[2]          = { 2118628.660, 1838687.258 };
+  double prev_adr_rover_rx[2]     = { 2115829.996, 1837353.309 };
+  double adr_reference_rx[2]      = { 191677.884, 183306.982 };
+  double prev_adr_reference_rx[2] = { 187937.197, 181031.021 };
+  double wavelength = 0.19029367279836488; // L1 wavelength
+  BOOL   wasSlipDetected[2];
+  double sizeOfSlipInCycles[2];
+  BOOL   wasSlipDetected_single = FALSE;
+  double sizeOfSlipInMeters_single = 0;
+  BOOL result;
+
+  result = CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(
+    rover_range, prev_rover_range, reference_range, prev_reference_range,
+    adr_rover_rx, prev_adr_rover_rx, adr_reference_rx, prev_adr_reference_rx,
+    2, 1, wavelength, 1000.0, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT_FATAL( result );
+  CU_ASSERT( wasSlipDetected[1] == FALSE );
+  CU_ASSERT_DOUBLE_EQUAL( sizeOfSlipInCycles[1], 0.0, 1.0e-12 );
+
+  // Compare with the single satellite function (its misclosure is in meters).
+  result = CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(
+    1454, 240631, 1454, 240630,
+    rover_range[1], prev_rover_range[1], reference_range[1], prev_reference_range[1],
+    rover_range[0], prev_rover_range[0], reference_range[0], prev_reference_range[0],
+    adr_reference_rx[1], adr_reference_rx[0], adr_rover_rx[1], adr_rover_rx[0],
+    prev_adr_reference_rx[1], prev_adr_reference_rx[0], prev_adr_rover_rx[1], prev_adr_rover_rx[0],
+    0.0, &wasSlipDetected_single, &sizeOfSlipInMeters_single );
+  CU_ASSERT_FATAL( result );
+  CU_ASSERT_DOUBLE_EQUAL( sizeOfSlipInCycles[0]*wavelength, sizeOfSlipInMeters_single, 1.0e-04 );
+
+  // With consistent ranges, a 2 cycle slip on the rover is found.
+  rover_range[0]          = adr_rover_rx[0]*wavelength;
+  prev_rover_range[0]     = prev_adr_rover_rx[0]*wavelength;
+  reference_range[0]      = adr_reference_rx[0]*wavelength;
+  prev_reference_range[0] = prev_adr_reference_rx[0]*wavelength;
+  rover_range[1]          = adr_rover_rx[1]*wavelength;
+  prev_rover_range[1]     = prev_adr_rover_rx[1]*wavelength;
+  reference_range[1]      = adr_reference_rx[1]*wavelength;
+  prev_reference_range[1] = prev_adr_reference_rx[1]*wavelength;
+  adr_rover_rx[0] += 2.0;
+  result = CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(
+    rover_range, prev_rover_range, reference_range, prev_reference_range,
+    adr_rover_rx, prev_adr_rover_rx, adr_reference_rx, prev_adr_reference_rx,
+    2, 1, wavelength, 0.5, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT_FATAL( result );
+  CU_ASSERT( wasSlipDetected[0] == TRUE );
+  CU_ASSERT( wasSlipDetected[1] == FALSE );
+  CU_ASSERT_DOUBLE_EQUAL( sizeOfSlipInCycles[0], -2.0, 1.0e-06 );
+
+  // Invalid base satellite index.
+  result = CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(
+    rover_range, prev_rover_range, reference_range, prev_reference_range,
+    adr_rover_rx, prev_adr_rover_rx, adr_reference_rx, prev_adr_reference_rx,
+    2, 2, wavelength, 0.5, wasSlipDetected, sizeOfSlipInCycles );
+  CU_ASSERT( result == FALSE );
+}
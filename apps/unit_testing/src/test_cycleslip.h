@@ -62,6 +62,15 @@ void test_CYCLESLIP_CheckForCycleSlipUsingDualFrequencyPhase(void);
 /** \brief test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(). */
 void test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(void);
 
+/** \brief Test CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(). */
+void test_CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(void);
+
+/** \brief Test CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(). */
+void test_CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(void);
+
+/** \brief Test CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(). */
+void test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(void);
+
 #ifdef __cplusplus
 }
 #endif
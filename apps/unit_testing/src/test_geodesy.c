@@ -36,6 +36,7 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 SUCH DAMAGE.
 */
 #include <stdio.h>
+#include <math.h>
 #include "Basic.h"     // CUnit/Basic.h
 #include "gnss_error.h"
 #include "geodesy.h"
@@ -846,3 +847,72 @@ void test_GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixed
   CU_ASSERT_DOUBLE_EQUAL( azimuth, PI, 1.0E-07 );
   
 }
+
+void test_GEODESY_ConvertCoordinates_Batch(void)
+{
+  // points from the center region, the poles, the equator and high altitude
+  double lat[6] = { 51.0*DEG2RAD, -33.0*DEG2RAD, 90.0*DEG2RAD, -90.0*DEG2RAD, 0.0, 45.0*DEG2RAD };
+  double lon[6] = { -114.0*DEG2RAD, 151.0*DEG2RAD, 0.0, 0.0, 179.0*DEG2RAD, 10.0*DEG2RAD };
+  double hgt[6] = { 1000.0, -50.0, 100.0, 0.0, 0.0, 20200000.0 };
+  double x[6];
+  double y[6];
+  double z[6];
+  double lat_b[6];
+  double lon_b[6];
+  double hgt_b[6];
+  double dN[6];
+  double dE[6];
+  double dU[6];
+  double xp, yp, zp;
+  double latp, lonp, hgtp;
+  double N, E, U;
+  unsigned i;
+  BOOL result;
+
+  result = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+    GEODESY_REFERENCE_ELLIPSE_WGS84, lat, lon, hgt, 6, x, y, z );
+  CU_ASSERT_FATAL( result );
+
+  result = GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch(
+    GEODESY_REFERENCE_ELLIPSE_WGS84, x, y, z, 6, lat_b, lon_b, hgt_b );
+  CU_ASSERT_FATAL( result );
+
+  result = GEODESY_ComputePositionDifference_Batch(
+    GEODESY_REFERENCE_ELLIPSE_WGS84, lat[0], lon[0], hgt[0], lat, lon, hgt, 6, dN, dE, dU );
+  CU_ASSERT_FATAL( result );
+
+  for( i = 0; i < 6; i++ )
+  {
+    result = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates(
+      GEODESY_REFERENCE_ELLIPSE_WGS84, lat[i], lon[i], hgt[i], &xp, &yp, &zp );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT_DOUBLE_EQUAL( x[i], xp, 1.0e-6 );
+    CU_ASSERT_DOUBLE_EQUAL( y[i], yp, 1.0e-6 );
+    CU_ASSERT_DOUBLE_EQUAL( z[i], zp, 1.0e-6 );
+
+    result = GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates(
+      GEODESY_REFERENCE_ELLIPSE_WGS84, x[i], y[i], z[i], &latp, &lonp, &hgtp );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT_DOUBLE_EQUAL( lat_b[i], latp, 1.0e-10 );
+    CU_ASSERT_DOUBLE_EQUAL( hgt_b[i], hgtp, 1.0e-4 );
+    CU_ASSERT_DOUBLE_EQUAL( lat_b[i], lat[i], 1.0e-10 );
+    CU_ASSERT_DOUBLE_EQUAL( hgt_b[i], hgt[i], 1.0e-4 );
+    if( fabs(lat[i]) < HALFPI - 1.0e-6 )
+    {
+      CU_ASSERT_DOUBLE_EQUAL( lon_b[i], lon[i], 1.0e-10 );
+    }
+
+    result = GEODESY_ComputePositionDifference(
+      GEODESY_REFERENCE_ELLIPSE_WGS84, lat[0], lon[0], hgt[0], lat[i], lon[i], hgt[i], &N, &E, &U );
+    CU_ASSERT_FATAL( result );
+    CU_ASSERT_DOUBLE_EQUAL( dN[i], N, 1.0e-6 );
+    CU_ASSERT_DOUBLE_EQUAL( dE[i], E, 1.0e-6 );
+    CU_ASSERT_DOUBLE_EQUAL( dU[i], U, 1.0e-6 );
+  }
+
+  // an invalid latitude is flagged
+  lat[2] = 2.0*PI;
+  result = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+    GEODESY_REFERENCE_ELLIPSE_WGS84, lat, lon, hgt, 6, x, y, z );
+  CU_ASSERT( result == FALSE );
+}
@@ -89,6 +89,9 @@ void test_GEODESY_RotateVectorFromEarthFixedFrameToLocalGeodeticFrame(void);
 /** \brief  Test GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame(). */
 void test_GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame(void);
 
+/** \brief  Test the batch coordinate conversion functions against the per point functions. */
+void test_GEODESY_ConvertCoordinates_Batch(void);
+
 #ifdef __cplusplus
 }
 #endif
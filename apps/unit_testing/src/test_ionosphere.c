@@ -36,6 +36,7 @@ SUCH DAMAGE.
 #include <stdio.h>
 #include "Basic.h"     // CUnit/Basic.h
 #include "ionosphere.h"
+#include "troposphere.h"
 #include "constants.h"
 
 
@@ -160,6 +161,164 @@ Data archive:    ftp://ftp.unibe.ch/aiub/CODE/              COMMENT
 }
 
 
+void test_IONOSPHERE_GetL1KlobucharCorrection_Batch(void)
+{
+  // The batch function must reproduce the single satellite function.
+  double alpha[4];
+  double beta[4];
+
+  double latitude;
+  double longitude;
+  double elevation[24*7];
+  double azimuth[24*7];
+  double ionospheric_delay[24*7];
+  double ionospheric_delay_test;
+  double gpstow;
+  double az;
+  double el;
+  unsigned n;
+  unsigned i;
+  BOOL result;
+
+  alpha[0] = 1.0836e-08;
+  alpha[1] = -6.6222e-09;
+  alpha[2] = -3.4546e-07;
+  alpha[3] = -5.5205e-07;
+
+  beta[0] = 1.0706e+05;
+  beta[1] = -1.1893e+05;
+  beta[2] = -9.7785e+05;
+  beta[3] = -1.3581e+06;
+
+  // for Calgary
+  latitude = 51*DEG2RAD;
+  longitude = -114*DEG2RAD;
+
+  n = 0;
+  for( az = 0; az < 360; az+= 15 )
+  {
+    for( el = 0; el <= 90; el += 15 )
+    {
+      azimuth[n] = az*DEG2RAD;
+      elevation[n] = el*DEG2RAD;
+      n++;
+    }
+  }
+
+  for( gpstow = 345600; gpstow < 5*86400.0; gpstow += 3600.0 )
+  {
+    result = IONOSPHERE_GetL1KlobucharCorrection_Batch(
+      alpha[0],
+      alpha[1],
+      alpha[2],
+      alpha[3],
+      beta[0],
+      beta[1],
+      beta[2],
+      beta[3],
+      latitude,  
+      longitude, 
+      elevation, 
+      azimuth,
+      n,
+      gpstow,    
+      ionospheric_delay 
+      );
+    CU_ASSERT_FATAL( result );
+
+    for( i = 0; i < n; i++ )
+    {
+      result = IONOSPHERE_GetL1KlobucharCorrection(   
+        alpha[0],
+        alpha[1],
+        alpha[2],
+        alpha[3],
+        beta[0],
+        beta[1],
+        beta[2],
+        beta[3],
+        latitude,  
+        longitude, 
+        elevation[i], 
+        azimuth[i],   
+        gpstow,    
+        &ionospheric_delay_test 
+        );
+      CU_ASSERT_FATAL( result );
+      CU_ASSERT_DOUBLE_EQUAL( ionospheric_delay[i], ionospheric_delay_test, 1e-09 );
+    }
+  }
+
+  // invalid parameters are rejected
+  result = IONOSPHERE_GetL1KlobucharCorrection_Batch(
+    1.0, alpha[1], alpha[2], alpha[3], beta[0], beta[1], beta[2], beta[3],
+    latitude, longitude, elevation, azimuth, n, 345600.0, ionospheric_delay );
+  CU_ASSERT( result == FALSE );
+}
+
+
+void test_TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(void)
+{
+  // The batch function must reproduce the single satellite function.
+  double zenith_dry_delay;
+  double zenith_wet_delay;
+  double latitude;
+  double height;
+  double elevation[100];
+  double drydelay[100];
+  double wetdelay[100];
+  double drydelay_test;
+  double wetdelay_test;
+  double el;
+  unsigned n;
+  unsigned i;
+
+  // for Calgary
+  latitude = 51*DEG2RAD;
+  height = 1100.0;
+  TROPOSPHERE_DetermineZenithDelayValues_WAAS_Model( latitude, height, 150, &zenith_dry_delay, &zenith_wet_delay );
+
+  // Include angles below the 2 deg and above the 90 deg clamps.
+  n = 0;
+  for( el = -1.0; el <= 92.0; el += 1.0 )
+  {
+    elevation[n] = el*DEG2RAD;
+    n++;
+  }
+
+  TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(
+    zenith_dry_delay,
+    zenith_wet_delay,
+    elevation,
+    n,
+    latitude,
+    height,
+    drydelay,
+    wetdelay
+    );
+
+  for( i = 0; i < n; i++ )
+  {
+    TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
+      zenith_dry_delay,
+      zenith_wet_delay,
+      elevation[i],
+      latitude,
+      height,
+      &drydelay_test,
+      &wetdelay_test
+      );
+    CU_ASSERT_DOUBLE_EQUAL( drydelay[i], drydelay_test, 1e-09 );
+    CU_ASSERT_DOUBLE_EQUAL( wetdelay[i], wetdelay_test, 1e-09 );
+  }
+
+  // The delays are the zenith delays at 90 deg and grow at low elevations.
+  CU_ASSERT_DOUBLE_EQUAL( drydelay[91], zenith_dry_delay, 1e-06 );
+  CU_ASSERT_DOUBLE_EQUAL( wetdelay[91], zenith_wet_delay, 1e-06 );
+  CU_ASSERT( drydelay[3] > 10.0*zenith_dry_delay );
+}
+
+
 
 
 
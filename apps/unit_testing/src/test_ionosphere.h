@@ -57,6 +57,12 @@ int clean_suite_IONOSPHERE(void);
 /** \brief  Test IONOSPHERE_GetL1KlobucharCorrection(). */
 void test_IONOSPHERE_GetL1KlobucharCorrection(void);
 
+/** \brief  Test IONOSPHERE_GetL1KlobucharCorrection_Batch(). */
+void test_IONOSPHERE_GetL1KlobucharCorrection_Batch(void);
+
+/** \brief  Test TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(). */
+void test_TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(void);
+
 
 #ifdef __cplusplus
 }
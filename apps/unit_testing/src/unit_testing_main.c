@@ -46,6 +46,7 @@ SUCH DAMAGE.
 #include "test_ionosphere.h"
 #include "test_rinex.h"
 #include "test_cycleslip.h"
+#include "test_cmatrix.h"
 
 
 /** \brief The function where all suites and tests are added. */
@@ -170,6 +171,8 @@ int AddTests()
     return CU_get_error();
   if( CU_add_test(pSuite, "GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame()", test_GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame) == NULL )
     return CU_get_error();
+  if( CU_add_test(pSuite, "GEODESY_ConvertCoordinates_Batch()", test_GEODESY_ConvertCoordinates_Batch) == NULL )
+    return CU_get_error();
 
 
 
@@ -241,6 +244,10 @@ int AddTests()
   /* add the tests to the suite */
   if( CU_add_test(pSuite, "IONOSPHERE_GetL1KlobucharCorrection()", test_IONOSPHERE_GetL1KlobucharCorrection) == NULL )
     return CU_get_error();
+  if( CU_add_test(pSuite, "IONOSPHERE_GetL1KlobucharCorrection_Batch()", test_IONOSPHERE_GetL1KlobucharCorrection_Batch) == NULL )
+    return CU_get_error();
+  if( CU_add_test(pSuite, "TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch()", test_TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch) == NULL )
+    return CU_get_error();
 
   /* add a suite to the registry */
   pSuite = CU_add_suite("RINEX", init_suite_RINEX, clean_suite_RINEX);
@@ -273,8 +280,23 @@ int AddTests()
     return CU_get_error();
   if( CU_add_test(pSuite, "CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase()", test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase) == NULL )
     return CU_get_error();
+  if( CU_add_test(pSuite, "CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch()", test_CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch) == NULL )
+    return CU_get_error();
+  if( CU_add_test(pSuite, "CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch()", test_CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch) == NULL )
+    return CU_get_error();
+  if( CU_add_test(pSuite, "CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch()", test_CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch) == NULL )
+    return CU_get_error();
   //
   ////
+
+  /* add a suite to the registry */
+  pSuite = CU_add_suite("CMATRIX", init_suite_CMATRIX, clean_suite_CMATRIX);
+  if (NULL == pSuite)   
+    return CU_get_error();
+
+  /* add the tests to the suite */
+  if( CU_add_test(pSuite, "MTX_SaveColumnar() and MTX_ReadColumnar()", test_MTX_SaveColumnar_ReadColumnar) == NULL )
+    return CU_get_error();
   
   
   return CUE_SUCCESS;
@@ -0,0 +1 @@
+..\bin\EssentialGNSS.exe -batch batch_manifest.txt
@@ -97,24 +97,111 @@ inevitable. Please report bugs and suggested fixes to glenn @ zenautics.com.\n
 #define MTX_MAX_READFROMFILE_BUFFER (65536)
 #define MATRIX_MIN_RLE_TOLERANCE (1.0e-16)
 #define MTX_MAX_COMMENT_LENGTH (1024*6)
+#define MTX_PRINTDELIMITED_BUFFER_SIZE (65536) //!< The output buffer size used by MTX_PrintDelimited for real data.
 
 // binary version identifiers
 #define MTX_ID_SIZE (8)
 #define MTX_ID_COMPRESSED_01 ("MTX01\n") //!< identifier used to indicate a file stored using SaveCompressed (version 1)
+#define MTX_ID_COMPRESSED_02 ("MTX02\n") //!< identifier used to indicate a file stored using SaveCompressed (version 2, chunked)
 #define MTX_ID_LEGACY_V01 ("Matrix\n") //!< legacy identifier used to indicate a file stored using Save with imprecise double RLE
 #define MTX_ID_LEGACY_V02 ("MTXV02\n") //!< legacy identifier used to indicate a file stored using Save with imprecise double RLE
+#define MTX_ID_COLUMNAR_01 ("MTXC01\n") //!< identifier used to indicate a file stored using SaveColumnar (version 1)
 
 #define MTX_VERSION_NR_DEFAULT (101) //!< identifier used to indicate a file stored using basic Save
 #define MTX_VERSION_NR_COMPRESSED_01 (102) //!< identifier used to indicate a file stored using SaveCompressed (version 1)
+#define MTX_VERSION_NR_COMPRESSED_02 (103) //!< identifier used to indicate a file stored using SaveCompressed (version 2, chunked)
 #define MTX_VERSION_NR_LEGACY_V01 (1) //!< legacy identifier used to indicate a file stored using Save with imprecise double RLE
 #define MTX_VERSION_NR_LEGACY_V02 (2) //!< legacy identifier used to indicate a file stored using Save with imprecise double RLE
 
 #define MTX_NK (8) //!< the number of byte columns used to represent a column of doubles when using MTX_ID_COMPRESSED_01
 
+// The encodings of a column block in a columnar matrix file (MTX_ID_COLUMNAR_01).
+#define MTX_COLUMNAR_RAW      (0) //!< the block is nrows doubles
+#define MTX_COLUMNAR_CONSTANT (1) //!< the block is a single double repeated nrows times
+#define MTX_COLUMNAR_RLE      (2) //!< the block is MTX_NK byte columns, each run length encoded if shorter
+#define MTX_COLUMNAR_DEFAULT_CHUNK (4096) //!< the default number of rows per chunk of a columnar matrix file
+
+// The transforms of a block in a compressed matrix file (MTX_ID_COMPRESSED_02).
+#define MTX_COMPRESSED_CONSTANT (0) //!< the block is a single double repeated n times
+#define MTX_COMPRESSED_NODELTA  (1) //!< the byte columns are formed from the doubles
+#define MTX_COMPRESSED_SUBDELTA (2) //!< the byte columns are formed from the differences of consecutive 64 bit words
+#define MTX_COMPRESSED_XORDELTA (3) //!< the byte columns are formed from the exclusive or of consecutive 64 bit words
+
+// The encodings of a byte column in a block of a compressed matrix file (MTX_ID_COMPRESSED_02).
+#define MTX_PLANE_RAW      (0) //!< n bytes
+#define MTX_PLANE_CONSTANT (1) //!< a single byte repeated n times
+#define MTX_PLANE_RLE      (2) //!< (byte, count) pairs
+#define MTX_PLANE_HUFFMAN  (3) //!< the code lengths (MTX_HUFFMAN_TABLE_SIZE bytes) followed by the canonical huffman code
+
+#define MTX_COMPRESSED_DEFAULT_CHUNK (16384) //!< the number of rows per chunk of a compressed matrix file
+#define MTX_HUFFMAN_MAX_BITS (12) //!< the maximum length of a huffman code [bits]
+#define MTX_HUFFMAN_TABLE_SIZE (128) //!< the code lengths of the 256 byte values stored as 4 bit values [bytes]
+#define MTX_COMPRESSED_MAX_BLOCK_LENGTH(n) (1 + MTX_NK*(1 + sizeof(unsigned) + (n)) + sizeof(double)) //!< the maximum length of an encoded block of n doubles
+
 #define MTX_NAN     (sqrt(-1.0))
 #define MTX_POS_INF (-log(0.0))
 #define MTX_NEG_INF ( log(0.0))
 
+#ifdef _MSC_VER
+typedef unsigned __int64 MTX_UINT64;
+#else
+typedef unsigned long long MTX_UINT64;
+#endif
+
+/// Exact powers of ten that are representable as doubles, 1e0 to 1e22.
+static const double MTX_static_pow10[23] = { 
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+/// The 32 bit CRC (polynomial 0xEDB88320) of each byte value, used by MTX_static_updateCRC.
+static const unsigned MTX_static_crcTable[256] = {
+  0x00000000U, 0x77073096U, 0xEE0E612CU, 0x990951BAU, 0x076DC419U, 0x706AF48FU,
+  0xE963A535U, 0x9E6495A3U, 0x0EDB8832U, 0x79DCB8A4U, 0xE0D5E91EU, 0x97D2D988U,
+  0x09B64C2BU, 0x7EB17CBDU, 0xE7B82D07U, 0x90BF1D91U, 0x1DB71064U, 0x6AB020F2U,
+  0xF3B97148U, 0x84BE41DEU, 0x1ADAD47DU, 0x6DDDE4EBU, 0xF4D4B551U, 0x83D385C7U,
+  0x136C9856U, 0x646BA8C0U, 0xFD62F97AU, 0x8A65C9ECU, 0x14015C4FU, 0x63066CD9U,
+  0xFA0F3D63U, 0x8D080DF5U, 0x3B6E20C8U, 0x4C69105EU, 0xD56041E4U, 0xA2677172U,
+  0x3C03E4D1U, 0x4B04D447U, 0xD20D85FDU, 0xA50AB56BU, 0x35B5A8FAU, 0x42B2986CU,
+  0xDBBBC9D6U, 0xACBCF940U, 0x32D86CE3U, 0x45DF5C75U, 0xDCD60DCFU, 0xABD13D59U,
+  0x26D930ACU, 0x51DE003AU, 0xC8D75180U, 0xBFD06116U, 0x21B4F4B5U, 0x56B3C423U,
+  0xCFBA9599U, 0xB8BDA50FU, 0x2802B89EU, 0x5F058808U, 0xC60CD9B2U, 0xB10BE924U,
+  0x2F6F7C87U, 0x58684C11U, 0xC1611DABU, 0xB6662D3DU, 0x76DC4190U, 0x01DB7106U,
+  0x98D220BCU, 0xEFD5102AU, 0x71B18589U, 0x06B6B51FU, 0x9FBFE4A5U, 0xE8B8D433U,
+  0x7807C9A2U, 0x0F00F934U, 0x9609A88EU, 0xE10E9818U, 0x7F6A0DBBU, 0x086D3D2DU,
+  0x91646C97U, 0xE6635C01U, 0x6B6B51F4U, 0x1C6C6162U, 0x856530D8U, 0xF262004EU,
+  0x6C0695EDU, 0x1B01A57BU, 0x8208F4C1U, 0xF50FC457U, 0x65B0D9C6U, 0x12B7E950U,
+  0x8BBEB8EAU, 0xFCB9887CU, 0x62DD1DDFU, 0x15DA2D49U, 0x8CD37CF3U, 0xFBD44C65U,
+  0x4DB26158U, 0x3AB551CEU, 0xA3BC0074U, 0xD4BB30E2U, 0x4ADFA541U, 0x3DD895D7U,
+  0xA4D1C46DU, 0xD3D6F4FBU, 0x4369E96AU, 0x346ED9FCU, 0xAD678846U, 0xDA60B8D0U,
+  0x44042D73U, 0x33031DE5U, 0xAA0A4C5FU, 0xDD0D7CC9U, 0x5005713CU, 0x270241AAU,
+  0xBE0B1010U, 0xC90C2086U, 0x5768B525U, 0x206F85B3U, 0xB966D409U, 0xCE61E49FU,
+  0x5EDEF90EU, 0x29D9C998U, 0xB0D09822U, 0xC7D7A8B4U, 0x59B33D17U, 0x2EB40D81U,
+  0xB7BD5C3BU, 0xC0BA6CADU, 0xEDB88320U, 0x9ABFB3B6U, 0x03B6E20CU, 0x74B1D29AU,
+  0xEAD54739U, 0x9DD277AFU, 0x04DB2615U, 0x73DC1683U, 0xE3630B12U, 0x94643B84U,
+  0x0D6D6A3EU, 0x7A6A5AA8U, 0xE40ECF0BU, 0x9309FF9DU, 0x0A00AE27U, 0x7D079EB1U,
+  0xF00F9344U, 0x8708A3D2U, 0x1E01F268U, 0x6906C2FEU, 0xF762575DU, 0x806567CBU,
+  0x196C3671U, 0x6E6B06E7U, 0xFED41B76U, 0x89D32BE0U, 0x10DA7A5AU, 0x67DD4ACCU,
+  0xF9B9DF6FU, 0x8EBEEFF9U, 0x17B7BE43U, 0x60B08ED5U, 0xD6D6A3E8U, 0xA1D1937EU,
+  0x38D8C2C4U, 0x4FDFF252U, 0xD1BB67F1U, 0xA6BC5767U, 0x3FB506DDU, 0x48B2364BU,
+  0xD80D2BDAU, 0xAF0A1B4CU, 0x36034AF6U, 0x41047A60U, 0xDF60EFC3U, 0xA867DF55U,
+  0x316E8EEFU, 0x4669BE79U, 0xCB61B38CU, 0xBC66831AU, 0x256FD2A0U, 0x5268E236U,
+  0xCC0C7795U, 0xBB0B4703U, 0x220216B9U, 0x5505262FU, 0xC5BA3BBEU, 0xB2BD0B28U,
+  0x2BB45A92U, 0x5CB36A04U, 0xC2D7FFA7U, 0xB5D0CF31U, 0x2CD99E8BU, 0x5BDEAE1DU,
+  0x9B64C2B0U, 0xEC63F226U, 0x756AA39CU, 0x026D930AU, 0x9C0906A9U, 0xEB0E363FU,
+  0x72076785U, 0x05005713U, 0x95BF4A82U, 0xE2B87A14U, 0x7BB12BAEU, 0x0CB61B38U,
+  0x92D28E9BU, 0xE5D5BE0DU, 0x7CDCEFB7U, 0x0BDBDF21U, 0x86D3D2D4U, 0xF1D4E242U,
+  0x68DDB3F8U, 0x1FDA836EU, 0x81BE16CDU, 0xF6B9265BU, 0x6FB077E1U, 0x18B74777U,
+  0x88085AE6U, 0xFF0F6A70U, 0x66063BCAU, 0x11010B5CU, 0x8F659EFFU, 0xF862AE69U,
+  0x616BFFD3U, 0x166CCF45U, 0xA00AE278U, 0xD70DD2EEU, 0x4E048354U, 0x3903B3C2U,
+  0xA7672661U, 0xD06016F7U, 0x4969474DU, 0x3E6E77DBU, 0xAED16A4AU, 0xD9D65ADCU,
+  0x40DF0B66U, 0x37D83BF0U, 0xA9BCAE53U, 0xDEBB9EC5U, 0x47B2CF7FU, 0x30B5FFE9U,
+  0xBDBDF21CU, 0xCABAC28AU, 0x53B39330U, 0x24B4A3A6U, 0xBAD03605U, 0xCDD70693U,
+  0x54DE5729U, 0x23D967BFU, 0xB3667A2EU, 0xC4614AB8U, 0x5D681B02U, 0x2A6F2B94U,
+  0xB40BBE37U, 0xC30C8EA1U, 0x5A05DF1BU, 0x2D02EF8DU };
+
+#define MTX_READ_BLOCK_SIZE (1<<20) //!< The block size used to read ASCII matrix files [bytes].
+#define MTX_READ_INITIAL_NROWS (1024) //!< The initial number of rows allocated when reading ASCII matrix files (doubled as needed).
+
 
 /// \brief This static global variable indicates whether matrix
 /// operations for single elements are treated as scalar
@@ -124,6 +211,16 @@ inevitable. Please report bugs and suggested fixes to glenn @ zenautics.com.\n
 /// treated as a scalar and is multiplied into every element of C.
 BOOL MTX_static_global_treat_1x1_as_scalar = TRUE;
 
+/// \brief These static global counters are the number of matrices
+/// allocated from scratch (MTX_static_alloc) and freed (MTX_Free).
+/// Freeing an empty matrix is not counted, nor is the free of the 
+/// previous memory when a matrix is allocated from scratch again.
+/// They are used to profile the allocation churn of the processing 
+/// loop (MTX_GetAllocationCounters). They are not synchronized between 
+/// threads and wrap around.
+unsigned MTX_static_global_nr_allocations = 0;
+unsigned MTX_static_global_nr_deallocations = 0;
+
 
 typedef struct
 {
@@ -155,6 +252,9 @@ typedef struct _MTX_listItemCplx
 }_MTX_STRUCT_ReadFromFileListElem;
 
 
+/// static function for freeing matrix memory, the free is counted if isCounted and memory was released
+static BOOL MTX_static_free( MTX *M, const BOOL isCounted );
+
 /// static function for matrix memory allocation
 static BOOL MTX_static_alloc( MTX *M, const unsigned nrows, const unsigned ncols, const BOOL setToZero, const BOOL isReal );
 
@@ -163,6 +263,26 @@ static BOOL MTX_static_ConvertComplexTo( MTX *M, BOOL useReal );
 
 static BOOL MTX_static_get_row_array_from_string( char *datastr, _MTX_STRUCT_ReadFromFileListElem *L, const unsigned ncols );
 
+/// Gets ncols real values from a string of data into row.
+static BOOL MTX_static_get_real_row_from_string( const char *datastr, double *row, const unsigned ncols );
+
+/// Converts the number at the start of str to a double, identical to sscanf( str, "%lf", value ).
+/// Decimal numbers with at most 2^53 as the significand and 1e22 as the power of ten are 
+/// converted exactly without the C runtime, others use strtod.
+static BOOL MTX_static_StringToDouble( const char *str, double *value );
+
+/// Reads the real data of an ASCII matrix file directly into the columns of M, starting 
+/// with firstLine (already read from the file) and reading the remainder of the file in blocks.
+/// If checkForComplex is TRUE and complex data is found, complexDetected is set and reading stops.
+static BOOL MTX_static_ReadRealDataFromFile( 
+  FILE *in,                     //!< The input file, positioned after firstLine.
+  const char *firstLine,        //!< The first line of data.
+  const unsigned ncols,         //!< The number of columns.
+  const BOOL checkForComplex,   //!< Stop if complex data is found.
+  MTX *M,                       //!< The result matrix.
+  BOOL *complexDetected         //!< A boolean to indicate that complex data was found.
+  );
+
 /// This function gets the next valid line of data. Whitespace lines are skipped.
 static BOOL MTX_static_get_next_valid_data_line(
   FILE *in, //!< The input file pointer (input).
@@ -261,9 +381,6 @@ static void MTX_static_quick_complex_divide(
 
 
 
-/// Calculate a CRC value to be used by CRC calculation functions.
-static unsigned MTX_static_CRC32(unsigned ulCRC);
-
 /// Updates the 32 bit CRC with a block of data.
 /// This function can be called once (with uiCRC initialized to zero) to get the crc
 /// for a single byte vector or multiple times to apply the crc calculation to multiple
@@ -276,6 +393,40 @@ static void MTX_static_SaveAndLoadCleanUp( FILE *fid, unsigned char **bytes, uns
 /// loads a legacy verison of a .mtx binary matrix file
 static BOOL MTX_static_ReadCompressed_LegacyVersion( MTX* M, const char *path );
 
+/// Encodes a column of n doubles as a block of a columnar matrix file (MTX_SaveColumnar).
+/// block must have room for 1 + MTX_NK*(n + 8) bytes and plane for n bytes.
+static void MTX_static_EncodeColumnarBlock( const double *x, const unsigned n, const BOOL compress, unsigned char *block, unsigned *length, unsigned char *plane );
+
+/// Decodes a block of a columnar matrix file to n doubles.
+static BOOL MTX_static_DecodeColumnarBlock( const unsigned char *block, const unsigned length, const unsigned n, double *x );
+
+/// Opens a columnar matrix file and reads the file header. The file is positioned at the first chunk.
+/// If header is not NULL, the column names are allocated and must be freed later.
+static BOOL MTX_static_OpenColumnar( const char *path, const char *mode, FILE **fid, unsigned *ncols, char **header );
+
+/// Reads the header of the next chunk of a columnar matrix file. atEOF is set if there are no more chunks.
+static BOOL MTX_static_ReadColumnarChunkHeader( FILE *fid, const unsigned ncols, unsigned *nrows, double *minimum, double *maximum, unsigned *length, BOOL *atEOF );
+
+/// Determines the huffman code lengths (at most MTX_HUFFMAN_MAX_BITS) for the 256 byte values.
+static void MTX_static_HuffmanCodeLengths( const unsigned *freq, unsigned char *lengths );
+
+/// Determines the canonical huffman codes (bit reversed) from the code lengths.
+/// \return FALSE if the code lengths are invalid.
+static BOOL MTX_static_HuffmanCodes( const unsigned char *lengths, unsigned *codes );
+
+/// Estimates the encoded length of each byte column of n 64 bit words.
+static void MTX_static_EstimateCompressedPlanes( const MTX_UINT64 *words, const unsigned n, unsigned *length );
+
+/// Encodes a column of n doubles as a block of a compressed matrix file (MTX_SaveCompressed, version 2).
+/// block must have room for MTX_COMPRESSED_MAX_BLOCK_LENGTH(n) bytes, words for n words and plane for n bytes.
+static void MTX_static_EncodeCompressedBlock( const double *x, const unsigned n, unsigned char *block, unsigned *length, MTX_UINT64 *words, unsigned char *plane );
+
+/// Decodes a block of a compressed matrix file (version 2) to n doubles.
+static BOOL MTX_static_DecodeCompressedBlock( const unsigned char *block, const unsigned length, const unsigned n, double *x );
+
+/// Loads nrows rows (0 for all rows) from startRow of a compressed matrix file (version 2).
+static BOOL MTX_static_ReadCompressed_Version2( MTX* M, const char *path, const unsigned startRow, const unsigned nrows );
+
 
 /// Performs factorization by gaussian elimination with scaled parital pivoting
 /// /b Reference /n
@@ -465,8 +616,14 @@ BOOL MTX_SetComment( MTX *M, const char *comment )
 }
 
 BOOL MTX_Free( MTX *M )
+{
+  return MTX_static_free( M, TRUE );
+}
+
+BOOL MTX_static_free( MTX *M, const BOOL isCounted )
 {
   unsigned j = 0;
+  BOOL isReleased = FALSE;
 
   if( !M )
   {
@@ -502,6 +659,7 @@ BOOL MTX_Free( MTX *M )
   }
 
 
+  isReleased = M->ncols > 0;
   if( M->isReal )
   {
     for( j = 0; j < M->ncols; j++ )
@@ -532,9 +690,20 @@ BOOL MTX_Free( MTX *M )
   if( M->comment )
     free( M->comment );
   M->comment = NULL;
+
+  if( isCounted && isReleased )
+    MTX_static_global_nr_deallocations++;
   return TRUE;
 }
 
+void MTX_GetAllocationCounters( unsigned *nrAllocations, unsigned *nrDeallocations )
+{
+  if( nrAllocations )
+    *nrAllocations = MTX_static_global_nr_allocations;
+  if( nrDeallocations )
+    *nrDeallocations = MTX_static_global_nr_deallocations;
+}
+
 
 BOOL MTX_Malloc( MTX *M, const unsigned nrows, const unsigned ncols, const BOOL isReal )
 {
@@ -622,8 +791,9 @@ BOOL MTX_static_alloc( MTX *M, const unsigned nrows, const unsigned ncols, const
     }    
   }
 
-  // The matrix must be built from scratch.
-  MTX_Free( M );
+  // The matrix must be built from scratch, the allocation is counted but not the free.
+  MTX_static_free( M, FALSE );
+  MTX_static_global_nr_allocations++;
 
   M->isReal = isReal;
   M->nrows = nrows;
@@ -3288,7 +3458,7 @@ BOOL MTX_OneMinus( const MTX* src, MTX *dst )
 
 BOOL MTX_DetermineFileDelimiter(
                                 const char *path, //!< path to the input file
-                                char *delimiter, //!< delimiter, 'b' is binary
+                                char *delimiter, //!< delimiter, 'b' is binary, 'c' is columnar binary
                                 BOOL *hasComment, //!< BOOL to indicate if a comment line is present
                                 char **comment //!< pointer to a string to store the comment line, *comment memory must be freed later.
                                 )
@@ -3337,13 +3507,21 @@ BOOL MTX_DetermineFileDelimiter(
   }
 
   // check is this is a binary compressed matrix
-  if( strcmp( line, MTX_ID_COMPRESSED_01 ) == 0 )
+  if( strcmp( line, MTX_ID_COMPRESSED_01 ) == 0 || strcmp( line, MTX_ID_COMPRESSED_02 ) == 0 )
   {
     *delimiter = 'b'; // binary
     fclose( in );
     return TRUE;
   }
 
+  // check is this is a columnar matrix
+  if( strcmp( line, MTX_ID_COLUMNAR_01 ) == 0 )
+  {
+    *delimiter = 'c'; // columnar binary
+    fclose( in );
+    return TRUE;
+  }
+
   // check is this is a legacy binary compressed matrix
   if( strcmp( line, MTX_ID_LEGACY_V01 ) == 0 )
   {
@@ -3970,13 +4148,6 @@ BOOL MTX_static_get_row_array_from_string_cplx( char *datastr, const char delimi
 
 BOOL MTX_static_get_row_array_from_string( char *datastr, _MTX_STRUCT_ReadFromFileListElem *L, const unsigned ncols )
 {
-  unsigned i = 0;
-  unsigned n; // number of columns read successfully
-  unsigned line_length;
-  char c;
-  BOOL wasLastCharData = FALSE;
-  int rv;
-
   if( !datastr )
   {
     MTX_ERROR_MSG( "datastr is NULL." );
@@ -3995,6 +4166,18 @@ BOOL MTX_static_get_row_array_from_string( char *datastr, _MTX_STRUCT_ReadFromFi
     return FALSE;
   }
 
+  return MTX_static_get_real_row_from_string( datastr, L->rowptr, ncols );
+}
+
+
+BOOL MTX_static_get_real_row_from_string( const char *datastr, double *row, const unsigned ncols )
+{
+  unsigned i = 0;
+  unsigned n; // number of columns read successfully
+  unsigned line_length;
+  char c;
+  BOOL wasLastCharData = FALSE;
+
   line_length = (unsigned int)strlen(datastr);
   if( line_length == 0 )
   {
@@ -4027,12 +4210,7 @@ BOOL MTX_static_get_row_array_from_string( char *datastr, _MTX_STRUCT_ReadFromFi
       if( !wasLastCharData )
       {
         // try to read in the data to be sure the element is valid
-#ifndef _CRT_SECURE_NO_DEPRECATE
-        rv = sscanf_s( &(datastr[i]), "%lf", &(L->rowptr[n]) );
-#else
-        rv = sscanf( &(datastr[i]), "%lf", &(L->rowptr[n]) );
-#endif
-        if( rv == 0 || rv == EOF )
+        if( !MTX_static_StringToDouble( &(datastr[i]), &(row[n]) ) )
         {
           // invalid element, file is corrupt
           MTX_ERROR_MSG( "Invalid element found." );
@@ -4072,6 +4250,296 @@ BOOL MTX_static_get_row_array_from_string( char *datastr, _MTX_STRUCT_ReadFromFi
 }
 
 
+
+BOOL MTX_static_StringToDouble( const char *str, double *value )
+{
+  const char *p = str;
+  char *end = NULL;
+  MTX_UINT64 m = 0;       // The significand.
+  int e = 0;              // The power of ten.
+  int ex = 0;             // The explicit exponent.
+  BOOL isNegative = FALSE;
+  BOOL isExponentNegative = FALSE;
+  BOOL hasDigits = FALSE;
+  BOOL isExact = TRUE;    // Is m an exact representation of the digits.
+  const MTX_UINT64 maxSignificand = (MTX_UINT64)1.0e17;           // m*10 cannot overflow
+  const MTX_UINT64 maxExactSignificand = (MTX_UINT64)9007199254740992.0; // 2^53
+
+  if( *p == '-' || *p == '+' )
+  {
+    isNegative = *p == '-';
+    p++;
+  }
+  while( *p >= '0' && *p <= '9' )
+  {
+    hasDigits = TRUE;
+    if( m < maxSignificand )
+      m = m*10 + (MTX_UINT64)(*p - '0');
+    else
+      isExact = FALSE;
+    p++;
+  }
+  if( *p == '.' )
+  {
+    p++;
+    while( *p >= '0' && *p <= '9' )
+    {
+      hasDigits = TRUE;
+      if( m < maxSignificand )
+      {
+        m = m*10 + (MTX_UINT64)(*p - '0');
+        e--;
+      }
+      else
+      {
+        isExact = FALSE;
+      }
+      p++;
+    }
+  }
+  if( hasDigits && (*p == 'e' || *p == 'E') )
+  {
+    if( (p[1] >= '0' && p[1] <= '9') || ((p[1] == '-' || p[1] == '+') && p[2] >= '0' && p[2] <= '9') )
+    {
+      p++;
+      if( *p == '-' || *p == '+' )
+      {
+        isExponentNegative = *p == '-';
+        p++;
+      }
+      while( *p >= '0' && *p <= '9' )
+      {
+        if( ex < 10000 )
+          ex = ex*10 + (*p - '0');
+        p++;
+      }
+      e += isExponentNegative ? -ex : ex;
+    }
+  }
+
+  // Anything that strtod might interpret differently (hexadecimal, inf, nan, a trailing 
+  // exponent character, etc) and values that cannot be converted exactly use strtod.
+  if( hasDigits && isExact && !isalnum( (unsigned char)(*p) ) && *p != '.' && m <= maxExactSignificand )
+  {
+    if( m == 0 )
+    {
+      *value = isNegative ? -0.0 : 0.0;
+      return TRUE;
+    }
+    if( e >= 0 && e <= 22 )
+    {
+      *value = (double)m * MTX_static_pow10[e];
+      if( isNegative )
+        *value = -(*value);
+      return TRUE;
+    }
+    if( e < 0 && e >= -22 )
+    {
+      *value = (double)m / MTX_static_pow10[-e];
+      if( isNegative )
+        *value = -(*value);
+      return TRUE;
+    }
+  }
+
+  *value = strtod( str, &end );
+  if( end == str )
+  {
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+BOOL MTX_static_ReadRealDataFromFile( 
+  FILE *in,
+  const char *firstLine,
+  const unsigned ncols,
+  const BOOL checkForComplex,
+  MTX *M,
+  BOOL *complexDetected
+  )
+{
+  char *block = NULL;             // The block of file data, always null terminated.
+  char *tmp = NULL;
+  char *line = NULL;              // The current line.
+  double *row = NULL;             // The values of the current line.
+  double *column = NULL;
+  unsigned blockSize = MTX_READ_BLOCK_SIZE;
+  unsigned nrows = 0;             // The number of rows read.
+  unsigned capacity = MTX_READ_INITIAL_NROWS; // The number of rows allocated in M.
+  unsigned length = 0;            // The number of bytes in the block.
+  unsigned start = 0;             // The start of the current line in the block.
+  unsigned i = 0;
+  unsigned j = 0;
+  size_t count = 0;
+  BOOL atEOF = FALSE;
+  BOOL isWhitespace = FALSE;
+  BOOL result = TRUE;
+
+  *complexDetected = FALSE;
+
+  if( ncols == 0 )
+  {
+    MTX_ERROR_MSG( "if( ncols == 0 )" );
+    return FALSE;
+  }
+
+  if( !MTX_Malloc( M, capacity, ncols, TRUE ) )
+  {
+    MTX_ERROR_MSG( "MTX_Malloc returned FALSE." );
+    return FALSE;
+  }
+  block = (char*)malloc( blockSize+1 );
+  row = (double*)malloc( ncols*sizeof(double) );
+  if( block == NULL || row == NULL )
+  {
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    if( block != NULL )
+      free( block );
+    if( row != NULL )
+      free( row );
+    return FALSE;
+  }
+
+  // The first line is already in memory, the lines that follow are parsed from the blocks.
+  line = (char*)firstLine;
+  while( result )
+  {
+    if( line != NULL )
+    {
+      // skip whitespace lines
+      isWhitespace = TRUE;
+      for( i = 0; line[i] != '\0'; i++ )
+      {
+        if( !isspace( (unsigned char)line[i] ) )
+        {
+          isWhitespace = FALSE;
+          break;
+        }
+      }
+
+      if( !isWhitespace )
+      {
+        if( checkForComplex && ( strchr( line, 'i' ) != NULL || strchr( line, 'j' ) != NULL ) )
+        {
+          *complexDetected = TRUE;
+          break;
+        }
+
+        if( !MTX_static_get_real_row_from_string( line, row, ncols ) )
+        {
+          MTX_ERROR_MSG( "MTX_static_get_real_row_from_string returned FALSE." );
+          result = FALSE;
+          break;
+        }
+
+        if( nrows == capacity )
+        {
+          // grow the columns
+          for( j = 0; j < ncols; j++ )
+          {
+            column = (double*)realloc( M->data[j], 2*capacity*sizeof(double) );
+            if( column == NULL )
+            {
+              MTX_ERROR_MSG( "realloc returned NULL." );
+              result = FALSE;
+              break;
+            }
+            M->data[j] = column;
+          }
+          if( !result )
+            break;
+          capacity *= 2;
+          M->nrows = capacity;
+        }
+        for( j = 0; j < ncols; j++ )
+        {
+          M->data[j][nrows] = row[j];
+        }
+        nrows++;
+      }
+      line = NULL;
+    }
+
+    // find the next line in the block
+    for( i = start; i < length; i++ )
+    {
+      if( block[i] == '\n' )
+        break;
+    }
+    if( i < length )
+    {
+      block[i] = '\0';
+      line = block + start;
+      start = i+1;
+      continue;
+    }
+    if( atEOF )
+    {
+      if( start < length )
+      {
+        // the last line has no line ending
+        line = block + start;
+        start = length;
+        continue;
+      }
+      break;
+    }
+
+    // move the partial line to the front of the block and read the next block
+    length -= start;
+    memmove( block, block + start, length );
+    start = 0;
+    if( length == blockSize )
+    {
+      // a very long line
+      tmp = (char*)realloc( block, 2*blockSize+1 );
+      if( tmp == NULL )
+      {
+        MTX_ERROR_MSG( "realloc returned NULL." );
+        result = FALSE;
+        break;
+      }
+      block = tmp;
+      blockSize *= 2;
+    }
+    count = fread( block + length, sizeof(char), blockSize - length, in );
+    if( count == 0 )
+    {
+      if( ferror( in ) )
+      {
+        MTX_ERROR_MSG( "Error reading in the data." );
+        result = FALSE;
+        break;
+      }
+      atEOF = TRUE;
+    }
+    length += (unsigned)count;
+    block[length] = '\0';
+  }
+
+  free( block );
+  free( row );
+
+  if( !result || *complexDetected )
+  {
+    MTX_Free( M );
+    return result;
+  }
+
+  // trim the columns to the number of rows read
+  for( j = 0; j < ncols; j++ )
+  {
+    column = (double*)realloc( M->data[j], nrows*sizeof(double) );
+    if( column != NULL )
+      M->data[j] = column;
+  }
+  M->nrows = nrows;
+  return TRUE;
+}
+
+
 BOOL MTX_static_get_next_valid_data_line(
   FILE *in, //!< The input file pointer (input).
   char *linebuf, //!< A exisiting buffer to store the input line (input/output).
@@ -4234,30 +4702,20 @@ BOOL MTX_static_look_for_complex_data(
 
 // Reads in the matrix M->data from the specified file using the indicated *delimiter
 // ReadFromFile is 'read smart' (it determines the size of the input matrix on its own)
-// The number of columns are first determined then all M->data is read into linked lists
-// untill end of file is reached. Data is then stored in the matrix.
+// The number of columns are first determined then the file is read in large blocks
+// and each line is parsed directly into the columns of M (grown as needed).
 BOOL MTX_ReadFromFileRealOnly( MTX *M, const char *path )
 {
-  unsigned i = 0;
   FILE *in = NULL;
   char delimiter = 0;
   char linebuf[MTX_MAX_READFROMFILE_BUFFER];
   unsigned ncols = 0;
-  unsigned nrows = 0;
   unsigned fsize = 0;
   unsigned line_length = 0;
   BOOL hasCommentLine = FALSE;
-  BOOL errorInReadingDataFile = FALSE;
-  BOOL errorInTranspose = FALSE;
   BOOL atEOF = FALSE;
-  MTX RowMatrix;
-
-  // a linked list of row arrays
-  _MTX_STRUCT_ReadFromFileListElem *L = NULL;
-  _MTX_STRUCT_ReadFromFileListElem *nL = NULL;
-  _MTX_STRUCT_ReadFromFileListElem head;
-  head.next = NULL;
-  head.rowptr = NULL;
+  BOOL complexDetected = FALSE;
+  char *commentLine = NULL;
 
   if( M == NULL )
   {
@@ -4295,10 +4753,8 @@ BOOL MTX_ReadFromFileRealOnly( MTX *M, const char *path )
   }
   fclose(in);
 
-  MTX_Init( &RowMatrix );
-
   // determine the file delimiter
-  if( MTX_DetermineFileDelimiter( path, &delimiter, &hasCommentLine, &(M->comment) ) == FALSE )
+  if( MTX_DetermineFileDelimiter( path, &delimiter, &hasCommentLine, &commentLine ) == FALSE )
   {
     MTX_ERROR_MSG( "MTX_DetermineFileDelimiter returned FALSE." );
     return FALSE;
@@ -4318,6 +4774,20 @@ BOOL MTX_ReadFromFileRealOnly( MTX *M, const char *path )
     }
   }
 
+  // check if this is a columnar matrix, all columns are read
+  if( delimiter == 'c' )
+  {
+    if( MTX_ReadColumnar( M, path, NULL, 0, FALSE, 0, 0 ) )
+    {
+      return TRUE;
+    }
+    else
+    {
+      MTX_ERROR_MSG( "MTX_ReadColumnar returned FALSE." );
+      return FALSE;
+    }
+  }
+
   // determine the size of the file
   if( MTX_DetermineFileSize( path, &fsize ) == FALSE )
   {
@@ -4381,156 +4851,24 @@ BOOL MTX_ReadFromFileRealOnly( MTX *M, const char *path )
   }
 
 
-  // super fast rowwise input routine
-  // a rowwise matrix is constructed using a linked list approach
-  // line by line input
-  nrows = 0;
-  head.rowptr = (double*)malloc( ncols*sizeof(double) );
-  // get the row data from the string and store it in the list item row array
-  if( MTX_static_get_row_array_from_string( linebuf, &head, ncols ) == FALSE )
+  // The data is parsed directly into the columns of M.
+  if( !MTX_static_ReadRealDataFromFile( in, linebuf, ncols, FALSE, M, &complexDetected ) )
   {
-    // must free head's rowarray
-    free( head.rowptr );
-    MTX_ERROR_MSG( "MTX_static_get_row_array_from_string returned FALSE." );
+    fclose( in );
+    MTX_ERROR_MSG( "MTX_static_ReadRealDataFromFile returned FALSE." );
     return FALSE;
   }
-  nrows++;
-  nL = &head;
+  fclose( in );
 
-  while(1)
+  if( commentLine != NULL )
   {
-    // get the next string of data
-    if( !MTX_static_get_next_valid_data_line( in, linebuf, &line_length, &atEOF ) )
-    {
-      errorInReadingDataFile = TRUE;
-      break;
-    }
-    if( atEOF )
-    {
-      break;
-    }
-
-    // the 'current' list itme
-    L = nL;
-
-    // allocate the next list item
-    nL = (_MTX_STRUCT_ReadFromFileListElem*)malloc( sizeof( _MTX_STRUCT_ReadFromFileListElem ) );
-    if( !nL )
-    {
-      // memory allocate failure
-      // must free the linked list
-      errorInReadingDataFile = TRUE;
-      // must free head's rowarray
-      free( head.rowptr );
-      MTX_ERROR_MSG( "if( !nL )" );
-      return FALSE;
-    }
-    // intialize the row
-    nL->rowptr = NULL;
-    nL->next = NULL;
-    // allocate the row
-    nL->rowptr = (double*)malloc( ncols*sizeof(double) );
-    if( !nL->rowptr )
-    {
-      // memory allocate failure
-      // must free the linked list
-      errorInReadingDataFile = TRUE;
-      break;
-    }
-
-    // store the pointer to the next list item
-    // in the 'current'
-    L->next = nL;
-
-    // get the row data from the string and store it in the list item row array
-    if( MTX_static_get_row_array_from_string( linebuf, nL, ncols ) == FALSE )
-    {
-      // must free the linked list
-      errorInReadingDataFile = TRUE;
-      break;
-    }
-    nrows++;
-  }
-
-  if( errorInReadingDataFile )
-  {
-    // free the list
-    L = head.next;
-    while( L!=NULL )
-    {
-      nL = L->next;
-      free( L->rowptr );
-      free(L);
-      L = nL;
-    }
-    free( head.rowptr );
-
-    MTX_ERROR_MSG( "if( errorInReadingDataFile )" );
-    return FALSE;
-  }
-
-  // copy the list into a MTX object
-
-  // allocate the row array of pointers
-  RowMatrix.data = (double**)malloc( nrows*sizeof(double*) );
-  if( !RowMatrix.data )
-  {
-    MTX_ERROR_MSG( "malloc returned NULL." );
-    return FALSE;
-  }
-
-  // looks weird but this is rowwise input
-  RowMatrix.ncols = nrows;
-  RowMatrix.nrows = ncols;
-
-  L = &head;
-  for( i = 0; i < nrows; i++ )
-  {
-    if( L == NULL )
-    {
-      // this should never happen
-      free(RowMatrix.data);
-      RowMatrix.data = NULL;
-      MTX_ERROR_MSG( "if( L == NULL )" );
-      return FALSE;
-    }
-    RowMatrix.data[i] = L->rowptr; // only copying a pointer!
-    L = L->next;
-  }
-
-  // copy the data by means of transpose
-  // this places the data in the correct MTX storage format
-  // only one copy operation
-  if( !MTX_Transpose( &RowMatrix, M ) )
-  {
-    errorInTranspose = TRUE;
-  }
-
-  // free the list data and the list items
-  L = head.next;
-  while( L!=NULL )
-  {
-    nL = L->next;
-    free( L->rowptr );
-    free(L);
-    L = nL;
-  }
-  // free the head data
-  free( head.rowptr );
-
-  // free the RowMatrix data ptr
-  free( RowMatrix.data );
-
-  if( errorInTranspose )
-  {
-    MTX_ERROR_MSG( "if( errorInTranspose )" );
-    return FALSE;
-  }
-  else
-  {
-    return TRUE;
-  }
-}
+    // Set the comment line.
+    if( M->comment != NULL )
+      free( M->comment );
+    M->comment = commentLine;
+  }
+  return TRUE;
+}
 
 // Reads in the matrix (real or complex) from the specified file using the indicated *delimiter
 // ReadFromFile is 'read smart' (it determines the size of the input matrix on its own)
@@ -4619,6 +4957,20 @@ BOOL MTX_ReadFromFile( MTX *M, const char *path )
     }
   }
 
+  // check if this is a columnar matrix, all columns are read
+  if( delimiter == 'c' )
+  {
+    if( MTX_ReadColumnar( M, path, NULL, 0, FALSE, 0, 0 ) )
+    {
+      return TRUE;
+    }
+    else
+    {
+      MTX_ERROR_MSG( "MTX_ReadColumnar returned FALSE." );
+      return FALSE;
+    }
+  }
+
   // determine the size of the file
   if( MTX_DetermineFileSize( path, &fsize ) == FALSE )
   {
@@ -4706,6 +5058,47 @@ BOOL MTX_ReadFromFile( MTX *M, const char *path )
   }
 
 
+  // Real data is parsed directly into the columns of M. If complex data is found 
+  // later in the file, the file is read again below as a list of rows.
+  if( isReal )
+  {
+    if( !MTX_static_ReadRealDataFromFile( in, linebuf, ncols, TRUE, M, &complexDetected ) )
+    {
+      fclose( in );
+      MTX_ERROR_MSG( "MTX_static_ReadRealDataFromFile returned FALSE." );
+      return FALSE;
+    }
+    if( !complexDetected )
+    {
+      fclose( in );
+      if( commentLine != NULL )
+      {
+        // Set the comment line.
+        if( M->comment != NULL )
+          free( M->comment );
+        M->comment = commentLine;
+      }
+      return TRUE;
+    }
+    complexDetected = FALSE;
+
+    // start again at the first line of data
+    rewind( in );
+    if( !MTX_static_get_next_valid_data_line( in, linebuf, &line_length, &atEOF ) || atEOF )
+    {
+      MTX_ERROR_MSG( "MTX_static_get_next_valid_data_line returned FALSE." );
+      return FALSE;
+    }
+    if( hasCommentLine )
+    {
+      if( !MTX_static_get_next_valid_data_line( in, linebuf, &line_length, &atEOF ) || atEOF )
+      {
+        MTX_ERROR_MSG( "MTX_static_get_next_valid_data_line returned FALSE." );
+        return FALSE;
+      }
+    }
+  }
+
   // super fast rowwise input routine
   // a rowwise matrix is constructed using a linked list approach
   // line by line input.
@@ -6832,12 +7225,231 @@ BOOL MTX_PrintAutoWidth_ToBuffer( const MTX *M, char *buffer, const unsigned max
   return TRUE;
 }
 
+/// The minimum number of exponent digits used by the C runtime for "%e" style output,
+/// e.g. "1e+05" (2 digits, C99 runtimes) or "1e+005" (3 digits, the msvcrt runtime 
+/// used before Visual Studio 2015). It is fixed when compiled rather than determined on 
+/// first use so that MTX_ValueToString_g has no shared state (it is called from several threads).
+#if defined WIN32 && !defined _UCRT && !defined __USE_MINGW_ANSI_STDIO && !( defined _MSC_VER && _MSC_VER >= 1900 )
+#define MTX_MIN_EXPONENT_DIGITS 3
+#else
+#define MTX_MIN_EXPONENT_DIGITS 2
+#endif
+
+
+BOOL MTX_ValueToString_g( const double value, const unsigned precision, char *buffer, const unsigned maxlength, unsigned *length )
+{
+  const double *pow10 = MTX_static_pow10;
+  const unsigned p = precision == 0 ? 1 : precision; // "%.0g" is treated as "%.1g"
+  MTX_UINT64 N = 0;
+  MTX_UINT64 Nmax = 1;  // 10^p
+  MTX_UINT64 Nmin = 1;  // 10^(p-1)
+  double a;     // The absolute value.
+  double t;     // The value scaled such that the integer part has p digits.
+  double f;     // The fraction part of t.
+  double err;   // The worst case error in t due to scaling.
+  int exp2 = 0; // The binary exponent.
+  int e = 0;    // The decimal exponent.
+  int k = 0;    // The scaling exponent.
+  int tries = 0;
+  BOOL isExact = FALSE;
+  char digits[24];
+  char exponent[8];
+  unsigned nd = 0; // The number of significant digits after stripping trailing zeros.
+  unsigned ne = 0; // The number of exponent digits.
+  unsigned n = 0;
+  unsigned i = 0;
+  char tmp[512];
+
+  if( buffer == NULL || length == NULL )
+  {
+    MTX_ERROR_MSG( "if( buffer == NULL || length == NULL )" );
+    return FALSE;
+  }
+  if( maxlength == 0 )
+  {
+    MTX_ERROR_MSG( "if( maxlength == 0 )" );
+    return FALSE;
+  }
+  *length = 0;
+  buffer[0] = '\0';
+
+  if( value == 0.0 && 1.0/value > 0.0 )
+  {
+    if( maxlength < 2 )
+    {
+      MTX_ERROR_MSG( "if( maxlength < 2 )" );
+      return FALSE;
+    }
+    buffer[0] = '0';
+    buffer[1] = '\0';
+    *length = 1;
+    return TRUE;
+  }
+
+  // Infinity, NAN, negative zero, and very high precision are left to the C runtime.
+  if( p <= 17 && fabs(value) <= DBL_MAX && value != 0.0 )
+  {
+    a = fabs(value);
+    frexp( a, &exp2 ); // a = m*2^exp2, 0.5 <= m < 1
+    e = (int)floor( (exp2-1)*0.30102999566398120 ); // log10(2)
+
+    for( i = 0; i < p; i++ )
+      Nmax *= 10;
+    Nmin = Nmax/10;
+
+    for( tries = 0; tries < 3; tries++ )
+    {
+      k = (int)p - 1 - e;
+      if( k > 44 || k < -44 )
+        break;
+
+      // Each multiplication or division by an exact power of ten is a single rounding.
+      if( k > 22 )
+      {
+        t = (a*pow10[22])*pow10[k-22];
+        err = 3.0*DBL_EPSILON;
+      }
+      else if( k >= 0 )
+      {
+        t = a*pow10[k];
+        err = 2.0*DBL_EPSILON;
+      }
+      else if( k >= -22 )
+      {
+        t = a/pow10[-k];
+        err = 2.0*DBL_EPSILON;
+      }
+      else
+      {
+        t = (a/pow10[22])/pow10[-k-22];
+        err = 3.0*DBL_EPSILON;
+      }
+      err *= t;
+
+      f = t - floor(t);
+      if( fabs( f - 0.5 ) <= err )
+        break; // too close to a rounding boundary to be certain
+
+      N = (MTX_UINT64)floor(t);
+      if( f > 0.5 )
+        N++;
+
+      if( N >= Nmax )
+      {
+        e++;
+        continue;
+      }
+      if( N < Nmin )
+      {
+        e--;
+        continue;
+      }
+      isExact = TRUE;
+      break;
+    }
+  }
+
+  if( !isExact )
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( sprintf_s( tmp, 512, "%.*g", precision, value ) < 0 )
+    {
+      MTX_ERROR_MSG( "sprintf_s returned failure." );
+      return FALSE;
+    }
+#else
+    if( sprintf( tmp, "%.*g", precision, value ) < 0 )
+    {
+      MTX_ERROR_MSG( "sprintf returned failure." );
+      return FALSE;
+    }
+#endif
+    n = (unsigned)strlen( tmp );
+  }
+  else
+  {
+    // The p digits of N, without trailing zeros.
+    for( i = p; i > 0; i-- )
+    {
+      digits[i-1] = (char)('0' + (int)(N % 10));
+      N /= 10;
+    }
+    nd = p;
+    while( nd > 1 && digits[nd-1] == '0' )
+      nd--;
+
+    if( value < 0 )
+      tmp[n++] = '-';
+
+    if( e < -4 || e >= (int)p )
+    {
+      // d.ddde+XX
+      tmp[n++] = digits[0];
+      if( nd > 1 )
+      {
+        tmp[n++] = '.';
+        for( i = 1; i < nd; i++ )
+          tmp[n++] = digits[i];
+      }
+      tmp[n++] = 'e';
+      tmp[n++] = e < 0 ? '-' : '+';
+      if( e < 0 )
+        e = -e;
+      do
+      {
+        exponent[ne++] = (char)('0' + e % 10);
+        e /= 10;
+      }while( e > 0 );
+      while( ne < MTX_MIN_EXPONENT_DIGITS )
+        exponent[ne++] = '0';
+      while( ne > 0 )
+        tmp[n++] = exponent[--ne];
+    }
+    else if( e >= 0 )
+    {
+      // ddd.ddd
+      for( i = 0; i <= (unsigned)e; i++ )
+        tmp[n++] = i < nd ? digits[i] : '0';
+      if( nd > (unsigned)e+1 )
+      {
+        tmp[n++] = '.';
+        for( i = (unsigned)e+1; i < nd; i++ )
+          tmp[n++] = digits[i];
+      }
+    }
+    else
+    {
+      // 0.000ddd
+      tmp[n++] = '0';
+      tmp[n++] = '.';
+      for( k = e; k < -1; k++ )
+        tmp[n++] = '0';
+      for( i = 0; i < nd; i++ )
+        tmp[n++] = digits[i];
+    }
+    tmp[n] = '\0';
+  }
+
+  if( n+1 > maxlength )
+  {
+    MTX_ERROR_MSG( "if( n+1 > maxlength )" );
+    return FALSE;
+  }
+  memcpy( buffer, tmp, n+1 );
+  *length = n;
+  return TRUE;
+}
+
+
 BOOL MTX_PrintDelimited( const MTX *M, const char *path, const unsigned precision, const char delimiter, const BOOL append )
 {
   unsigned i = 0;
   unsigned j = 0;
   char format[16];
   char ValueBuffer[512];
+  char *OutputBuffer = NULL;
+  unsigned nrBuffered = 0;
+  unsigned length = 0;
   FILE* out;
 
   if( MTX_isNull( M ) )
@@ -6898,67 +7510,50 @@ BOOL MTX_PrintDelimited( const MTX *M, const char *path, const unsigned precisio
 
   if( M->isReal )
   {
+    // Real data is formatted directly into a large output buffer that is written in blocks.
+    OutputBuffer = (char*)malloc( MTX_PRINTDELIMITED_BUFFER_SIZE );
+    if( OutputBuffer == NULL )
+    {
+      fclose(out);
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      return FALSE;
+    }
     for( i = 0; i < M->nrows; i++ )
     {
-      for( j = 0; j < M->ncols-1; j++ )
+      for( j = 0; j < M->ncols; j++ )
       {
-#ifndef _CRT_SECURE_NO_DEPRECATE
-        if( sprintf_s( format, 16, "%%.%dg%c", precision, delimiter ) < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf_s returned failure." );
-          return FALSE;
-        }
-        if( sprintf_s( ValueBuffer, 512, format, M->data[j][i] ) < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf_s returned failure." );
-          return FALSE;
-        }
-#else
-        if( sprintf( format, "%%.%dg%c", precision, delimiter ) < 0 )
+        if( !MTX_ValueToString_g( M->data[j][i], precision, OutputBuffer+nrBuffered, MTX_PRINTDELIMITED_BUFFER_SIZE-nrBuffered, &length ) )
         {
-          MTX_ERROR_MSG( "sprintf returned failure." );
+          free( OutputBuffer );
+          fclose(out);
+          MTX_ERROR_MSG( "MTX_ValueToString_g returned FALSE." );
           return FALSE;
         }
-        if( sprintf( ValueBuffer, format, M->data[j][i] ) < 0 )
+        nrBuffered += length;
+        if( j < M->ncols-1 )
+          OutputBuffer[nrBuffered++] = delimiter;
+        else
+          OutputBuffer[nrBuffered++] = '\n';
+
+        // Flush when there may not be enough room for the next value.
+        if( MTX_PRINTDELIMITED_BUFFER_SIZE - nrBuffered < 512 )
         {
-          MTX_ERROR_MSG( "sprintf returned failure." );
-          return FALSE;
+          fwrite( OutputBuffer, 1, nrBuffered, out );
+          nrBuffered = 0;
         }
-#endif
-        fprintf( out, ValueBuffer );
-      }
-#ifndef _CRT_SECURE_NO_DEPRECATE
-      if( sprintf_s( format, 16, "%%.%dg", precision ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
       }
-      if( sprintf_s( ValueBuffer, 512, format, M->data[j][i] ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
-      }
-#else
-      if( sprintf( format, "%%.%dg", precision ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-      if( sprintf( ValueBuffer, format, M->data[j][i] ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-#endif
-      fprintf( out, ValueBuffer );
-      fprintf( out, "\n" );
-    }
-  }
-  else
-  {
-    for( i = 0; i < M->nrows; i++ )
-    {
-      for( j = 0; j < M->ncols-1; j++ )
+    }
+    if( nrBuffered > 0 )
+    {
+      fwrite( OutputBuffer, 1, nrBuffered, out );
+    }
+    free( OutputBuffer );
+  }
+  else
+  {
+    for( i = 0; i < M->nrows; i++ )
+    {
+      for( j = 0; j < M->ncols-1; j++ )
       {
         if( M->cplx[j][i].im == 0 )
         {
@@ -7138,6 +7733,7 @@ BOOL MTX_PrintDelimited_ToBuffer( const MTX *M, char *buffer, const unsigned max
   unsigned j = 0;
   unsigned scount = 0;
   unsigned dcount = 0;
+  unsigned length = 0;
   BOOL endOfBuffer = FALSE;
   char format[16];
   char ValueBuffer[512];
@@ -7174,71 +7770,39 @@ BOOL MTX_PrintDelimited_ToBuffer( const MTX *M, char *buffer, const unsigned max
 
   ValueBuffer[0] = '\0';
 
-#ifndef _CRT_SECURE_NO_DEPRECATE
   if( M->isReal )
   {
     for( i = 0; i < M->nrows; i++ )
     {
-      for( j = 0; j < M->ncols-1; j++ )
+      for( j = 0; j < M->ncols; j++ )
       {
-        if( sprintf_s( format, 16, "%%.%dg%c", precision, delimiter ) < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf_s returned failure." );
-          return FALSE;
-        }
-        if( sprintf_s( ValueBuffer, 512, format, M->data[j][i] ) < 0 )
+        if( !MTX_ValueToString_g( M->data[j][i], precision, ValueBuffer, 511, &length ) )
         {
-          MTX_ERROR_MSG( "sprintf_s returned failure." );
+          MTX_ERROR_MSG( "MTX_ValueToString_g returned FALSE." );
           return FALSE;
         }
-        if( scount + strlen(ValueBuffer) >= maxlength )
+        if( j < M->ncols-1 )
+          ValueBuffer[length++] = delimiter;
+        if( scount + length >= maxlength )
         {
           endOfBuffer = TRUE;
           break;
         }
-        dcount = sprintf_s( buffer+scount, maxlength-scount, "%s", ValueBuffer );
-        if( dcount < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf_s returned failure." );
-          return FALSE;
-        }
-        scount += dcount;
+        memcpy( buffer+scount, ValueBuffer, length );
+        scount += length;
+        buffer[scount] = '\0';
       }
       if( endOfBuffer )
         break;
-      if( sprintf_s( format, 16, "%%.%dg", precision ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
-      }
-      if( sprintf_s( ValueBuffer, 512, format, M->data[j][i] ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
-      }
-      if( scount + strlen(ValueBuffer) >= maxlength )
-        break;
-      dcount = sprintf_s( buffer+scount, maxlength-scount, "%s", ValueBuffer );
-      if( dcount < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
-      }
-      scount += dcount;
-
       if( scount + 2 >= maxlength )
         break;
-      dcount = sprintf_s( buffer+scount, maxlength-scount, "\n" );
-      if( dcount < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf_s returned failure." );
-        return FALSE;
-      }
-      scount += dcount;
+      buffer[scount++] = '\n';
+      buffer[scount] = '\0';
     }
   }
   else
   {
+#ifndef _CRT_SECURE_NO_DEPRECATE
     for( i = 0; i < M->nrows; i++ )
     {
       for( j = 0; j < M->ncols-1; j++ )
@@ -7400,72 +7964,7 @@ BOOL MTX_PrintDelimited_ToBuffer( const MTX *M, char *buffer, const unsigned max
       }
       scount += dcount;
     }
-  }
 #else
-  if( M->isReal )
-  {
-    for( i = 0; i < M->nrows; i++ )
-    {
-      for( j = 0; j < M->ncols-1; j++ )
-      {
-        if( sprintf( format, "%%.%dg%c", precision, delimiter ) < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf returned failure." );
-          return FALSE;
-        }
-        if( sprintf( ValueBuffer, format, M->data[j][i] ) < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf returned failure." );
-          return FALSE;
-        }
-        if( scount + strlen(ValueBuffer) >= maxlength )
-        {
-          endOfBuffer = TRUE;
-          break;
-        }
-        dcount = sprintf( buffer+scount, "%s", ValueBuffer );
-        if( dcount < 0 )
-        {
-          MTX_ERROR_MSG( "sprintf returned failure." );
-          return FALSE;
-        }
-        scount += dcount;
-      }
-      if( endOfBuffer )
-        break;
-      if( sprintf( format, "%%.%dg", precision ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-      if( sprintf( ValueBuffer, format, M->data[j][i] ) < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-      if( scount + strlen(ValueBuffer) >= maxlength )
-        break;
-      dcount = sprintf( buffer+scount, "%s", ValueBuffer );
-      if( dcount < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-      scount += dcount;
-
-      if( scount + 2 >= maxlength )
-        break;
-      dcount = sprintf( buffer+scount, "\n" );
-      if( dcount < 0 )
-      {
-        MTX_ERROR_MSG( "sprintf returned failure." );
-        return FALSE;
-      }
-      scount += dcount;
-    }
-  }
-  else
-  {
     for( i = 0; i < M->nrows; i++ )
     {
       for( j = 0; j < M->ncols-1; j++ )
@@ -7853,8 +8352,8 @@ BOOL MTX_PrintRowToString( const MTX *M, const unsigned row, char *buffer, const
   {
     MTX_ERROR_MSG( "sprintf returned failure." );
     return FALSE;
-  }
 #endif
+  }
   return TRUE;
 }
 
@@ -13724,87 +14223,67 @@ int MTX_static_partition_indexed( double *a, double *index, unsigned start, unsi
 
 
 
-// Compression works as follows:
-// take a column of doubles
-// take each 8 bytes of a double
-// and RLE encode with the next 8 bytes of the next double
-// [ xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx xxxx ] a double
+// Compression (version 2) works as follows:
+// The rows are split into chunks of MTX_COMPRESSED_DEFAULT_CHUNK rows and each column
+// of a chunk (the real and imaginary parts of complex columns separately) is a block
+// that can be decoded on its own. The file header is followed by an index with the
+// offset, length and crc of every block, so that a range of rows can be read by
+// decoding only the chunks that contain them (MTX_ReadCompressedRows).
+//
+// Each block is formed as follows:
+// take the 64 bit words of the doubles in the column chunk
+// take the difference (or exclusive or) of consecutive words, whichever is estimated 
+// to compress better, so that slowly varying data has mostly zero high order bytes
 // [ byte0_0 byte1_0 byte2_0 byte3_0 byte4_0 byte5_0 byte6_0 byte7_0 ] as bytes
 // [ .. .. .. .. .. .. .. .. ]
-// [ .. .. .. .. .. .. .. .. ]
 // [ byte0_n byte1_n byte2_n byte3_n byte4_n byte5_n byte6_n byte7_n ] as bytes
-//
-// RLE encode byte0_0:n, byte1_0:n, etc
-// in this way one column becomes 8 columns
-//
-// this process takes advantage of the similarities in the data of each column
-// and the RLE methods available with INTEL_IPPS
-//
-// Note: The INTEL_IPPS RLE encoding method did not prove significantly faster in testing.
-//
-// aaabbbbaaaaabbabbbbbb
-// compressed becomes
-// aa1bb2aa3bb0abb4
-//
-// Columns where compression does not provide benefit are written without compression
+// and store each byte column as the shortest of: the raw bytes, a single constant byte, 
+// (byte, count) run length pairs, or a canonical huffman code.
 BOOL MTX_SaveCompressed( const MTX *M, const char *path )
 {
   unsigned i = 0;
   unsigned j = 0;
-  unsigned k = 0;
-  unsigned ncols = 0; // number of columns if real, number of columns * 2 if complex.
-
-  MTX MtxCol; // The current column for complex matrices only. Either real part or imag part.
+  unsigned c = 0;
+  unsigned n = 0;              // The number of rows in the current chunk.
+  unsigned r0 = 0;             // The first row of the current chunk.
+  unsigned nstored = 0;        // The number of stored columns, M->ncols if real, M->ncols*2 if complex.
+  unsigned nchunks = 0;        // The number of chunks.
+  unsigned chunk = MTX_COMPRESSED_DEFAULT_CHUNK; // The number of rows per chunk.
+  unsigned commentLength = 0;  // The length of the matrix comment if any.
+  unsigned length = 0;         // The length of the current block.
+  unsigned offset = 0;         // The file position of the current block.
+  unsigned indexLength = 0;    // The number of unsigned values in the block index.
+  unsigned *blockIndex = NULL; // The offset, length and crc of each block.
+  unsigned char *block = NULL; // The current encoded block.
+  unsigned char *plane = NULL; // A byte column (work buffer).
+  MTX_UINT64 *words = NULL;    // The transformed 64 bit words (work buffer).
+  double *column = NULL;       // The real or imaginary parts of a complex column chunk.
+  const double *x = NULL;      // The column chunk to encode.
+  long filemark = 0;           // The file position of the file size and crc.
+  long filesize = 0;
+  char msg[512];
+  FILE* fid = NULL;
+  BOOL result = TRUE;
+  _MTX_STRUCT_FileHeader fileHeader;
 
 #ifdef MTX_DEBUG
-  time_t t0, t1; /* time_t is defined on <time.h> and <sys/types.h> as long */
   clock_t c0, c1; /* clock_t is defined on <time.h> and <sys/types.h> as int */
   unsigned total_length = 0;
 #endif
 
-  const unsigned nk = MTX_NK; // number of byte columns per double column
-
-
-  unsigned char prevByte = 0;
-  unsigned char currByte = 0;
-  unsigned n = 0; // number of times the byte repeats (256 is upper bound!!)
-  unsigned p = 0; // counter  
-
-  unsigned char* bytes[MTX_NK];
-  unsigned char* compressed[MTX_NK];
-  unsigned char curr[MTX_NK];
-
-  char msg[512];
-
-  FILE* fid = NULL; // the output file pointer
-
-  unsigned commentLength = 0; // the length of the matrix comment if any
-  long filemark = 0; // a file position
-
-  double col_stdev = 0; // The variance of a column.
-  size_t count = 0;
-
-  _MTX_STRUCT_FileHeader fileHeader;
-  _MTX_STRUCT_CompressedColumnHeader columnHeader;
-
-  // initialize MtxCol
-  MTX_Init( &MtxCol );
-
-  memset( &fileHeader, 0, sizeof(fileHeader) );
-  memset( &columnHeader, 0, sizeof(columnHeader) );
-
-
-  // initialize the file header information
-#ifndef _CRT_SECURE_NO_DEPRECATE
-  if( strcpy_s( fileHeader.id, 8, MTX_ID_COMPRESSED_01 ) != 0 )
+  if( MTX_isNull( M ) )
   {
-    MTX_ERROR_MSG( "strcpy_s returned an error condition." );
+    MTX_ERROR_MSG( "NULL Matrix" );
+    return FALSE;
+  }
+  if( path == NULL )
+  {
+    MTX_ERROR_MSG( "if( path == NULL )" );
     return FALSE;
   }
-#else
-  strcpy( fileHeader.id, MTX_ID_COMPRESSED_01 );
-#endif
 
+  memset( &fileHeader, 0, sizeof(fileHeader) );
+  memcpy( fileHeader.id, MTX_ID_COMPRESSED_02, strlen(MTX_ID_COMPRESSED_02) );
   if( M->comment != NULL )
   {
     fileHeader.comment = M->comment;
@@ -13814,16 +14293,20 @@ BOOL MTX_SaveCompressed( const MTX *M, const char *path )
   fileHeader.isReal = M->isReal;
   fileHeader.nrows = M->nrows;
   fileHeader.ncols = M->ncols;
-  fileHeader.filesize = 0;
-  fileHeader.crc = 0;
+
+  if( chunk > M->nrows )
+    chunk = M->nrows;
+  nchunks = (M->nrows + chunk - 1) / chunk;
+  if( M->isReal )
+    nstored = M->ncols;
+  else
+    nstored = M->ncols*2;
+  indexLength = 3*nchunks*nstored;
 
   // open the output binary file
 #ifndef _CRT_SECURE_NO_DEPRECATE
   if( fopen_s( &fid, path, "wb" ) != 0 )
-  {
-    MTX_ERROR_MSG( "fopen_s returned an error condition." );
-    return FALSE;
-  }
+    fid = NULL;
 #else
   fid = fopen( path, "wb" );
 #endif
@@ -13833,465 +14316,725 @@ BOOL MTX_SaveCompressed( const MTX *M, const char *path )
     if( sprintf_s( msg, 512, "Unable to open %s", path ) > 0 )
       MTX_ERROR_MSG( msg );
 #else
-    if( sprintf( msg, "Unable to open %s", path ) > 0 )
+    if( sprintf( msg, "Unable to open %.480s", path ) > 0 )
       MTX_ERROR_MSG( msg );
 #endif
     return FALSE;
   }
 
-  // allocate memory for the RLE byte vectors
-  // at most twice as long is possible with RLE
-  for( k = 0; k < nk; k++ )
-  {
-    bytes[k] = (unsigned char*)malloc( M->nrows*sizeof(unsigned char) );
-    if( bytes[k] == NULL )
-    {
-      MTX_ERROR_MSG( "malloc returned NULL." );
-      fclose(fid);
-      return FALSE;
-    }
-    compressed[k] = (unsigned char*)malloc( M->nrows*sizeof(unsigned char)*2 );
-    if( compressed[k] == NULL )
-    {
-      MTX_ERROR_MSG( "malloc returned NULL." );
-      fclose(fid);
-      return FALSE;
-    }
-  }
-
-  // write the matrix file identifier
-  // in this case the compressed binary matrix version 01
-  count = fwrite( fileHeader.id, sizeof(char), MTX_ID_SIZE, fid );
-  if( count != MTX_ID_SIZE )
-  {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
-  }
-  // write the header size
-  count = fwrite( &fileHeader.headersize, sizeof(unsigned), 1, fid );
-  if( count != 1 )
-  {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
-  }
-  // write is the matrix is real or complex
-  count = fwrite( &fileHeader.isReal, sizeof(unsigned), 1, fid );
-  if( count != 1 )
-  {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
-  }
-  // write the size of the matrix
-  count = fwrite( &M->nrows, sizeof(unsigned), 1, fid );
-  if( count != 1 )
-  {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
-  }
-  count = fwrite( &M->ncols, sizeof(unsigned), 1, fid );
-  if( count != 1 )
+  blockIndex = (unsigned*)calloc( indexLength, sizeof(unsigned) );
+  block = (unsigned char*)malloc( MTX_COMPRESSED_MAX_BLOCK_LENGTH(chunk) );
+  plane = (unsigned char*)malloc( chunk );
+  words = (MTX_UINT64*)malloc( chunk*sizeof(MTX_UINT64) );
+  if( !M->isReal )
+    column = (double*)malloc( chunk*sizeof(double) );
+  if( blockIndex == NULL || block == NULL || plane == NULL || words == NULL || (!M->isReal && column == NULL) )
   {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    result = FALSE;
   }
 
-
-  // store the file position where the filesize and crc are written
-  // after writing the data, we'll come back to this position to
-  // rewrite this information correctly
-  filemark = ftell( fid );
-  count = fwrite( &fileHeader.filesize, sizeof(unsigned), 1, fid );
-  if( count != 1 )
-  {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
-  }
-  count = fwrite( &fileHeader.crc, sizeof(unsigned), 1, fid );
-  if( count != 1 )
+  // Write the file header. The file size and crc are rewritten once the blocks are written.
+  if( result )
   {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
+    if( fwrite( fileHeader.id, sizeof(char), MTX_ID_SIZE, fid ) != MTX_ID_SIZE ||
+      fwrite( &fileHeader.headersize, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &fileHeader.isReal, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &fileHeader.nrows, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &fileHeader.ncols, sizeof(unsigned), 1, fid ) != 1 )
+    {
+      MTX_ERROR_MSG( "fwrite returned an error condition." );
+      result = FALSE;
+    }
   }
-  // write the matrix comment if any
-  if( commentLength )
+  if( result )
   {
-    count = fwrite( fileHeader.comment, sizeof(char), commentLength, fid );
-    if( count != commentLength )
+    filemark = ftell( fid );
+    if( fwrite( &fileHeader.filesize, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &fileHeader.crc, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( fileHeader.comment, sizeof(char), commentLength, fid ) != commentLength ||
+      fwrite( &chunk, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &nchunks, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( blockIndex, sizeof(unsigned), indexLength, fid ) != indexLength )
     {
       MTX_ERROR_MSG( "fwrite returned an error condition." );
-      MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-      return FALSE;
+      result = FALSE;
     }
+    offset = (unsigned)ftell( fid );
   }
 
-
 #ifdef MTX_DEBUG
-  t0 = time(NULL);
   c0 = clock();
 #endif
 
-  if( M->isReal )
-    ncols = M->ncols;
-  else
-    ncols = M->ncols*2;
-
-  for( j = 0; j < ncols; j++ )
+  for( c = 0; c < nchunks && result; c++ )
   {
-    // complex matrices are treated as re,im,re,im, etc so the matrix is stored as M->ncols*2 columns
-    if( !M->isReal )
+    r0 = c*chunk;
+    n = M->nrows - r0;
+    if( n > chunk )
+      n = chunk;
+
+    for( j = 0; j < nstored; j++ )
     {
-      if( j == 0 || j%2 == 0 )
+      // complex matrices are treated as re,im,re,im, etc so the matrix is stored as M->ncols*2 columns
+      if( M->isReal )
       {
-        if( !MTX_RealColumn( M, j/2, &MtxCol ) )
-        {
-          MTX_ERROR_MSG( "MTX_RealColumn returned FALSE." );
-          MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-          return FALSE;
-        }
+        x = &(M->data[j][r0]);
       }
       else
       {
-        if( !MTX_ImagColumn( M, j/2, &MtxCol ) )
+        if( j%2 == 0 )
         {
-          MTX_ERROR_MSG( "MTX_ImagColumn returned FALSE." );
-          MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-          return FALSE;
+          for( i = 0; i < n; i++ )
+            column[i] = M->cplx[j/2][r0+i].re;
         }
-      }
-    }
-
-    // initialize lengths
-    for( k = 0; k < nk; k++ )
-    {
-      columnHeader.length[k] = 0;
-      columnHeader.isCompressed[k] = 0;
-    }
-    columnHeader.totalLength = 0;
+        else
+        {
+          for( i = 0; i < n; i++ )
+            column[i] = M->cplx[j/2][r0+i].im;
+        }
+        x = column;
+      }
 
+      MTX_static_EncodeCompressedBlock( x, n, block, &length, words, plane );
 
-    col_stdev = 1.0; // A non zero default value.
-    if( M->isReal )
-    {
-      if( !MTX_ColumnStdev( M, j, &col_stdev ) )
+      if( fwrite( block, sizeof(unsigned char), length, fid ) != length )
       {
-        MTX_ERROR_MSG( "MTX_ColumnStdev returned FALSE." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
+        MTX_ERROR_MSG( "fwrite returned an error condition." );
+        result = FALSE;
+        break;
       }
+      blockIndex[3*(c*nstored+j)] = offset;
+      blockIndex[3*(c*nstored+j)+1] = length;
+      MTX_static_updateCRC( block, length, &(blockIndex[3*(c*nstored+j)+2]) );
+      offset += length;
+#ifdef MTX_DEBUG
+      total_length += length;
+#endif
     }
-    else
+  }
+
+  // Rewrite the block index, the file size and the crc of the chunk length, number of chunks and block index.
+  if( result )
+  {
+    filesize = ftell( fid );
+    fileHeader.filesize = (unsigned)filesize;
+    MTX_static_updateCRC( (unsigned char*)&chunk, sizeof(unsigned), &(fileHeader.crc) );
+    MTX_static_updateCRC( (unsigned char*)&nchunks, sizeof(unsigned), &(fileHeader.crc) );
+    MTX_static_updateCRC( (unsigned char*)blockIndex, indexLength*sizeof(unsigned), &(fileHeader.crc) );
+
+    if( fseek( fid, filemark, SEEK_SET ) != 0 ||
+      fwrite( &fileHeader.filesize, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &fileHeader.crc, sizeof(unsigned), 1, fid ) != 1 ||
+      fseek( fid, (long)(filemark + 2*sizeof(unsigned) + commentLength + 2*sizeof(unsigned)), SEEK_SET ) != 0 ||
+      fwrite( blockIndex, sizeof(unsigned), indexLength, fid ) != indexLength )
     {
-      if( !MTX_ColumnStdev( &MtxCol, 0, &col_stdev ) )
-      {
-        MTX_ERROR_MSG( "MTX_ColumnStdev returned FALSE." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
-      }
+      MTX_ERROR_MSG( "fwrite returned an error condition." );
+      result = FALSE;
     }
+  }
 
-    if( col_stdev == 0.0 )
-    {
-      // output a single 0 for the first length indicating that a single double value represents this column
-      count = fwrite( &(columnHeader.length[0]), sizeof(unsigned), 1, fid );
-      if( count != 1 )
-      {
-        MTX_ERROR_MSG( "fwrite returned an error condition." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
-      }
-      MTX_static_updateCRC( (unsigned char*)(columnHeader.length), 4, &(fileHeader.crc) );
+#ifdef MTX_DEBUG
+  c1 = clock();
+  if( M->nrows*nstored > 0 )
+    printf("\n%s compressed to: %.1lf (%%) of the original size.\n", path, 100.0*total_length/(M->nrows*nstored*8.0) );
+  printf("Compression (version 2): %.2f (s)\n", (float) (c1 - c0)/CLOCKS_PER_SEC);
+#endif
 
-      // output the double
-      if( M->isReal )
-      {
-        count = fwrite( &M->data[j][0], sizeof(double), 1, fid );
-        if( count != 1 )
-        {
-          MTX_ERROR_MSG( "fwrite returned an error condition." );
-          MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-          return FALSE;
-        }
-      }
-      else
+  if( blockIndex != NULL )
+    free( blockIndex );
+  if( block != NULL )
+    free( block );
+  if( plane != NULL )
+    free( plane );
+  if( words != NULL )
+    free( words );
+  if( column != NULL )
+    free( column );
+  if( fclose( fid ) != 0 )
+  {
+    MTX_ERROR_MSG( "fclose returned an error condition." );
+    result = FALSE;
+  }
+  return result;
+}
+
+
+void MTX_static_HuffmanCodeLengths( const unsigned *freq, unsigned char *lengths )
+{
+  unsigned f[256];        // The symbol frequencies, flattened if the code is too long.
+  unsigned sym[256];      // The symbols present, sorted by increasing frequency.
+  unsigned weight[511];   // The weights of the leaves (0 to m-1) and the internal nodes (m to 2m-2).
+  unsigned parent[511];   // The parent of each node.
+  unsigned char depth[511];
+  unsigned m = 0;         // The number of symbols present.
+  unsigned i = 0;
+  unsigned k = 0;
+  unsigned leaf = 0;      // The next leaf in the leaf queue.
+  unsigned node = 0;      // The next node in the internal node queue.
+  unsigned next = 0;      // The next internal node to form.
+  unsigned a = 0;
+  unsigned b = 0;
+  unsigned tmp = 0;
+  unsigned maxDepth = 0;
+
+  memset( lengths, 0, 256 );
+  for( i = 0; i < 256; i++ )
+    f[i] = freq[i];
+
+  while( 1 )
+  {
+    m = 0;
+    for( i = 0; i < 256; i++ )
+    {
+      if( f[i] )
       {
-        count = fwrite( &MtxCol.data[0][0], sizeof(double), 1, fid );
-        if( count != 1 )
+        // insertion sort by frequency
+        k = m;
+        while( k > 0 && f[sym[k-1]] > f[i] )
         {
-          MTX_ERROR_MSG( "fwrite returned an error condition." );
-          MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-          return FALSE;
+          sym[k] = sym[k-1];
+          k--;
         }
+        sym[k] = i;
+        m++;
       }
+    }
+    if( m == 0 )
+      return;
+    if( m == 1 )
+    {
+      lengths[sym[0]] = 1;
+      return;
+    }
 
-      // copy the double's bytes to update the crc
-      if( M->isReal )
-      {
-        memcpy( curr, &(M->data[j][0]), sizeof(double) );
-        MTX_static_updateCRC( curr, 8, &(fileHeader.crc) );
-      }
+    // Two queue huffman tree construction, the leaves are sorted and the internal nodes are formed in order.
+    for( i = 0; i < m; i++ )
+      weight[i] = f[sym[i]];
+    leaf = 0;
+    node = m;
+    for( next = m; next < 2*m-1; next++ )
+    {
+      if( leaf < m && (node >= next || weight[leaf] <= weight[node]) )
+        a = leaf++;
       else
-      {
-        memcpy( curr, &(MtxCol.data[0][0]), sizeof(double) );
-        MTX_static_updateCRC( curr, 8, &(fileHeader.crc) );
-      }
-
-      continue;
+        a = node++;
+      if( leaf < m && (node >= next || weight[leaf] <= weight[node]) )
+        b = leaf++;
+      else
+        b = node++;
+      weight[next] = weight[a] + weight[b];
+      parent[a] = next;
+      parent[b] = next;
     }
 
-    // form the bytes vector for RLE input
-    for( i = 0; i < M->nrows; i++ )
+    // The parents are formed after their children so the depths are found in reverse order.
+    depth[2*m-2] = 0;
+    maxDepth = 0;
+    for( i = 2*m-2; i > 0; i-- )
     {
-      if( M->isReal )
-        memcpy( curr, &(M->data[j][i]), sizeof(double) );
-      else
-        memcpy( curr, &(MtxCol.data[0][i]), sizeof(double) );
+      tmp = depth[parent[i-1]] + 1;
+      depth[i-1] = (unsigned char)(tmp > 255 ? 255 : tmp);
+      if( i-1 < m && tmp > maxDepth )
+        maxDepth = tmp;
+    }
+    if( maxDepth <= MTX_HUFFMAN_MAX_BITS )
+    {
+      for( i = 0; i < m; i++ )
+        lengths[sym[i]] = depth[i];
+      return;
+    }
 
-      for( k = 0; k < nk; k++ )
-      {
-        bytes[k][i] = curr[k];
-      }
+    // The code is too long, flatten the frequencies and try again.
+    for( i = 0; i < 256; i++ )
+    {
+      if( f[i] )
+        f[i] = (f[i]+1)/2;
     }
+  }
+}
 
 
-    // quick test code
-    /*
-    k = 0;
-    bytes[k][0] = 'a';
-    bytes[k][1] = 'b';
-    bytes[k][2] = 'b';
-    bytes[k][3] = 'a';
-    bytes[k][4] = 'b';
-    bytes[k][5] = 'a';
-
-    bytes[k][6] = 'a';
-    bytes[k][7] = 'a';
-    bytes[k][8] = 'b';
-    bytes[k][9] = 'b';
-    bytes[k][10] = 'b';
-    bytes[k][11] = 'b';
-
-    bytes[k][12] = 'a';
-    bytes[k][13] = 'a';
-    bytes[k][14] = 'a';
-    bytes[k][15] = 'a';
-    bytes[k][16] = 'a';
-    bytes[k][17] = 'b';
-
-    bytes[k][18] = 'b';
-    bytes[k][19] = 'a';
-    bytes[k][20] = 'b';
-    bytes[k][21] = 'b';
-    bytes[k][22] = 'a';
-    */
+BOOL MTX_static_HuffmanCodes( const unsigned char *lengths, unsigned *codes )
+{
+  unsigned count[MTX_HUFFMAN_MAX_BITS+1];
+  unsigned nextCode[MTX_HUFFMAN_MAX_BITS+1];
+  unsigned i = 0;
+  unsigned k = 0;
+  unsigned code = 0;
+  unsigned reversed = 0;
 
-    for( k = 0; k < nk; k++ )
+  memset( count, 0, sizeof(count) );
+  for( i = 0; i < 256; i++ )
+  {
+    if( lengths[i] > MTX_HUFFMAN_MAX_BITS )
+      return FALSE;
+    count[lengths[i]]++;
+  }
+  count[0] = 0;
+
+  // canonical codes, shorter codes first and in symbol order for equal lengths
+  code = 0;
+  for( k = 1; k <= MTX_HUFFMAN_MAX_BITS; k++ )
+  {
+    code = (code + count[k-1]) << 1;
+    nextCode[k] = code;
+    if( code + count[k] > (1u << k) )
+      return FALSE; // over subscribed
+  }
+  for( i = 0; i < 256; i++ )
+  {
+    codes[i] = 0;
+    if( lengths[i] == 0 )
+      continue;
+    code = nextCode[lengths[i]]++;
+    // the bits are written least significant bit first, so the code is reversed
+    reversed = 0;
+    for( k = 0; k < lengths[i]; k++ )
     {
-      // abbabaaabbbbaaaaabbabba
-      // compressed becomes
-      // abb0abaa1bb2aa3bb0abb0a
-      i = 0;
-      n = 0;
-      p = 0;
-      prevByte = bytes[k][i];
-      i++;
-      compressed[k][p] = prevByte;
-      p++;
+      reversed = (reversed << 1) | (code & 1);
+      code >>= 1;
+    }
+    codes[i] = reversed;
+  }
+  return TRUE;
+}
 
-      while( i < M->nrows )
-      {
-        currByte = bytes[k][i];
-        i++;
 
-        if( currByte == prevByte )
-        {
-          n++;
-          if( n == 256 )
-          {
-            compressed[k][p] = prevByte;
-            p++;
-            compressed[k][p] = (unsigned char)(n-1);
-            p++;
-            n = 0;
+void MTX_static_EstimateCompressedPlanes( const MTX_UINT64 *words, const unsigned n, unsigned *length )
+{
+  unsigned freq[MTX_NK][256];
+  unsigned runs[MTX_NK];
+  unsigned i = 0;
+  unsigned k = 0;
+  unsigned s = 0;
+  unsigned runLength[MTX_NK];
+  double bits = 0;
+  const unsigned char *bytes = NULL;
+  const unsigned char *prev = NULL;
 
-            prevByte = bytes[k][i];
-            i++;
-            compressed[k][p] = prevByte;
-            p++;
-            if( i == M->nrows )
-              break;
-          }
-        }
-        else
-        {
-          if( n > 0 )
-          {
-            compressed[k][p] = prevByte;
-            p++;
-            compressed[k][p] = (unsigned char)(n-1);
-            p++;
-            n = 0;
-          }
-          compressed[k][p] = currByte;
-          p++;
-          prevByte = currByte;
-        }
+  memset( freq, 0, sizeof(freq) );
+  for( k = 0; k < MTX_NK; k++ )
+  {
+    runs[k] = 1;
+    runLength[k] = 1;
+  }
+
+  bytes = (const unsigned char*)&words[0];
+  for( k = 0; k < MTX_NK; k++ )
+    freq[k][bytes[k]]++;
+  for( i = 1; i < n; i++ )
+  {
+    bytes = (const unsigned char*)&words[i];
+    prev = (const unsigned char*)&words[i-1];
+    for( k = 0; k < MTX_NK; k++ )
+    {
+      freq[k][bytes[k]]++;
+      if( bytes[k] == prev[k] && runLength[k] < 255 )
+      {
+        runLength[k]++;
       }
-      if( n > 0 )
+      else
       {
-        compressed[k][p] = prevByte;
-        p++;
-        compressed[k][p] = (unsigned char)(n-1);
-        p++;
-        n = 0;
+        runs[k]++;
+        runLength[k] = 1;
       }
-
-      columnHeader.length[k] = p;
-      columnHeader.totalLength += columnHeader.length[k];
     }
+  }
 
-    /*
-    for( k = 0; k < nk; k++ )
+  for( k = 0; k < MTX_NK; k++ )
+  {
+    length[k] = n;
+    if( freq[k][bytes[k]] == n )
     {
-    for( n = 0; n < p; n++ )
+      length[k] = 1;
+      continue;
+    }
+    if( 2*runs[k] < length[k] )
+      length[k] = 2*runs[k];
+
+    // the order zero entropy approximates the huffman code length
+    bits = 0;
+    for( s = 0; s < 256; s++ )
     {
-    if( compressed[k][p] != compressed_intel[k][p] )
+      if( freq[k][s] )
+        bits -= freq[k][s] * log( (double)freq[k][s] / (double)n );
+    }
+    bits /= log(2.0);
+    if( MTX_HUFFMAN_TABLE_SIZE + (unsigned)(bits/8.0) < length[k] )
+      length[k] = MTX_HUFFMAN_TABLE_SIZE + (unsigned)(bits/8.0);
+  }
+}
+
+
+void MTX_static_EncodeCompressedBlock( const double *x, const unsigned n, unsigned char *block, unsigned *length, MTX_UINT64 *words, unsigned char *plane )
+{
+  unsigned i = 0;
+  unsigned k = 0;
+  unsigned s = 0;
+  unsigned p = 0;           // The position in the block.
+  unsigned len = 0;         // The length of the current byte column.
+  unsigned rleLength = 0;   // The run length encoded length of the current byte column.
+  unsigned huffLength = 0;  // The huffman encoded length of the current byte column.
+  unsigned count = 0;
+  unsigned freq[256];
+  unsigned codes[256];
+  unsigned char lengths[256];
+  unsigned estimate[MTX_NK];
+  unsigned bestLength = 0;
+  unsigned transform = 0;
+  unsigned bestTransform = MTX_COMPRESSED_NODELTA;
+  unsigned nbits = 0;
+  MTX_UINT64 bits = 0;
+  MTX_UINT64 bitBuffer = 0;
+  MTX_UINT64 prev = 0;
+  MTX_UINT64 curr = 0;
+  BOOL isConstant = TRUE;
+
+  for( i = 1; i < n; i++ )
+  {
+    if( memcmp( &x[i], &x[0], sizeof(double) ) != 0 )
+    {
+      isConstant = FALSE;
+      break;
+    }
+  }
+  if( n == 0 || isConstant )
+  {
+    block[0] = MTX_COMPRESSED_CONSTANT;
+    if( n > 0 )
+      memcpy( block+1, &x[0], sizeof(double) );
+    else
+      memset( block+1, 0, sizeof(double) );
+    *length = 1 + sizeof(double);
+    return;
+  }
+
+  // choose the transform with the shortest estimated length
+  for( transform = MTX_COMPRESSED_NODELTA; transform <= MTX_COMPRESSED_XORDELTA; transform++ )
+  {
+    prev = 0;
+    for( i = 0; i < n; i++ )
     {
-    count = 99;
+      memcpy( &curr, &x[i], sizeof(double) );
+      if( transform == MTX_COMPRESSED_SUBDELTA )
+        words[i] = curr - prev;
+      else if( transform == MTX_COMPRESSED_XORDELTA )
+        words[i] = curr ^ prev;
+      else
+        words[i] = curr;
+      prev = curr;
     }
+    MTX_static_EstimateCompressedPlanes( words, n, estimate );
+    len = 0;
+    for( k = 0; k < MTX_NK; k++ )
+      len += estimate[k];
+    if( transform == MTX_COMPRESSED_NODELTA || len < bestLength )
+    {
+      bestLength = len;
+      bestTransform = transform;
     }
+  }
+  if( bestTransform != MTX_COMPRESSED_XORDELTA )
+  {
+    prev = 0;
+    for( i = 0; i < n; i++ )
+    {
+      memcpy( &curr, &x[i], sizeof(double) );
+      if( bestTransform == MTX_COMPRESSED_SUBDELTA )
+        words[i] = curr - prev;
+      else
+        words[i] = curr;
+      prev = curr;
     }
-    */
-
-#ifdef MTX_DEBUG
-    total_length += columnHeader.totalLength;
-#endif
+  }
 
-    // test the compressed data lengths to determine if the compressed version should be output
-    for( k = 0; k < nk; k++ )
+  // Each byte column is stored as: encoding (1 byte), length (unsigned), bytes.
+  block[0] = (unsigned char)bestTransform;
+  p = 1;
+  for( k = 0; k < MTX_NK; k++ )
+  {
+    memset( freq, 0, sizeof(freq) );
+    rleLength = 0;
+    for( i = 0; i < n; i++ )
     {
-      if( columnHeader.length[k] >= M->nrows )
-      {
-        columnHeader.length[k] = M->nrows;
-        columnHeader.isCompressed[k] = 0;
-      }
-      else
-      {
-        columnHeader.isCompressed[k] = 1;
-      }
+      plane[i] = ((const unsigned char*)&words[i])[k];
+      freq[plane[i]]++;
     }
 
-    // output the data lengths
-    for( k = 0; k < nk; k++ )
+    if( freq[plane[0]] == n )
     {
-      count = fwrite( &(columnHeader.length[k]), sizeof(unsigned), 1, fid );
-      if( count != 1 )
-      {
-        MTX_ERROR_MSG( "fwrite returned an error condition." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
-      }
-      MTX_static_updateCRC( (unsigned char*)(&(columnHeader.length[k])), 4, &(fileHeader.crc) );
+      block[p] = MTX_PLANE_CONSTANT;
+      len = 1;
+      block[p+1+sizeof(unsigned)] = plane[0];
+      memcpy( block+p+1, &len, sizeof(unsigned) );
+      p += 1 + sizeof(unsigned) + len;
+      continue;
     }
 
-    // output the compression indication
-    for( k = 0; k < nk; k++ )
+    // the run length encoded length as (byte, count) pairs
+    for( i = 0; i < n && rleLength < n; i += count )
     {
-      count = fwrite( &(columnHeader.isCompressed[k]), sizeof(unsigned char), 1, fid );
-      if( count != 1 )
-      {
-        MTX_ERROR_MSG( "fwrite returned an error condition." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
-      }
-      MTX_static_updateCRC( &(columnHeader.isCompressed[k]), 1, &(fileHeader.crc) );
+      count = 1;
+      while( i+count < n && count < 255 && plane[i+count] == plane[i] )
+        count++;
+      rleLength += 2;
     }
+    if( i < n )
+      rleLength = n;
 
-    // output the data or compressed data
-    for( k = 0; k < nk; k++ )
+    // the huffman encoded length
+    MTX_static_HuffmanCodeLengths( freq, lengths );
+    bits = 0;
+    for( s = 0; s < 256; s++ )
+      bits += (MTX_UINT64)freq[s]*lengths[s];
+    huffLength = MTX_HUFFMAN_TABLE_SIZE + (unsigned)((bits+7)/8);
+
+    if( huffLength < n && huffLength < rleLength )
     {
-      if( columnHeader.isCompressed[k] )
-      {
-        count = fwrite( compressed[k], sizeof(unsigned char), columnHeader.length[k], fid );
-      }
-      else
+      block[p] = MTX_PLANE_HUFFMAN;
+      len = 0;
+      for( s = 0; s < 256; s += 2 )
       {
-        count = fwrite( bytes[k], sizeof(unsigned char), columnHeader.length[k], fid );
+        block[p+1+sizeof(unsigned)+len] = (unsigned char)(lengths[s] | (lengths[s+1] << 4));
+        len++;
       }
-      if( count != columnHeader.length[k] )
+      MTX_static_HuffmanCodes( lengths, codes );
+      bitBuffer = 0;
+      nbits = 0;
+      for( i = 0; i < n; i++ )
       {
-        MTX_ERROR_MSG( "fwrite returned an error condition." );
-        MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-        return FALSE;
+        bitBuffer |= ((MTX_UINT64)codes[plane[i]]) << nbits;
+        nbits += lengths[plane[i]];
+        while( nbits >= 8 )
+        {
+          block[p+1+sizeof(unsigned)+len] = (unsigned char)(bitBuffer & 0xFF);
+          len++;
+          bitBuffer >>= 8;
+          nbits -= 8;
+        }
       }
-      if( columnHeader.isCompressed[k] )
+      if( nbits > 0 )
       {
-        MTX_static_updateCRC( compressed[k], columnHeader.length[k], &(fileHeader.crc) );
+        block[p+1+sizeof(unsigned)+len] = (unsigned char)(bitBuffer & 0xFF);
+        len++;
       }
-      else
+    }
+    else if( rleLength < n )
+    {
+      block[p] = MTX_PLANE_RLE;
+      len = 0;
+      for( i = 0; i < n; i += count )
       {
-        MTX_static_updateCRC( bytes[k], columnHeader.length[k], &(fileHeader.crc) );
+        count = 1;
+        while( i+count < n && count < 255 && plane[i+count] == plane[i] )
+          count++;
+        block[p+1+sizeof(unsigned)+len] = plane[i];
+        block[p+2+sizeof(unsigned)+len] = (unsigned char)count;
+        len += 2;
       }
     }
+    else
+    {
+      block[p] = MTX_PLANE_RAW;
+      len = n;
+      memcpy( block+p+1+sizeof(unsigned), plane, n );
+    }
+    memcpy( block+p+1, &len, sizeof(unsigned) );
+    p += 1 + sizeof(unsigned) + len;
   }
+  *length = p;
+}
 
-  // determine the filesize
-  fileHeader.filesize = ftell(fid);
-  fseek( fid, 0, SEEK_SET );
-  fileHeader.filesize -= ftell(fid);
 
-  // write the filesize and the crc back to the header position in the file
-  fseek( fid, filemark, SEEK_SET );
-  count = fwrite( &fileHeader.filesize, sizeof(unsigned), 1, fid );
-  if( count != 1 )
+BOOL MTX_static_DecodeCompressedBlock( const unsigned char *block, const unsigned length, const unsigned n, double *x )
+{
+  unsigned i = 0;
+  unsigned j = 0;
+  unsigned k = 0;
+  unsigned s = 0;
+  unsigned p = 0;
+  unsigned len = 0;
+  unsigned count = 0;
+  unsigned nbits = 0;
+  unsigned entry = 0;
+  unsigned codes[256];
+  unsigned char lengths[256];
+  unsigned short table[1 << MTX_HUFFMAN_MAX_BITS]; // symbol | length << 8, indexed by the next MTX_HUFFMAN_MAX_BITS bits
+  MTX_UINT64 bitBuffer = 0;
+  MTX_UINT64 prev = 0;
+  MTX_UINT64 curr = 0;
+  unsigned char *bytes = (unsigned char*)x;
+  const unsigned char *data = NULL;
+
+  if( length < 1 + sizeof(double) )
   {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
+    MTX_ERROR_MSG( "Invalid compressed block length." );
     return FALSE;
   }
-  count = fwrite( &fileHeader.crc, sizeof(unsigned), 1, fid );
-  if( count != 1 )
+
+  if( block[0] == MTX_COMPRESSED_CONSTANT )
   {
-    MTX_ERROR_MSG( "fwrite returned an error condition." );
-    MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-    return FALSE;
+    for( i = 0; i < n; i++ )
+      memcpy( &x[i], block+1, sizeof(double) );
+    return TRUE;
   }
-
-#ifdef MTX_DEBUG
-  t1 = time(NULL);
-  c1 = clock();
-  printf("\n%s compressed to: %.1lf (%%) of the original size.\n", path, 100.0*total_length/(M->nrows*M->ncols*8) );
-
-  printf("Compression (GDM's) RLE: %.2f (s)\n", (float) (c1 - c0)/CLOCKS_PER_SEC);
-
-#endif
-
-  // cleanup
-  MTX_static_SaveAndLoadCleanUp( fid, bytes, compressed, nk );
-
-  return TRUE;
-}
-
-
-unsigned MTX_static_CRC32(unsigned ulCRC)
-{
-#define CRC32_POLYNOMIAL 0xEDB88320L
-  int k;
-  for( k = 8 ; k > 0; k-- )
+  if( block[0] != MTX_COMPRESSED_NODELTA && block[0] != MTX_COMPRESSED_SUBDELTA && block[0] != MTX_COMPRESSED_XORDELTA )
   {
-    if( ulCRC & 1 )
-      ulCRC = ( ulCRC >> 1 ) ^ CRC32_POLYNOMIAL;
-    else
-      ulCRC >>= 1;
+    MTX_ERROR_MSG( "Unknown compressed block transform." );
+    return FALSE;
   }
-  return ulCRC;
-}
+
+  p = 1;
+  for( k = 0; k < MTX_NK; k++ )
+  {
+    if( p + 1 + sizeof(unsigned) > length )
+    {
+      MTX_ERROR_MSG( "Invalid compressed block length." );
+      return FALSE;
+    }
+    memcpy( &len, block+p+1, sizeof(unsigned) );
+    if( len > length || p + 1 + sizeof(unsigned) + len > length )
+    {
+      MTX_ERROR_MSG( "Invalid compressed block length." );
+      return FALSE;
+    }
+    data = block+p+1+sizeof(unsigned);
+
+    switch( block[p] )
+    {
+    case MTX_PLANE_RAW:
+      {
+        if( len != n )
+        {
+          MTX_ERROR_MSG( "Invalid compressed byte column length." );
+          return FALSE;
+        }
+        for( i = 0; i < n; i++ )
+          bytes[i*MTX_NK+k] = data[i];
+        break;
+      }
+    case MTX_PLANE_CONSTANT:
+      {
+        if( len != 1 )
+        {
+          MTX_ERROR_MSG( "Invalid compressed byte column length." );
+          return FALSE;
+        }
+        for( i = 0; i < n; i++ )
+          bytes[i*MTX_NK+k] = data[0];
+        break;
+      }
+    case MTX_PLANE_RLE:
+      {
+        i = 0;
+        for( j = 0; j+1 < len; j += 2 )
+        {
+          count = data[j+1];
+          if( i + count > n )
+          {
+            MTX_ERROR_MSG( "Invalid compressed run length." );
+            return FALSE;
+          }
+          while( count > 0 )
+          {
+            bytes[i*MTX_NK+k] = data[j];
+            i++;
+            count--;
+          }
+        }
+        if( i != n )
+        {
+          MTX_ERROR_MSG( "Invalid compressed run length." );
+          return FALSE;
+        }
+        break;
+      }
+    case MTX_PLANE_HUFFMAN:
+      {
+        if( len < MTX_HUFFMAN_TABLE_SIZE )
+        {
+          MTX_ERROR_MSG( "Invalid compressed byte column length." );
+          return FALSE;
+        }
+        for( s = 0; s < 256; s += 2 )
+        {
+          lengths[s] = (unsigned char)(data[s/2] & 0x0F);
+          lengths[s+1] = (unsigned char)(data[s/2] >> 4);
+        }
+        if( !MTX_static_HuffmanCodes( lengths, codes ) )
+        {
+          MTX_ERROR_MSG( "Invalid huffman code lengths." );
+          return FALSE;
+        }
+        // every code fills the table entries that begin with its bits
+        memset( table, 0, sizeof(table) );
+        for( s = 0; s < 256; s++ )
+        {
+          if( lengths[s] == 0 )
+            continue;
+          for( entry = codes[s]; entry < (1u << MTX_HUFFMAN_MAX_BITS); entry += (1u << lengths[s]) )
+            table[entry] = (unsigned short)(s | (lengths[s] << 8));
+        }
+
+        j = MTX_HUFFMAN_TABLE_SIZE;
+        bitBuffer = 0;
+        nbits = 0;
+        for( i = 0; i < n; i++ )
+        {
+          while( nbits <= 56 && j < len )
+          {
+            bitBuffer |= ((MTX_UINT64)data[j]) << nbits;
+            nbits += 8;
+            j++;
+          }
+          entry = table[bitBuffer & ((1u << MTX_HUFFMAN_MAX_BITS)-1)];
+          count = entry >> 8;
+          if( count == 0 || count > nbits )
+          {
+            MTX_ERROR_MSG( "Invalid huffman coded data." );
+            return FALSE;
+          }
+          bytes[i*MTX_NK+k] = (unsigned char)(entry & 0xFF);
+          bitBuffer >>= count;
+          nbits -= count;
+        }
+        break;
+      }
+    default:
+      {
+        MTX_ERROR_MSG( "Unknown compressed byte column encoding." );
+        return FALSE;
+      }
+    }
+    p += 1 + sizeof(unsigned) + len;
+  }
+
+  // undo the transform
+  if( block[0] == MTX_COMPRESSED_SUBDELTA )
+  {
+    prev = 0;
+    for( i = 0; i < n; i++ )
+    {
+      memcpy( &curr, &x[i], sizeof(double) );
+      curr += prev;
+      memcpy( &x[i], &curr, sizeof(double) );
+      prev = curr;
+    }
+  }
+  else if( block[0] == MTX_COMPRESSED_XORDELTA )
+  {
+    prev = 0;
+    for( i = 0; i < n; i++ )
+    {
+      memcpy( &curr, &x[i], sizeof(double) );
+      curr ^= prev;
+      memcpy( &x[i], &curr, sizeof(double) );
+      prev = curr;
+    }
+  }
+  return TRUE;
+}
 
 
 void MTX_static_updateCRC( unsigned char *pBytes, const unsigned nBytes, unsigned *uiCRC )
@@ -14304,7 +15047,7 @@ void MTX_static_updateCRC( unsigned char *pBytes, const unsigned nBytes, unsigne
   while( byteCount-- != 0 )
   {
     tmp1 = ( (*uiCRC) >> 8 ) & 0x00FFFFFFL;
-    tmp2 = MTX_static_CRC32( ((unsigned) (*uiCRC) ^ *CRCData++ ) & 0xff );
+    tmp2 = MTX_static_crcTable[ ((unsigned) (*uiCRC) ^ *CRCData++ ) & 0xff ];
     *uiCRC = tmp1 ^ tmp2;
   }
 }
@@ -14372,6 +15115,7 @@ BOOL MTX_GetCompressedFileAttributes(
   }
 
   if( strcmp( fileHeader.id, MTX_ID_COMPRESSED_01 ) == 0 ){ version = MTX_VERSION_NR_COMPRESSED_01; }
+  else if( strcmp( fileHeader.id, MTX_ID_COMPRESSED_02 ) == 0 ){ version = MTX_VERSION_NR_COMPRESSED_02; }
   else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V01 ) == 0 ){ version = MTX_VERSION_NR_LEGACY_V01; }
   else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V02 ) == 0 ){ version = MTX_VERSION_NR_LEGACY_V02; }
 
@@ -14382,7 +15126,7 @@ BOOL MTX_GetCompressedFileAttributes(
     return FALSE;
   }
 
-  if( version == MTX_VERSION_NR_LEGACY_V01 || version == MTX_VERSION_NR_LEGACY_V01 )
+  if( version == MTX_VERSION_NR_LEGACY_V01 || version == MTX_VERSION_NR_LEGACY_V02 )
   {
     // NOT SUPPORTED HERE
     MTX_ERROR_MSG( "Unsupported compressed Matrix version." );
@@ -14534,6 +15278,7 @@ BOOL MTX_ReadCompressed( MTX *M, const char *path )
   }
 
   if( strcmp( fileHeader.id, MTX_ID_COMPRESSED_01 ) == 0 ){ version = MTX_VERSION_NR_COMPRESSED_01; }
+  else if( strcmp( fileHeader.id, MTX_ID_COMPRESSED_02 ) == 0 ){ version = MTX_VERSION_NR_COMPRESSED_02; }
   else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V01 ) == 0 ){ version = MTX_VERSION_NR_LEGACY_V01; }
   else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V02 ) == 0 ){ version = MTX_VERSION_NR_LEGACY_V02; }
 
@@ -14544,12 +15289,18 @@ BOOL MTX_ReadCompressed( MTX *M, const char *path )
     return FALSE;
   }
 
-  if( version == MTX_VERSION_NR_LEGACY_V01 || version == MTX_VERSION_NR_LEGACY_V01 )
+  if( version == MTX_VERSION_NR_LEGACY_V01 || version == MTX_VERSION_NR_LEGACY_V02 )
   {
     fclose(fid);
     return MTX_static_ReadCompressed_LegacyVersion( M, path );
   }
 
+  if( version == MTX_VERSION_NR_COMPRESSED_02 )
+  {
+    fclose(fid);
+    return MTX_static_ReadCompressed_Version2( M, path, 0, 0 );
+  }
+
   // get the size of the header
   count = fread( &(fileHeader.headersize), sizeof(unsigned), 1, fid );
   if( count != 1 )
@@ -14971,251 +15722,1424 @@ BOOL MTX_ReadCompressed( MTX *M, const char *path )
 }
 
 
-BOOL MTX_static_ReadCompressed_LegacyVersion( MTX* M, const char *path )
+BOOL MTX_ReadCompressedRows( MTX *M, const char *path, const unsigned startRow, const unsigned nrows )
 {
-  unsigned i = 0;
+  FILE* fid = NULL;
+  char id[MTX_ID_SIZE];
+  char msg[512];
   unsigned j = 0;
-  int version = 0;
+  unsigned n = 0; // The number of rows to read.
+  MTX A;          // The full matrix of an older version file.
+  BOOL result = TRUE;
 
-  FILE* fid = NULL;
+  if( M == NULL || path == NULL )
+  {
+    MTX_ERROR_MSG( "if( M == NULL || path == NULL )" );
+    return FALSE;
+  }
 
-  unsigned g = 0; // counter
-  unsigned p = 0; // counter
-  unsigned k = 0; // counter
-  unsigned char nrepeat = 0;
-  unsigned char method = 0;
-  double d = 0.0;
-  const unsigned kCompressionByDouble = 1;
+#ifndef _CRT_SECURE_NO_DEPRECATE
+  if( fopen_s( &fid, path, "rb" ) != 0 )
+    fid = NULL;
+#else
+  fid = fopen( path, "rb" );
+#endif
+  if( fid == NULL )
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( sprintf_s( msg, 512, "Unable to open %s.", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#else
+    if( sprintf( msg, "Unable to open %.480s.", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#endif
+    return FALSE;
+  }
+  if( fread( id, sizeof(char), MTX_ID_SIZE, fid ) != MTX_ID_SIZE )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    fclose( fid );
+    return FALSE;
+  }
+  fclose( fid );
+  id[MTX_ID_SIZE-1] = '\0';
 
-  unsigned char* columnBuffer = NULL;
-  unsigned char* compressedBuffer = NULL;
-  unsigned char ucTmp[2];
-  unsigned columnBufSize = 0;
-  unsigned compressedSize = 0;
+  if( strcmp( id, MTX_ID_COMPRESSED_02 ) == 0 )
+    return MTX_static_ReadCompressed_Version2( M, path, startRow, nrows );
 
-  char msg[512];
+  // Older versions are not chunked, the whole matrix is read.
+  MTX_Init( &A );
+  if( !MTX_ReadCompressed( &A, path ) )
+  {
+    MTX_ERROR_MSG( "MTX_ReadCompressed returned FALSE." );
+    MTX_Free( &A );
+    return FALSE;
+  }
+  n = nrows;
+  if( n == 0 && startRow < A.nrows )
+    n = A.nrows - startRow;
+  if( startRow >= A.nrows || n > A.nrows - startRow )
+  {
+    MTX_ERROR_MSG( "The rows are beyond the end of the matrix." );
+    MTX_Free( &A );
+    return FALSE;
+  }
+  if( !MTX_Malloc( M, n, A.ncols, A.isReal ) )
+  {
+    MTX_ERROR_MSG( "MTX_Malloc returned FALSE." );
+    MTX_Free( &A );
+    return FALSE;
+  }
+  for( j = 0; j < A.ncols; j++ )
+  {
+    if( A.isReal )
+      memcpy( M->data[j], &(A.data[j][startRow]), n*sizeof(double) );
+    else
+      memcpy( M->cplx[j], &(A.cplx[j][startRow]), n*sizeof(stComplex) );
+  }
+  if( M->comment )
+    free( M->comment );
+  M->comment = A.comment;
+  A.comment = NULL;
+  MTX_Free( &A );
+  return result;
+}
 
-  size_t count = 0;
 
+BOOL MTX_static_ReadCompressed_Version2( MTX* M, const char *path, const unsigned startRow, const unsigned nrows )
+{
+  FILE* fid = NULL;
+  char msg[512];
+  unsigned i = 0;
+  unsigned j = 0;
+  unsigned c = 0;
+  unsigned n = 0;              // The number of rows in the current chunk.
+  unsigned r0 = 0;             // The first row of the current chunk.
+  unsigned first = 0;          // The first row read from the current chunk.
+  unsigned last = 0;           // One past the last row read from the current chunk.
+  unsigned endRow = 0;         // One past the last row to read.
+  unsigned firstChunk = 0;
+  unsigned lastChunk = 0;
+  unsigned filesize = 0;       // The actual file size.
+  unsigned commentLength = 0;
+  unsigned chunk = 0;          // The number of rows per chunk.
+  unsigned nchunks = 0;
+  unsigned nstored = 0;        // The number of stored columns, ncols if real, ncols*2 if complex.
+  unsigned indexLength = 0;
+  unsigned maxLength = 0;      // The largest block to read.
+  unsigned offset = 0;
+  unsigned length = 0;
+  unsigned crc = 0;
+  unsigned *blockIndex = NULL; // The offset, length and crc of each block.
+  unsigned char *block = NULL;
+  double *values = NULL;       // A decoded column chunk.
+  double *x = NULL;            // The destination of the decoded column chunk.
+  char *comment = NULL;
+  BOOL result = TRUE;
   _MTX_STRUCT_FileHeader fileHeader;
 
-  fileHeader.nrows = 0;
-  fileHeader.ncols = 0;
-  fileHeader.filesize = 0;
-  fileHeader.headersize = 0;
-  fileHeader.crc = 0;
-  fileHeader.comment = NULL;
+  memset( &fileHeader, 0, sizeof(fileHeader) );
 
-#ifndef _CRT_SECURE_NO_DEPRECATE
-  if( fopen_s( &fid, path, "rb" ) != 0 )
+  if( !MTX_DetermineFileSize( path, &filesize ) )
   {
-    MTX_ERROR_MSG( "fopen_s returned an error condition." );
+    MTX_ERROR_MSG( "MTX_DetermineFileSize returned FALSE." );
     return FALSE;
   }
+
+#ifndef _CRT_SECURE_NO_DEPRECATE
+  if( fopen_s( &fid, path, "rb" ) != 0 )
+    fid = NULL;
 #else
-  fid = fopen(path,"rb");
+  fid = fopen( path, "rb" );
 #endif
-  if( !fid )
+  if( fid == NULL )
   {
 #ifndef _CRT_SECURE_NO_DEPRECATE
     if( sprintf_s( msg, 512, "Unable to open %s.", path ) > 0 )
       MTX_ERROR_MSG( msg );
 #else
-    if( sprintf( msg, "Unable to open %s.", path ) > 0 )
+    if( sprintf( msg, "Unable to open %.480s.", path ) > 0 )
       MTX_ERROR_MSG( msg );
 #endif
     return FALSE;
   }
 
-  // write the file identifiers
-  count = fread( fileHeader.id, sizeof(char), MTX_ID_SIZE, fid );
-  if( count != MTX_ID_SIZE )
-  {
-    MTX_ERROR_MSG( "fread returned an error condition." );
-    fclose(fid);
-    return FALSE;
+  if( fread( fileHeader.id, sizeof(char), MTX_ID_SIZE, fid ) != MTX_ID_SIZE ||
+    fread( &(fileHeader.headersize), sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &(fileHeader.isReal), sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &(fileHeader.nrows), sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &(fileHeader.ncols), sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &(fileHeader.filesize), sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &(fileHeader.crc), sizeof(unsigned), 1, fid ) != 1 )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    fclose( fid );
+    return FALSE;
+  }
+  fileHeader.id[MTX_ID_SIZE-1] = '\0';
+  if( strcmp( fileHeader.id, MTX_ID_COMPRESSED_02 ) != 0 )
+  {
+    MTX_ERROR_MSG( "Unsupported compressed matrix version." );
+    fclose( fid );
+    return FALSE;
+  }
+  if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )
+  {
+    MTX_ERROR_MSG( "if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )" );
+    fclose( fid );
+    return FALSE;
+  }
+  if( filesize != fileHeader.filesize )
+  {
+    MTX_ERROR_MSG( "if( filesize != fileHeader.filesize )" );
+    fclose( fid );
+    return FALSE;
+  }
+  if( fileHeader.headersize < MTX_ID_SIZE + 6*sizeof(unsigned) || fileHeader.headersize > filesize )
+  {
+    MTX_ERROR_MSG( "Invalid compressed matrix header size." );
+    fclose( fid );
+    return FALSE;
+  }
+
+  endRow = fileHeader.nrows;
+  if( nrows != 0 )
+    endRow = startRow + nrows;
+  if( startRow >= fileHeader.nrows || nrows > fileHeader.nrows - startRow )
+  {
+    MTX_ERROR_MSG( "The rows are beyond the end of the matrix." );
+    fclose( fid );
+    return FALSE;
+  }
+
+  // get the matrix comment if any
+  commentLength = fileHeader.headersize - MTX_ID_SIZE - 6*sizeof(unsigned);
+  if( commentLength != 0 )
+  {
+    comment = (char*)malloc( sizeof(char)*(commentLength+1) );
+    if( comment == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      fclose( fid );
+      return FALSE;
+    }
+    if( fread( comment, sizeof(char), commentLength, fid ) != commentLength )
+    {
+      MTX_ERROR_MSG( "fread returned an error condition." );
+      free( comment );
+      fclose( fid );
+      return FALSE;
+    }
+    comment[commentLength] = '\0';
+  }
+
+  // get the chunks and the block index
+  if( fread( &chunk, sizeof(unsigned), 1, fid ) != 1 ||
+    fread( &nchunks, sizeof(unsigned), 1, fid ) != 1 )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    result = FALSE;
+  }
+  else if( chunk == 0 || nchunks != (fileHeader.nrows - 1)/chunk + 1 )
+  {
+    MTX_ERROR_MSG( "Invalid compressed matrix chunks." );
+    result = FALSE;
+  }
+  if( result )
+  {
+    if( fileHeader.isReal )
+      nstored = fileHeader.ncols;
+    else
+      nstored = fileHeader.ncols*2;
+    indexLength = 3*nchunks*nstored;
+    if( indexLength / 3 / nchunks != nstored || indexLength > filesize/sizeof(unsigned) )
+    {
+      MTX_ERROR_MSG( "Invalid compressed matrix block index." );
+      result = FALSE;
+    }
+  }
+  if( result )
+  {
+    blockIndex = (unsigned*)malloc( indexLength*sizeof(unsigned) );
+    if( blockIndex == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      result = FALSE;
+    }
+    else if( fread( blockIndex, sizeof(unsigned), indexLength, fid ) != indexLength )
+    {
+      MTX_ERROR_MSG( "fread returned an error condition." );
+      result = FALSE;
+    }
+  }
+  if( result )
+  {
+    MTX_static_updateCRC( (unsigned char*)&chunk, sizeof(unsigned), &crc );
+    MTX_static_updateCRC( (unsigned char*)&nchunks, sizeof(unsigned), &crc );
+    MTX_static_updateCRC( (unsigned char*)blockIndex, indexLength*sizeof(unsigned), &crc );
+    if( fileHeader.crc != crc )
+    {
+      MTX_ERROR_MSG( "if( fileHeader.crc != crc )" );
+      result = FALSE;
+    }
+  }
+
+  // Only the chunks that contain the rows are read.
+  if( result )
+  {
+    firstChunk = startRow / chunk;
+    lastChunk = (endRow - 1) / chunk;
+    for( c = firstChunk; c <= lastChunk; c++ )
+    {
+      for( j = 0; j < nstored; j++ )
+      {
+        offset = blockIndex[3*(c*nstored+j)];
+        length = blockIndex[3*(c*nstored+j)+1];
+        if( offset > filesize || length > filesize - offset )
+        {
+          MTX_ERROR_MSG( "Invalid compressed matrix block index." );
+          result = FALSE;
+        }
+        if( length > maxLength )
+          maxLength = length;
+      }
+    }
+  }
+  if( result )
+  {
+    block = (unsigned char*)malloc( maxLength );
+    values = (double*)malloc( chunk*sizeof(double) );
+    if( block == NULL || values == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      result = FALSE;
+    }
+  }
+  if( result )
+  {
+    if( !MTX_Malloc( M, endRow - startRow, fileHeader.ncols, fileHeader.isReal ) )
+    {
+      MTX_ERROR_MSG( "MTX_Malloc returned FALSE." );
+      result = FALSE;
+    }
+  }
+
+  for( c = firstChunk; c <= lastChunk && result; c++ )
+  {
+    r0 = c*chunk;
+    n = fileHeader.nrows - r0;
+    if( n > chunk )
+      n = chunk;
+    first = r0 > startRow ? r0 : startRow;
+    last = r0 + n < endRow ? r0 + n : endRow;
+
+    for( j = 0; j < nstored; j++ )
+    {
+      offset = blockIndex[3*(c*nstored+j)];
+      length = blockIndex[3*(c*nstored+j)+1];
+      if( fseek( fid, (long)offset, SEEK_SET ) != 0 || 
+        fread( block, sizeof(unsigned char), length, fid ) != length )
+      {
+        MTX_ERROR_MSG( "fread returned an error condition." );
+        result = FALSE;
+        break;
+      }
+      crc = 0;
+      MTX_static_updateCRC( block, length, &crc );
+      if( crc != blockIndex[3*(c*nstored+j)+2] )
+      {
+        MTX_ERROR_MSG( "The crc of a compressed matrix block is invalid." );
+        result = FALSE;
+        break;
+      }
+
+      // whole chunks of real columns are decoded in place
+      x = values;
+      if( M->isReal && first == r0 && last == r0 + n )
+        x = &(M->data[j][r0 - startRow]);
+
+      if( !MTX_static_DecodeCompressedBlock( block, length, n, x ) )
+      {
+        MTX_ERROR_MSG( "MTX_static_DecodeCompressedBlock returned FALSE." );
+        result = FALSE;
+        break;
+      }
+
+      if( M->isReal )
+      {
+        if( x == values )
+          memcpy( &(M->data[j][first - startRow]), &(values[first - r0]), (last - first)*sizeof(double) );
+      }
+      else
+      {
+        if( j%2 == 0 )
+        {
+          for( i = first; i < last; i++ )
+            M->cplx[j/2][i - startRow].re = values[i - r0];
+        }
+        else
+        {
+          for( i = first; i < last; i++ )
+            M->cplx[j/2][i - startRow].im = values[i - r0];
+        }
+      }
+    }
+  }
+
+  if( result )
+  {
+    if( M->comment )
+      free( M->comment );
+    M->comment = comment;
+    comment = NULL;
+  }
+
+  if( comment != NULL )
+    free( comment );
+  if( blockIndex != NULL )
+    free( blockIndex );
+  if( block != NULL )
+    free( block );
+  if( values != NULL )
+    free( values );
+  fclose( fid );
+  return result;
+}
+
+
+BOOL MTX_static_ReadCompressed_LegacyVersion( MTX* M, const char *path )
+{
+  unsigned i = 0;
+  unsigned j = 0;
+  int version = 0;
+
+  FILE* fid = NULL;
+
+  unsigned g = 0; // counter
+  unsigned p = 0; // counter
+  unsigned k = 0; // counter
+  unsigned char nrepeat = 0;
+  unsigned char method = 0;
+  double d = 0.0;
+  const unsigned kCompressionByDouble = 1;
+
+  unsigned char* columnBuffer = NULL;
+  unsigned char* compressedBuffer = NULL;
+  unsigned char ucTmp[2];
+  unsigned columnBufSize = 0;
+  unsigned compressedSize = 0;
+
+  char msg[512];
+
+  size_t count = 0;
+
+  _MTX_STRUCT_FileHeader fileHeader;
+
+  fileHeader.nrows = 0;
+  fileHeader.ncols = 0;
+  fileHeader.filesize = 0;
+  fileHeader.headersize = 0;
+  fileHeader.crc = 0;
+  fileHeader.comment = NULL;
+
+#ifndef _CRT_SECURE_NO_DEPRECATE
+  if( fopen_s( &fid, path, "rb" ) != 0 )
+  {
+    MTX_ERROR_MSG( "fopen_s returned an error condition." );
+    return FALSE;
+  }
+#else
+  fid = fopen(path,"rb");
+#endif
+  if( !fid )
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( sprintf_s( msg, 512, "Unable to open %s.", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#else
+    if( sprintf( msg, "Unable to open %s.", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#endif
+    return FALSE;
+  }
+
+  // write the file identifiers
+  count = fread( fileHeader.id, sizeof(char), MTX_ID_SIZE, fid );
+  if( count != MTX_ID_SIZE )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    fclose(fid);
+    return FALSE;
+  }
+
+  if( strcmp( fileHeader.id, MTX_ID_LEGACY_V01 ) == 0 )
+  {
+    version = MTX_VERSION_NR_LEGACY_V01;
+  }
+  else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V02 ) == 0 )
+  {
+    version = MTX_VERSION_NR_LEGACY_V02;
+  }
+  else // version == 0
+  {
+    MTX_ERROR_MSG( "Unsupported compressed matrix version." );
+    fclose(fid);
+    return FALSE;
+  }
+
+  count = fread( &(fileHeader.nrows), sizeof(unsigned), 1, fid );
+  if( count != 1 )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    fclose(fid);
+    return FALSE;
+  }
+  count = fread( &(fileHeader.ncols), sizeof(unsigned), 1, fid );
+  if( count != 1 )
+  {
+    MTX_ERROR_MSG( "fread returned an error condition." );
+    fclose(fid);
+    return FALSE;
+  }
+
+  if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )
+  {
+    MTX_ERROR_MSG( "if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )" );
+    fclose(fid);
+    return FALSE;
+  }
+
+  // read in version 2 header info
+  if( version == 2 )
+  {
+    // info was used for column width determination, no longer needed
+    // with better code :D
+    for( j = 0; j < fileHeader.ncols; j++ )
+    {
+      count = fread( ucTmp, sizeof(unsigned char), 2, fid );
+      if( count != 2 )
+      {
+        MTX_ERROR_MSG( "fread returned an error condition." );
+        fclose(fid);
+        return FALSE;
+      }
+    }
+  }
+
+  // resize the matrix accordingly
+  if( M->nrows != fileHeader.nrows || M->ncols != fileHeader.ncols )
+  {
+    if( !MTX_Resize( M, fileHeader.nrows, fileHeader.ncols, TRUE ) ) //!!!! adress complex/real
+    {
+      MTX_ERROR_MSG( "MTX_Resize returned FALSE." );
+      fclose(fid);
+      return FALSE;
+    }
+  }
+
+
+  // here's where we go crazy
+  // Run Length Encoding is used in decompressing the matrix
+  // on a column by column basis
+
+  // allocate a buffer large enough to store one column completely
+  columnBufSize = sizeof(double)*(M->nrows);
+  columnBuffer = (unsigned char*)malloc( columnBufSize );
+  if( columnBuffer == NULL )
+  {
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    fclose(fid);
+    return FALSE;
+  }
+
+  for( j = 0; j < M->ncols; j++ )
+  {
+    // get the size of the compressedBuffer
+    count = fread( &compressedSize, sizeof(unsigned), 1, fid );
+    if( count != 1 )
+    {
+      MTX_ERROR_MSG( "fread returned an error condition." );
+      if( columnBuffer ) 
+        free(columnBuffer);
+      fclose(fid);
+      return FALSE;
+    }
+
+    if( compressedSize == columnBufSize )
+    {
+      // no compression just read in the doubles
+      count = fread( M->data[j], sizeof(double), M->nrows, fid );
+      if( count != M->nrows )
+      {
+        MTX_ERROR_MSG( "fread returned an error condition." );
+        if( columnBuffer )
+          free(columnBuffer);
+        fclose(fid);
+        return FALSE;
+      }
+      continue;
+    }
+
+    // allocate the compressedBuffer
+    compressedBuffer = (unsigned char*)malloc( compressedSize );
+    if( compressedBuffer == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      if( columnBuffer )
+        free(columnBuffer);
+      fclose(fid);      
+      return FALSE;
+    }
+
+    memcpy( &(compressedBuffer[0]), &compressedSize, sizeof(unsigned) );
+
+    // read in the compressed data
+    count = fread( &(compressedBuffer[sizeof(unsigned)]), 1, (compressedSize - sizeof(unsigned)), fid );
+    if( count != (compressedSize - sizeof(unsigned)) )
+    {
+      MTX_ERROR_MSG( "fread returned an error condition." );
+      if( compressedBuffer )
+        free(compressedBuffer);
+      if( columnBuffer )
+        free(columnBuffer);
+      fclose(fid);
+      return FALSE;
+    }
+
+    // determine compression method
+    memcpy( &method, &(compressedBuffer[sizeof(unsigned)]), 1 );
+    if( method != kCompressionByDouble )
+    {
+      MTX_ERROR_MSG( "if( method != kCompressionByDouble )" );
+      if( compressedBuffer )
+        free(compressedBuffer);
+      if( columnBuffer )
+        free(columnBuffer);
+      fclose(fid);
+      return FALSE;
+    }
+
+    // simple double RLE decompression
+    k = 0;
+    for( g = sizeof(unsigned)+1; g < compressedSize-sizeof(double); g+=sizeof(double) )
+    {
+      nrepeat = compressedBuffer[g];
+      g++;
+      memcpy( &d, &(compressedBuffer[g]), sizeof(double) );
+      for( p = 0; p < nrepeat; p++)
+      {
+        memcpy( &(columnBuffer[k]), &d, sizeof(double) );
+        k+=sizeof(double);
+      }
+    }
+
+    // set the data
+    for( i = 0; i < M->nrows; i++ )
+      memcpy( &(M->data[j][i]), &(columnBuffer[i*sizeof(double)]), sizeof(double) );
+
+    // remember to free the compressed buffer
+    free(compressedBuffer);
+    compressedBuffer = NULL;
+    compressedSize = 0;
+  }
+
+  // remember to delete the columnBuffer
+  free(columnBuffer);
+
+  // we're done
+  fclose(fid);
+
+  return TRUE;
+}
+
+void MTX_static_EncodeColumnarBlock( const double *x, const unsigned n, const BOOL compress, unsigned char *block, unsigned *length, unsigned char *plane )
+{
+  unsigned i = 0;
+  unsigned k = 0;
+  unsigned p = 0;     // The position in the block.
+  unsigned len = 0;   // The length of the current byte column.
+  unsigned count = 0; // The number of times a byte repeats (at most 255).
+  BOOL isConstant = TRUE;
+
+  for( i = 1; i < n; i++ )
+  {
+    if( memcmp( &x[i], &x[0], sizeof(double) ) != 0 )
+    {
+      isConstant = FALSE;
+      break;
+    }
+  }
+  if( n > 0 && isConstant )
+  {
+    block[0] = MTX_COLUMNAR_CONSTANT;
+    memcpy( block+1, &x[0], sizeof(double) );
+    *length = 1 + sizeof(double);
+    return;
+  }
+
+  if( compress )
+  {
+    // Each byte column is stored as: isCompressed (1 byte), length (unsigned), bytes.
+    block[0] = MTX_COLUMNAR_RLE;
+    p = 1;
+    for( k = 0; k < MTX_NK; k++ )
+    {
+      for( i = 0; i < n; i++ )
+        plane[i] = ((const unsigned char*)&x[i])[k];
+
+      // run length encode as (byte, count) pairs, stop once no shorter than the bytes
+      len = 0;
+      i = 0;
+      while( i < n && len < n )
+      {
+        count = 1;
+        while( i+count < n && count < 255 && plane[i+count] == plane[i] )
+          count++;
+        block[p+1+sizeof(unsigned)+len] = plane[i];
+        block[p+2+sizeof(unsigned)+len] = (unsigned char)count;
+        len += 2;
+        i += count;
+      }
+      if( i < n || len >= n )
+      {
+        block[p] = 0;
+        len = n;
+        memcpy( block+p+1+sizeof(unsigned), plane, n );
+      }
+      else
+      {
+        block[p] = 1;
+      }
+      memcpy( block+p+1, &len, sizeof(unsigned) );
+      p += 1 + sizeof(unsigned) + len;
+    }
+    if( p < 1 + n*sizeof(double) )
+    {
+      *length = p;
+      return;
+    }
+  }
+
+  block[0] = MTX_COLUMNAR_RAW;
+  memcpy( block+1, x, n*sizeof(double) );
+  *length = 1 + n*sizeof(double);
+}
+
+
+BOOL MTX_static_DecodeColumnarBlock( const unsigned char *block, const unsigned length, const unsigned n, double *x )
+{
+  unsigned i = 0;
+  unsigned j = 0;
+  unsigned k = 0;
+  unsigned p = 0;
+  unsigned len = 0;
+  unsigned count = 0;
+
+  if( length == 0 )
+  {
+    MTX_ERROR_MSG( "if( length == 0 )" );
+    return FALSE;
+  }
+
+  switch( block[0] )
+  {
+  case MTX_COLUMNAR_RAW:
+    {
+      if( length != 1 + n*sizeof(double) )
+      {
+        MTX_ERROR_MSG( "Invalid columnar block length." );
+        return FALSE;
+      }
+      memcpy( x, block+1, n*sizeof(double) );
+      break;
+    }
+  case MTX_COLUMNAR_CONSTANT:
+    {
+      if( length != 1 + sizeof(double) )
+      {
+        MTX_ERROR_MSG( "Invalid columnar block length." );
+        return FALSE;
+      }
+      for( i = 0; i < n; i++ )
+        memcpy( &x[i], block+1, sizeof(double) );
+      break;
+    }
+  case MTX_COLUMNAR_RLE:
+    {
+      p = 1;
+      for( k = 0; k < MTX_NK; k++ )
+      {
+        if( p + 1 + sizeof(unsigned) > length )
+        {
+          MTX_ERROR_MSG( "Invalid columnar block length." );
+          return FALSE;
+        }
+        memcpy( &len, block+p+1, sizeof(unsigned) );
+        if( p + 1 + sizeof(unsigned) + len > length )
+        {
+          MTX_ERROR_MSG( "Invalid columnar block length." );
+          return FALSE;
+        }
+        if( block[p] == 0 )
+        {
+          if( len != n )
+          {
+            MTX_ERROR_MSG( "Invalid columnar byte column length." );
+            return FALSE;
+          }
+          for( i = 0; i < n; i++ )
+            ((unsigned char*)&x[i])[k] = block[p+1+sizeof(unsigned)+i];
+        }
+        else
+        {
+          i = 0;
+          for( j = 0; j+1 < len; j += 2 )
+          {
+            count = block[p+2+sizeof(unsigned)+j];
+            if( i + count > n )
+            {
+              MTX_ERROR_MSG( "Invalid columnar run length." );
+              return FALSE;
+            }
+            while( count > 0 )
+            {
+              ((unsigned char*)&x[i])[k] = block[p+1+sizeof(unsigned)+j];
+              i++;
+              count--;
+            }
+          }
+          if( i != n )
+          {
+            MTX_ERROR_MSG( "Invalid columnar run length." );
+            return FALSE;
+          }
+        }
+        p += 1 + sizeof(unsigned) + len;
+      }
+      break;
+    }
+  default:
+    {
+      MTX_ERROR_MSG( "Unknown columnar block encoding." );
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+BOOL MTX_static_OpenColumnar( const char *path, const char *mode, FILE **fid, unsigned *ncols, char **header )
+{
+  char id[MTX_ID_SIZE];
+  char msg[512];
+  unsigned headerLength = 0;
+
+  *fid = NULL;
+  if( header != NULL )
+    *header = NULL;
+
+#ifndef _CRT_SECURE_NO_DEPRECATE
+  if( fopen_s( fid, path, mode ) != 0 )
+    *fid = NULL;
+#else
+  *fid = fopen( path, mode );
+#endif
+  if( *fid == NULL )
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( sprintf_s( msg, 512, "Unable to open %s", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#else
+    if( sprintf( msg, "Unable to open %.480s", path ) > 0 )
+      MTX_ERROR_MSG( msg );
+#endif
+    return FALSE;
+  }
+
+  if( fread( id, sizeof(char), MTX_ID_SIZE, *fid ) != MTX_ID_SIZE ||
+    fread( &headerLength, sizeof(unsigned), 1, *fid ) != 1 ||
+    fread( ncols, sizeof(unsigned), 1, *fid ) != 1 )
+  {
+    MTX_ERROR_MSG( "Unable to read the columnar file header." );
+    fclose( *fid );
+    *fid = NULL;
+    return FALSE;
+  }
+  id[MTX_ID_SIZE-1] = '\0';
+  if( strcmp( id, MTX_ID_COLUMNAR_01 ) != 0 || *ncols == 0 )
+  {
+    MTX_ERROR_MSG( "Not a columnar matrix file." );
+    fclose( *fid );
+    *fid = NULL;
+    return FALSE;
+  }
+
+  if( header != NULL )
+  {
+    *header = (char*)malloc( headerLength+1 );
+    if( *header == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      fclose( *fid );
+      *fid = NULL;
+      return FALSE;
+    }
+    if( fread( *header, sizeof(char), headerLength, *fid ) != headerLength )
+    {
+      MTX_ERROR_MSG( "Unable to read the columnar file header." );
+      free( *header );
+      *header = NULL;
+      fclose( *fid );
+      *fid = NULL;
+      return FALSE;
+    }
+    (*header)[headerLength] = '\0';
+  }
+  else
+  {
+    if( fseek( *fid, headerLength, SEEK_CUR ) != 0 )
+    {
+      MTX_ERROR_MSG( "Unable to read the columnar file header." );
+      fclose( *fid );
+      *fid = NULL;
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+
+BOOL MTX_static_ReadColumnarChunkHeader( FILE *fid, const unsigned ncols, unsigned *nrows, double *minimum, double *maximum, unsigned *length, BOOL *atEOF )
+{
+  size_t count = 0;
+
+  *atEOF = FALSE;
+  count = fread( nrows, sizeof(unsigned), 1, fid );
+  if( count == 0 && feof(fid) )
+  {
+    *atEOF = TRUE;
+    return TRUE;
+  }
+  if( count != 1 ||
+    fread( minimum, sizeof(double), 1, fid ) != 1 ||
+    fread( maximum, sizeof(double), 1, fid ) != 1 ||
+    fread( length, sizeof(unsigned), ncols, fid ) != ncols )
+  {
+    MTX_ERROR_MSG( "Unable to read the columnar chunk header." );
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+BOOL MTX_SaveColumnar( const MTX *M, const char *path, const char *header, const unsigned chunkLength, const BOOL compress, const BOOL append )
+{
+  FILE* fid = NULL;
+  char id[MTX_ID_SIZE];
+  char msg[512];
+  unsigned ncols = 0;
+  unsigned headerLength = 0;
+  unsigned chunk = chunkLength;
+  unsigned blockSize = 0; // The maximum size of one column block [bytes].
+  unsigned nr = 0;        // The number of rows in the current chunk.
+  unsigned r0 = 0;        // The first row of the current chunk.
+  unsigned i = 0;
+  unsigned j = 0;
+  double minimum = 0;
+  double maximum = 0;
+  unsigned *length = NULL;
+  unsigned char *blocks = NULL;
+  unsigned char *plane = NULL;
+  BOOL isExisting = FALSE;
+  BOOL result = TRUE;
+
+  if( MTX_isNull( M ) )
+  {
+    MTX_ERROR_MSG( "NULL Matrix" );
+    return FALSE;
+  }
+  if( !M->isReal )
+  {
+    MTX_ERROR_MSG( "Only real matrices can be saved in the columnar format." );
+    return FALSE;
+  }
+  if( path == NULL )
+  {
+    MTX_ERROR_MSG( "if( path == NULL )" );
+    return FALSE;
+  }
+  if( chunk == 0 )
+    chunk = MTX_COLUMNAR_DEFAULT_CHUNK;
+  if( chunk > M->nrows )
+    chunk = M->nrows;
+
+  if( append )
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( fopen_s( &fid, path, "rb" ) != 0 )
+      fid = NULL;
+#else
+    fid = fopen( path, "rb" );
+#endif
+    if( fid != NULL )
+    {
+      isExisting = TRUE;
+      fclose( fid );
+      fid = NULL;
+    }
+  }
+
+  if( isExisting )
+  {
+    // Check the existing file and append the chunks at the end.
+    if( !MTX_static_OpenColumnar( path, "r+b", &fid, &ncols, NULL ) )
+    {
+      MTX_ERROR_MSG( "MTX_static_OpenColumnar returned FALSE." );
+      return FALSE;
+    }
+    if( ncols != M->ncols )
+    {
+      MTX_ERROR_MSG( "The number of columns differs from the existing columnar file." );
+      fclose( fid );
+      return FALSE;
+    }
+    if( fseek( fid, 0, SEEK_END ) != 0 )
+    {
+      MTX_ERROR_MSG( "fseek returned an error condition." );
+      fclose( fid );
+      return FALSE;
+    }
+  }
+  else
+  {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+    if( fopen_s( &fid, path, "wb" ) != 0 )
+      fid = NULL;
+#else
+    fid = fopen( path, "wb" );
+#endif
+    if( fid == NULL )
+    {
+#ifndef _CRT_SECURE_NO_DEPRECATE
+      if( sprintf_s( msg, 512, "Unable to open %s", path ) > 0 )
+        MTX_ERROR_MSG( msg );
+#else
+      if( sprintf( msg, "Unable to open %.480s", path ) > 0 )
+        MTX_ERROR_MSG( msg );
+#endif
+      return FALSE;
+    }
+
+    memset( id, 0, MTX_ID_SIZE );
+    memcpy( id, MTX_ID_COLUMNAR_01, strlen(MTX_ID_COLUMNAR_01) );
+    if( header != NULL )
+      headerLength = (unsigned)strlen( header );
+    ncols = M->ncols;
+    if( fwrite( id, sizeof(char), MTX_ID_SIZE, fid ) != MTX_ID_SIZE ||
+      fwrite( &headerLength, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &ncols, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( header, sizeof(char), headerLength, fid ) != headerLength )
+    {
+      MTX_ERROR_MSG( "fwrite returned an error condition." );
+      fclose( fid );
+      return FALSE;
+    }
   }
 
-  if( strcmp( fileHeader.id, MTX_ID_LEGACY_V01 ) == 0 )
+  blockSize = 1 + MTX_NK*(chunk + 8);
+  length = (unsigned*)malloc( M->ncols*sizeof(unsigned) );
+  blocks = (unsigned char*)malloc( M->ncols*blockSize );
+  plane = (unsigned char*)malloc( chunk );
+  if( length == NULL || blocks == NULL || plane == NULL )
   {
-    version = MTX_VERSION_NR_LEGACY_V01;
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    result = FALSE;
   }
-  else if( strcmp( fileHeader.id, MTX_ID_LEGACY_V02 ) == 0 )
+
+  for( r0 = 0; r0 < M->nrows && result; r0 += nr )
   {
-    version = MTX_VERSION_NR_LEGACY_V02;
+    nr = M->nrows - r0;
+    if( nr > chunk )
+      nr = chunk;
+
+    // The range of the first column allows chunks to be skipped when reading.
+    minimum = M->data[0][r0];
+    maximum = M->data[0][r0];
+    for( i = r0+1; i < r0+nr; i++ )
+    {
+      if( M->data[0][i] < minimum )
+        minimum = M->data[0][i];
+      if( M->data[0][i] > maximum )
+        maximum = M->data[0][i];
+    }
+
+    for( j = 0; j < M->ncols; j++ )
+    {
+      MTX_static_EncodeColumnarBlock( &(M->data[j][r0]), nr, compress, blocks + j*blockSize, &length[j], plane );
+    }
+
+    if( fwrite( &nr, sizeof(unsigned), 1, fid ) != 1 ||
+      fwrite( &minimum, sizeof(double), 1, fid ) != 1 ||
+      fwrite( &maximum, sizeof(double), 1, fid ) != 1 ||
+      fwrite( length, sizeof(unsigned), M->ncols, fid ) != M->ncols )
+    {
+      MTX_ERROR_MSG( "fwrite returned an error condition." );
+      result = FALSE;
+      break;
+    }
+    for( j = 0; j < M->ncols; j++ )
+    {
+      if( fwrite( blocks + j*blockSize, sizeof(unsigned char), length[j], fid ) != length[j] )
+      {
+        MTX_ERROR_MSG( "fwrite returned an error condition." );
+        result = FALSE;
+        break;
+      }
+    }
   }
-  else // version == 0
+
+  if( length != NULL )
+    free( length );
+  if( blocks != NULL )
+    free( blocks );
+  if( plane != NULL )
+    free( plane );
+  if( fclose( fid ) != 0 )
   {
-    MTX_ERROR_MSG( "Unsupported compressed matrix version." );
-    fclose(fid);
-    return FALSE;
+    MTX_ERROR_MSG( "fclose returned an error condition." );
+    result = FALSE;
   }
+  return result;
+}
 
-  count = fread( &(fileHeader.nrows), sizeof(unsigned), 1, fid );
-  if( count != 1 )
+
+BOOL MTX_ReadColumnar( 
+  MTX *M, 
+  const char *path, 
+  const unsigned *columns, 
+  const unsigned nrColumns, 
+  const BOOL useRange, 
+  const double startValue, 
+  const double endValue 
+  )
+{
+  FILE* fid = NULL;
+  unsigned ncols = 0;     // The number of columns in the file.
+  unsigned n = 0;         // The number of columns read.
+  unsigned nr = 0;        // The number of rows in the current chunk.
+  unsigned nrows = 0;     // The number of rows read.
+  unsigned maxRows = 0;   // The number of rows in the chunks within the range.
+  unsigned maxChunk = 0;  // The largest number of rows in a chunk.
+  unsigned maxLength = 0; // The largest column block [bytes].
+  unsigned i = 0;
+  unsigned j = 0;
+  unsigned c = 0;
+  unsigned count = 0;
+  unsigned *length = NULL;
+  unsigned *offset = NULL;
+  unsigned char *block = NULL;
+  double *values = NULL;
+  double *keys = NULL;
+  double minimum = 0;
+  double maximum = 0;
+  long dataStart = 0;
+  long chunkStart = 0;
+  BOOL atEOF = FALSE;
+  BOOL isSelected = FALSE;
+  BOOL isAllRows = FALSE;
+  BOOL result = TRUE;
+
+  if( M == NULL || path == NULL )
   {
-    MTX_ERROR_MSG( "fread returned an error condition." );
-    fclose(fid);
+    MTX_ERROR_MSG( "if( M == NULL || path == NULL )" );
     return FALSE;
   }
-  count = fread( &(fileHeader.ncols), sizeof(unsigned), 1, fid );
-  if( count != 1 )
+
+  if( !MTX_static_OpenColumnar( path, "rb", &fid, &ncols, NULL ) )
   {
-    MTX_ERROR_MSG( "fread returned an error condition." );
-    fclose(fid);
+    MTX_ERROR_MSG( "MTX_static_OpenColumnar returned FALSE." );
     return FALSE;
   }
 
-  if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )
+  if( columns == NULL || nrColumns == 0 )
   {
-    MTX_ERROR_MSG( "if( fileHeader.nrows == 0 || fileHeader.ncols == 0 )" );
-    fclose(fid);
-    return FALSE;
+    n = ncols;
   }
-
-  // read in version 2 header info
-  if( version == 2 )
+  else
   {
-    // info was used for column width determination, no longer needed
-    // with better code :D
-    for( j = 0; j < fileHeader.ncols; j++ )
+    n = nrColumns;
+    for( j = 0; j < n; j++ )
     {
-      count = fread( ucTmp, sizeof(unsigned char), 2, fid );
-      if( count != 2 )
+      if( columns[j] >= ncols )
       {
-        MTX_ERROR_MSG( "fread returned an error condition." );
-        fclose(fid);
+        MTX_ERROR_MSG( "if( columns[j] >= ncols )" );
+        fclose( fid );
         return FALSE;
       }
     }
   }
 
-  // resize the matrix accordingly
-  if( M->nrows != fileHeader.nrows || M->ncols != fileHeader.ncols )
+  length = (unsigned*)malloc( ncols*sizeof(unsigned) );
+  offset = (unsigned*)malloc( (ncols+1)*sizeof(unsigned) );
+  if( length == NULL || offset == NULL )
   {
-    if( !MTX_Resize( M, fileHeader.nrows, fileHeader.ncols, TRUE ) ) //!!!! adress complex/real
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    result = FALSE;
+  }
+
+  // Pass 1, find the chunks within the range from the chunk headers only.
+  dataStart = ftell( fid );
+  while( result )
+  {
+    if( !MTX_static_ReadColumnarChunkHeader( fid, ncols, &nr, &minimum, &maximum, length, &atEOF ) )
     {
-      MTX_ERROR_MSG( "MTX_Resize returned FALSE." );
-      fclose(fid);
-      return FALSE;
+      MTX_ERROR_MSG( "MTX_static_ReadColumnarChunkHeader returned FALSE." );
+      result = FALSE;
+      break;
     }
-  }
+    if( atEOF )
+      break;
 
+    offset[0] = 0;
+    for( c = 0; c < ncols; c++ )
+      offset[c+1] = offset[c] + length[c];
 
-  // here's where we go crazy
-  // Run Length Encoding is used in decompressing the matrix
-  // on a column by column basis
+    if( !useRange || !( maximum < startValue || minimum > endValue ) )
+    {
+      maxRows += nr;
+      if( nr > maxChunk )
+        maxChunk = nr;
+      for( c = 0; c < ncols; c++ )
+      {
+        if( length[c] > maxLength )
+          maxLength = length[c];
+      }
+    }
+    if( fseek( fid, (long)offset[ncols], SEEK_CUR ) != 0 )
+    {
+      MTX_ERROR_MSG( "fseek returned an error condition." );
+      result = FALSE;
+    }
+  }
 
-  // allocate a buffer large enough to store one column completely
-  columnBufSize = sizeof(double)*(M->nrows);
-  columnBuffer = (unsigned char*)malloc( columnBufSize );
-  if( columnBuffer == NULL )
+  if( result && maxRows == 0 )
   {
-    MTX_ERROR_MSG( "malloc returned NULL." );
-    fclose(fid);
-    return FALSE;
+    // Nothing within the range.
+    free( length );
+    free( offset );
+    fclose( fid );
+    return MTX_Free( M );
   }
 
-  for( j = 0; j < M->ncols; j++ )
+  if( result )
   {
-    // get the size of the compressedBuffer
-    count = fread( &compressedSize, sizeof(unsigned), 1, fid );
-    if( count != 1 )
+    if( !MTX_Malloc( M, maxRows, n, TRUE ) )
     {
-      MTX_ERROR_MSG( "fread returned an error condition." );
-      if( columnBuffer ) 
-        free(columnBuffer);
-      fclose(fid);
-      return FALSE;
+      MTX_ERROR_MSG( "MTX_Malloc returned FALSE." );
+      result = FALSE;
+    }
+    block = (unsigned char*)malloc( maxLength );
+    values = (double*)malloc( maxChunk*sizeof(double) );
+    keys = (double*)malloc( maxChunk*sizeof(double) );
+    if( block == NULL || values == NULL || keys == NULL )
+    {
+      MTX_ERROR_MSG( "malloc returned NULL." );
+      result = FALSE;
+    }
+    if( fseek( fid, dataStart, SEEK_SET ) != 0 )
+    {
+      MTX_ERROR_MSG( "fseek returned an error condition." );
+      result = FALSE;
     }
+  }
 
-    if( compressedSize == columnBufSize )
+  // Pass 2, decode only the requested column blocks of the chunks within the range.
+  while( result )
+  {
+    if( !MTX_static_ReadColumnarChunkHeader( fid, ncols, &nr, &minimum, &maximum, length, &atEOF ) )
     {
-      // no compression just read in the doubles
-      count = fread( M->data[j], sizeof(double), M->nrows, fid );
-      if( count != M->nrows )
+      MTX_ERROR_MSG( "MTX_static_ReadColumnarChunkHeader returned FALSE." );
+      result = FALSE;
+      break;
+    }
+    if( atEOF )
+      break;
+
+    offset[0] = 0;
+    for( c = 0; c < ncols; c++ )
+      offset[c+1] = offset[c] + length[c];
+    chunkStart = ftell( fid );
+
+    isSelected = !useRange || !( maximum < startValue || minimum > endValue );
+    isAllRows = !useRange || ( minimum >= startValue && maximum <= endValue );
+
+    if( isSelected && !isAllRows )
+    {
+      // The first column is needed to select the rows.
+      if( fread( block, sizeof(unsigned char), length[0], fid ) != length[0] ||
+        !MTX_static_DecodeColumnarBlock( block, length[0], nr, keys ) )
       {
-        MTX_ERROR_MSG( "fread returned an error condition." );
-        if( columnBuffer )
-          free(columnBuffer);
-        fclose(fid);
-        return FALSE;
+        MTX_ERROR_MSG( "Unable to read the first column block." );
+        result = FALSE;
+        break;
       }
-      continue;
     }
 
-    // allocate the compressedBuffer
-    compressedBuffer = (unsigned char*)malloc( compressedSize );
-    if( compressedBuffer == NULL )
+    for( j = 0; j < n && isSelected; j++ )
     {
-      MTX_ERROR_MSG( "malloc returned NULL." );
-      if( columnBuffer )
-        free(columnBuffer);
-      fclose(fid);      
-      return FALSE;
+      c = columns == NULL || nrColumns == 0 ? j : columns[j];
+      if( fseek( fid, chunkStart + (long)offset[c], SEEK_SET ) != 0 ||
+        fread( block, sizeof(unsigned char), length[c], fid ) != length[c] )
+      {
+        MTX_ERROR_MSG( "Unable to read the column block." );
+        result = FALSE;
+        break;
+      }
+      if( !MTX_static_DecodeColumnarBlock( block, length[c], nr, values ) )
+      {
+        MTX_ERROR_MSG( "MTX_static_DecodeColumnarBlock returned FALSE." );
+        result = FALSE;
+        break;
+      }
+      if( isAllRows )
+      {
+        memcpy( &(M->data[j][nrows]), values, nr*sizeof(double) );
+        count = nr;
+      }
+      else
+      {
+        count = 0;
+        for( i = 0; i < nr; i++ )
+        {
+          if( keys[i] >= startValue && keys[i] <= endValue )
+          {
+            M->data[j][nrows+count] = values[i];
+            count++;
+          }
+        }
+      }
     }
+    if( !result )
+      break;
+    if( isSelected )
+      nrows += count;
 
-    memcpy( &(compressedBuffer[0]), &compressedSize, sizeof(unsigned) );
-
-    // read in the compressed data
-    count = fread( &(compressedBuffer[sizeof(unsigned)]), 1, (compressedSize - sizeof(unsigned)), fid );
-    if( count != (compressedSize - sizeof(unsigned)) )
+    if( fseek( fid, chunkStart + (long)offset[ncols], SEEK_SET ) != 0 )
     {
-      MTX_ERROR_MSG( "fread returned an error condition." );
-      if( compressedBuffer )
-        free(compressedBuffer);
-      if( columnBuffer )
-        free(columnBuffer);
-      fclose(fid);
-      return FALSE;
+      MTX_ERROR_MSG( "fseek returned an error condition." );
+      result = FALSE;
     }
+  }
 
-    // determine compression method
-    memcpy( &method, &(compressedBuffer[sizeof(unsigned)]), 1 );
-    if( method != kCompressionByDouble )
+  if( length != NULL )
+    free( length );
+  if( offset != NULL )
+    free( offset );
+  if( block != NULL )
+    free( block );
+  if( values != NULL )
+    free( values );
+  if( keys != NULL )
+    free( keys );
+  fclose( fid );
+
+  if( !result )
+    return FALSE;
+
+  // Remove the rows of partially selected chunks that were outside the range.
+  if( nrows == 0 )
+    return MTX_Free( M );
+  if( nrows < M->nrows )
+  {
+    if( !MTX_Redim( M, nrows, n ) )
     {
-      MTX_ERROR_MSG( "if( method != kCompressionByDouble )" );
-      if( compressedBuffer )
-        free(compressedBuffer);
-      if( columnBuffer )
-        free(columnBuffer);
-      fclose(fid);
+      MTX_ERROR_MSG( "MTX_Redim returned FALSE." );
       return FALSE;
     }
+  }
+  return TRUE;
+}
 
-    // simple double RLE decompression
-    k = 0;
-    for( g = sizeof(unsigned)+1; g < compressedSize-sizeof(double); g+=sizeof(double) )
-    {
-      nrepeat = compressedBuffer[g];
-      g++;
-      memcpy( &d, &(compressedBuffer[g]), sizeof(double) );
-      for( p = 0; p < nrepeat; p++)
-      {
-        memcpy( &(columnBuffer[k]), &d, sizeof(double) );
-        k+=sizeof(double);
-      }
-    }
 
-    // set the data
-    for( i = 0; i < M->nrows; i++ )
-      memcpy( &(M->data[j][i]), &(columnBuffer[i*sizeof(double)]), sizeof(double) );
+BOOL MTX_GetColumnarFileAttributes( 
+  const char *path, 
+  unsigned *nrows, 
+  unsigned *ncols, 
+  char *header, 
+  const unsigned maxlength 
+  )
+{
+  FILE* fid = NULL;
+  char *names = NULL;
+  unsigned nr = 0;
+  unsigned *length = NULL;
+  unsigned c = 0;
+  unsigned total = 0;
+  double minimum = 0;
+  double maximum = 0;
+  BOOL atEOF = FALSE;
+  BOOL result = TRUE;
 
-    // remember to free the compressed buffer
-    free(compressedBuffer);
-    compressedBuffer = NULL;
-    compressedSize = 0;
+  if( path == NULL || nrows == NULL || ncols == NULL )
+  {
+    MTX_ERROR_MSG( "if( path == NULL || nrows == NULL || ncols == NULL )" );
+    return FALSE;
   }
+  *nrows = 0;
+  *ncols = 0;
 
-  // remember to delete the columnBuffer
-  free(columnBuffer);
+  if( !MTX_static_OpenColumnar( path, "rb", &fid, ncols, &names ) )
+  {
+    MTX_ERROR_MSG( "MTX_static_OpenColumnar returned FALSE." );
+    return FALSE;
+  }
 
-  // we're done
-  fclose(fid);
+  if( header != NULL && maxlength > 0 )
+  {
+    c = (unsigned)strlen( names );
+    if( c > maxlength-1 )
+      c = maxlength-1;
+    memcpy( header, names, c );
+    header[c] = '\0';
+  }
+  free( names );
 
-  return TRUE;
+  length = (unsigned*)malloc( (*ncols)*sizeof(unsigned) );
+  if( length == NULL )
+  {
+    MTX_ERROR_MSG( "malloc returned NULL." );
+    fclose( fid );
+    return FALSE;
+  }
+
+  // The number of rows is the sum over the chunk headers.
+  while( result )
+  {
+    if( !MTX_static_ReadColumnarChunkHeader( fid, *ncols, &nr, &minimum, &maximum, length, &atEOF ) )
+    {
+      MTX_ERROR_MSG( "MTX_static_ReadColumnarChunkHeader returned FALSE." );
+      result = FALSE;
+      break;
+    }
+    if( atEOF )
+      break;
+    *nrows += nr;
+    total = 0;
+    for( c = 0; c < *ncols; c++ )
+      total += length[c];
+    if( fseek( fid, (long)total, SEEK_CUR ) != 0 )
+    {
+      MTX_ERROR_MSG( "fseek returned an error condition." );
+      result = FALSE;
+    }
+  }
+
+  free( length );
+  fclose( fid );
+  return result;
 }
 
+
 BOOL MTX_LoadAndSave( const char* infilepath, const char* outfilepath )
 {
   MTX M;
@@ -15258,9 +17182,9 @@ BOOL MTX_LoadAndSaveQuick( const char* infilepath )
   }
 
   length = (unsigned int)strlen(infilepath);
-  if( length >= 1024 )
+  if( length + 4 >= 1024 )
   {
-    MTX_ERROR_MSG( "if( length >= 1024 )" );
+    MTX_ERROR_MSG( "if( length + 4 >= 1024 )" );
     MTX_Free( &M );
     return FALSE;
   }
@@ -15275,7 +17199,9 @@ BOOL MTX_LoadAndSaveQuick( const char* infilepath )
 #else
   strcpy( outfilepath, infilepath );
 #endif
-  // find the last instance of '.' in the input file name
+  // find the last instance of '.' in the input file name (the extension is appended if there is none)
+  strptr = &(outfilepath[length]);
+  p = length;
   for( k = 0; k < length; k++ )
   {
     if( outfilepath[k] == '.' )
@@ -15283,9 +17209,14 @@ BOOL MTX_LoadAndSaveQuick( const char* infilepath )
       strptr = &(outfilepath[k]);
       p = k;
     }
+    else if( outfilepath[k] == '/' || outfilepath[k] == '\\' )
+    {
+      strptr = &(outfilepath[length]);
+      p = length;
+    }
   }
 #ifndef _CRT_SECURE_NO_DEPRECATE
-  if( sprintf_s( strptr, length-p+1, ".mtx" ) < 0 )
+  if( sprintf_s( strptr, 1024-p, ".mtx" ) < 0 )
   {
     MTX_ERROR_MSG( "sprintf_s returned failure." );
     MTX_Free( &M );
@@ -15295,6 +17226,7 @@ BOOL MTX_LoadAndSaveQuick( const char* infilepath )
   if( sprintf( strptr, ".mtx" ) < 0 )
   {
     MTX_ERROR_MSG( "sprintf returned failure." );
+    MTX_Free( &M );
     return FALSE;
   }
 #endif
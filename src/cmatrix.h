@@ -142,6 +142,25 @@ BOOL MTX_SetComment( MTX *M, const char *comment );
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_Free( MTX *M );
 
+/// \brief  Get the number of matrices allocated from scratch and freed so far.
+///         The difference between two calls is the allocation churn of the 
+///         code in between. Only frees that release memory are counted, a matrix
+///         allocated from scratch again counts as an allocation only.
+///         The counters are not synchronized between threads.
+///
+/// \code
+/// unsigned before = 0;
+/// unsigned after = 0;
+/// MTX_GetAllocationCounters( &before, NULL );
+/// MTX_Multiply( &C, &A, &B );
+/// MTX_GetAllocationCounters( &after, NULL );
+/// // after - before is the number of allocations made by the multiplication.
+/// \endcode
+void MTX_GetAllocationCounters( 
+  unsigned *nrAllocations,  //!< The number of matrices allocated from scratch (NULL to ignore).
+  unsigned *nrDeallocations //!< The number of matrices freed (NULL to ignore).
+  );
+
 /// \brief  Allocate matrix data (set to zero).
 ///
 /// \return TRUE if successful, FALSE otherwise.
@@ -453,7 +472,7 @@ BOOL MTX_OneMinus( const MTX* src, MTX *dst );
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_DetermineFileDelimiter( 
   const char *path,    //!< path to the input file
-  char *delimiter,     //!< delimiter, 'b' is binary
+  char *delimiter,     //!< delimiter, 'b' is binary, 'c' is columnar binary
   BOOL *hasComment,    //!< BOOL to indicate if a comment line is present
   char **comment       //!< pointer to a string to store the comment line, *comment memory must be freed later.
   );
@@ -511,6 +530,19 @@ BOOL MTX_ValueToString(
   const unsigned ValueBufferSize  //!< The size of the output buffer.
   );
 
+/// \brief  Convert a value to a string, identical to sprintf( buffer, "%.precision'g'", value ).
+/// The digits are generated directly with exact power of ten scaling. The C runtime is 
+/// used only when the correct rounding cannot be guaranteed this way.
+///
+/// \return TRUE if successful, FALSE otherwise.
+BOOL MTX_ValueToString_g( 
+  const double value,        //!< The double value to output.
+  const unsigned precision,  //!< The precision, %g style.
+  char *buffer,              //!< The output buffer.
+  const unsigned maxlength,  //!< The size of the output buffer.
+  unsigned *length           //!< The number of characters written, excluding the terminating null.
+  );
+
 /// \brief  Print the matrix to a file with specifed width and precision.
 /// MTX_PrintAutoWidth is recommended over this function, "%'blank''-'width.precision'g'".
 ///
@@ -1241,17 +1273,34 @@ BOOL MTX_SortByColumn( MTX *M, const unsigned col );
 
 
 
-/// \brief  Saves a matrix to the specified file path using a proprietary compressed format.
-/// ADVANCED EDITION ONLY!
+/// \brief  Saves a matrix to the specified file path using a compressed binary format (version 2).
+/// The rows are stored in chunks and each column of a chunk is an independent block. 
+/// The 64 bit words of a block are delta encoded, split into byte columns, and each byte 
+/// column is stored raw, as a constant, run length encoded or huffman coded, whichever is 
+/// shortest. The compression is lossless.
+///
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_SaveCompressed( const MTX *M, const char *path );
 
 
 /// \brief  Loads a binary compressed matrix that was saved using the MTX_SaveCompressed function.
+/// Files saved by earlier versions (version 1 and legacy) are also supported.
 ///
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_ReadCompressed( MTX *M, const char *path );
 
+/// \brief  Loads a range of rows of a binary compressed matrix that was saved using the 
+/// MTX_SaveCompressed function. Only the chunks that contain the rows are read and decoded.
+/// Files saved by earlier versions are read fully and the rows are then extracted.
+///
+/// \return TRUE if successful, FALSE otherwise.
+BOOL MTX_ReadCompressedRows( 
+  MTX *M,                      //!< The result matrix, nrows x ncols.
+  const char *path,            //!< The file path.
+  const unsigned startRow,     //!< The first row to read (zero based).
+  const unsigned nrows         //!< The number of rows to read, 0 to read to the last row.
+  );
+
 /// \brief  Get attributes of the compressed file.
 ///
 /// \return TRUE if successful, FALSE otherwise.
@@ -1263,15 +1312,57 @@ BOOL MTX_GetCompressedFileAttributes(
   );
 
 
+/// \brief  Saves a real matrix to the specified file path using a columnar format.
+/// The rows are stored in chunks of chunkLength rows. Each chunk stores the range of
+/// the first column (usually time) and each column as a separate block, so that 
+/// MTX_ReadColumnar can read only the columns and rows needed. The column blocks are
+/// optionally compressed (byte column run length encoding). If append is TRUE and the 
+/// file exists, the rows are added as new chunks (the number of columns must match).
+///
+/// \return TRUE if successful, FALSE otherwise.
+BOOL MTX_SaveColumnar( 
+  const MTX *M,                //!< The real matrix to save.
+  const char *path,            //!< The file path.
+  const char *header,          //!< The comma delimited column names and units, NULL if none.
+  const unsigned chunkLength,  //!< The number of rows per chunk, 0 for the default (4096).
+  const BOOL compress,         //!< Compress the column blocks.
+  const BOOL append            //!< Append to an existing file.
+  );
+
+/// \brief  Loads selected columns and rows of a matrix saved using MTX_SaveColumnar.
+/// Only the blocks of the requested columns are decoded, and chunks outside the
+/// range of the first column are skipped without being read.
+///
+/// \return TRUE if successful, FALSE otherwise.
+BOOL MTX_ReadColumnar( 
+  MTX *M,                      //!< The result matrix, nrows x nrColumns (empty if no rows are within the range).
+  const char *path,            //!< The file path.
+  const unsigned *columns,     //!< The column indices to read (zero based), NULL for all columns.
+  const unsigned nrColumns,    //!< The number of column indices, 0 for all columns.
+  const BOOL useRange,         //!< Read only the rows with the first column within [startValue, endValue].
+  const double startValue,     //!< The start of the range of the first column (e.g. the start time).
+  const double endValue        //!< The end of the range of the first column (e.g. the end time).
+  );
+
+/// \brief  Get attributes of a columnar file saved using MTX_SaveColumnar.
+///
+/// \return TRUE if successful, FALSE otherwise.
+BOOL MTX_GetColumnarFileAttributes( 
+  const char *path,            //!< The file path.
+  unsigned *nrows,             //!< The total number of rows.
+  unsigned *ncols,             //!< The number of columns.
+  char *header,                //!< The comma delimited column names (truncated to maxlength), NULL if not needed.
+  const unsigned maxlength     //!< The size of the header buffer.
+  );
+
+
 /// \brief  Read an ASCII matrix data file and save it using MTX_SaveCompressed.
-/// ADVANCED EDITION ONLY!
 ///
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_LoadAndSave( const char* infilepath, const char* outfilepath );
 
 /// \brief  Read an ASCII matrix data file and save it using MTX_SaveCompressed.
 /// This version saves the data to the same base filename and uses the .mtx extension.
-/// ADVANCED EDITION ONLY!
 ///
 /// \return TRUE if successful, FALSE otherwise.
 BOOL MTX_LoadAndSaveQuick( const char* infilepath );
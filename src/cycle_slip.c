@@ -291,3 +291,147 @@ BOOL CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(
   }
   return TRUE;
 }
+
+
+BOOL CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+  const double   elapsedTime,
+  const double*  previous_Doppler,
+  const double*  previous_adr,
+  const double*  current_Doppler,
+  const double*  current_adr,
+  const unsigned n,
+  const double   specifiedThresholdInCycles,
+  BOOL*    wasSlipDetected,
+  double*  sizeOfSlipInCycles
+  )
+{
+  unsigned i;
+  double half_dt;
+
+  if( previous_Doppler == NULL || previous_adr == NULL || current_Doppler == NULL || current_adr == NULL ||
+    wasSlipDetected == NULL || sizeOfSlipInCycles == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+  if( elapsedTime <= 0.0 )
+  {
+    GNSS_ERROR_MSG( "if( elapsedTime <= 0.0 )" );
+    return FALSE;
+  }
+  if( elapsedTime > 60.0 ) // The phase rate prediction method is not going to work well.
+  {
+    for( i = 0; i < n; i++ )
+    {
+      wasSlipDetected[i]    = FALSE;
+      sizeOfSlipInCycles[i] = 0.0;
+    }
+    return TRUE;
+  }
+
+  // The loop has no branches so that it can be vectorized.
+  half_dt = elapsedTime/2.0;
+  for( i = 0; i < n; i++ )
+  {
+    sizeOfSlipInCycles[i] = previous_adr[i] - (previous_Doppler[i] + current_Doppler[i]) * half_dt - current_adr[i]; // GDM_BEWARE Doppler sign convention
+    wasSlipDetected[i]    = fabs(sizeOfSlipInCycles[i]) > specifiedThresholdInCycles;
+  }
+  return TRUE;
+}
+
+
+BOOL CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(
+  const double*  previous_adr_Frequency1,
+  const double*  previous_adr_Frequency2,
+  const double*  current_adr_Frequency1,
+  const double*  current_adr_Frequency2,
+  const unsigned n,
+  const double   wavelength1,
+  const double   wavelength2,
+  const double   specifiedThresholdInMeters,
+  BOOL*    wasSlipDetected,
+  double*  sizeOfSlipInMeters
+  )
+{
+  unsigned i;
+
+  if( previous_adr_Frequency1 == NULL || previous_adr_Frequency2 == NULL || 
+    current_adr_Frequency1 == NULL || current_adr_Frequency2 == NULL ||
+    wasSlipDetected == NULL || sizeOfSlipInMeters == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+  if( wavelength1 <= 0.0 || wavelength2 <= 0.0 )
+  {
+    GNSS_ERROR_MSG( "if( wavelength1 <= 0.0 || wavelength2 <= 0.0 )" );
+    return FALSE;
+  }
+
+  // The differences are formed per frequency first to keep the precision of large adr values.
+  for( i = 0; i < n; i++ )
+  {
+    sizeOfSlipInMeters[i] = 
+      (current_adr_Frequency1[i] - previous_adr_Frequency1[i]) * wavelength1 - 
+      (current_adr_Frequency2[i] - previous_adr_Frequency2[i]) * wavelength2;
+    wasSlipDetected[i] = fabs(sizeOfSlipInMeters[i]) > specifiedThresholdInMeters;
+  }
+  return TRUE;
+}
+
+
+BOOL CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(
+  const double*  rover_range,
+  const double*  prev_rover_range,
+  const double*  reference_range,
+  const double*  prev_reference_range,
+  const double*  adr_rover_rx,
+  const double*  prev_adr_rover_rx,
+  const double*  adr_reference_rx,
+  const double*  prev_adr_reference_rx,
+  const unsigned n,
+  const unsigned indexOfBaseSatellite,
+  const double   wavelength,
+  const double   specifiedThresholdInCycles,
+  BOOL*    wasSlipDetected,
+  double*  sizeOfSlipInCycles
+  )
+{
+  unsigned i;
+  double base_misclosure;
+
+  if( rover_range == NULL || prev_rover_range == NULL || reference_range == NULL || prev_reference_range == NULL ||
+    adr_rover_rx == NULL || prev_adr_rover_rx == NULL || adr_reference_rx == NULL || prev_adr_reference_rx == NULL ||
+    wasSlipDetected == NULL || sizeOfSlipInCycles == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+  if( indexOfBaseSatellite >= n )
+  {
+    GNSS_ERROR_MSG( "if( indexOfBaseSatellite >= n )" );
+    return FALSE;
+  }
+  if( wavelength <= 0.0 )
+  {
+    GNSS_ERROR_MSG( "if( wavelength <= 0.0 )" );
+    return FALSE;
+  }
+
+  // The time differenced single difference range minus phase [cycles].
+  for( i = 0; i < n; i++ )
+  {
+    sizeOfSlipInCycles[i] = 
+      ( (rover_range[i] - prev_rover_range[i]) - (reference_range[i] - prev_reference_range[i]) ) / wavelength -
+      ( (adr_rover_rx[i] - prev_adr_rover_rx[i]) - (adr_reference_rx[i] - prev_adr_reference_rx[i]) );
+  }
+
+  // Difference with the base satellite.
+  base_misclosure = sizeOfSlipInCycles[indexOfBaseSatellite];
+  for( i = 0; i < n; i++ )
+  {
+    sizeOfSlipInCycles[i] -= base_misclosure;
+    wasSlipDetected[i] = fabs(sizeOfSlipInCycles[i]) > specifiedThresholdInCycles;
+  }
+  return TRUE;
+}
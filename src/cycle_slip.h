@@ -129,6 +129,104 @@ BOOL CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase(
   );
 
 
+/**
+\brief  Use phase rate (Doppler) to detect cycle slips for arrays of channels.
+The same test as CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction() for all 
+channels of an epoch in one pass. The arrays are aligned, element i of each 
+array is the same channel at the previous and current epoch.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+
+\pre The input adr measurements must be phase locked and have valid parity.
+
+\return  TRUE if successful, FALSE otherwise. If the elapsed time is over 60 s
+         no slips are indicated (the prediction is not reliable).
+*/
+BOOL CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch(
+  const double   elapsedTime,       //!< The time between the previous and current epochs [s].
+  const double*  previous_Doppler,  //!< The previous Doppler, n elements [Hz].
+  const double*  previous_adr,      //!< The previous adr, n elements [cycles].
+  const double*  current_Doppler,   //!< The current Doppler, n elements [Hz].
+  const double*  current_adr,       //!< The current adr, n elements [cycles].
+  const unsigned n,                 //!< The number of channels.
+  const double   specifiedThresholdInCycles, //!< The detection threshold [cycles].
+  BOOL*    wasSlipDetected,         //!< The slip indication, n elements.
+  double*  sizeOfSlipInCycles       //!< The predicted minus the measured adr, n elements [cycles].
+  );
+
+
+/**
+\brief  Use the epoch to epoch change of the dual frequency geometry free phase 
+combination to detect cycle slips for arrays of satellites. The geometry free 
+combination (L1 minus L2 phase in meters) removes the range, clock, and 
+troposphere so only the slowly changing ionosphere remains.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+
+\pre The input adr measurements must be phase locked and have valid parity.
+
+\remarks
+A slip cannot be attributed to L1 or L2. Slips with n1*wavelength1 = n2*wavelength2
+(e.g. 77 L1 and 60 L2 cycles) are not detectable.
+
+\return  TRUE if successful, FALSE otherwise.
+*/
+BOOL CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch(
+  const double*  previous_adr_Frequency1, //!< The previous frequency 1 adr, n elements [cycles].
+  const double*  previous_adr_Frequency2, //!< The previous frequency 2 adr, n elements [cycles].
+  const double*  current_adr_Frequency1,  //!< The current frequency 1 adr, n elements [cycles].
+  const double*  current_adr_Frequency2,  //!< The current frequency 2 adr, n elements [cycles].
+  const unsigned n,                       //!< The number of satellites.
+  const double   wavelength1,             //!< The frequency 1 wavelength [m].
+  const double   wavelength2,             //!< The frequency 2 wavelength [m].
+  const double   specifiedThresholdInMeters, //!< The detection threshold [m].
+  BOOL*    wasSlipDetected,               //!< The slip indication, n elements.
+  double*  sizeOfSlipInMeters             //!< The change in the geometry free phase, n elements [m].
+  );
+
+
+/**
+\brief  Use triple difference phase to detect cycle slips for arrays of satellites.
+The rover and reference measurements of all satellites at the previous and 
+current epochs are differenced in one pass. The time differenced single 
+difference (rover minus reference) range minus phase misclosure of the base 
+satellite is subtracted from that of each satellite.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+
+\pre The arrays are aligned (element i of each array is the same satellite) and the 
+     adr measurements must be phase locked and have valid parity.
+
+\remarks
+A slip on the base satellite is indicated on all other satellites.
+The base satellite itself is never indicated.
+
+\return  TRUE if successful, FALSE otherwise.
+*/
+BOOL CYCLESLIP_CheckForCycleSlipUsingTripleDifferencePhase_Batch(
+  const double*  rover_range,            //!< The rover to satellite range, n elements [m].
+  const double*  prev_rover_range,       //!< The previous rover to satellite range, n elements [m].
+  const double*  reference_range,        //!< The reference to satellite range, n elements [m].
+  const double*  prev_reference_range,   //!< The previous reference to satellite range, n elements [m].
+  const double*  adr_rover_rx,           //!< The rover adr, n elements [cycles].
+  const double*  prev_adr_rover_rx,      //!< The previous rover adr, n elements [cycles].
+  const double*  adr_reference_rx,       //!< The reference adr, n elements [cycles].
+  const double*  prev_adr_reference_rx,  //!< The previous reference adr, n elements [cycles].
+  const unsigned n,                      //!< The number of satellites.
+  const unsigned indexOfBaseSatellite,   //!< The index of the base satellite in the arrays.
+  const double   wavelength,             //!< The carrier wavelength [m].
+  const double   specifiedThresholdInCycles, //!< The detection threshold [cycles].
+  BOOL*    wasSlipDetected,              //!< The slip indication, n elements.
+  double*  sizeOfSlipInCycles            //!< The triple difference misclosure, n elements [cycles].
+  );
+
+
 #ifdef __cplusplus
 }
 #endif
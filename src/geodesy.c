@@ -34,12 +34,35 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 SUCH DAMAGE.
 */
 
+#include <stdlib.h>
 #include <math.h>
 #include "gnss_error.h"
 #include "geodesy.h"
 #include "constants.h"
 
 
+/// The text descriptions corresponding to GEODESY_enumReferenceEllipse (declared in geodesy.h).
+char *GEODESY_REFERENCE_ELLIPSE_STRING_DESCRIPTION[64] =
+{
+  "World Geodetic System 1984",
+  "Airy 1830",
+  "Modified Airy",
+  "Australian National",
+  "Bessel 1841",
+  "Clarke 1866",
+  "Clarke 1880",
+  "Everest(India 1830)",
+  "Everest(Brunei & E.Malaysia)",
+  "Everest(W.Malaysia & Singapore)",
+  "Geodetic Reference System 1980",
+  "Helmert 1906",
+  "Hough 1960",
+  "International 1924",
+  "South American 1969",
+  "World Geodetic System 1972",  
+};
+
+
 /*************************************************************************************************/
 // static function definitions (for functions used in this file only)
 // static functions are functions that are only visable to other functions in the same file.
@@ -846,3 +869,350 @@ BOOL GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame
   return TRUE;
 }
 
+
+
+BOOL GEODESY_ComputeLocalFrame(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const double latitude,            //!< geodetic latitude  [rad]
+  const double longitude,           //!< geodetic longitude [rad]
+  const double height,              //!< geodetic height    [m]
+  GEODESY_structLocalFrame* frame   //!< the computed local frame
+  )
+{
+  double a;  // semi-major axis of reference ellipse    [m]
+  double e2; // first eccentricity of reference ellipse []
+  double W;
+  BOOL result;
+
+  if( frame == NULL )
+  {
+    GNSS_ERROR_MSG( "if( frame == NULL )" );
+    return FALSE;
+  }
+  frame->isValid = FALSE;
+
+  result = GEODESY_IsLatitudeValid( latitude );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "Latitude is invalid." );
+    return result;    
+  }
+
+  result = GEODESY_GetReferenceEllipseParameters_A_E2( referenceEllipse, &a, &e2 );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "Reference ellipse invalid." );    
+    return result;
+  }
+
+  frame->latitude  = latitude;
+  frame->longitude = longitude;
+  frame->height    = height;
+
+  frame->sinlat = sin(latitude);
+  frame->coslat = cos(latitude);
+  frame->sinlon = sin(longitude);
+  frame->coslon = cos(longitude);
+
+  // radii of curvature
+  W = sqrt( 1.0 - e2 * frame->sinlat * frame->sinlat );
+  frame->N = a / W;
+  frame->M = a * ( 1.0 - e2 ) / (W*W*W);
+
+  // earth fixed position
+  frame->x = ( frame->N + height ) * frame->coslat * frame->coslon;
+  frame->y = ( frame->N + height ) * frame->coslat * frame->sinlon;
+  frame->z = ( frame->N*( 1.0 - e2 ) + height ) * frame->sinlat;
+
+  // earth fixed to local geodetic rotation (north, east, up)
+  frame->R[0][0] = -frame->sinlat*frame->coslon;
+  frame->R[0][1] = -frame->sinlat*frame->sinlon;
+  frame->R[0][2] =  frame->coslat;
+  frame->R[1][0] = -frame->sinlon;
+  frame->R[1][1] =  frame->coslon;
+  frame->R[1][2] =  0.0;
+  frame->R[2][0] =  frame->coslat*frame->coslon;
+  frame->R[2][1] =  frame->coslat*frame->sinlon;
+  frame->R[2][2] =  frame->sinlat;
+
+  frame->isValid = TRUE;
+  return TRUE;
+}
+
+
+void GEODESY_ComputeAzimuthAndElevationAnglesUsingTheLocalFrame(
+  const GEODESY_structLocalFrame* frame, //!< the local frame of the 'from' point
+  const double toX,   //!< earth centered earth fixed vector to point X component   [m]
+  const double toY,   //!< earth centered earth fixed vector to point Y component   [m]
+  const double toZ,   //!< earth centered earth fixed vector to point Z component   [m]
+  double* elevation,  //!< elevation angle [rad]
+  double* azimuth     //!< azimuth angle   [rad]
+  )
+{
+  double dX;  // ECEF X vector component between 'from' and 'to' point (m)
+  double dY;  // ECEF Y vector component between 'from' and 'to' point (m)
+  double dZ;  // ECEF Z vector component between 'from' and 'to' point (m)
+  double dN;  // LG northing vector component between 'from' and 'to' point (m)
+  double dE;  // LG easting  vector component between 'from' and 'to' point (m)
+  double dUp; // LG vertical vector component between 'from' and 'to' point (m)
+
+  // vector between the two points in the earth fixed frame
+  dX = toX - frame->x;
+  dY = toY - frame->y;
+  dZ = toZ - frame->z;
+
+  // rotate the vector to the local geodetic frame
+  dN  = frame->R[0][0]*dX + frame->R[0][1]*dY + frame->R[0][2]*dZ;
+  dE  = frame->R[1][0]*dX + frame->R[1][1]*dY;
+  dUp = frame->R[2][0]*dX + frame->R[2][1]*dY + frame->R[2][2]*dZ;
+
+  // compute the elevation
+  *elevation = atan( dUp / sqrt( dN*dN + dE*dE ) );
+  
+  // compute the azimuth
+  *azimuth = atan2(dE, dN);
+
+  // by convention, azimuth will be between 0 to 2 PI
+  if( *azimuth < 0.0 )
+    *azimuth += TWOPI;
+}
+
+
+
+BOOL GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double*  latitude,   //!< geodetic latitude, n elements                [rad]
+  const double*  longitude,  //!< geodetic longitude, n elements               [rad]
+  const double*  height,     //!< geodetic height, n elements                  [m]
+  const unsigned n,          //!< the number of points
+  double*        x,          //!< earth fixed cartesian coordinate, n elements [m]
+  double*        y,          //!< earth fixed cartesian coordinate, n elements [m]
+  double*        z           //!< earth fixed cartesian coordinate, n elements [m]
+  )
+{
+  double a;      // semi-major axis of reference ellipse [m]
+  double e2;     // first eccentricity of reference ellipse []
+  double N;      // prime vertical radius of curvature [m]
+  double sinlat; // sin of the latitude
+  double dtmp;   // temp
+  unsigned i;
+  BOOL result;
+  BOOL isAllValid = TRUE;
+
+  if( latitude == NULL || longitude == NULL || height == NULL || x == NULL || y == NULL || z == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+
+  // get necessary reference ellipse parameters
+  result = GEODESY_GetReferenceEllipseParameters_A_E2( referenceEllipse, &a, &e2 );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "Reference ellipse invalid." );
+    return FALSE;
+  }
+
+  for( i = 0; i < n; i++ )
+  {
+    if( latitude[i] > HALFPI || latitude[i] < -HALFPI )
+    {
+      x[i] = 0.0;
+      y[i] = 0.0;
+      z[i] = 0.0;
+      isAllValid = FALSE;
+      continue;
+    }
+
+    sinlat = sin( latitude[i] );
+    N = a / sqrt( 1.0 - e2 * sinlat*sinlat );
+    dtmp = (N + height[i]) * cos(latitude[i]);
+
+    x[i] = dtmp * cos(longitude[i]);
+    y[i] = dtmp * sin(longitude[i]);
+    z[i] = ( (1.0 - e2)*N + height[i] ) * sinlat;
+  }
+
+  if( !isAllValid )
+  {
+    GNSS_ERROR_MSG( "One or more input latitudes are invalid." );
+    return FALSE;
+  }
+  return TRUE;
+}
+
+
+BOOL GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double*  x,          //!< earth fixed cartesian coordinate, n elements [m]
+  const double*  y,          //!< earth fixed cartesian coordinate, n elements [m]
+  const double*  z,          //!< earth fixed cartesian coordinate, n elements [m]
+  const unsigned n,          //!< the number of points
+  double*        latitude,   //!< geodetic latitude, n elements                [rad]
+  double*        longitude,  //!< geodetic longitude, n elements               [rad]
+  double*        height      //!< geodetic height, n elements                  [m]
+  )
+{
+  double a;      // semi-major axis of reference ellipse [m]
+  double b;      // semi-minor axis of reference ellipse [m]
+  double e2;     // first eccentricity of reference ellipse []
+  double ep2;    // second eccentricity squared []
+  double a2;     // a*a
+  double b2;     // b*b
+  double e4;     // e2*e2
+  double p2;     // x^2 + y^2 [m^2]
+  double p;      // sqrt( x^2 + y^2 ) [m]
+  double z2;     // z^2 [m^2]
+  double F, G, c, s, P, Q, r0, U, V, z0, dtmp;
+  unsigned i;
+  BOOL result;
+
+  if( latitude == NULL || longitude == NULL || height == NULL || x == NULL || y == NULL || z == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+
+  // get necessary reference ellipse parameters
+  result = GEODESY_GetReferenceEllipseParameters_A_B_E2( referenceEllipse, &a, &b, &e2 );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "Reference ellipse invalid." );    
+    return FALSE;
+  }
+  a2  = a*a;
+  b2  = b*b;
+  e4  = e2*e2;
+  ep2 = (a2 - b2) / b2;
+
+  for( i = 0; i < n; i++ )
+  {
+    p2 = x[i]*x[i] + y[i]*y[i];
+    z2 = z[i]*z[i];
+
+    if( p2 == 0.0 )
+    {
+      // at a pole, longitude is really unknown
+      longitude[i] = 0.0;
+      if( z[i] < 0 )
+      {
+        height[i] = -z[i] - b;
+        latitude[i] = -HALFPI;
+      }
+      else
+      {
+        height[i] = z[i] - b;
+        latitude[i] = HALFPI;
+      }
+      continue;
+    }
+
+    p = sqrt( p2 );
+
+    // Heikkinen's closed form (Zhu, 1994)
+    F  = 54.0 * b2 * z2;
+    G  = p2 + (1.0 - e2)*z2 - e2*(a2 - b2);
+    c  = e4 * F * p2 / (G*G*G);
+    s  = pow( 1.0 + c + sqrt( c*c + 2.0*c ), 1.0/3.0 );
+    dtmp = s + 1.0/s + 1.0;
+    P  = F / ( 3.0 * dtmp*dtmp * G*G );
+    Q  = sqrt( 1.0 + 2.0*e4*P );
+    dtmp = 0.5*a2*(1.0 + 1.0/Q) - P*(1.0 - e2)*z2/(Q*(1.0 + Q)) - 0.5*P*p2;
+    if( G <= 0.0 || dtmp < 0.0 )
+    {
+      // Near the center of the earth, the closed form is not defined.
+      result = GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates(
+        referenceEllipse, x[i], y[i], z[i], &latitude[i], &longitude[i], &height[i] );
+      if( result == FALSE )
+      {
+        GNSS_ERROR_MSG( "GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates returned FALSE." );
+        return FALSE;
+      }
+      continue;
+    }
+    r0 = -P*e2*p/(1.0 + Q) + sqrt( dtmp );
+    dtmp = p - e2*r0;
+    U  = sqrt( dtmp*dtmp + z2 );
+    V  = sqrt( dtmp*dtmp + (1.0 - e2)*z2 );
+    z0 = b2 * z[i] / (a*V);
+
+    height[i]    = U * ( 1.0 - b2/(a*V) );
+    latitude[i]  = atan2( z[i] + ep2*z0, p );
+    
+    // unique solution for longitude
+    // best formula for any longitude and applies well near the poles
+    longitude[i] = 2.0 * atan2( y[i], ( x[i] + p ) );
+  }
+  return TRUE;
+}
+
+
+BOOL GEODESY_ComputePositionDifference_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double   referenceLatitude,  //!< reference point geodetic latitude  [rad]
+  const double   referenceLongitude, //!< reference point geodetic longitude [rad]
+  const double   referenceHeight,    //!< reference point geodetic height    [m]
+  const double*  latitude,           //!< geodetic latitude, n elements      [rad]
+  const double*  longitude,          //!< geodetic longitude, n elements     [rad]
+  const double*  height,             //!< geodetic height, n elements        [m]
+  const unsigned n,                  //!< the number of points
+  double*        difference_northing, //!< difference in northing, n elements [m]
+  double*        difference_easting,  //!< difference in easting, n elements  [m]
+  double*        difference_vertical  //!< difference in vertical, n elements [m]
+  )
+{
+  GEODESY_structLocalFrame frame;
+  double dx;
+  double dy;
+  double dz;
+  unsigned i;
+  BOOL result;
+
+  if( latitude == NULL || longitude == NULL || height == NULL ||
+    difference_northing == NULL || difference_easting == NULL || difference_vertical == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+
+  result = GEODESY_ComputeLocalFrame( referenceEllipse, referenceLatitude, referenceLongitude, referenceHeight, &frame );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "GEODESY_ComputeLocalFrame returned FALSE." );
+    return FALSE;
+  }
+
+  // The points are converted in place into the output arrays.
+  result = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+    referenceEllipse,
+    latitude,
+    longitude,
+    height,
+    n,
+    difference_northing,
+    difference_easting,
+    difference_vertical );
+
+  // the cartesian vector between the two points in the geodetic 
+  // frame is rotated to the local geodetic frame
+  for( i = 0; i < n; i++ )
+  {
+    dx = difference_northing[i] - frame.x;
+    dy = difference_easting[i]  - frame.y;
+    dz = difference_vertical[i] - frame.z;
+    if( latitude[i] > HALFPI || latitude[i] < -HALFPI )
+    {
+      dx = dy = dz = 0.0;
+    }
+    difference_northing[i] = frame.R[0][0]*dx + frame.R[0][1]*dy + frame.R[0][2]*dz;
+    difference_easting[i]  = frame.R[1][0]*dx + frame.R[1][1]*dy;
+    difference_vertical[i] = frame.R[2][0]*dx + frame.R[2][1]*dy + frame.R[2][2]*dz;
+  }
+
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "One or more input latitudes are invalid." );
+    return FALSE;
+  }
+  return TRUE;
+}
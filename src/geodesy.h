@@ -107,25 +107,7 @@ typedef enum
 \brief  string array with text description corresponding to GEODESY_enumReferenceEllipse
 \see    GEODESY_enumReferenceEllipse
 */
-static char *GEODESY_REFERENCE_ELLIPSE_STRING_DESCRIPTION[64] =
-{
-  "World Geodetic System 1984",
-  "Airy 1830",
-  "Modified Airy",
-  "Australian National",
-  "Bessel 1841",
-  "Clarke 1866",
-  "Clarke 1880",
-  "Everest(India 1830)",
-  "Everest(Brunei & E.Malaysia)",
-  "Everest(W.Malaysia & Singapore)",
-  "Geodetic Reference System 1980",
-  "Helmert 1906",
-  "Hough 1960",
-  "International 1924",
-  "South American 1969",
-  "World Geodetic System 1972",  
-};
+extern char *GEODESY_REFERENCE_ELLIPSE_STRING_DESCRIPTION[64];
 
 
 #define GEODESY_REFERENCE_ELLIPSE_WGS84_A                                (6378137.0)
@@ -211,6 +193,34 @@ static char *GEODESY_REFERENCE_ELLIPSE_STRING_DESCRIPTION[64] =
 /*************************************************************************************************/
 
 
+/**
+\brief  The local geodetic frame at a user position. 
+
+All the quantities that depend only on the user position and are needed for
+each satellite (trigonometric terms, radii of curvature, the earth fixed
+position and the earth fixed to local geodetic rotation) are computed once by
+GEODESY_ComputeLocalFrame() and reused for every satellite in the epoch.
+*/
+typedef struct
+{
+  double latitude;  //!< geodetic latitude                            [rad]
+  double longitude; //!< geodetic longitude                           [rad]
+  double height;    //!< geodetic height                              [m]
+  double sinlat;    //!< sin(latitude)                                []
+  double coslat;    //!< cos(latitude)                                []
+  double sinlon;    //!< sin(longitude)                               []
+  double coslon;    //!< cos(longitude)                               []
+  double M;         //!< meridian radius of curvature                 [m]
+  double N;         //!< prime vertical radius of curvature           [m]
+  double x;         //!< earth fixed X coordinate                     [m]
+  double y;         //!< earth fixed Y coordinate                     [m]
+  double z;         //!< earth fixed Z coordinate                     [m]
+  double R[3][3];   //!< rotation from the earth fixed frame to the local geodetic frame (rows: north, east, up) []
+  BOOL   isValid;   //!< indicates if the frame has been computed     []
+} GEODESY_structLocalFrame;
+
+
+
 
 /** 
 \brief    This is a look up table function to get reference ellipse parameters.
@@ -557,6 +567,132 @@ BOOL GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame
   double* elevation,  //!< elevation angle [rad]
   double* azimuth     //!< azimuth angle   [rad]
   );
+
+
+/**
+\brief  Computes the local geodetic frame quantities at a user position. The frame is
+meant to be computed once per epoch and passed to the per satellite functions, e.g.
+GEODESY_ComputeAzimuthAndElevationAnglesUsingTheLocalFrame().
+ 
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+\return   TRUE(1) if successful, FALSE(0) otherwise.
+*/
+BOOL GEODESY_ComputeLocalFrame(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const double latitude,            //!< geodetic latitude  [rad]
+  const double longitude,           //!< geodetic longitude [rad]
+  const double height,              //!< geodetic height    [m]
+  GEODESY_structLocalFrame* frame   //!< the computed local frame
+  );
+
+
+/**
+\brief  Computes the azimuth and elevation angles in the local geodetic (LG) frame from 
+the origin of a precomputed local frame to the 'to' point given in the earth fixed frame. 
+This is equivalent to GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame()
+without the per call coordinate conversion and trigonometry.
+ 
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+*/
+void GEODESY_ComputeAzimuthAndElevationAnglesUsingTheLocalFrame(
+  const GEODESY_structLocalFrame* frame, //!< the local frame of the 'from' point
+  const double toX,   //!< earth centered earth fixed vector to point X component   [m]
+  const double toY,   //!< earth centered earth fixed vector to point Y component   [m]
+  const double toZ,   //!< earth centered earth fixed vector to point Z component   [m]
+  double* elevation,  //!< elevation angle [rad]
+  double* azimuth     //!< azimuth angle   [rad]
+  );
+
+
+/**
+\brief    Converts arrays of curvilinear geodetic coordinates (latitude, longitude, 
+and ellipsoidal height) to earth fixed cartesian coordinates for the reference 
+ellipse specified. The ellipse parameters are looked up once for all points.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+\return   TRUE(1) if successful, FALSE(0) if an input is invalid (the outputs
+          for the invalid point are set to zero and the remaining points are still converted).
+*/
+BOOL GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double*  latitude,   //!< geodetic latitude, n elements                [rad]
+  const double*  longitude,  //!< geodetic longitude, n elements               [rad]
+  const double*  height,     //!< geodetic height, n elements                  [m]
+  const unsigned n,          //!< the number of points
+  double*        x,          //!< earth fixed cartesian coordinate, n elements [m]
+  double*        y,          //!< earth fixed cartesian coordinate, n elements [m]
+  double*        z           //!< earth fixed cartesian coordinate, n elements [m]
+  );
+
+
+/**
+\brief    Converts arrays of earth fixed cartesian coordinates to curvilinear 
+geodetic coordinates for the reference ellipse specified using the closed form
+(non-iterative) solution of Heikkinen as presented by Zhu.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+\return   TRUE(1) if successful, FALSE(0) otherwise.
+
+\remarks
+(1) For points near the earth's surface (and out to beyond GPS orbit altitude) the closed 
+    form agrees with GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates() 
+    to well within its 0.1 mm height convergence criterion. \n
+(2) Points close to the center of the earth (where the closed form is not defined) are 
+    converted with the iterative method. \n
+
+\b REFERENCES \n
+- Zhu, J. (1994). Conversion of Earth-centered Earth-fixed coordinates to 
+  geodetic coordinates. IEEE Transactions on Aerospace and Electronic Systems, 
+  30, 957-961. \n
+- Heikkinen, M. (1982). Geschlossene formeln zur berechnung raumlicher 
+  geodatischer koordinaten aus rechtwinkligen koordinaten. Zeitschrift 
+  Vermess. 107, 207-211. \n
+*/
+BOOL GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double*  x,          //!< earth fixed cartesian coordinate, n elements [m]
+  const double*  y,          //!< earth fixed cartesian coordinate, n elements [m]
+  const double*  z,          //!< earth fixed cartesian coordinate, n elements [m]
+  const unsigned n,          //!< the number of points
+  double*        latitude,   //!< geodetic latitude, n elements                [rad]
+  double*        longitude,  //!< geodetic longitude, n elements               [rad]
+  double*        height      //!< geodetic height, n elements                  [m]
+  );
+
+
+/**
+\brief  Compute the difference between an array of points and a single reference
+point in the local geodetic frame of the reference point. The same as calling 
+GEODESY_ComputePositionDifference() for each point but the reference point 
+position and rotation are computed once.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+\return   TRUE(1) if successful, FALSE(0) if an input is invalid (the outputs
+          for the invalid point are set to zero and the remaining points are still computed).
+*/
+BOOL GEODESY_ComputePositionDifference_Batch(
+  const GEODESY_enumReferenceEllipse  referenceEllipse,  //!< reference ellipse enumerated []
+  const double   referenceLatitude,  //!< reference point geodetic latitude  [rad]
+  const double   referenceLongitude, //!< reference point geodetic longitude [rad]
+  const double   referenceHeight,    //!< reference point geodetic height    [m]
+  const double*  latitude,           //!< geodetic latitude, n elements      [rad]
+  const double*  longitude,          //!< geodetic longitude, n elements     [rad]
+  const double*  height,             //!< geodetic height, n elements        [m]
+  const unsigned n,                  //!< the number of points
+  double*        difference_northing, //!< difference in northing, n elements [m]
+  double*        difference_easting,  //!< difference in easting, n elements  [m]
+  double*        difference_vertical  //!< difference in vertical, n elements [m]
+  );
   
 #ifdef __cplusplus
 }
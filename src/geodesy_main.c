@@ -36,9 +36,37 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+#include <time.h>
 #include "geodesy.h"
 #include "constants.h"
 
+/// The number of points converted per call to the batch functions in the streaming modes.
+#define GEODESY_MAIN_BLOCK_SIZE (4096)
+
+
+/// \brief  Convert the points read from stdin (one CSV point per line) and write 
+///         the converted points to stdout as CSV. Blank lines and lines starting 
+///         with '#' are skipped. Lines that cannot be parsed are reported on stderr.
+///
+/// \return 0 if successful, -1 otherwise.
+static int GEODESY_MAIN_Stream(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const int fn_choice,             //!< 6: lat,lon,hgt -> x,y,z, 7: x,y,z -> lat,lon,hgt, 8: lat,lon,hgt -> northing,easting,vertical
+  const double referenceLatitude,  //!< reference point geodetic latitude  (fn_choice 8 only) [rad]
+  const double referenceLongitude, //!< reference point geodetic longitude (fn_choice 8 only) [rad]
+  const double referenceHeight     //!< reference point geodetic height    (fn_choice 8 only) [m]
+  );
+
+/// \brief  Compare the throughput and agreement of the per point and the batch
+///         coordinate conversion functions using nrPoints generated points.
+///
+/// \return 0 if successful, -1 otherwise.
+static int GEODESY_MAIN_Benchmark(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const unsigned nrPoints //!< the number of points to convert.
+  );
+
 /// \brief  A  main() for a geodesy application.
 int main( int argc, char* argv[] )
 {
@@ -83,6 +111,15 @@ int main( int argc, char* argv[] )
     printf("   fromX[m], fromY[m], fromZ[m], toX[m], toY[m], toZ[m]\n" );
     printf("5, GEODESY_ComputePositionDifference\n");
     printf("   ref_lat[deg], ref_lon[deg] ref_hgt[m], lat[deg], lon[deg], hgt[m]\n");
+    printf("6, GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch\n");
+    printf("   stdin CSV: lat[deg],lon[deg],hgt[m], stdout CSV: x[m],y[m],z[m]\n");
+    printf("7, GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch\n");
+    printf("   stdin CSV: x[m],y[m],z[m], stdout CSV: lat[deg],lon[deg],hgt[m]\n");
+    printf("8, GEODESY_ComputePositionDifference_Batch\n");
+    printf("   ref_lat[deg], ref_lon[deg] ref_hgt[m]\n");
+    printf("   stdin CSV: lat[deg],lon[deg],hgt[m], stdout CSV: northing[m],easting[m],vertical[m]\n");
+    printf("9, Benchmark the per point vs. the batch conversions\n");
+    printf("   nr_points\n");
 
     return 0;
   }
@@ -96,7 +133,7 @@ int main( int argc, char* argv[] )
   referenceEllipse = (GEODESY_enumReferenceEllipse)ellipse;
 
   fn_choice = atoi(argv[2]);
-  if( fn_choice < 0 || fn_choice > 5 )
+  if( fn_choice < 0 || fn_choice > 9 )
   { 
     printf("Invalid function argument\n");
     return -1;
@@ -111,7 +148,11 @@ int main( int argc, char* argv[] )
     case 2: if( argc != 6 ){ printf("Invalid function arguments\n"); return -1; } break;
     case 3: if( argc != 9 ){ printf("Invalid function arguments\n"); return -1; } break;
     case 4: if( argc != 9 ){ printf("Invalid function arguments\n"); return -1; } break;
-    case 5: if( argc != 6 ){ printf("Invalid function arguments\n"); return -1; } break;
+    case 5: if( argc != 9 ){ printf("Invalid function arguments\n"); return -1; } break;
+    case 6: if( argc != 3 ){ printf("Invalid function arguments\n"); return -1; } break;
+    case 7: if( argc != 3 ){ printf("Invalid function arguments\n"); return -1; } break;
+    case 8: if( argc != 6 ){ printf("Invalid function arguments\n"); return -1; } break;
+    case 9: if( argc != 4 ){ printf("Invalid function arguments\n"); return -1; } break;
     default: break;
   }
 
@@ -361,6 +402,29 @@ int main( int argc, char* argv[] )
       printf( "vertical            [m]   = %.4lf\n\n", vertical );
       break;
     }
+    case 6:
+    case 7:
+    {
+      return GEODESY_MAIN_Stream( referenceEllipse, fn_choice, 0.0, 0.0, 0.0 );
+    }
+    case 8:
+    {
+      return GEODESY_MAIN_Stream( 
+        referenceEllipse, 
+        fn_choice, 
+        atof(argv[3])*DEG2RAD, 
+        atof(argv[4])*DEG2RAD, 
+        atof(argv[5]) );
+    }
+    case 9:
+    {
+      if( atoi(argv[3]) <= 0 )
+      {
+        printf("Invalid number of points\n");
+        return -1;
+      }
+      return GEODESY_MAIN_Benchmark( referenceEllipse, (unsigned)atoi(argv[3]) );
+    }
     default:
     {
       break;
@@ -369,3 +433,204 @@ int main( int argc, char* argv[] )
 
   return 0;
 }
+
+
+static int GEODESY_MAIN_Stream(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const int fn_choice,             //!< 6: lat,lon,hgt -> x,y,z, 7: x,y,z -> lat,lon,hgt, 8: lat,lon,hgt -> northing,easting,vertical
+  const double referenceLatitude,  //!< reference point geodetic latitude  (fn_choice 8 only) [rad]
+  const double referenceLongitude, //!< reference point geodetic longitude (fn_choice 8 only) [rad]
+  const double referenceHeight     //!< reference point geodetic height    (fn_choice 8 only) [m]
+  )
+{
+  static double in1[GEODESY_MAIN_BLOCK_SIZE];
+  static double in2[GEODESY_MAIN_BLOCK_SIZE];
+  static double in3[GEODESY_MAIN_BLOCK_SIZE];
+  static double out1[GEODESY_MAIN_BLOCK_SIZE];
+  static double out2[GEODESY_MAIN_BLOCK_SIZE];
+  static double out3[GEODESY_MAIN_BLOCK_SIZE];
+  char line[1024];
+  unsigned n = 0;
+  unsigned i = 0;
+  unsigned long line_number = 0;
+  int isEndOfInput = 0;
+  BOOL result = FALSE;
+
+  while( !isEndOfInput )
+  {
+    // Fill a block.
+    n = 0;
+    while( n < GEODESY_MAIN_BLOCK_SIZE )
+    {
+      if( fgets( line, sizeof(line), stdin ) == NULL )
+      {
+        isEndOfInput = 1;
+        break;
+      }
+      line_number++;
+      if( line[0] == '#' || line[0] == '\n' || line[0] == '\r' || line[0] == '\0' )
+        continue;
+      if( sscanf( line, "%lf , %lf , %lf", &in1[n], &in2[n], &in3[n] ) != 3 )
+      {
+        fprintf( stderr, "line %lu skipped, expecting three comma delimited values\n", line_number );
+        continue;
+      }
+      if( fn_choice != 7 )
+      {
+        in1[n] *= DEG2RAD;
+        in2[n] *= DEG2RAD;
+      }
+      n++;
+    }
+    if( n == 0 )
+      continue;
+
+    // Convert the block.
+    switch( fn_choice )
+    {
+      case 6:
+        result = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch(
+          referenceEllipse, in1, in2, in3, n, out1, out2, out3 );
+        break;
+      case 7:
+        result = GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch(
+          referenceEllipse, in1, in2, in3, n, out1, out2, out3 );
+        for( i = 0; i < n; i++ )
+        {
+          out1[i] *= RAD2DEG;
+          out2[i] *= RAD2DEG;
+        }
+        break;
+      case 8:
+        result = GEODESY_ComputePositionDifference_Batch(
+          referenceEllipse, referenceLatitude, referenceLongitude, referenceHeight,
+          in1, in2, in3, n, out1, out2, out3 );
+        break;
+      default:
+        return -1;
+    }
+    if( result == FALSE )
+    {
+      fprintf( stderr, "invalid input in the block ending at line %lu\n", line_number );
+    }
+
+    // Write the block.
+    for( i = 0; i < n; i++ )
+    {
+      if( fn_choice == 7 )
+        printf( "%.12lf,%.12lf,%.4lf\n", out1[i], out2[i], out3[i] );
+      else
+        printf( "%.4lf,%.4lf,%.4lf\n", out1[i], out2[i], out3[i] );
+    }
+  }
+  return 0;
+}
+
+
+static int GEODESY_MAIN_Benchmark(
+  const GEODESY_enumReferenceEllipse  referenceEllipse, //!< reference ellipse enumerated []
+  const unsigned nrPoints //!< the number of points to convert.
+  )
+{
+  double *lat = NULL;
+  double *lon = NULL;
+  double *hgt = NULL;
+  double *x = NULL;
+  double *y = NULL;
+  double *z = NULL;
+  double *lat_b = NULL;
+  double *lon_b = NULL;
+  double *hgt_b = NULL;
+  double max_dlat = 0;
+  double max_dhgt = 0;
+  double dtmp = 0;
+  double t_point = 0;
+  double t_batch = 0;
+  clock_t t0;
+  unsigned i = 0;
+  int rcode = 0;
+
+  lat   = (double*)malloc( nrPoints*sizeof(double) );
+  lon   = (double*)malloc( nrPoints*sizeof(double) );
+  hgt   = (double*)malloc( nrPoints*sizeof(double) );
+  x     = (double*)malloc( nrPoints*sizeof(double) );
+  y     = (double*)malloc( nrPoints*sizeof(double) );
+  z     = (double*)malloc( nrPoints*sizeof(double) );
+  lat_b = (double*)malloc( nrPoints*sizeof(double) );
+  lon_b = (double*)malloc( nrPoints*sizeof(double) );
+  hgt_b = (double*)malloc( nrPoints*sizeof(double) );
+  if( !lat || !lon || !hgt || !x || !y || !z || !lat_b || !lon_b || !hgt_b )
+  {
+    printf("Unable to allocate memory for %u points\n", nrPoints );
+    rcode = -1;
+  }
+  else
+  {
+    // A pseudo random set of points from below sea level to aircraft altitudes.
+    srand( 1 );
+    for( i = 0; i < nrPoints; i++ )
+    {
+      lat[i] = ( rand()/(double)RAND_MAX - 0.5 ) * PI;
+      lon[i] = ( rand()/(double)RAND_MAX - 0.5 ) * TWOPI;
+      hgt[i] = ( rand()/(double)RAND_MAX ) * 20000.0 - 500.0;
+    }
+
+    printf( "ellipse   = %s\n", GEODESY_REFERENCE_ELLIPSE_STRING_DESCRIPTION[referenceEllipse] );
+    printf( "points    = %u\n\n", nrPoints );
+
+    // geodetic to earth fixed
+    t0 = clock();
+    for( i = 0; i < nrPoints; i++ )
+    {
+      GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates( referenceEllipse, lat[i], lon[i], hgt[i], &x[i], &y[i], &z[i] );
+    }
+    t_point = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    t0 = clock();
+    GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates_Batch( referenceEllipse, lat, lon, hgt, nrPoints, x, y, z );
+    t_batch = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    printf( "geodetic to earth fixed\n" );
+    printf( "per point [points/s] = %.0lf\n", t_point > 0 ? nrPoints/t_point : 0.0 );
+    printf( "batch     [points/s] = %.0lf\n\n", t_batch > 0 ? nrPoints/t_batch : 0.0 );
+
+    // earth fixed to geodetic
+    t0 = clock();
+    for( i = 0; i < nrPoints; i++ )
+    {
+      GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates( referenceEllipse, x[i], y[i], z[i], &lat[i], &lon[i], &hgt[i] );
+    }
+    t_point = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    t0 = clock();
+    GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates_Batch( referenceEllipse, x, y, z, nrPoints, lat_b, lon_b, hgt_b );
+    t_batch = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    for( i = 0; i < nrPoints; i++ )
+    {
+      dtmp = fabs( lat[i] - lat_b[i] );
+      if( dtmp > max_dlat )
+        max_dlat = dtmp;
+      dtmp = fabs( hgt[i] - hgt_b[i] );
+      if( dtmp > max_dhgt )
+        max_dhgt = dtmp;
+    }
+
+    printf( "earth fixed to geodetic (iterative per point vs. closed form batch)\n" );
+    printf( "per point [points/s] = %.0lf\n", t_point > 0 ? nrPoints/t_point : 0.0 );
+    printf( "batch     [points/s] = %.0lf\n", t_batch > 0 ? nrPoints/t_batch : 0.0 );
+    printf( "max latitude difference [deg] = %.3g\n", max_dlat*RAD2DEG );
+    printf( "max height difference   [m]   = %.3g\n\n", max_dhgt );
+  }
+
+  if( lat )   free( lat );
+  if( lon )   free( lon );
+  if( hgt )   free( hgt );
+  if( x )     free( x );
+  if( y )     free( y );
+  if( z )     free( z );
+  if( lat_b ) free( lat_b );
+  if( lon_b ) free( lon_b );
+  if( hgt_b ) free( hgt_b );
+  return rcode;
+}
@@ -587,6 +587,114 @@ void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmeris
   double* elevation,         //!< satelilte elevation                                          [rad]
   double* doppler            //!< satellite doppler with respect to the user position          [m/s], Note: User must convert to Hz
   )
+{
+  GEODESY_structLocalFrame frame;
+  double lat;
+  double lon;
+  double hgt;
+  BOOL result;
+
+  // The local frame is computed from the user position for this satellite only. 
+  // Use the _UsingTheLocalFrame version to reuse a frame for all satellites.
+  result = GEODESY_ConvertEarthFixedCartesianToGeodeticCurvilinearCoordinates(
+    GEODESY_REFERENCE_ELLIPSE_WGS84,
+    userX,
+    userY,
+    userZ,
+    &lat,
+    &lon,
+    &hgt );
+  if( result == TRUE )
+  {
+    result = GEODESY_ComputeLocalFrame( GEODESY_REFERENCE_ELLIPSE_WGS84, lat, lon, hgt, &frame );
+  }
+  if( result == FALSE )
+  {
+    frame.isValid = FALSE; // the azimuth and elevation will be zero
+  }
+  frame.x = userX;
+  frame.y = userY;
+  frame.z = userZ;
+
+  GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData_UsingTheLocalFrame(
+    &frame,
+    gpsweek,
+    gpstow,
+    ephem_week,
+    toe,
+    toc,
+    af0,
+    af1,
+    af2,
+    tgd,
+    m0,
+    delta_n,
+    ecc,
+    sqrta,
+    omega0,
+    i0,
+    w,
+    omegadot,
+    idot,
+    cuc,
+    cus,
+    crc,
+    crs,
+    cic,
+    cis,
+    clock_correction,
+    clock_drift,
+    satX,
+    satY,
+    satZ,
+    satVx,
+    satVy,
+    satVz,
+    azimuth,
+    elevation,
+    doppler
+    );
+}
+
+
+void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData_UsingTheLocalFrame(
+  const GEODESY_structLocalFrame* userFrame, //!< local frame at the user position (userFrame->x,y,z must be valid) 
+  const unsigned short gpsweek,      //!< gps week of signal transmission (0-1024+)                              [week]
+  const double         gpstow,       //!< time of week of signal transmission  (gpstow-psr/c)                    [s]
+  const unsigned short ephem_week,   //!< ephemeris: GPS week (0-1024+)                                          [weeks]
+  const unsigned       toe,          //!< ephemeris: time of week                                                [s]
+  const unsigned       toc,          //!< ephemeris: clock reference time of week                                [s]
+  const double         af0,          //!< ephemeris: polynomial clock correction coefficient                     [s],   Note: parameters from ephemeris preferred vs almanac (22 vs 11 bits)
+  const double         af1,          //!< ephemeris: polynomial clock correction coefficient                     [s/s], Note: parameters from ephemeris preferred vs almanac (16 vs 11 bits)
+  const double         af2,          //!< ephemeris: polynomial clock correction coefficient                     [s/s^2]  
+  const double         tgd,          //!< ephemeris: group delay differential between L1 and L2                  [s]
+  const double         m0,           //!< ephemeris: mean anomaly at reference time                              [rad]
+  const double         delta_n,      //!< ephemeris: mean motion difference from computed value                  [rad/s]
+  const double         ecc,          //!< ephemeris: eccentricity                                                []
+  const double         sqrta,        //!< ephemeris: square root of the semi-major axis                          [m^(1/2)]
+  const double         omega0,       //!< ephemeris: longitude of ascending node of orbit plane at weekly epoch  [rad]
+  const double         i0,           //!< ephemeris: inclination angle at reference time                         [rad]
+  const double         w,            //!< ephemeris: argument of perigee                                         [rad]
+  const double         omegadot,     //!< ephemeris: rate of right ascension                                     [rad/s]
+  const double         idot,         //!< ephemeris: rate of inclination angle                                   [rad/s]
+  const double         cuc,          //!< ephemeris: amplitude of the cosine harmonic correction term to the argument of latitude  [rad]
+  const double         cus,          //!< ephemeris: amplitude of the sine   harmonic correction term to the argument of latitude  [rad]
+  const double         crc,          //!< ephemeris: amplitude of the cosine harmonic correction term to the orbit radius          [m]
+  const double         crs,          //!< ephemeris: amplitude of the sine   harmonic correction term to the orbit radius          [m]
+  const double         cic,          //!< ephemeris: amplitude of the cosine harmonic correction term to the angle of inclination  [rad]
+  const double         cis,          //!< ephemeris: amplitude of the sine   harmonic correction term to the angle of inclination  [rad]
+  double* clock_correction,  //!< clock correction for this satellite for this epoch           [m]
+  double* clock_drift,       //!< clock drift correction for this satellite for this epoch     [m/s]
+  double* satX,              //!< satellite X position WGS84 ECEF                              [m]
+  double* satY,              //!< satellite Y position WGS84 ECEF                              [m]
+  double* satZ,              //!< satellite Z position WGS84 ECEF                              [m]
+  double* satVx,             //!< satellite X velocity WGS84 ECEF                              [m/s]
+  double* satVy,             //!< satellite Y velocity WGS84 ECEF                              [m/s]
+  double* satVz,             //!< satellite Z velocity WGS84 ECEF                              [m/s]
+  double* azimuth,           //!< satelilte azimuth                                            [rad]
+  double* elevation,         //!< satelilte elevation                                          [rad]
+  double* doppler            //!< satellite doppler with respect to the user position          [m/s], Note: User must convert to Hz
+  )
 {
   double tow;         // user time of week adjusted with the clock corrections [s]
   double range;       // range estimate between user and satellite             [m]
@@ -674,9 +782,9 @@ void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmeris
       &vz );
 
     GPS_ComputeUserToSatelliteRangeAndRangeRate(
-      userX,
-      userY,
-      userZ,
+      userFrame->x,
+      userFrame->y,
+      userFrame->z,
       0.0,
       0.0,
       0.0,
@@ -690,16 +798,21 @@ void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmeris
       &range_rate );    
   }
 
-  GEODESY_ComputeAzimuthAndElevationAnglesBetweenToPointsInTheEarthFixedFrame(
-    GEODESY_REFERENCE_ELLIPSE_WGS84,
-    userX,
-    userY,
-    userZ,
-    x,
-    y,
-    z,
-    elevation, // sets the elevation 
-    azimuth ); // sets the azimuth
+  if( userFrame->isValid )
+  {
+    GEODESY_ComputeAzimuthAndElevationAnglesUsingTheLocalFrame(
+      userFrame,
+      x,
+      y,
+      z,
+      elevation, // sets the elevation 
+      azimuth ); // sets the azimuth
+  }
+  else
+  {
+    *elevation = 0.0;
+    *azimuth = 0.0;
+  }
 
   *satX = x;
   *satY = y;
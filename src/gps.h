@@ -42,6 +42,7 @@ extern "C" {
 #endif
 
 #include "basictypes.h"
+#include "geodesy.h"
 
 
 /// \brief    A set of satellite orbit parameters that is used 
@@ -375,6 +376,59 @@ void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmeris
   );
 
 
+/// Computes the satellite position and velocity in WGS84 based on ephemeris data
+/// given a precomputed local frame at the user position. This is the same as
+/// GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData()
+/// but the user position dependent terms needed for the azimuth and elevation are
+/// computed once per epoch rather than once per satellite.
+/// 
+/// \author   agent (agent@local)
+/// \date     2026-10-18
+/// \since    2026-10-18
+/// 
+/// \remarks
+/// (1) If userFrame->isValid is FALSE, the azimuth and elevation are set to zero. \n
+/// 
+void GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData_UsingTheLocalFrame(
+  const GEODESY_structLocalFrame* userFrame, //!< local frame at the user position (userFrame->x,y,z must be valid) 
+  const unsigned short gpsweek,      //!< gps week of signal transmission (0-1024+)                              [week]
+  const double         gpstow,       //!< time of week of signal transmission  (gpstow-psr/c)                    [s]
+  const unsigned short ephem_week,   //!< ephemeris: GPS week (0-1024+)                                          [weeks]
+  const unsigned       toe,          //!< ephemeris: time of week                                                [s]
+  const unsigned       toc,          //!< ephemeris: clock reference time of week                                [s]
+  const double         af0,          //!< ephemeris: polynomial clock correction coefficient                     [s],   Note: parameters from ephemeris preferred vs almanac (22 vs 11 bits)
+  const double         af1,          //!< ephemeris: polynomial clock correction coefficient                     [s/s], Note: parameters from ephemeris preferred vs almanac (16 vs 11 bits)
+  const double         af2,          //!< ephemeris: polynomial clock correction coefficient                     [s/s^2]  
+  const double         tgd,          //!< ephemeris: group delay differential between L1 and L2                  [s]
+  const double         m0,           //!< ephemeris: mean anomaly at reference time                              [rad]
+  const double         delta_n,      //!< ephemeris: mean motion difference from computed value                  [rad/s]
+  const double         ecc,          //!< ephemeris: eccentricity                                                []
+  const double         sqrta,        //!< ephemeris: square root of the semi-major axis                          [m^(1/2)]
+  const double         omega0,       //!< ephemeris: longitude of ascending node of orbit plane at weekly epoch  [rad]
+  const double         i0,           //!< ephemeris: inclination angle at reference time                         [rad]
+  const double         w,            //!< ephemeris: argument of perigee                                         [rad]
+  const double         omegadot,     //!< ephemeris: rate of right ascension                                     [rad/s]
+  const double         idot,         //!< ephemeris: rate of inclination angle                                   [rad/s]
+  const double         cuc,          //!< ephemeris: amplitude of the cosine harmonic correction term to the argument of latitude  [rad]
+  const double         cus,          //!< ephemeris: amplitude of the sine   harmonic correction term to the argument of latitude  [rad]
+  const double         crc,          //!< ephemeris: amplitude of the cosine harmonic correction term to the orbit radius          [m]
+  const double         crs,          //!< ephemeris: amplitude of the sine   harmonic correction term to the orbit radius          [m]
+  const double         cic,          //!< ephemeris: amplitude of the cosine harmonic correction term to the angle of inclination  [rad]
+  const double         cis,          //!< ephemeris: amplitude of the sine   harmonic correction term to the angle of inclination  [rad]
+  double* clock_correction,  //!< clock correction for this satellite for this epoch           [m]
+  double* clock_drift,       //!< clock drift correction for this satellite for this epoch     [m/s]
+  double* satX,              //!< satellite X position WGS84 ECEF                              [m]
+  double* satY,              //!< satellite Y position WGS84 ECEF                              [m]
+  double* satZ,              //!< satellite Z position WGS84 ECEF                              [m]
+  double* satVx,             //!< satellite X velocity WGS84 ECEF                              [m/s]
+  double* satVy,             //!< satellite Y velocity WGS84 ECEF                              [m/s]
+  double* satVz,             //!< satellite Z velocity WGS84 ECEF                              [m/s]
+  double* azimuth,           //!< satelilte azimuth                                            [rad]
+  double* elevation,         //!< satelilte elevation                                          [rad]
+  double* doppler            //!< satellite doppler with respect to the user position          [m/s], Note: User must convert to Hz
+  );
+
+
 
 /// Decodes the raw gps ephemeris (note, with the parity bits removed).
 /// 
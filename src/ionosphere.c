@@ -42,6 +42,7 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 SUCH DAMAGE.
 */
 
+#include <stdlib.h>
 #include <math.h>
 #include <float.h>
 #include "gnss_error.h"
@@ -56,6 +57,46 @@ SUCH DAMAGE.
 #define TWO_TO_THE_POWER_OF_16   (65536) 
 
 
+/// Validate the Klobuchar model parameters and the receiver inputs that are 
+/// common to all satellites.
+static BOOL IONOSPHERE_CheckKlobucharInputs(
+  const double  alpha0,
+  const double  alpha1,
+  const double  alpha2,
+  const double  alpha3,
+  const double  beta0,
+  const double  beta1,
+  const double  beta2,
+  const double  latitude,
+  const double  gpstow
+  )
+{
+  // Refer to page 116 of the GPS Interface Control Document. Tabble 20-X Ionospheric Parameters.
+  if( fabs(alpha0) > 128 * TWO_TO_THE_POWER_OF_M30 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha0" ); return FALSE; }
+  if( fabs(alpha1) > 128 * TWO_TO_THE_POWER_OF_M27 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha1" ); return FALSE; }
+  if( fabs(alpha2) > 128 * TWO_TO_THE_POWER_OF_M24 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha2" ); return FALSE; }
+  if( fabs(alpha3) > 128 * TWO_TO_THE_POWER_OF_M24 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha3" ); return FALSE; }
+  if( fabs(beta0)  > 128 * TWO_TO_THE_POWER_OF_11  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta0" ); return FALSE; }
+  if( fabs(beta1)  > 128 * TWO_TO_THE_POWER_OF_14  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta1" ); return FALSE; }
+  if( fabs(beta2)  > 128 * TWO_TO_THE_POWER_OF_16  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta2" ); return FALSE; }
+
+  // beta3 is not checked, it can be larger when using CODE ionosheric corrections
+  //if( fabs(beta3)  > 128 * TWO_TO_THE_POWER_OF_16  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta3" ); return FALSE; }
+  if( latitude > PI/2 || latitude < -PI/2 )
+  {
+    GNSS_ERROR_MSG( "if( latitude > PI/2 || latitude < -PI/2 )" );
+    return FALSE;
+  }
+  if( gpstow < 0.0 )
+  {
+    GNSS_ERROR_MSG( "if( gpstow < 0.0 )" );
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
 BOOL IONOSPHERE_GetL1KlobucharCorrection(   
   const double  alpha0,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s]
   const double  alpha1,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle]
@@ -87,27 +128,8 @@ BOOL IONOSPHERE_GetL1KlobucharCorrection(
   double central_angle; // earth's central angle between the user position and the earth projection of the ionospheric intersection point [semi-circles]
 
   // Check the input parameters. 
-  // Refer to page 116 of the GPS Interface Control Document. Tabble 20-X Ionospheric Parameters.
-  if( fabs(alpha0) > 128 * TWO_TO_THE_POWER_OF_M30 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha0" ); return FALSE; }
-  if( fabs(alpha1) > 128 * TWO_TO_THE_POWER_OF_M27 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha1" ); return FALSE; }
-  if( fabs(alpha2) > 128 * TWO_TO_THE_POWER_OF_M24 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha2" ); return FALSE; }
-  if( fabs(alpha3) > 128 * TWO_TO_THE_POWER_OF_M24 ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: alpha3" ); return FALSE; }
-  if( fabs(beta0)  > 128 * TWO_TO_THE_POWER_OF_11  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta0" ); return FALSE; }
-  if( fabs(beta1)  > 128 * TWO_TO_THE_POWER_OF_14  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta1" ); return FALSE; }
-  if( fabs(beta2)  > 128 * TWO_TO_THE_POWER_OF_16  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta2" ); return FALSE; }
-
-  // beta3 can be larger when using CODE ionosheric corrections
-  //if( fabs(beta3)  > 128 * TWO_TO_THE_POWER_OF_16  ){ GNSS_ERROR_MSG( "invalid ionospheric parameter: beta3" ); return FALSE; }
-  if( latitude > PI/2 || latitude < -PI/2 )
-  {
-    GNSS_ERROR_MSG( "if( latitude > PI/2 || latitude < -PI/2 )" );
+  if( !IONOSPHERE_CheckKlobucharInputs( alpha0, alpha1, alpha2, alpha3, beta0, beta1, beta2, latitude, gpstow ) )
     return FALSE;
-  }
-  if( gpstow < 0.0 )
-  {
-    GNSS_ERROR_MSG( "if( gpstow < 0.0 )" );
-    return FALSE;
-  }
    
   // convert to semi-circles
   lat = latitude  / PI;
@@ -185,3 +207,116 @@ BOOL IONOSPHERE_GetL1KlobucharCorrection(
   return TRUE;
 }
 
+
+BOOL IONOSPHERE_GetL1KlobucharCorrection_Batch(
+  const double    alpha0,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s]
+  const double    alpha1,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle]
+  const double    alpha2,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle^2]
+  const double    alpha3,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle^3]  
+  const double    beta0,      //!< coefficients of a cubic equation representing the period of the model [s]
+  const double    beta1,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle]
+  const double    beta2,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle^2]
+  const double    beta3,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle^3]
+  const double    latitude,   //!< user geodetic latitude  [rad]
+  const double    longitude,  //!< user geodetic longitude [rad]
+  const double*   elevation,  //!< elevation angles between the user and the satellites, n elements [rad]
+  const double*   azimuth,    //!< azimuth angles between the user and the satellites, measured clockwise positive from the true North, n elements [rad]   
+  const unsigned  n,          //!< number of satellites
+  const double    gpstow,     //!< receiver computed gps time of week [s]
+  double*         ionospheric_delay //!< computed ionospheric corrections, n elements [m]
+  )
+{
+  unsigned i;
+  double E;     // elevation angle between the user and the satellite [semi-circles]
+  double x;     // phase [rad]
+  double F;     // obliquity factor []
+  double t;     // local time [s]
+  double AMP;   // amplitude of the vertical delay [s]
+  double PER;   // period of the model [s]
+  double lat;   // user latitude [semi-circles]
+  double lon;   // user longitude [semi-circles]
+  double phi_m; // geomagnetic latitude of the earth projection of the ionospheric intersection point [semi-circles]
+  double lon_i; // geodetic longitude of the earth projection of the ionospheric intersection point [semi-circles]
+  double lat_i; // geodetic latitude of the earth projection of the ionospheric intersection point [semi-circles]
+  double central_angle; // earth's central angle between the user position and the earth projection of the ionospheric intersection point [semi-circles]
+  double dtmp;
+  BOOL isValid = TRUE;
+
+  if( elevation == NULL || azimuth == NULL || ionospheric_delay == NULL )
+  {
+    GNSS_ERROR_MSG( "NULL input." );
+    return FALSE;
+  }
+
+  // Check the input parameters once for all satellites.
+  if( !IONOSPHERE_CheckKlobucharInputs( alpha0, alpha1, alpha2, alpha3, beta0, beta1, beta2, latitude, gpstow ) )
+    return FALSE;
+
+  // convert to semi-circles
+  lat = latitude  / PI;
+  lon = longitude / PI;  
+
+  // The local time is wrapped with floor rather than the loop used by 
+  // IONOSPHERE_GetL1KlobucharCorrection, the delay is the same for finite times.
+  for( i = 0; i < n; i++ )
+  {
+    E = elevation[i] / PI;
+
+    // compute the central angle
+    central_angle = 0.0137 / (E + 0.11) - 0.022;
+
+    // lat of the intersection point
+    lat_i = lat + central_angle * cos( azimuth[i] );
+    lat_i = lat_i >  0.416 ?  0.416 : lat_i;
+    lat_i = lat_i < -0.416 ? -0.416 : lat_i;
+
+    // lon of the intersection point
+    lon_i = lon + central_angle * sin( azimuth[i] ) / cos( lat_i*PI );
+
+    // local time [s], bounded (0-86400)
+    t = 4.32e4 * lon_i + gpstow;
+    t = t - 86400.0*floor( t / 86400.0 );
+
+    // geomagnetic latitude
+    phi_m = lat_i + 0.064 * cos( (lon_i-1.617)*PI );
+
+    // obliquity factor
+    dtmp = 0.53 - E;
+    F = 1.0 + 16.0 * dtmp*dtmp*dtmp;
+
+    // period of the model
+    PER = beta0 + phi_m*(beta1 + phi_m*(beta2 + phi_m*beta3));
+    PER = PER < 72000.0 ? 72000.0 : PER;
+
+    // amplitude of the vertical delay
+    AMP = alpha0 + phi_m*(alpha1 + phi_m*(alpha2 + phi_m*alpha3));
+    AMP = AMP < 0.0 ? 0.0 : AMP;
+
+    // phase
+    x = TWOPI * ( t - 50400.0 ) / PER;
+
+    // compute the ionospheric delay [m]
+    dtmp = ( x >= 1.57 || x <= -1.57 ) ? 0.0 : AMP * ( 1.0 - x*x/2.0 + x*x*x*x/24.0 );
+    ionospheric_delay[i] = F * (5.0e-09 + dtmp) * LIGHTSPEED;
+  }
+
+  // A non-finite input (which the single satellite function traps in its 
+  // local time loop) propagates to the output, check once after the loop.
+  for( i = 0; i < n; i++ )
+  {
+#ifdef WIN32
+    if( !_finite(ionospheric_delay[i]) )
+      isValid = FALSE;
+#else
+    if( !isfinite(ionospheric_delay[i]) )
+      isValid = FALSE;
+#endif
+  }
+  if( !isValid )
+  {
+    GNSS_ERROR_MSG( "Non-finite ionospheric correction." );
+    return FALSE;
+  }
+
+  return TRUE;
+}
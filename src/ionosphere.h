@@ -85,6 +85,38 @@ BOOL IONOSPHERE_GetL1KlobucharCorrection(
   double* ionospheric_delay //!< computed ionospheric correction [m]
   );
 
+
+/**
+\brief Compute the L1 Klobuchar ionospheric delay for an array of satellites
+observed by one receiver at one epoch.
+
+This is equivalent to calling IONOSPHERE_GetL1KlobucharCorrection() once per 
+satellite but the model parameters are validated once for all satellites.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+
+\return TRUE if successful, FALSE if the inputs are invalid or any delay is not finite.
+*/
+BOOL IONOSPHERE_GetL1KlobucharCorrection_Batch(
+  const double    alpha0,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s]
+  const double    alpha1,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle]
+  const double    alpha2,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle^2]
+  const double    alpha3,     //!< coefficients of a cubic equation representing the amplitude of the vertical delay [s/semi-circle^3]  
+  const double    beta0,      //!< coefficients of a cubic equation representing the period of the model [s]
+  const double    beta1,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle]
+  const double    beta2,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle^2]
+  const double    beta3,      //!< coefficients of a cubic equation representing the period of the model [s/semi-circle^3]
+  const double    latitude,   //!< user geodetic latitude  [rad]
+  const double    longitude,  //!< user geodetic longitude [rad]
+  const double*   elevation,  //!< elevation angles between the user and the satellites, n elements [rad]
+  const double*   azimuth,    //!< azimuth angles between the user and the satellites, measured clockwise positive from the true North, n elements [rad]   
+  const unsigned  n,          //!< number of satellites
+  const double    gpstow,     //!< receiver computed gps time of week [s]
+  double*         ionospheric_delay //!< computed ionospheric corrections, n elements [m]
+  );
+
 #ifdef __cplusplus
 }
 #endif
@@ -143,6 +143,34 @@ void NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight(
 }
 
 
+void NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight_UsingTheLocalFrame( 
+  const GEODESY_structLocalFrame* frame, // The local frame at the user position.
+  const double satX,      // Satellite X coordinate WGS84 ECEF        [m]
+  const double satY,      // Satellite Y coordinate WGS84 ECEF        [m]
+  const double satZ,      // Satellite Z coordinate WGS84 ECEF        [m]  
+  double* dlat,           // d(P)/d(lat) but not in units of [m/rad], [m/m]
+  double* dlon,           // d(P)/d(lon) but not in units of [m/rad], [m/m]
+  double* dhgt,           // d(P)/d(hgt)                              [m/m]
+  double* range )         // computed user to satellite range         [m]
+{
+  double dx;
+  double dy;
+  double dz;  
+
+  // d/dx(P) = -(x_s-x)/range, likewise for d/dy, d/dz
+  dx = frame->x - satX;
+  dy = frame->y - satY;
+  dz = frame->z - satZ;
+
+  *range  = sqrt( dx*dx + dy*dy + dz*dz );
+
+  // Rotate the derivatives with respect to xyz to the local frame.
+  *dlat = ( frame->R[0][0]*dx + frame->R[0][1]*dy + frame->R[0][2]*dz ) / (*range);
+  *dlon = ( frame->R[1][0]*dx + frame->R[1][1]*dy                     ) / (*range);  
+  *dhgt = ( frame->R[2][0]*dx + frame->R[2][1]*dy + frame->R[2][2]*dz ) / (*range);  
+}
+
+
 
 
 
@@ -37,6 +37,8 @@ SUCH DAMAGE.
 #ifndef _C_NAVIGATION_H_
 #define _C_NAVIGATION_H_
 
+#include "geodesy.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -86,6 +88,28 @@ void NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight(
   );
 
 
+/// \brief    Computes the derivative of the pseudorange with respect 
+///           to latitude, longitude, and height using a precomputed local
+///           frame at the user position. The results are the same as
+///           NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight()
+///           but the user position terms are not recomputed for each satellite.
+/// 
+/// \author   agent (agent@local)
+/// \date     2026-10-18
+/// \since    2026-10-18
+/// 
+void NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight_UsingTheLocalFrame( 
+  const GEODESY_structLocalFrame* frame, //!< The local frame at the user position.
+  const double satX,      //!< Satellite X coordinate WGS84 ECEF        [m]
+  const double satY,      //!< Satellite Y coordinate WGS84 ECEF        [m]
+  const double satZ,      //!< Satellite Z coordinate WGS84 ECEF        [m]  
+  double* dlat,           //!< d(P)/d(lat) but not in units of [m/rad], [m/m]
+  double* dlon,           //!< d(P)/d(lon) but not in units of [m/rad], [m/m]
+  double* dhgt,           //!< d(P)/d(hgt)                              [m/m]
+  double* range           //!< computed user to satellite range         [m]
+  );
+
+
 
 
 /// \brief    Compute a closed form position solution using four 
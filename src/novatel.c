@@ -1476,6 +1476,140 @@ BOOL NOVATELOEM4_FindNextMessageInFile(
 
 
 
+BOOL NOVATELOEM4_FindNextMessageInStream(
+  FILE *fid,                       //!< A file pointer to an open stream (input).
+  unsigned char *message,          //!< A message buffer in which to place the message found (input/output).
+  const unsigned maxMessageLength, //!< The maximum size of the message buffer (input).
+  BOOL *wasEndOfFileReached,       //!< Has the end of the stream been reached (output).
+  BOOL *wasMessageFound,           //!< Was a valid message found (output).
+  unsigned short *messageLength,   //!< The length of the entire message found and stored in the message buffer (output).
+  unsigned short *messageID,       //!< The message ID of the message found.
+  unsigned *numberBadCRC           //!< The number of bad crc values found. (crc fails or mistaken messages).  
+  )
+{
+  unsigned i = 0;                  // The index into the message buffer.
+  int c = 0;                       // A byte read by fgetc().
+  unsigned char sync[3];           // 0xAA 0x44 0x12
+  unsigned char headerLength = 0;  // The length of the message header [bytes].
+  unsigned byteCount = 0;          // This indicates the number of bytes read by fread().
+  unsigned short dataLength = 0;   // The length of the data portion of the message.
+  unsigned msgLength = 0;          // The entire length of the current message being examined.
+  unsigned messageCRC = 0;         // The message CRC value.
+  BOOL isCRCValid = FALSE;         // A boolean to indicate if the CRC is valid. Does it match the calculated value.
+
+  // Initialize the output parameters.
+  *wasEndOfFileReached = FALSE;
+  *wasMessageFound = FALSE;
+  *messageLength   = 0;
+  *messageID       = 0;
+  *numberBadCRC    = 0;
+
+  if( fid == NULL )
+  {
+    GNSS_ERROR_MSG( "if( fid == NULL )" );
+    return FALSE;
+  }
+  if( maxMessageLength < 32 ) // at least 3 sync bytes plus 25 header bytes plus the 4 byte CRC.
+  {
+    GNSS_ERROR_MSG( "if( maxMessageLength < 32 )" );
+    return FALSE;
+  }
+
+  sync[0] = 0;
+  sync[1] = 0;
+  sync[2] = 0;
+  while( !(*wasMessageFound) )
+  {
+    // Shift in the next byte until the three sync bytes are found.
+    c = fgetc( fid );
+    if( c == EOF )
+    {
+      *wasEndOfFileReached = TRUE;
+      return TRUE;
+    }
+    sync[0] = sync[1];
+    sync[1] = sync[2];
+    sync[2] = (unsigned char)c;
+    if( !(sync[0] == 0xAA && sync[1] == 0x44 && sync[2] == 0x12) )
+      continue;
+
+    // Reset the sync so that the search after a bad message starts afresh.
+    sync[2] = 0;
+
+    message[0] = 0xAA;
+    message[1] = 0x44;
+    message[2] = 0x12;
+
+    // Get the header length.
+    c = fgetc( fid );
+    if( c == EOF )
+    {
+      *wasEndOfFileReached = TRUE;
+      return TRUE;
+    }
+    headerLength = (unsigned char)c;
+    message[3] = headerLength;
+    if( headerLength < 10 || headerLength > maxMessageLength )
+    {
+      *numberBadCRC += 1;
+      continue;
+    }
+
+    // Get rest of the header.
+    byteCount = (unsigned)fread( &(message[4]), sizeof(unsigned char), headerLength-4, fid );
+    if( byteCount+4 != headerLength )
+    {
+      *wasEndOfFileReached = TRUE;
+      return TRUE;
+    }
+
+    // Determine the 2 byte message ID and the 2 byte data length.
+    *messageID  = message[4];
+    *messageID |= message[5] << 8;
+    dataLength  = message[8];
+    dataLength |= message[9] << 8;
+
+    // Check that the entire message length will fit in the message buffer.
+    msgLength = headerLength + dataLength + 4; // plus 4 for the CRC.
+    if( msgLength > maxMessageLength )
+    {
+      *numberBadCRC += 1;
+      continue;
+    }
+
+    // Get the data part of the message and the CRC.
+    i = headerLength;
+    byteCount = (unsigned)fread( &(message[i]), sizeof(unsigned char), dataLength+4, fid );
+    if( byteCount != (unsigned)(dataLength+4) )
+    {
+      *wasEndOfFileReached = TRUE;
+      return TRUE;
+    }
+    i += dataLength;
+    messageCRC  = message[i];
+    messageCRC |= message[i+1] << 8;
+    messageCRC |= message[i+2] << 16;
+    messageCRC |= message[i+3] << 24;
+
+    // Compare the received message CRC with the calculated CRC.
+    if( !NOVATEL_CheckCRC32( message, (unsigned short)msgLength, messageCRC, &isCRCValid ) )
+    {
+      GNSS_ERROR_MSG( "NOVATEL_CheckCRC32 returned FALSE." );
+      return FALSE;
+    }
+    if( !isCRCValid )
+    {
+      *numberBadCRC += 1;
+      continue;
+    }
+
+    *wasMessageFound = TRUE;
+    *messageLength = (unsigned short)msgLength;
+  }
+  return TRUE;
+}
+
+
 BOOL NOVATELOEM4_FindNextMessageInBuffer(
   unsigned char *buffer,           //!< A pointer to a buffer containing input data.
   const unsigned bufferLength,     //!< The length of the valid data contained in the buffer.
@@ -734,6 +734,33 @@ BOOL NOVATELOEM4_FindNextMessageInFile(
   );
 
 
+/**
+\brief  Read the next NovAtel OEM4 message from an open stream that cannot 
+        be repositioned (e.g. a pipe).
+
+Same as NOVATELOEM4_FindNextMessageInFile but no file positioning is 
+used, so a stream is read as it is written. Each read blocks until the 
+bytes needed are available. If a candidate message fails its CRC, the 
+search resumes after the bytes already read, so a message that starts 
+within the corrupted one is skipped.
+
+\author   agent (agent@local)
+\date     2026-10-18
+\since    2026-10-18
+\return   TRUE(1) if successful, FALSE(0) otherwise.
+*/
+BOOL NOVATELOEM4_FindNextMessageInStream(
+  FILE *fid,                       //!< A file pointer to an open stream (input).
+  unsigned char *message,          //!< A message buffer in which to place the message found (input/output).
+  const unsigned maxMessageLength, //!< The maximum size of the message buffer (input).
+  BOOL *wasEndOfFileReached,       //!< Has the end of the stream been reached (output).
+  BOOL *wasMessageFound,           //!< Was a valid message found (output).
+  unsigned short *messageLength,   //!< The length of the entire message found and stored in the message buffer (output).
+  unsigned short *messageID,       //!< The message ID of the message found.
+  unsigned *numberBadCRC           //!< The number of bad crc values found. (crc fails or mistaken messages).
+  );
+
+
 /**
 \brief  Find the next NovAtel OEM4 message in a buffer.
 
@@ -44,6 +44,7 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 SUCH DAMAGE.
 */
 
+#include <stdlib.h>
 #include <math.h>
 #include "gnss_error.h"
 #include "troposphere.h"
@@ -268,6 +269,57 @@ void TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
 } 
 
 
+void TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(
+  const double    zenith_dry_delay,  //!< dry zenith delay                              [m]
+  const double    zenith_wet_delay,  //!< wet zenith delay                              [m]
+  const double*   elevation,         //!< satellite elevation angles, n elements        [rad]
+  const unsigned  n,                 //!< number of elevation angles
+  const double    latitude,          //!< user latitude                                 [rad]
+  const double    height,            //!< user height (orthometric, ie above sea level) [m]  
+  double*         drydelay,          //!< dry delays mapped to the elevation angles, n elements [m]
+  double*         wetdelay           //!< wet delays mapped to the elevation angles, n elements [m]
+  )
+{
+  unsigned i;
+  double coslat;
+  double a_dry, num_dry; // dry mapping value parameter and numerator (see Eqn 2, [2])
+  double a_wet, num_wet; // wet mapping value parameter and numerator (see Eqn 2, [2])
+  double el;             // clamped elevation angle [rad]
+  double sine;           // sin(elevation)
+  double dem;            // denominator
+  const double b_dry = 0.0035716;
+  const double c_dry = 0.082456;
+  const double b_wet = 0.0018576;
+  const double c_wet = 0.062741;
+  const double min_el = 2.0*DEG2RAD;
+
+  if( elevation == NULL || drydelay == NULL || wetdelay == NULL )
+    return;
+
+  // The receiver dependent terms are common to all satellites.
+  coslat  = cos(latitude);
+  a_dry   = (1.18972 - 0.026855*height/1000.0 + 0.10664*coslat) / 1000.0;
+  num_dry = 1.0 + ( a_dry / ( 1.0 + ( b_dry / ( 1.0 + c_dry ) ) ) );
+  a_wet   = (0.61120 - 0.035348*height/1000.0 - 0.01526*coslat) / 1000.0;
+  num_wet = 1.0 + ( a_wet / ( 1.0 + ( b_wet / ( 1.0 + c_wet ) ) ) );
+
+  // Only sin(elevation) and the continued fractions remain per elevation angle.
+  for( i = 0; i < n; i++ )
+  {
+    el = elevation[i];
+    el = el < min_el ? min_el : el; // this mapping function is only good to 2 degrees
+    el = el > HALFPI ? HALFPI : el; // user error, sine(HALFPI)
+    sine = sin(el);
+
+    dem = sine + ( a_dry / ( sine + ( b_dry / ( sine + c_dry ) ) ) );
+    drydelay[i] = zenith_dry_delay*num_dry/dem;
+
+    dem = sine + ( a_wet / ( sine + ( b_wet / ( sine + c_wet ) ) ) );
+    wetdelay[i] = zenith_wet_delay*num_wet/dem;
+  }
+}
+
+
 
 
 /*
@@ -63,7 +63,7 @@ extern "C" {
 /// [1] Guo, J. and R. B. Langely 2003. A New Tropospheric Propagation Delay Mapping Function for 
 ///     Elevation Angles Down to 2 degrees. ION GPS 2003, 9-12 Sept. 2003, Portland OR
 /// 
-void TROPOSPHERE_GetDayAndWetMappingValues_UsingThe_UNBabc_Model( 
+void TROPOSPHERE_GetDayAndWetMappingValues_UsingThe_UNBabc_MappingFunction( 
   const double elevation,  //!< satellite elevation angle                     [rad]
   const double latitude,   //!< user latitude                                 [rad]
   const double height,     //!< user height (orthometric, ie above sea level) [m]
@@ -113,6 +113,32 @@ void TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
   double*      wetdelay           //!< wet delay mapped to this elevation angle      [m]
   );
 
+
+/// Computes the dry and wet delays for an array of elevation angles using the UNBabc
+/// mapping function. This is equivalent to calling 
+/// TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction() once per 
+/// elevation angle, but the latitude and height dependent terms are computed only
+/// once.
+/// 
+/// \author   agent (agent@local)
+/// \date     2026-10-18
+/// \since    2026-10-18
+///
+/// \remarks
+/// - Elevation angles are clamped to [2 deg, 90 deg] exactly as in the single
+///   satellite function.
+/// 
+void TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(
+  const double    zenith_dry_delay,  //!< dry zenith delay                              [m]
+  const double    zenith_wet_delay,  //!< wet zenith delay                              [m]
+  const double*   elevation,         //!< satellite elevation angles, n elements        [rad]
+  const unsigned  n,                 //!< number of elevation angles
+  const double    latitude,          //!< user latitude                                 [rad]
+  const double    height,            //!< user height (orthometric, ie above sea level) [m]  
+  double*         drydelay,          //!< dry delays mapped to the elevation angles, n elements [m]
+  double*         wetdelay           //!< wet delays mapped to the elevation angles, n elements [m]
+  );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,698 @@
+/**
+\file    GNSS_AmbiguityResolver.cpp
+\brief   Integer least squares ambiguity resolution (LAMBDA method) with
+         the decorrelating transformation kept between epochs.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include "gnss_error.h"
+#include "GNSS_AmbiguityResolver.h"
+
+/// The largest element of the kept Z transformation before it is discarded.
+#define GNSS_AMBIGUITYRESOLVER_MAX_Z (1.0e6)
+
+namespace GNSS
+{
+  /// \brief   Round to the nearest integer, halves away from zero.
+  static double AmbiguityResolver_Round( const double x )
+  {
+    if( x < 0 )
+      return -floor( -x + 0.5 );
+    else
+      return floor( x + 0.5 );
+  }
+
+  /// \brief   The sign of x, +1 for zero.
+  static double AmbiguityResolver_Sign( const double x )
+  {
+    return x < 0 ? -1.0 : 1.0;
+  }
+
+
+  GNSS_AmbiguityResolver::GNSS_AmbiguityResolver()
+    : m_MaxSearchNodes(0),
+    m_PartialRatioThreshold(0),
+    m_MinNrPartialAmbiguities(4),
+    m_nrFixed(0),
+    m_nrSearchNodes(0),
+    m_maxNrSearchNodes(0),
+    m_nrEpochs(0),
+    m_nrColdStarts(0),
+    m_nrIntegerTransformations(0),
+    m_n(0),
+    m_first(0),
+    m_baseId(0)
+  {}
+
+  GNSS_AmbiguityResolver::~GNSS_AmbiguityResolver()
+  {}
+
+
+  void GNSS_AmbiguityResolver::Reset()
+  {
+    m_n = 0;
+    m_first = 0;
+    m_nrFixed = 0;
+    m_ids.clear();
+    m_Z.clear();
+    m_Zinv.clear();
+  }
+
+
+  bool GNSS_AmbiguityResolver::GetFixedSubsetTransformation( Matrix& Zs )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+
+    if( m_nrFixed == 0 )
+    {
+      GNSS_ERROR_MSG( "if( m_nrFixed == 0 )" );
+      return false;
+    }
+    if( !Zs.Resize( m_n, m_nrFixed ) )
+    {
+      GNSS_ERROR_MSG( "if( !Zs.Resize( m_n, m_nrFixed ) )" );
+      return false;
+    }
+    for( i = 0; i < m_n; i++ )
+    {
+      for( j = 0; j < m_nrFixed; j++ )
+        Zs[i][j] = m_Z[i*m_n+m_first+j];
+    }
+    return true;
+  }
+
+
+  bool GNSS_AmbiguityResolver::FactorLtDL( const std::vector<double>& Q )
+  {
+    const unsigned n = m_n;
+    std::vector<double> q( Q );
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    double s = 0;
+
+    m_L.assign( n*n, 0.0 );
+    m_D.assign( n, 0.0 );
+
+    for( i = (int)n-1; i >= 0; i-- )
+    {
+      m_D[i] = q[i*n+i];
+      if( m_D[i] <= 0.0 )
+        return false;
+      s = sqrt( m_D[i] );
+      for( j = 0; j <= i; j++ )
+        m_L[i*n+j] = q[i*n+j] / s;
+      for( j = 0; j < i; j++ )
+      {
+        for( k = 0; k <= j; k++ )
+          q[j*n+k] -= m_L[i*n+k] * m_L[i*n+j];
+      }
+      for( j = 0; j <= i; j++ )
+        m_L[i*n+j] /= m_L[i*n+i];
+    }
+    return true;
+  }
+
+
+  void GNSS_AmbiguityResolver::Decorrelate()
+  {
+    const int n = (int)m_n;
+    int i = 0;
+    int i1 = n-2;
+    int j = 0;
+    int k = 0;
+    bool sw = true;
+    double mu = 0;
+    double delta = 0;
+    double lambda = 0;
+    double eta = 0;
+    double a0 = 0;
+    double a1 = 0;
+    double tmp = 0;
+
+    while( sw )
+    {
+      i = n-1;
+      sw = false;
+      while( !sw && i > 0 )
+      {
+        i--;
+        if( i <= i1 )
+        {
+          // Integer Gauss transformations of column i.
+          for( j = i+1; j < n; j++ )
+          {
+            mu = AmbiguityResolver_Round( m_L[j*n+i] );
+            if( mu != 0.0 )
+            {
+              for( k = j; k < n; k++ )
+                m_L[k*n+i] -= mu * m_L[k*n+j];
+              for( k = 0; k < n; k++ )
+              {
+                m_Z[k*n+i] -= mu * m_Z[k*n+j];
+                m_Zinv[j*n+k] += mu * m_Zinv[i*n+k];
+              }
+              m_nrIntegerTransformations++;
+            }
+          }
+        }
+
+        // Permute i and i+1 if it reduces D[i+1].
+        delta = m_D[i] + m_L[(i+1)*n+i] * m_L[(i+1)*n+i] * m_D[i+1];
+        if( delta < m_D[i+1] )
+        {
+          lambda = m_D[i+1] * m_L[(i+1)*n+i] / delta;
+          eta = m_D[i] / delta;
+          m_D[i] = eta * m_D[i+1];
+          m_D[i+1] = delta;
+          for( k = 0; k < i; k++ )
+          {
+            a0 = m_L[i*n+k];
+            a1 = m_L[(i+1)*n+k];
+            m_L[i*n+k]     = -m_L[(i+1)*n+i] * a0 + a1;
+            m_L[(i+1)*n+k] = eta * a0 + lambda * a1;
+          }
+          m_L[(i+1)*n+i] = lambda;
+          for( k = i+2; k < n; k++ )
+          {
+            tmp = m_L[k*n+i];
+            m_L[k*n+i] = m_L[k*n+i+1];
+            m_L[k*n+i+1] = tmp;
+          }
+          for( k = 0; k < n; k++ )
+          {
+            tmp = m_Z[k*n+i];
+            m_Z[k*n+i] = m_Z[k*n+i+1];
+            m_Z[k*n+i+1] = tmp;
+
+            tmp = m_Zinv[i*n+k];
+            m_Zinv[i*n+k] = m_Zinv[(i+1)*n+k];
+            m_Zinv[(i+1)*n+k] = tmp;
+          }
+          m_nrIntegerTransformations++;
+          i1 = i;
+          sw = true;
+        }
+      }
+    }
+  }
+
+
+  bool GNSS_AmbiguityResolver::Search( 
+    const std::vector<double>& z,
+    const unsigned first,
+    const unsigned nrCandidates,
+    const unsigned maxNodes,
+    unsigned& nrNodes,
+    std::vector<double>& zfixed,
+    std::vector<double>& norms
+    )
+  {
+    const int n = (int)m_n;
+    const int f = (int)first;
+    const int nc = (int)nrCandidates;
+    std::vector<double> dist( n, 0.0 );
+    std::vector<double> acond( n, 0.0 );
+    std::vector<double> zcond( n, 0.0 );
+    std::vector<double> step( n, 0.0 );
+    std::vector<double> S( n*n, 0.0 );
+    std::vector<double> tmp;
+    double Chi2 = 1.0e18;
+    double newdist = 0;
+    double left = 0;
+    bool endsearch = false;
+    int count = 0;
+    int imax = nc-1;
+    int i = 0;
+    int j = 0;
+    int k = n-1;
+
+    nrNodes = 0;
+    zfixed.assign( n*nc, 0.0 );
+    norms.assign( nc, 0.0 );
+
+    acond[k] = z[k];
+    zcond[k] = AmbiguityResolver_Round( acond[k] );
+    left = acond[k] - zcond[k];
+    step[k] = AmbiguityResolver_Sign( left );
+
+    while( !endsearch )
+    {
+      if( maxNodes != 0 && nrNodes >= maxNodes )
+        return false;
+      nrNodes++;
+
+      newdist = dist[k] + left*left / m_D[k];
+      if( newdist < Chi2 )
+      {
+        if( k != f )
+        {
+          // Move down a level.
+          k--;
+          dist[k] = newdist;
+          for( j = f; j <= k; j++ )
+            S[k*n+j] = S[(k+1)*n+j] + (zcond[k+1] - acond[k+1]) * m_L[(k+1)*n+j];
+          acond[k] = z[k] + S[k*n+k];
+          zcond[k] = AmbiguityResolver_Round( acond[k] );
+          left = acond[k] - zcond[k];
+          step[k] = AmbiguityResolver_Sign( left );
+        }
+        else
+        {
+          // A candidate was found. Once nc candidates are known, the 
+          // worst is replaced and the search ellipsoid shrinks.
+          if( count < nc-1 )
+          {
+            for( i = f; i < n; i++ )
+              zfixed[i*nc+count] = zcond[i];
+            norms[count] = newdist;
+            count++;
+          }
+          else
+          {
+            for( i = f; i < n; i++ )
+              zfixed[i*nc+imax] = zcond[i];
+            norms[imax] = newdist;
+            imax = 0;
+            for( i = 1; i < nc; i++ )
+            {
+              if( norms[i] > norms[imax] )
+                imax = i;
+            }
+            Chi2 = norms[imax];
+          }
+          zcond[f] += step[f];
+          left = acond[f] - zcond[f];
+          step[f] = -step[f] - AmbiguityResolver_Sign( step[f] );
+        }
+      }
+      else
+      {
+        // Move up a level.
+        if( k == n-1 )
+        {
+          endsearch = true;
+        }
+        else
+        {
+          k++;
+          zcond[k] += step[k];
+          left = acond[k] - zcond[k];
+          step[k] = -step[k] - AmbiguityResolver_Sign( step[k] );
+        }
+      }
+    }
+
+    // Order the candidates by their squared norms (nc is small).
+    for( i = 1; i < nc; i++ )
+    {
+      for( j = i; j > 0 && norms[j] < norms[j-1]; j-- )
+      {
+        newdist = norms[j];
+        norms[j] = norms[j-1];
+        norms[j-1] = newdist;
+        for( k = f; k < n; k++ )
+        {
+          left = zfixed[k*nc+j];
+          zfixed[k*nc+j] = zfixed[k*nc+j-1];
+          zfixed[k*nc+j-1] = left;
+        }
+      }
+    }
+    return true;
+  }
+
+
+  bool GNSS_AmbiguityResolver::Resolve( 
+    const std::vector<unsigned>& ids,
+    const unsigned baseId,
+    Matrix& a,
+    Matrix& Q,
+    const unsigned nrCandidates,
+    Matrix& afixed,
+    Matrix& sqnorm,
+    bool& isPositiveDefinite
+    )
+  {
+    const unsigned n = static_cast<unsigned>(ids.size());
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    unsigned first = 0;
+    unsigned minNrFixed = 0;
+    unsigned maxNodes = 0;
+    unsigned nrNodes = 0;
+    bool isWarmStart = false;
+    bool isPartial = false;
+    bool isLastSubset = false;
+    bool isComplete = false;
+    std::vector<unsigned> newIndex; // The index in the new set of each kept ambiguity.
+    std::vector<double> Z;
+    std::vector<double> Zinv;
+    std::vector<double> ZtQ;
+    std::vector<double> Qz;
+    std::vector<double> z;
+    std::vector<double> zfixed;
+    std::vector<double> norms;
+    std::vector<double> acond;
+    std::vector<double> zcond;
+    double sum = 0;
+
+    isPositiveDefinite = true;
+    if( n == 0 || nrCandidates == 0 )
+    {
+      GNSS_ERROR_MSG( "if( n == 0 || nrCandidates == 0 )" );
+      return false;
+    }
+    if( a.GetNrRows() != n || Q.GetNrRows() != n || Q.GetNrCols() != n )
+    {
+      GNSS_ERROR_MSG( "if( a.GetNrRows() != n || Q.GetNrRows() != n || Q.GetNrCols() != n )" );
+      return false;
+    }
+
+    m_nrEpochs++;
+
+    // Keep the Z transformation if the previous ambiguities are all 
+    // still present with the same base satellite.
+    if( m_n > 0 && baseId == m_baseId && n >= m_n )
+    {
+      isWarmStart = true;
+      newIndex.resize( m_n );
+      for( i = 0; i < m_n && isWarmStart; i++ )
+      {
+        for( j = 0; j < n; j++ )
+        {
+          if( ids[j] == m_ids[i] )
+            break;
+        }
+        if( j == n )
+          isWarmStart = false;
+        else
+          newIndex[i] = j;
+      }
+      for( i = 0; i < m_n*m_n && isWarmStart; i++ )
+      {
+        if( fabs( m_Z[i] ) > GNSS_AMBIGUITYRESOLVER_MAX_Z || fabs( m_Zinv[i] ) > GNSS_AMBIGUITYRESOLVER_MAX_Z )
+          isWarmStart = false;
+      }
+    }
+
+    Z.assign( n*n, 0.0 );
+    Zinv.assign( n*n, 0.0 );
+    for( i = 0; i < n; i++ )
+    {
+      Z[i*n+i] = 1.0;
+      Zinv[i*n+i] = 1.0;
+    }
+    if( isWarmStart )
+    {
+      // New ambiguities get identity rows and columns.
+      for( i = 0; i < m_n; i++ )
+      {
+        for( j = 0; j < m_n; j++ )
+        {
+          Z[newIndex[i]*n+newIndex[j]] = m_Z[i*m_n+j];
+          Zinv[newIndex[i]*n+newIndex[j]] = m_Zinv[i*m_n+j];
+        }
+      }
+    }
+    else
+    {
+      m_nrColdStarts++;
+    }
+    m_n = n;
+    m_ids = ids;
+    m_baseId = baseId;
+    m_Z.swap( Z );
+    m_Zinv.swap( Zinv );
+
+    // Qz = Z^T * Q * Z
+    ZtQ.assign( n*n, 0.0 );
+    for( i = 0; i < n; i++ )
+    {
+      for( j = 0; j < n; j++ )
+      {
+        sum = 0;
+        for( k = 0; k < n; k++ )
+        {
+          if( m_Z[k*n+i] != 0.0 )
+            sum += m_Z[k*n+i] * Q[k][j];
+        }
+        ZtQ[i*n+j] = sum;
+      }
+    }
+    Qz.assign( n*n, 0.0 );
+    for( i = 0; i < n; i++ )
+    {
+      for( j = 0; j <= i; j++ )
+      {
+        sum = 0;
+        for( k = 0; k < n; k++ )
+        {
+          if( m_Z[k*n+j] != 0.0 )
+            sum += ZtQ[i*n+k] * m_Z[k*n+j];
+        }
+        Qz[i*n+j] = sum;
+        Qz[j*n+i] = sum;
+      }
+    }
+
+    if( !FactorLtDL( Qz ) )
+    {
+      // No search is possible (e.g. the filter covariance has degraded), 
+      // the candidates are the float ambiguities. The caller decides what to do.
+      Reset();
+      isPositiveDefinite = false;
+      m_nrSearchNodes = 0;
+      if( !afixed.Resize( n, nrCandidates ) )
+      {
+        GNSS_ERROR_MSG( "if( !afixed.Resize( n, nrCandidates ) )" );
+        return false;
+      }
+      if( !sqnorm.Resize( nrCandidates, 1 ) )
+      {
+        GNSS_ERROR_MSG( "if( !sqnorm.Resize( nrCandidates, 1 ) )" );
+        return false;
+      }
+      for( j = 0; j < nrCandidates; j++ )
+      {
+        for( i = 0; i < n; i++ )
+          afixed[i][j] = a[i];
+        sqnorm[j] = 0.0;
+      }
+      return true;
+    }
+
+    Decorrelate();
+
+    // z = Z^T * a
+    z.assign( n, 0.0 );
+    for( i = 0; i < n; i++ )
+    {
+      sum = 0;
+      for( k = 0; k < n; k++ )
+        sum += m_Z[k*n+i] * a[k];
+      z[i] = sum;
+    }
+
+    // Search the full set first. With partial ambiguity resolution, the 
+    // least precise decorrelated ambiguity (the first) is dropped until 
+    // a subset passes the ratio test. The marginal covariance of a 
+    // trailing subset is factored by the trailing blocks of L and D.
+    isPartial = m_PartialRatioThreshold > 0.0 && nrCandidates > 1;
+    minNrFixed = m_MinNrPartialAmbiguities > 0 ? m_MinNrPartialAmbiguities : 1;
+    m_nrFixed = 0;
+    m_nrSearchNodes = 0;
+    m_first = n;
+    for( first = 0; first < n; first++ )
+    {
+      isLastSubset = !isPartial || n - first <= minNrFixed;
+      maxNodes = 0;
+      if( m_MaxSearchNodes != 0 )
+      {
+        if( m_nrSearchNodes >= m_MaxSearchNodes )
+          break;
+        maxNodes = m_MaxSearchNodes - m_nrSearchNodes;
+        if( !isLastSubset && maxNodes > 1 )
+          maxNodes /= 2; // leave nodes for the smaller subsets
+      }
+
+      isComplete = Search( z, first, nrCandidates, maxNodes, nrNodes, zfixed, norms );
+      m_nrSearchNodes += nrNodes;
+
+      if( isComplete && ( !isPartial || norms[1] >= m_PartialRatioThreshold*norms[0] ) )
+      {
+        m_nrFixed = n - first;
+        m_first = first;
+        break;
+      }
+      if( isLastSubset )
+        break;
+    }
+    if( m_nrSearchNodes > m_maxNrSearchNodes )
+      m_maxNrSearchNodes = m_nrSearchNodes;
+
+    // afixed = Z^-T * zcond, where zcond is the fixed subset and the 
+    // remaining ambiguities conditioned on it.
+    if( !afixed.Resize( n, nrCandidates ) )
+    {
+      GNSS_ERROR_MSG( "if( !afixed.Resize( n, nrCandidates ) )" );
+      return false;
+    }
+    if( !sqnorm.Resize( nrCandidates, 1 ) )
+    {
+      GNSS_ERROR_MSG( "if( !sqnorm.Resize( nrCandidates, 1 ) )" );
+      return false;
+    }
+    acond.assign( n, 0.0 );
+    zcond.assign( n, 0.0 );
+    for( j = 0; j < nrCandidates; j++ )
+    {
+      for( i = n; i-- > 0; )
+      {
+        sum = z[i];
+        for( k = i+1; k < n; k++ )
+          sum += ( zcond[k] - acond[k] ) * m_L[k*n+i];
+        acond[i] = sum;
+        zcond[i] = i >= m_first ? zfixed[i*nrCandidates+j] : sum;
+      }
+      for( i = 0; i < n; i++ )
+      {
+        sum = 0;
+        for( k = 0; k < n; k++ )
+          sum += m_Zinv[k*n+i] * zcond[k];
+        afixed[i][j] = sum;
+      }
+      sqnorm[j] = m_nrFixed > 0 ? norms[j] : 0.0;
+    }
+    return true;
+  }
+
+
+  bool GNSS_AmbiguityResolver::ComputeConditionalBaseline(
+    Matrix& Qb,
+    Matrix& Qba,
+    Matrix& Qa,
+    Matrix& delta_a,
+    Matrix& delta_b,
+    Matrix& Qb_given_a
+    )
+  {
+    const unsigned n = Qa.GetNrRows();
+    const unsigned m = Qb.GetNrRows();
+    std::vector<double> C( n*n, 0.0 ); // The lower triangular Cholesky factor of Qa.
+    std::vector<double> W( n*m, 0.0 ); // W = inv(C) * Qba^T, row major [n x m].
+    std::vector<double> v( n, 0.0 );   // v = inv(C) * delta_a.
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    double sum = 0;
+
+    if( n == 0 || Qa.GetNrCols() != n || Qb.GetNrCols() != m 
+      || Qba.GetNrRows() != m || Qba.GetNrCols() != n || delta_a.GetNrRows() != n )
+    {
+      GNSS_ERROR_MSG( "Inconsistent matrix dimensions." );
+      return false;
+    }
+
+    // Qa = C * C^T
+    for( j = 0; j < n; j++ )
+    {
+      sum = Qa[j][j];
+      for( k = 0; k < j; k++ )
+        sum -= C[j*n+k] * C[j*n+k];
+      if( sum <= 0.0 )
+      {
+        GNSS_ERROR_MSG( "The ambiguity variance-covariance matrix is not positive definite." );
+        return false;
+      }
+      C[j*n+j] = sqrt( sum );
+      for( i = j+1; i < n; i++ )
+      {
+        sum = Qa[i][j];
+        for( k = 0; k < j; k++ )
+          sum -= C[i*n+k] * C[j*n+k];
+        C[i*n+j] = sum / C[j*n+j];
+      }
+    }
+
+    // Forward substitution for W and v.
+    for( i = 0; i < n; i++ )
+    {
+      for( j = 0; j < m; j++ )
+      {
+        sum = Qba[j][i];
+        for( k = 0; k < i; k++ )
+          sum -= C[i*n+k] * W[k*m+j];
+        W[i*m+j] = sum / C[i*n+i];
+      }
+      sum = delta_a[i];
+      for( k = 0; k < i; k++ )
+        sum -= C[i*n+k] * v[k];
+      v[i] = sum / C[i*n+i];
+    }
+
+    // delta_b = W^T * v, Qb_given_a = Qb - W^T * W
+    if( !delta_b.Resize( m, 1 ) )
+    {
+      GNSS_ERROR_MSG( "if( !delta_b.Resize( m, 1 ) )" );
+      return false;
+    }
+    if( !Qb_given_a.Resize( m, m ) )
+    {
+      GNSS_ERROR_MSG( "if( !Qb_given_a.Resize( m, m ) )" );
+      return false;
+    }
+    for( i = 0; i < m; i++ )
+    {
+      sum = 0;
+      for( k = 0; k < n; k++ )
+        sum += W[k*m+i] * v[k];
+      delta_b[i] = sum;
+
+      for( j = 0; j <= i; j++ )
+      {
+        sum = Qb[i][j];
+        for( k = 0; k < n; k++ )
+          sum -= W[k*m+i] * W[k*m+j];
+        Qb_given_a[i][j] = sum;
+        Qb_given_a[j][i] = sum;
+      }
+    }
+    return true;
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,192 @@
+/**
+\file    GNSS_AmbiguityResolver.h
+\brief   Integer least squares ambiguity resolution (LAMBDA method) with
+         the decorrelating transformation kept between epochs.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b REFERENCES \n
+- de Jonge, P. J. and C. C. J. M. Tiberius (1996). The LAMBDA method for 
+  integer ambiguity estimation: implementation aspects. Delft Geodetic 
+  Computing Centre LGR series, No. 12. \n
+- Chang, X.-W., X. Yang and T. Zhou (2005). MLAMBDA: a modified LAMBDA 
+  method for integer least-squares estimation. Journal of Geodesy 79. \n
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_AMBIGUITYRESOLVER_H_
+#define _GNSS_AMBIGUITYRESOLVER_H_
+
+#include <vector>
+#include "Matrix.h"
+
+using namespace Zenautics; // for Matrix
+
+namespace GNSS
+{
+  /**
+  \brief   Integer least squares ambiguity resolution.
+
+  The float ambiguities are decorrelated with an integer (unimodular) 
+  Z transformation and the integer candidates are found with a 
+  search-and-shrink of the LtDL factored, transformed covariance.
+
+  The Z transformation depends only slowly on the covariance, so it is 
+  kept between epochs for the same set of ambiguities. Each epoch the 
+  covariance is transformed with the kept Z and the decorrelation is 
+  continued from there, which usually needs few or no further integer 
+  transformations. Satellites added to the set extend Z with identity 
+  rows and columns. Any other change to the set (a satellite removed or 
+  a new base satellite) starts from the identity.
+
+  Partial ambiguity resolution is enabled with m_PartialRatioThreshold. 
+  The search starts with all of the decorrelated ambiguities. If the 
+  ratio test fails, the least precise decorrelated ambiguity is dropped 
+  and the search is repeated on the remaining subset, down to 
+  m_MinNrPartialAmbiguities. The unfixed ambiguities are conditioned on 
+  the fixed subset.
+
+  m_MaxSearchNodes bounds the number of search tree nodes visited per 
+  epoch over all of the subsets. A search that runs out of nodes is 
+  discarded, and when smaller subsets remain it is limited to half of 
+  the remaining nodes so they can still be tried.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_AmbiguityResolver
+  {
+  public:
+
+    /// \brief    The default constructor (no ambiguity set).
+    GNSS_AmbiguityResolver();
+
+    /// \brief    The destructor.
+    virtual ~GNSS_AmbiguityResolver();
+
+  public:
+
+    /// \brief    Find the best integer candidates for the float ambiguities.
+    ///           If m_nrFixed is less than n, the candidates are the float 
+    ///           ambiguities conditioned on the fixed subset. If m_nrFixed
+    ///           is zero, the candidates are the float ambiguities and the 
+    ///           squared norms are zero. This is also the result when Q is 
+    ///           not positive definite, which is not an error.
+    /// \return   true if successful, false if error.
+    bool Resolve( 
+      const std::vector<unsigned>& ids, //!< An identifier for each ambiguity (e.g. the PRN of the non-base satellite) [n].
+      const unsigned baseId,            //!< An identifier for the base satellite of the double differences.
+      Matrix& a,                        //!< The float ambiguities [cycles], [n x 1].
+      Matrix& Q,                        //!< The float ambiguity variance-covariance matrix [cycles^2], [n x n].
+      const unsigned nrCandidates,      //!< The number of integer candidates to find (>= 1).
+      Matrix& afixed,                   //!< The integer candidates, best first [n x nrCandidates].
+      Matrix& sqnorm,                   //!< The squared norms of the candidates, best first [nrCandidates x 1].
+      bool& isPositiveDefinite          //!< This indicates if Q is positive definite, otherwise no search was possible.
+      );
+
+    /// \brief    Discard the kept Z transformation.
+    void Reset();
+
+    /// \brief    Get the integer transformation of the fixed subset from 
+    ///           the last call to Resolve, zs = Zs^T a.
+    /// \return   true if successful, false if error.
+    bool GetFixedSubsetTransformation( 
+      Matrix& Zs  //!< The integer transformation [n x m_nrFixed].
+      );
+
+    /// \brief    Compute the baseline conditioned on the fixed ambiguities
+    ///           with a single Cholesky factorization of Qa. \n
+    ///           delta_b    = Qba * inv(Qa) * delta_a \n
+    ///           Qb_given_a = Qb - Qba * inv(Qa) * Qba^T
+    /// \return   true if successful, false if error.
+    static bool ComputeConditionalBaseline(
+      Matrix& Qb,         //!< The float baseline variance-covariance [m x m].
+      Matrix& Qba,        //!< The float baseline-ambiguity covariance [m x n].
+      Matrix& Qa,         //!< The float ambiguity variance-covariance [n x n].
+      Matrix& delta_a,    //!< The fixed minus float ambiguities [n x 1].
+      Matrix& delta_b,    //!< The change to the baseline [m x 1].
+      Matrix& Qb_given_a  //!< The conditional baseline variance-covariance [m x m].
+      );
+
+  public:
+
+    unsigned m_MaxSearchNodes;           //!< The maximum number of search nodes per epoch, 0 for no limit.
+    double m_PartialRatioThreshold;      //!< The ratio of the second best to best squared norm needed to accept a subset, 0 to fix the full set only.
+    unsigned m_MinNrPartialAmbiguities;  //!< The smallest subset that is tried with partial ambiguity resolution.
+
+  public:
+
+    unsigned m_nrFixed;                  //!< The number of ambiguities fixed at the last call to Resolve.
+    unsigned m_nrSearchNodes;            //!< The number of search nodes visited at the last call to Resolve.
+    unsigned m_maxNrSearchNodes;         //!< The largest number of search nodes visited at one call to Resolve.
+    unsigned m_nrEpochs;                 //!< The number of calls to Resolve.
+    unsigned m_nrColdStarts;             //!< The number of times the decorrelation started from the identity.
+    unsigned m_nrIntegerTransformations; //!< The total number of integer Gauss transformations and permutations performed.
+
+  protected:
+
+    /// \brief    Factor Q = L^T * D * L, L unit lower triangular.
+    /// \return   true if successful, false if Q is not positive definite.
+    bool FactorLtDL( const std::vector<double>& Q );
+
+    /// \brief    Continue the decorrelation of the factored covariance,
+    ///           updating m_Z and m_Zinv.
+    void Decorrelate();
+
+    /// \brief    Search-and-shrink for the best nrCandidates integer vectors
+    ///           of the decorrelated ambiguities first to n-1.
+    /// \return   true if the search completed, false if it ran out of nodes.
+    bool Search( 
+      const std::vector<double>& z,     //!< The transformed float ambiguities.
+      const unsigned first,             //!< The index of the first (least precise) ambiguity in the subset.
+      const unsigned nrCandidates,      //!< The number of candidates.
+      const unsigned maxNodes,          //!< The maximum number of nodes to visit, 0 for no limit.
+      unsigned& nrNodes,                //!< The number of nodes visited.
+      std::vector<double>& zfixed,      //!< The candidates, row major [n*nrCandidates]. Rows less than first are not set.
+      std::vector<double>& norms        //!< The squared norms [nrCandidates].
+      );
+
+  protected:
+
+    unsigned m_n;                   //!< The number of ambiguities.
+    unsigned m_first;               //!< The index of the first fixed decorrelated ambiguity at the last call to Resolve.
+    std::vector<unsigned> m_ids;    //!< The identifiers of the ambiguities for the kept Z.
+    unsigned m_baseId;              //!< The identifier of the base satellite for the kept Z.
+    std::vector<double> m_Z;        //!< The integer transformation, z = Z^T a, row major [n*n].
+    std::vector<double> m_Zinv;     //!< The inverse of Z, row major [n*n].
+    std::vector<double> m_L;        //!< The unit lower triangular factor, row major [n*n].
+    std::vector<double> m_D;        //!< The diagonal factor [n].
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_AMBIGUITYRESOLVER_H_
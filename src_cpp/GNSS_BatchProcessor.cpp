@@ -0,0 +1,781 @@
+/**
+\file    GNSS_BatchProcessor.cpp
+\brief   Batch reprocessing of many data sets with a pool of worker processes.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <limits.h>
+#endif
+#include "gnss_error.h"
+#include "GNSS_BatchProcessor.h"
+#include "GNSS_ThreadPool.h"
+#include "GNSS_OptionFile.h"
+#include "StdStringUtils.h"
+
+#ifndef WIN32
+#ifndef PATH_MAX
+#define PATH_MAX (4096)
+#endif
+#endif
+
+/// The name of the console output file written in each job's folder.
+#define GNSS_BATCH_LOG_FILENAME "batch_log.txt"
+
+namespace GNSS
+{
+  /// \brief   The platform process information of a running job.
+  struct stBatchProcess
+  {
+#ifdef WIN32
+    HANDLE process; //!< The process handle.
+    HANDLE job;     //!< The job object enforcing the memory limit.
+#else
+    pid_t pid;      //!< The process id.
+#endif
+  };
+
+  /// \brief   Used to sort the jobs by decreasing input size.
+  struct stJobOrder
+  {
+    const std::vector<GNSS_BatchProcessor::stJob>* jobs;
+    bool operator()( const unsigned a, const unsigned b ) const
+    {
+      return (*jobs)[a].inputSize > (*jobs)[b].inputSize;
+    }
+  };
+
+  /// \brief   Is the path absolute.
+  static bool BatchProcessor_IsAbsolutePath( const std::string& path )
+  {
+    if( path.length() == 0 )
+      return false;
+    if( path[0] == '/' || path[0] == '\\' )
+      return true;
+    if( path.length() > 1 && path[1] == ':' )
+      return true;
+    return false;
+  }
+
+  /// \brief   The size of a file [bytes], 0 if it does not exist.
+  static double BatchProcessor_GetFileSize( const std::string& path )
+  {
+    FILE* fid = NULL;
+    long size = 0;
+    fid = fopen( path.c_str(), "rb" );
+    if( fid == NULL )
+      return 0;
+    if( fseek( fid, 0, SEEK_END ) == 0 )
+    {
+      size = ftell( fid );
+      if( size < 0 )
+        size = 0;
+    }
+    fclose( fid );
+    return static_cast<double>(size);
+  }
+
+  
+  GNSS_BatchProcessor::GNSS_BatchProcessor()
+    : m_TotalWallTime(0), m_nrWorkers(0)
+  {}
+
+  GNSS_BatchProcessor::~GNSS_BatchProcessor()
+  {}
+
+
+  bool GNSS_BatchProcessor::ReadManifest( const char* path, const unsigned defaultMemoryLimitMB )
+  {
+    FILE* fid = NULL;
+    char line[4096];
+    char msg[512];
+    std::string str;
+    std::string field;
+    std::string ManifestDirectory;
+    std::string::size_type p;
+    unsigned lineNumber = 0;
+    int limit = 0;
+    stJob job;
+
+    if( path == NULL )
+    {
+      GNSS_ERROR_MSG( "if( path == NULL )" );
+      return false;
+    }
+
+    fid = fopen( path, "r" );
+    if( fid == NULL )
+    {
+      sprintf( msg, "Unable to open the batch manifest: %.256s", path );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+
+    StdStringUtils::GetDirectoryOfThisStringPath( path, ManifestDirectory );
+
+    m_Jobs.clear();
+    while( fgets( line, 4096, fid ) != NULL )
+    {
+      lineNumber++;
+      str = line;
+
+      // Remove comments.
+      p = str.find_first_of( ";#" );
+      if( p != std::string::npos )
+        str.erase( p );
+      StdStringUtils::TrimLeftAndRight( str );
+      if( str.length() == 0 )
+        continue;
+
+      job = stJob();
+      job.memoryLimitMB = defaultMemoryLimitMB;
+
+      // An optional memory limit follows the option file path.
+      p = str.find( ',' );
+      if( p != std::string::npos )
+      {
+        field = str.substr( p+1 );
+        str.erase( p );
+        StdStringUtils::TrimLeftAndRight( field );
+        StdStringUtils::TrimLeftAndRight( str );
+        limit = atoi( field.c_str() );
+        if( field.length() == 0 || limit < 0 )
+        {
+          fclose( fid );
+          sprintf( msg, "Invalid memory limit on line %d of the batch manifest.", lineNumber );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+        job.memoryLimitMB = static_cast<unsigned>(limit);
+      }
+
+      if( BatchProcessor_IsAbsolutePath( str ) )
+        job.OptionFilePath = str;
+      else
+        job.OptionFilePath = ManifestDirectory + str;
+
+      StdStringUtils::GetDirectoryOfThisStringPath( job.OptionFilePath, job.Directory );
+      StdStringUtils::GetFileNameFromThisStringPath( job.OptionFilePath, job.OptionFileName );
+
+      if( BatchProcessor_GetFileSize( job.OptionFilePath ) <= 0 )
+      {
+        fclose( fid );
+        sprintf( msg, "Invalid option file on line %d of the batch manifest: %.256s", lineNumber, job.OptionFilePath.c_str() );
+        GNSS_ERROR_MSG( msg );
+        return false;
+      }
+
+      DetermineInputSize( job );
+      m_Jobs.push_back( job );
+    }
+    fclose( fid );
+
+    DetermineOutputPrefixes();
+
+    if( m_Jobs.size() == 0 )
+    {
+      GNSS_ERROR_MSG( "The batch manifest does not list any option files." );
+      return false;
+    }
+    return true;
+  }
+
+
+  void GNSS_BatchProcessor::DetermineInputSize( stJob& job )
+  {
+    OptionFile opt;
+    std::string DataPath;
+    char key[64];
+    unsigned k = 0;
+
+    job.inputSize = 0;
+    if( !opt.ReadOptionFile( job.OptionFilePath ) )
+      return; // The job will report the error when it is run.
+
+    // The receiver data paths are relative to the job's folder.
+    if( opt.GetValue( "Reference_DataPath", DataPath ) && DataPath.length() != 0 )
+      job.inputSize += BatchProcessor_GetFileSize( BatchProcessor_IsAbsolutePath( DataPath ) ? DataPath : job.Directory + DataPath );
+    if( opt.GetValue( "Rover_DataPath", DataPath ) && DataPath.length() != 0 )
+      job.inputSize += BatchProcessor_GetFileSize( BatchProcessor_IsAbsolutePath( DataPath ) ? DataPath : job.Directory + DataPath );
+    for( k = 2; k <= GNSS_OPTIONFILE_MAX_ROVERS; k++ )
+    {
+      sprintf( key, "Rover%d_DataPath", k );
+      if( opt.GetValue( key, DataPath ) && DataPath.length() != 0 )
+        job.inputSize += BatchProcessor_GetFileSize( BatchProcessor_IsAbsolutePath( DataPath ) ? DataPath : job.Directory + DataPath );
+    }
+  }
+
+
+  double GNSS_BatchProcessor::GetTime()
+  {
+#ifdef WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER count;
+    QueryPerformanceFrequency( &frequency );
+    QueryPerformanceCounter( &count );
+    return static_cast<double>(count.QuadPart) / static_cast<double>(frequency.QuadPart);
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec + tv.tv_usec*1.0e-6;
+#endif
+  }
+
+
+  bool GNSS_BatchProcessor::GetExecutablePath( const char* argv0, std::string& path )
+  {
+#ifdef WIN32
+    char buffer[MAX_PATH];
+    DWORD n = GetModuleFileNameA( NULL, buffer, MAX_PATH );
+    if( n > 0 && n < MAX_PATH )
+    {
+      path = buffer;
+      return true;
+    }
+#else
+    char buffer[PATH_MAX];
+    ssize_t n = readlink( "/proc/self/exe", buffer, PATH_MAX-1 );
+    if( n > 0 )
+    {
+      buffer[n] = '\0';
+      path = buffer;
+      return true;
+    }
+    if( argv0 != NULL && realpath( argv0, buffer ) != NULL )
+    {
+      path = buffer;
+      return true;
+    }
+#endif
+    if( argv0 == NULL )
+    {
+      GNSS_ERROR_MSG( "if( argv0 == NULL )" );
+      return false;
+    }
+    path = argv0;
+    return true;
+  }
+
+
+  void GNSS_BatchProcessor::DetermineOutputPrefixes()
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    bool isShared = false;
+    bool isSameName = false;
+    std::string::size_type p;
+    char number[32];
+
+    for( i = 0; i < m_Jobs.size(); i++ )
+    {
+      isShared = false;
+      isSameName = false;
+      for( j = 0; j < m_Jobs.size(); j++ )
+      {
+        if( j != i && m_Jobs[j].Directory == m_Jobs[i].Directory )
+        {
+          isShared = true;
+          if( m_Jobs[j].OptionFileName == m_Jobs[i].OptionFileName )
+            isSameName = true;
+        }
+      }
+
+      m_Jobs[i].OutputPrefix.clear();
+      if( !isShared )
+        continue;
+
+      if( isSameName )
+      {
+        // The same option file is listed more than once.
+        sprintf( number, "job%u_", i+1 );
+        m_Jobs[i].OutputPrefix = number;
+      }
+      else
+      {
+        m_Jobs[i].OutputPrefix = m_Jobs[i].OptionFileName;
+        p = m_Jobs[i].OutputPrefix.find_last_of( '.' );
+        if( p != std::string::npos && p > 0 )
+          m_Jobs[i].OutputPrefix.erase( p );
+        m_Jobs[i].OutputPrefix += "_";
+      }
+    }
+  }
+
+
+  bool GNSS_BatchProcessor::StartJob( const char* executablePath, stJob& job, void*& process )
+  {
+    stBatchProcess* bp = NULL;
+    std::string LogPath = job.Directory + job.OutputPrefix + GNSS_BATCH_LOG_FILENAME;
+
+    process = NULL;
+    bp = new stBatchProcess;
+    if( bp == NULL )
+    {
+      GNSS_ERROR_MSG( "new failed" );
+      return false;
+    }
+
+#ifdef WIN32
+    {
+      SECURITY_ATTRIBUTES sa;
+      STARTUPINFOA si;
+      PROCESS_INFORMATION pi;
+      JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+      HANDLE hLog = INVALID_HANDLE_VALUE;
+      std::string CommandLine;
+      BOOL isCreated = FALSE;
+      BOOL isLimited = FALSE;
+      char msg[512];
+
+      memset( &sa, 0, sizeof(sa) );
+      sa.nLength = sizeof(sa);
+      sa.bInheritHandle = TRUE;
+      hLog = CreateFileA( LogPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, &sa, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+      if( hLog == INVALID_HANDLE_VALUE )
+      {
+        delete bp;
+        GNSS_ERROR_MSG( "if( hLog == INVALID_HANDLE_VALUE )" );
+        return false;
+      }
+
+      memset( &si, 0, sizeof(si) );
+      si.cb = sizeof(si);
+      si.dwFlags = STARTF_USESTDHANDLES;
+      si.hStdInput = GetStdHandle( STD_INPUT_HANDLE );
+      si.hStdOutput = hLog;
+      si.hStdError = hLog;
+      memset( &pi, 0, sizeof(pi) );
+
+      CommandLine = "\"" + std::string(executablePath) + "\" \"" + job.OptionFileName + "\"";
+      if( job.OutputPrefix.length() != 0 )
+        CommandLine += " \"" + job.OutputPrefix + "\"";
+
+      // The process is started suspended so that it is in the job object before it allocates anything.
+      isCreated = CreateProcessA( 
+        executablePath, 
+        const_cast<char*>(CommandLine.c_str()), 
+        NULL, 
+        NULL, 
+        TRUE, 
+        CREATE_SUSPENDED, 
+        NULL, 
+        job.Directory.length() == 0 ? NULL : job.Directory.c_str(), 
+        &si, 
+        &pi );
+      CloseHandle( hLog );
+      if( !isCreated )
+      {
+        delete bp;
+        GNSS_ERROR_MSG( "if( !isCreated )" );
+        return false;
+      }
+
+      bp->process = pi.hProcess;
+      bp->job = CreateJobObject( NULL, NULL );
+      isLimited = FALSE;
+      if( bp->job != NULL )
+      {
+        memset( &limits, 0, sizeof(limits) );
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        if( job.memoryLimitMB > 0 )
+        {
+          limits.BasicLimitInformation.LimitFlags |= JOB_OBJECT_LIMIT_PROCESS_MEMORY;
+          limits.ProcessMemoryLimit = static_cast<SIZE_T>(job.memoryLimitMB) * 1024 * 1024;
+        }
+        isLimited = SetInformationJobObject( bp->job, JobObjectExtendedLimitInformation, &limits, sizeof(limits) ) &&
+          AssignProcessToJobObject( bp->job, pi.hProcess );
+      }
+      if( !isLimited )
+      {
+        if( job.memoryLimitMB > 0 )
+        {
+          // The job is not run without its memory limit.
+          sprintf( msg, "The memory limit of %u MB could not be enforced, the job is not run: %.256s", job.memoryLimitMB, job.OptionFilePath.c_str() );
+          GNSS_ERROR_MSG( msg );
+          TerminateProcess( pi.hProcess, 1 );
+          WaitForSingleObject( pi.hProcess, INFINITE );
+          CloseHandle( pi.hThread );
+          CloseHandle( pi.hProcess );
+          if( bp->job != NULL )
+            CloseHandle( bp->job );
+          delete bp;
+          return true;
+        }
+        sprintf( msg, "Warning: the job object could not be set up, the job is not stopped with the batch: %.256s", job.OptionFilePath.c_str() );
+        GNSS_ERROR_MSG( msg );
+      }
+      ResumeThread( pi.hThread );
+      CloseHandle( pi.hThread );
+    }
+#else
+    {
+      int fd = -1;
+      struct rlimit limit;
+      pid_t pid;
+
+      fd = open( LogPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+      if( fd < 0 )
+      {
+        delete bp;
+        GNSS_ERROR_MSG( "if( fd < 0 )" );
+        return false;
+      }
+      fflush( stdout );
+      fflush( stderr );
+
+      pid = fork();
+      if( pid < 0 )
+      {
+        close( fd );
+        delete bp;
+        GNSS_ERROR_MSG( "if( pid < 0 )" );
+        return false;
+      }
+      if( pid == 0 )
+      {
+        // The child process.
+        if( job.Directory.length() != 0 && chdir( job.Directory.c_str() ) != 0 )
+          _exit( 126 );
+        dup2( fd, 1 );
+        dup2( fd, 2 );
+        close( fd );
+        if( job.memoryLimitMB > 0 )
+        {
+          limit.rlim_cur = static_cast<rlim_t>(job.memoryLimitMB) * 1024 * 1024;
+          limit.rlim_max = limit.rlim_cur;
+          if( setrlimit( RLIMIT_AS, &limit ) != 0 )
+          {
+            // The job is not run without its memory limit.
+            printf( "The memory limit of %u MB could not be enforced, the job is not run.\n", job.memoryLimitMB );
+            fflush( stdout );
+            _exit( 125 );
+          }
+        }
+        if( job.OutputPrefix.length() != 0 )
+          execl( executablePath, executablePath, job.OptionFileName.c_str(), job.OutputPrefix.c_str(), (char*)NULL );
+        else
+          execl( executablePath, executablePath, job.OptionFileName.c_str(), (char*)NULL );
+        _exit( 127 );
+      }
+      close( fd );
+      bp->pid = pid;
+    }
+#endif
+
+    job.wasRun = true;
+    process = bp;
+    return true;
+  }
+
+
+  bool GNSS_BatchProcessor::WaitForJob( 
+    std::vector<void*>& processes,
+    std::vector<unsigned>& jobIndex,
+    std::vector<double>& startTime,
+    unsigned& completedJob )
+  {
+    unsigned i = 0;
+    stBatchProcess* bp = NULL;
+
+    if( processes.size() == 0 )
+    {
+      GNSS_ERROR_MSG( "if( processes.size() == 0 )" );
+      return false;
+    }
+
+#ifdef WIN32
+    {
+      HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+      DWORD result;
+      DWORD exitCode = 0;
+      FILETIME creationTime, exitTime, kernelTime, userTime;
+      JOBOBJECT_EXTENDED_LIMIT_INFORMATION info;
+      ULARGE_INTEGER t;
+
+      for( i = 0; i < processes.size() && i < MAXIMUM_WAIT_OBJECTS; i++ )
+        handles[i] = ((stBatchProcess*)processes[i])->process;
+      result = WaitForMultipleObjects( i, handles, FALSE, INFINITE );
+      if( result < WAIT_OBJECT_0 || result >= WAIT_OBJECT_0 + i )
+      {
+        GNSS_ERROR_MSG( "WaitForMultipleObjects failed." );
+        return false;
+      }
+      i = result - WAIT_OBJECT_0;
+      bp = (stBatchProcess*)processes[i];
+      completedJob = jobIndex[i];
+      stJob& job = m_Jobs[completedJob];
+      job.wallTime = GetTime() - startTime[i];
+
+      if( GetExitCodeProcess( bp->process, &exitCode ) )
+        job.exitCode = static_cast<int>(exitCode);
+      if( GetProcessTimes( bp->process, &creationTime, &exitTime, &kernelTime, &userTime ) )
+      {
+        t.LowPart = userTime.dwLowDateTime;
+        t.HighPart = userTime.dwHighDateTime;
+        job.userTime = static_cast<double>(t.QuadPart) * 1.0e-7;
+        t.LowPart = kernelTime.dwLowDateTime;
+        t.HighPart = kernelTime.dwHighDateTime;
+        job.systemTime = static_cast<double>(t.QuadPart) * 1.0e-7;
+      }
+      if( bp->job != NULL )
+      {
+        if( QueryInformationJobObject( bp->job, JobObjectExtendedLimitInformation, &info, sizeof(info), NULL ) )
+          job.peakMemoryMB = static_cast<double>(info.PeakProcessMemoryUsed) / (1024.0*1024.0);
+        CloseHandle( bp->job );
+      }
+      CloseHandle( bp->process );
+    }
+#else
+    {
+      int status = 0;
+      struct rusage usage;
+      pid_t pid;
+
+      do
+      {
+        pid = wait4( -1, &status, 0, &usage );
+      } while( pid < 0 && errno == EINTR );
+      if( pid < 0 )
+      {
+        GNSS_ERROR_MSG( "if( pid < 0 )" );
+        return false;
+      }
+      for( i = 0; i < processes.size(); i++ )
+      {
+        if( ((stBatchProcess*)processes[i])->pid == pid )
+          break;
+      }
+      if( i == processes.size() )
+      {
+        GNSS_ERROR_MSG( "Unexpected child process." );
+        return false;
+      }
+      bp = (stBatchProcess*)processes[i];
+      completedJob = jobIndex[i];
+      stJob& job = m_Jobs[completedJob];
+      job.wallTime = GetTime() - startTime[i];
+
+      if( WIFEXITED( status ) )
+      {
+        job.exitCode = WEXITSTATUS( status );
+      }
+      else if( WIFSIGNALED( status ) )
+      {
+        job.exitCode = -1;
+        job.signal = WTERMSIG( status );
+      }
+      job.userTime = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec*1.0e-6;
+      job.systemTime = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec*1.0e-6;
+      job.peakMemoryMB = usage.ru_maxrss / 1024.0; // ru_maxrss is in kilobytes
+    }
+#endif
+
+    delete bp;
+    processes.erase( processes.begin() + i );
+    jobIndex.erase( jobIndex.begin() + i );
+    startTime.erase( startTime.begin() + i );
+    return true;
+  }
+
+
+  bool GNSS_BatchProcessor::Run( const char* executablePath, const unsigned nrWorkers )
+  {
+    unsigned i = 0;
+    unsigned next = 0;
+    unsigned completedJob = 0;
+    double t0 = 0;
+    std::vector<unsigned> order;
+    std::vector<void*> processes;
+    std::vector<unsigned> jobIndex;
+    std::vector<double> startTime;
+    void* process = NULL;
+    stJobOrder byInputSize;
+    bool result = true;
+
+    if( executablePath == NULL )
+    {
+      GNSS_ERROR_MSG( "if( executablePath == NULL )" );
+      return false;
+    }
+    if( m_Jobs.size() == 0 )
+    {
+      GNSS_ERROR_MSG( "if( m_Jobs.size() == 0 )" );
+      return false;
+    }
+
+    m_nrWorkers = nrWorkers;
+    if( m_nrWorkers == 0 )
+      m_nrWorkers = GNSS_ThreadPool::GetNrProcessors();
+#ifdef WIN32
+    if( m_nrWorkers > MAXIMUM_WAIT_OBJECTS )
+      m_nrWorkers = MAXIMUM_WAIT_OBJECTS;
+#endif
+    if( m_nrWorkers > m_Jobs.size() )
+      m_nrWorkers = static_cast<unsigned>(m_Jobs.size());
+
+    // Start the jobs with the most data first so a long job does not start last.
+    order.resize( m_Jobs.size() );
+    for( i = 0; i < order.size(); i++ )
+      order[i] = i;
+    byInputSize.jobs = &m_Jobs;
+    std::stable_sort( order.begin(), order.end(), byInputSize );
+
+    t0 = GetTime();
+    while( next < order.size() || processes.size() > 0 )
+    {
+      while( result && next < order.size() && processes.size() < m_nrWorkers )
+      {
+        stJob& job = m_Jobs[order[next]];
+        printf( "Starting job %d of %d: %s\n", order[next]+1, (int)m_Jobs.size(), job.OptionFilePath.c_str() );
+        if( !StartJob( executablePath, job, process ) )
+        {
+          GNSS_ERROR_MSG( "StartJob returned false." );
+          result = false;
+          break;
+        }
+        if( process == NULL )
+        {
+          next++; // The job could not be run, it is reported as NOT_RUN.
+          continue;
+        }
+        processes.push_back( process );
+        jobIndex.push_back( order[next] );
+        startTime.push_back( GetTime() );
+        next++;
+      }
+      if( !result )
+        next = static_cast<unsigned>(order.size()); // Do not start any more jobs, wait for those running.
+      if( processes.size() == 0 )
+        break;
+
+      if( !WaitForJob( processes, jobIndex, startTime, completedJob ) )
+      {
+        GNSS_ERROR_MSG( "WaitForJob returned false." );
+        return false;
+      }
+      printf( "Completed job %d of %d (exit code %d, %.1f s): %s\n", 
+        completedJob+1, 
+        (int)m_Jobs.size(), 
+        m_Jobs[completedJob].exitCode, 
+        m_Jobs[completedJob].wallTime, 
+        m_Jobs[completedJob].OptionFilePath.c_str() );
+    }
+    m_TotalWallTime = GetTime() - t0;
+    return result;
+  }
+
+
+  unsigned GNSS_BatchProcessor::GetNrFailedJobs() const
+  {
+    unsigned i = 0;
+    unsigned n = 0;
+    for( i = 0; i < m_Jobs.size(); i++ )
+    {
+      if( !m_Jobs[i].wasRun || m_Jobs[i].exitCode != 0 )
+        n++;
+    }
+    return n;
+  }
+
+
+  bool GNSS_BatchProcessor::WriteSummary( const char* path )
+  {
+    FILE* fid = NULL;
+    unsigned i = 0;
+    double sumWallTime = 0;
+    const char* status = NULL;
+
+    if( path == NULL )
+    {
+      GNSS_ERROR_MSG( "if( path == NULL )" );
+      return false;
+    }
+    fid = fopen( path, "w" );
+    if( fid == NULL )
+    {
+      GNSS_ERROR_MSG( "if( fid == NULL )" );
+      return false;
+    }
+
+    fprintf( fid, "Job, OptionFile, Status, ExitCode, Signal, InputSize(MB), MemoryLimit(MB), PeakMemory(MB), WallTime(s), UserTime(s), SystemTime(s)\n" );
+    for( i = 0; i < m_Jobs.size(); i++ )
+    {
+      const stJob& job = m_Jobs[i];
+      if( !job.wasRun )
+        status = "NOT_RUN";
+      else if( job.exitCode == 0 )
+        status = "OK";
+      else
+        status = "FAILED";
+      sumWallTime += job.wallTime;
+
+      fprintf( fid, "%d, %s, %s, %d, %d, %.3f, %d, %.1f, %.3f, %.3f, %.3f\n",
+        i+1,
+        job.OptionFilePath.c_str(),
+        status,
+        job.exitCode,
+        job.signal,
+        job.inputSize / (1024.0*1024.0),
+        job.memoryLimitMB,
+        job.peakMemoryMB,
+        job.wallTime,
+        job.userTime,
+        job.systemTime );
+    }
+    fclose( fid );
+
+    printf( "\nBatch summary: %d jobs, %d failed, %d workers\n", (int)m_Jobs.size(), GetNrFailedJobs(), m_nrWorkers );
+    printf( "Total elapsed time: %.3f s, sum of job times: %.3f s", m_TotalWallTime, sumWallTime );
+    if( m_TotalWallTime > 0 )
+      printf( ", speedup: %.2f", sumWallTime / m_TotalWallTime );
+    printf( "\nSummary written to %s\n", path );
+    return true;
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,184 @@
+/**
+\file    GNSS_BatchProcessor.h
+\brief   Batch reprocessing of many data sets with a pool of worker processes.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_BATCHPROCESSOR_H_
+#define _GNSS_BATCHPROCESSOR_H_
+
+#include <string>
+#include <vector>
+
+namespace GNSS
+{
+  /**
+  \brief   Run EssentialGNSS for every option file listed in a manifest 
+           using a pool of worker processes.
+
+  The manifest is a text file with one job per line:
+  \code
+  ; comment
+  20071120_UofC/options.txt
+  20080120_UofC/options.txt, 512   ; a memory limit of 512 MB for this job
+  \endcode
+  Relative option file paths are relative to the manifest's folder. 
+  Each job is run in a separate process in the folder containing its 
+  option file (as the win32_process.bat scripts do), with its console 
+  output written to batch_log.txt in that folder. When several jobs run 
+  in the same folder, each job's output file names (the log, pvt.csv, 
+  obs_XX.csv, ...) are prefixed with its option file name, e.g. 
+  options_batch_log.txt and options_pvt.csv. The jobs with the most 
+  input data are started first. A memory limit per job is enforced with 
+  a job object (WIN32) or RLIMIT_AS (POSIX); a job is not run if its 
+  limit cannot be enforced.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_BatchProcessor
+  {
+  public:
+
+    /// \brief    The default constructor (no jobs yet).
+    GNSS_BatchProcessor();
+
+    /// \brief    The destructor.
+    virtual ~GNSS_BatchProcessor();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_BatchProcessor( const GNSS_BatchProcessor& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_BatchProcessor& rhs);
+
+  public:
+
+    /// \brief    Read the list of jobs from a manifest file.
+    /// \return   true if successful, false if error.
+    bool ReadManifest( 
+      const char* path,                  //!< The path to the manifest.
+      const unsigned defaultMemoryLimitMB //!< The memory limit for jobs that do not specify one [MB], 0 if none.
+      );
+
+    /// \brief    Run all of the jobs.
+    /// \return   true if successful (all jobs were run, some may have failed), false if error.
+    bool Run( 
+      const char* executablePath, //!< The path to the EssentialGNSS executable.
+      const unsigned nrWorkers    //!< The maximum number of jobs run at once, 0 indicates one per processor.
+      );
+
+    /// \brief    Write the summary timing report (comma delimited, one line per job).
+    /// \return   true if successful, false if error.
+    bool WriteSummary( const char* path );
+
+    /// \brief    The number of jobs that did not complete successfully.
+    unsigned GetNrFailedJobs() const;
+
+    /// \brief    Get the full path of the running executable.
+    /// \return   true if successful, false if error.
+    static bool GetExecutablePath( 
+      const char* argv0,  //!< argv[0], used if the path cannot be obtained from the system.
+      std::string& path   //!< The executable path.
+      );
+
+  public:
+
+    /// \brief   The information and results for one job.
+    struct stJob
+    {
+      std::string OptionFilePath; //!< The path to the option file.
+      std::string Directory;      //!< The folder the job is run in (the option file's folder).
+      std::string OptionFileName; //!< The option file name (without the folder).
+      std::string OutputPrefix;   //!< The prefix of the job's output file names, empty unless other jobs run in the same folder.
+      unsigned memoryLimitMB;     //!< The memory limit [MB], 0 if none.
+      double inputSize;           //!< The size of the receiver data files [bytes], used to order the jobs.
+      bool wasRun;                //!< Was the job run.
+      int exitCode;               //!< The process exit code, -1 if the process did not exit normally.
+      int signal;                 //!< The signal that terminated the process (POSIX), 0 if none.
+      double wallTime;            //!< The elapsed time [s].
+      double userTime;            //!< The user mode processor time [s].
+      double systemTime;          //!< The kernel mode processor time [s].
+      double peakMemoryMB;        //!< The peak memory used [MB], 0 if unknown.
+
+      stJob()
+        : memoryLimitMB(0), inputSize(0), wasRun(false), exitCode(-1), signal(0), 
+        wallTime(0), userTime(0), systemTime(0), peakMemoryMB(0)
+      {}
+    };
+
+    /// The jobs in manifest order.
+    std::vector<stJob> m_Jobs;
+
+    /// The elapsed time to run all the jobs [s].
+    double m_TotalWallTime;
+
+    /// The number of worker processes used.
+    unsigned m_nrWorkers;
+
+  protected:
+
+    /// \brief   Determine the size of the receiver data files referred to by the job's option file.
+    void DetermineInputSize( stJob& job );
+
+    /// \brief   Set the output prefix of the jobs that share a folder with another job.
+    void DetermineOutputPrefixes();
+
+    /// \brief   Start a job's process. The process is NULL if the job could not 
+    ///          be run (its memory limit could not be enforced).
+    /// \return  true if successful, false if error.
+    bool StartJob( 
+      const char* executablePath, //!< The path to the EssentialGNSS executable.
+      stJob& job,                 //!< The job.
+      void*& process              //!< The platform process information (deleted by WaitForJob).
+      );
+
+    /// \brief   Wait for one of the running jobs to complete.
+    /// \return  true if successful, false if error.
+    bool WaitForJob( 
+      std::vector<void*>& processes,   //!< The platform process information of the running jobs.
+      std::vector<unsigned>& jobIndex, //!< The index in m_Jobs of each running job.
+      std::vector<double>& startTime,  //!< The start time of each running job [s].
+      unsigned& completedJob           //!< The index in m_Jobs of the job that completed.
+      );
+
+    /// \brief   A monotonic clock [s].
+    static double GetTime();
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_BATCHPROCESSOR_H_
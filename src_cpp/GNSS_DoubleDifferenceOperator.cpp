@@ -0,0 +1,216 @@
+/**
+\file    GNSS_DoubleDifferenceOperator.cpp
+\brief   An implicit single to double difference operator.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include "gnss_error.h"
+#include "GNSS_DoubleDifferenceOperator.h"
+
+namespace GNSS
+{
+  GNSS_DoubleDifferenceOperator::GNSS_DoubleDifferenceOperator()
+    : m_base(0),
+    m_isBaseSet(false)
+  {}
+
+  GNSS_DoubleDifferenceOperator::~GNSS_DoubleDifferenceOperator()
+  {}
+
+
+  void GNSS_DoubleDifferenceOperator::Clear()
+  {
+    m_base = 0;
+    m_isBaseSet = false;
+    m_kept.clear();
+    m_diff.clear();
+  }
+
+  void GNSS_DoubleDifferenceOperator::SetBase( const unsigned index )
+  {
+    m_base = index;
+    m_isBaseSet = true;
+  }
+
+  void GNSS_DoubleDifferenceOperator::AddKept( const unsigned index )
+  {
+    m_kept.push_back( index );
+  }
+
+  void GNSS_DoubleDifferenceOperator::AddDifference( const unsigned index )
+  {
+    m_diff.push_back( index );
+  }
+
+  unsigned GNSS_DoubleDifferenceOperator::GetNrRows() const
+  {
+    return static_cast<unsigned>( m_kept.size() + m_diff.size() );
+  }
+
+  unsigned GNSS_DoubleDifferenceOperator::GetNrDifferences() const
+  {
+    return static_cast<unsigned>( m_diff.size() );
+  }
+
+  int GNSS_DoubleDifferenceOperator::GetRow( const unsigned index ) const
+  {
+    unsigned i = 0;
+    for( i = 0; i < m_diff.size(); i++ )
+    {
+      if( m_diff[i] == index )
+        return static_cast<int>( m_kept.size() + i );
+    }
+    return -1;
+  }
+
+
+  bool GNSS_DoubleDifferenceOperator::IsValid( const unsigned n ) const
+  {
+    unsigned i = 0;
+
+    if( !m_diff.empty() && ( !m_isBaseSet || m_base >= n ) )
+      return false;
+    for( i = 0; i < m_kept.size(); i++ )
+    {
+      if( m_kept[i] >= n )
+        return false;
+    }
+    for( i = 0; i < m_diff.size(); i++ )
+    {
+      if( m_diff[i] >= n || m_diff[i] == m_base )
+        return false;
+    }
+    return true;
+  }
+
+
+  bool GNSS_DoubleDifferenceOperator::ApplyToRows( Matrix& A, Matrix& BA ) const
+  {
+    const unsigned n = A.GetNrRows();
+    const unsigned u = A.GetNrCols();
+    const unsigned nk = static_cast<unsigned>( m_kept.size() );
+    const unsigned m = GetNrRows();
+    unsigned i = 0;
+    unsigned j = 0;
+
+    if( m == 0 )
+    {
+      GNSS_ERROR_MSG( "if( m == 0 )" );
+      return false;
+    }
+    if( !IsValid( n ) )
+    {
+      GNSS_ERROR_MSG( "if( !IsValid( n ) )" );
+      return false;
+    }
+    if( !BA.Resize( m, u ) )
+    {
+      GNSS_ERROR_MSG( "if( !BA.Resize( m, u ) )" );
+      return false;
+    }
+
+    for( i = 0; i < nk; i++ )
+    {
+      for( j = 0; j < u; j++ )
+        BA[i][j] = A[m_kept[i]][j];
+    }
+    for( i = nk; i < m; i++ )
+    {
+      for( j = 0; j < u; j++ )
+        BA[i][j] = A[m_diff[i-nk]][j] - A[m_base][j];
+    }
+    return true;
+  }
+
+
+  bool GNSS_DoubleDifferenceOperator::ApplyToCovariance( Matrix& P, Matrix& BPBt ) const
+  {
+    const unsigned n = P.GetNrRows();
+    const unsigned nk = static_cast<unsigned>( m_kept.size() );
+    const unsigned m = GetNrRows();
+    std::vector<unsigned> index( m, 0 ); // The element of each row.
+    std::vector<double> Pb( m, 0.0 );    // The row elements of P times B^T for the base column.
+    double Pbb = 0;
+    unsigned i = 0;
+    unsigned j = 0;
+    double v = 0;
+
+    if( m == 0 )
+    {
+      GNSS_ERROR_MSG( "if( m == 0 )" );
+      return false;
+    }
+    if( P.GetNrCols() != n || !IsValid( n ) )
+    {
+      GNSS_ERROR_MSG( "if( P.GetNrCols() != n || !IsValid( n ) )" );
+      return false;
+    }
+    if( !BPBt.Resize( m, m ) )
+    {
+      GNSS_ERROR_MSG( "if( !BPBt.Resize( m, m ) )" );
+      return false;
+    }
+
+    for( i = 0; i < nk; i++ )
+      index[i] = m_kept[i];
+    for( i = nk; i < m; i++ )
+      index[i] = m_diff[i-nk];
+
+    // (B P B^T)_ij = P_ij - P_i,base - P_base,j + P_base,base 
+    // where the base terms only apply to the differenced rows and columns.
+    if( !m_diff.empty() )
+    {
+      Pbb = P[m_base][m_base];
+      for( i = 0; i < m; i++ )
+        Pb[i] = P[index[i]][m_base];
+    }
+    for( i = 0; i < m; i++ )
+    {
+      for( j = 0; j <= i; j++ )
+      {
+        v = P[index[i]][index[j]];
+        if( i >= nk )
+          v -= Pb[j];
+        if( j >= nk )
+          v -= Pb[i];
+        if( i >= nk && j >= nk )
+          v += Pbb;
+        BPBt[i][j] = v;
+        BPBt[j][i] = v;
+      }
+    }
+    return true;
+  }
+
+} // end namespace GNSS
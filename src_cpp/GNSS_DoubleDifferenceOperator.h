@@ -0,0 +1,131 @@
+/**
+\file    GNSS_DoubleDifferenceOperator.h
+\brief   An implicit single to double difference operator.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_DOUBLEDIFFERENCEOPERATOR_H_
+#define _GNSS_DOUBLEDIFFERENCEOPERATOR_H_
+
+#include <vector>
+#include "Matrix.h"
+
+using namespace Zenautics; // for Matrix
+
+namespace GNSS
+{
+  /**
+  \brief   An implicit double difference operator, B.
+
+  B has a row for each kept element (e.g. the position states), which 
+  is copied, followed by a row for each differenced element, which is 
+  the element minus the base satellite element. e.g. \n
+  B = [1 0 0 0 0  0 0 0 ... \n
+       0 1 0 0 0  0 0 0 ... \n
+       0 0 1 0 0  0 0 0 ... \n
+       0 0 0 0 -1 1 0 0 ... \n
+       0 0 0 0 -1 0 1 0 ... ] \n
+  
+  Only the indices are stored. B*A costs O(m*u) for an [n x u] A with 
+  m rows of B and B*P*B^T costs O(m^2), rather than the dense products.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_DoubleDifferenceOperator
+  {
+  public:
+
+    /// \brief    The default constructor (an empty operator).
+    GNSS_DoubleDifferenceOperator();
+
+    /// \brief    The destructor.
+    virtual ~GNSS_DoubleDifferenceOperator();
+
+  public:
+
+    /// \brief    Remove all of the rows.
+    void Clear();
+
+    /// \brief    Set the index of the base satellite element.
+    void SetBase( const unsigned index );
+
+    /// \brief    Add a row that copies the element at index.
+    void AddKept( const unsigned index );
+
+    /// \brief    Add a row that differences the element at index with the base element.
+    void AddDifference( const unsigned index );
+
+    /// \brief    The number of rows of B.
+    unsigned GetNrRows() const;
+
+    /// \brief    The number of double differences.
+    unsigned GetNrDifferences() const;
+
+    /// \brief    The row of B for the difference of the element at index, -1 if none.
+    int GetRow( const unsigned index ) const;
+
+    /// \brief    Compute BA = B * A, e.g. the double difference states 
+    ///           from the single difference states or the double difference
+    ///           design matrix from the single difference design matrix.
+    /// \return   true if successful, false if error.
+    bool ApplyToRows( 
+      Matrix& A,  //!< The input matrix [n x u].
+      Matrix& BA  //!< The output matrix [m x u].
+      ) const;
+
+    /// \brief    Compute BPBt = B * P * B^T, e.g. the double difference 
+    ///           state or measurement variance-covariance matrix.
+    /// \return   true if successful, false if error.
+    bool ApplyToCovariance( 
+      Matrix& P,    //!< The symmetric input matrix [n x n].
+      Matrix& BPBt  //!< The output matrix [m x m].
+      ) const;
+
+  protected:
+
+    /// \brief    Check that the operator can be applied to n elements.
+    bool IsValid( const unsigned n ) const;
+
+  protected:
+
+    unsigned m_base;                 //!< The index of the base satellite element.
+    bool m_isBaseSet;                //!< Has the base element index been set.
+    std::vector<unsigned> m_kept;    //!< The indices of the kept elements.
+    std::vector<unsigned> m_diff;    //!< The indices of the differenced elements.
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_DOUBLEDIFFERENCEOPERATOR_H_
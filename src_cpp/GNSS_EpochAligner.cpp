@@ -0,0 +1,529 @@
+/**
+\file    GNSS_EpochAligner.cpp
+\brief   Alignment of the reference station observations to the rover epochs.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <string.h>
+#include "gnss_error.h"
+#include "constants.h"
+#include "GNSS_EpochAligner.h"
+
+namespace GNSS
+{
+  GNSS_EpochAligner::GNSS_EpochAligner()
+    : m_Mode(GNSS_ALIGNMENT_MATCH),
+    m_MaxSpan(5.0),
+    m_ReferenceLatency(0),
+    m_LatestEpoch(0),
+    m_nrEpochs(0),
+    m_prev_nrValidObs(0),
+    m_PendingMsJumps(0),
+    m_isClockJumpPending(false),
+    m_PendingClockJump(0)
+  {
+    memset( m_Epochs, 0, sizeof(m_Epochs) );
+    memset( m_prev_ObsArray, 0, sizeof(m_prev_ObsArray) );
+  }
+
+
+  GNSS_EpochAligner::~GNSS_EpochAligner()
+  {
+  }
+
+
+  bool GNSS_EpochAligner::Configure( 
+    const GNSS_enumAlignmentMode mode,
+    const double maxSpan,
+    const double referenceLatency
+    )
+  {
+    if( mode != GNSS_ALIGNMENT_MATCH && mode != GNSS_ALIGNMENT_INTERPOLATE && mode != GNSS_ALIGNMENT_EXTRAPOLATE )
+    {
+      GNSS_ERROR_MSG( "Unexpected alignment mode." );
+      return false;
+    }
+    if( maxSpan <= 0 || referenceLatency < 0 )
+    {
+      GNSS_ERROR_MSG( "if( maxSpan <= 0 || referenceLatency < 0 )" );
+      return false;
+    }
+    m_Mode = mode;
+    m_MaxSpan = maxSpan;
+    m_ReferenceLatency = referenceLatency;
+    return true;
+  }
+
+
+  bool GNSS_EpochAligner::LoadNext( 
+    GNSS_RxData &rxDataBase,
+    bool &endOfStreamBase,
+    GNSS_RxData &rxData,
+    bool &endOfStreamRover
+    )
+  {
+    bool result = false;
+    bool isAligned = false;
+    unsigned i = 0;
+    double timeRover = 0;
+    double interval = 0;
+
+    // Keep the previous aligned epoch, as the estimator left it, before 
+    // reading the reference data overwrites it.
+    m_prev_nrValidObs = rxDataBase.m_nrValidObs;
+    for( i = 0; i < m_prev_nrValidObs; i++ )
+    {
+      m_prev_ObsArray[i] = rxDataBase.m_ObsArray[i];
+    }
+
+    while( !endOfStreamBase && !endOfStreamRover )
+    {
+      result = rxData.LoadNext( endOfStreamRover );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "rxData.LoadNext returned false." );
+        return false;
+      }
+      if( endOfStreamRover )
+        return true;
+
+      timeRover = rxData.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxData.m_pvt.time.gps_tow;
+
+      // Read the reference epochs needed for this rover epoch.
+      while( !endOfStreamBase )
+      {
+        if( m_nrEpochs > 0 )
+        {
+          if( m_Mode == GNSS_ALIGNMENT_EXTRAPOLATE )
+          {
+            if( m_nrEpochs < 2 )
+            {
+              if( timeRover < GetEpoch(0).time + GNSS_ALIGNER_MATCH_TOLERANCE )
+                break;
+            }
+            else
+            {
+              // Wait for the next reference epoch only once it should be available.
+              interval = GetEpoch(0).time - GetEpoch(1).time;
+              if( timeRover < GetEpoch(0).time + interval + m_ReferenceLatency - GNSS_ALIGNER_MATCH_TOLERANCE )
+                break;
+            }
+          }
+          else
+          {
+            if( GetEpoch(0).time > timeRover - GNSS_ALIGNER_MATCH_TOLERANCE )
+              break;
+          }
+        }
+
+        result = LoadNextReferenceEpoch( rxDataBase, endOfStreamBase );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "LoadNextReferenceEpoch returned false." );
+          return false;
+        }
+      }
+      if( endOfStreamBase )
+        return true;
+
+      result = AlignReferenceEpoch( rxDataBase, rxData.m_pvt.time.gps_week, rxData.m_pvt.time.gps_tow, isAligned );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "AlignReferenceEpoch returned false." );
+        return false;
+      }
+      if( isAligned )
+        return true;
+
+      m_Statistics.nrSkipped++;
+    }
+    return true;
+  }
+
+
+  bool GNSS_EpochAligner::LoadNextReferenceEpoch( 
+    GNSS_RxData &rxDataBase,
+    bool &endOfStreamBase
+    )
+  {
+    bool result = false;
+    unsigned i = 0;
+
+    result = rxDataBase.LoadNext( endOfStreamBase );
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "rxDataBase.LoadNext returned false." );
+      return false;
+    }
+    if( endOfStreamBase )
+      return true;
+
+    m_Statistics.nrReferenceEpochs++;
+
+    // The observations are not aligned across a reference receiver clock jump.
+    // The jump is passed on with the next aligned epoch.
+    if( rxDataBase.m_msJumpDetected_Positive || rxDataBase.m_msJumpDetected_Negative || rxDataBase.m_clockJumpDetected )
+    {
+      m_nrEpochs = 0;
+      m_Statistics.nrClockJumps++;
+
+      if( rxDataBase.m_msJumpDetected_Positive )
+      {
+        m_PendingMsJumps++;
+      }
+      else if( rxDataBase.m_msJumpDetected_Negative )
+      {
+        m_PendingMsJumps--;
+      }
+      else
+      {
+        m_isClockJumpPending = true;
+        m_PendingClockJump += rxDataBase.m_clockJump;
+      }
+    }
+
+    m_LatestEpoch = (m_LatestEpoch + 1) % GNSS_ALIGNER_NR_EPOCHS;
+    if( m_nrEpochs < GNSS_ALIGNER_NR_EPOCHS )
+      m_nrEpochs++;
+
+    stReferenceEpoch& epoch = GetEpoch(0);
+    epoch.week = rxDataBase.m_pvt.time.gps_week;
+    epoch.tow  = rxDataBase.m_pvt.time.gps_tow;
+    epoch.time = epoch.week*SECONDS_IN_WEEK + epoch.tow;
+    epoch.nrValidObs = rxDataBase.m_nrValidObs;
+    epoch.nrGPSL1Obs = rxDataBase.m_nrGPSL1Obs;
+    for( i = 0; i < epoch.nrValidObs; i++ )
+    {
+      epoch.ObsArray[i] = rxDataBase.m_ObsArray[i];
+    }
+    return true;
+  }
+
+
+  bool GNSS_EpochAligner::AlignReferenceEpoch( 
+    GNSS_RxData &rxDataBase,
+    const unsigned week,
+    const double tow,
+    bool &isAligned
+    )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    int index_prev = 0;
+    unsigned nrEpochs = 0;
+    unsigned indexReference = 0;
+    int channels[GNSS_ALIGNER_NR_EPOCHS];
+    double t = week*SECONDS_IN_WEEK + tow;
+    double tFirst = 0;
+    double tLast = 0;
+    double dt = 0;
+    double value = 0;
+    double psrReference = 0;
+    bool isMatched = false;
+
+    isAligned = false;
+    if( m_nrEpochs == 0 )
+      return true;
+
+    // A reference epoch at the rover time is used as read.
+    for( k = 0; k < m_nrEpochs; k++ )
+    {
+      if( fabs( GetEpoch(k).time - t ) < GNSS_ALIGNER_MATCH_TOLERANCE )
+      {
+        isMatched = true;
+        indexReference = k;
+        break;
+      }
+    }
+
+    if( isMatched )
+    {
+      stReferenceEpoch& epoch = GetEpoch(indexReference);
+      rxDataBase.m_nrValidObs = epoch.nrValidObs;
+      rxDataBase.m_nrGPSL1Obs = epoch.nrGPSL1Obs;
+      for( i = 0; i < epoch.nrValidObs; i++ )
+      {
+        rxDataBase.m_ObsArray[i] = epoch.ObsArray[i];
+      }
+      rxDataBase.m_pvt.time.gps_week = epoch.week;
+      rxDataBase.m_pvt.time.gps_tow  = epoch.tow;
+      m_Statistics.nrMatched++;
+    }
+    else
+    {
+      if( m_Mode == GNSS_ALIGNMENT_MATCH )
+        return true;
+
+      // Use the latest epochs that are within the maximum span of the rover time.
+      nrEpochs = m_nrEpochs;
+      while( nrEpochs >= 2 )
+      {
+        tFirst = GetEpoch(nrEpochs-1).time;
+        tLast  = GetEpoch(0).time;
+        if( (t > tLast ? t : tLast) - (t < tFirst ? t : tFirst) <= m_MaxSpan )
+          break;
+        nrEpochs--;
+      }
+      if( nrEpochs < 2 )
+        return true;
+      if( t < GetEpoch(nrEpochs-1).time )
+        return true; // The rover time is before the reference epochs.
+
+      // The channel structure, flags, and satellite information are those of the nearest epoch.
+      for( k = 1; k < nrEpochs; k++ )
+      {
+        if( fabs( GetEpoch(k).time - t ) < fabs( GetEpoch(indexReference).time - t ) )
+          indexReference = k;
+      }
+      stReferenceEpoch& epoch = GetEpoch(indexReference);
+      dt = t - epoch.time;
+
+      rxDataBase.m_nrValidObs = epoch.nrValidObs;
+      rxDataBase.m_nrGPSL1Obs = epoch.nrGPSL1Obs;
+      for( i = 0; i < epoch.nrValidObs; i++ )
+      {
+        GNSS_structMeasurement& obs = rxDataBase.m_ObsArray[i];
+        obs = epoch.ObsArray[i];
+        if( !obs.flags.isActive )
+          continue;
+
+        // The matching channel in each epoch.
+        for( k = 0; k < nrEpochs; k++ )
+        {
+          channels[k] = -1;
+          if( k == indexReference )
+          {
+            channels[k] = i;
+            continue;
+          }
+          for( j = 0; j < GetEpoch(k).nrValidObs; j++ )
+          {
+            const GNSS_structMeasurement& other = GetEpoch(k).ObsArray[j];
+            if( other.system   == obs.system && 
+              other.codeType == obs.codeType && 
+              other.freqType == obs.freqType && 
+              other.id       == obs.id )
+            {
+              channels[k] = j;
+              break;
+            }
+          }
+        }
+
+        psrReference = obs.psr;
+        if( AlignObservation( nrEpochs, channels, 0, t, value ) )
+          obs.psr = value;
+        else
+          obs.flags.isPsrValid = 0;
+
+        if( AlignObservation( nrEpochs, channels, 1, t, value ) )
+          obs.adr = value;
+        else
+          obs.flags.isAdrValid = 0;
+
+        if( AlignObservation( nrEpochs, channels, 2, t, value ) )
+          obs.doppler = static_cast<float>(value);
+        else
+          obs.flags.isDopplerValid = 0;
+
+        // The transmit time follows the receive time and the aligned pseudorange.
+        if( obs.tow != 0.0 || obs.week != 0 )
+        {
+          obs.tow += dt - (obs.psr - psrReference)/LIGHTSPEED;
+          if( obs.tow >= SECONDS_IN_WEEK )
+          {
+            obs.tow -= SECONDS_IN_WEEK;
+            obs.week++;
+          }
+          else if( obs.tow < 0 )
+          {
+            obs.tow += SECONDS_IN_WEEK;
+            obs.week--;
+          }
+        }
+        if( obs.locktime > 0 )
+        {
+          obs.locktime += static_cast<float>(dt);
+          if( obs.locktime < 0 )
+            obs.locktime = 0;
+        }
+      }
+
+      rxDataBase.m_pvt.time.gps_week = week;
+      rxDataBase.m_pvt.time.gps_tow  = tow;
+      if( t > GetEpoch(0).time )
+      {
+        m_Statistics.nrExtrapolated++;
+        if( t - GetEpoch(0).time > m_Statistics.maxExtrapolation )
+          m_Statistics.maxExtrapolation = t - GetEpoch(0).time;
+      }
+      else
+      {
+        m_Statistics.nrInterpolated++;
+      }
+    }
+
+    rxDataBase.m_pvt_lsq.time.gps_week = rxDataBase.m_pvt.time.gps_week;
+    rxDataBase.m_pvt_lsq.time.gps_tow  = rxDataBase.m_pvt.time.gps_tow;
+
+    // The time differential indices refer to the previous aligned epoch.
+    rxDataBase.m_prev_nrValidObs = m_prev_nrValidObs;
+    for( i = 0; i < m_prev_nrValidObs; i++ )
+    {
+      rxDataBase.m_prev_ObsArray[i] = m_prev_ObsArray[i];
+    }
+    rxDataBase.BuildChannelLookup();
+    for( i = 0; i < rxDataBase.m_nrValidObs; i++ )
+    {
+      GNSS_structMeasurement& obs = rxDataBase.m_ObsArray[i];
+      if( obs.tow == 0.0 && obs.week == 0 )
+        continue;
+
+      obs.index_time_differential = -1;
+      if( obs.flags.isActive && obs.flags.isPsrValid )
+      {
+        index_prev = rxDataBase.GetPreviousChannelIndex( obs.system, obs.id, obs.freqType );
+        while( index_prev >= 0 && !( m_prev_ObsArray[index_prev].flags.isActive && m_prev_ObsArray[index_prev].flags.isPsrValid ) )
+          index_prev = rxDataBase.GetNextPreviousChannelIndex( index_prev ); // a duplicate channel of this satellite
+        if( index_prev >= 0 && 
+          m_prev_ObsArray[index_prev].flags.isActive && 
+          m_prev_ObsArray[index_prev].flags.isPsrValid )
+        {
+          obs.index_time_differential = static_cast<short>(index_prev);
+        }
+      }
+    }
+
+    // The clock jumps since the previous aligned epoch.
+    rxDataBase.m_msJumpDetected_Positive = m_PendingMsJumps > 0;
+    rxDataBase.m_msJumpDetected_Negative = m_PendingMsJumps < 0;
+    rxDataBase.m_clockJumpDetected = m_isClockJumpPending;
+    rxDataBase.m_clockJump = m_PendingClockJump;
+    m_PendingMsJumps = 0;
+    m_isClockJumpPending = false;
+    m_PendingClockJump = 0;
+
+    isAligned = true;
+    return true;
+  }
+
+
+  bool GNSS_EpochAligner::AlignObservation(
+    const unsigned nrEpochs,
+    const int* channels,
+    const unsigned observable,
+    const double t,
+    double &value
+    )
+  {
+    unsigned k = 0;
+    unsigned m = 0;
+    unsigned n = 0;
+    double times[GNSS_ALIGNER_NR_EPOCHS];
+    double values[GNSS_ALIGNER_NR_EPOCHS];
+    float locktime = 0;
+    double weight = 0;
+    bool isValid = false;
+
+    for( k = 0; k < nrEpochs; k++ )
+    {
+      isValid = false;
+      if( channels[k] >= 0 )
+      {
+        const GNSS_structMeasurement& obs = GetEpoch(k).ObsArray[channels[k]];
+        if( obs.flags.isActive )
+        {
+          switch( observable )
+          {
+          case 0: 
+            {
+              isValid = obs.flags.isPsrValid ? true : false; 
+              values[n] = obs.psr; 
+              break;
+            }
+          case 1: 
+            {
+              isValid = (obs.flags.isAdrValid && obs.flags.isPhaseLocked) ? true : false; 
+              values[n] = obs.adr;
+              if( n == 0 )
+                locktime = obs.locktime;
+              break;
+            }
+          default:
+            {
+              isValid = obs.flags.isDopplerValid ? true : false; 
+              values[n] = obs.doppler;
+              break;
+            }
+          }
+        }
+      }
+      if( isValid )
+      {
+        times[n] = GetEpoch(k).time;
+        n++;
+      }
+      else if( observable == 1 )
+      {
+        break; // The ADR is only aligned over consecutive epochs from the latest.
+      }
+    }
+
+    if( observable == 1 )
+    {
+      // Phase lock must be continuous over the epochs used.
+      while( n >= 2 && locktime < times[0] - times[n-1] - GNSS_ALIGNER_MATCH_TOLERANCE )
+        n--;
+    }
+    if( n < 2 )
+      return false;
+
+    // Lagrange polynomial through the n epochs.
+    value = 0;
+    for( k = 0; k < n; k++ )
+    {
+      weight = 1.0;
+      for( m = 0; m < n; m++ )
+      {
+        if( m != k )
+          weight *= (t - times[m]) / (times[k] - times[m]);
+      }
+      value += weight*values[k];
+    }
+    return true;
+  }
+
+} // end namespace GNSS
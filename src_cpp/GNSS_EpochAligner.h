@@ -0,0 +1,244 @@
+/**
+\file    GNSS_EpochAligner.h
+\brief   Alignment of the reference station observations to the rover epochs.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_EPOCHALIGNER_H_
+#define _GNSS_EPOCHALIGNER_H_
+
+#include "gnss_types.h"
+#include "GNSS_RxData.h"
+
+/// The number of reference station epochs kept by GNSS_EpochAligner (quadratic alignment).
+#define GNSS_ALIGNER_NR_EPOCHS (3)
+
+/// The time difference below which a reference and rover epoch are considered the same [s].
+#define GNSS_ALIGNER_MATCH_TOLERANCE (0.020)
+
+namespace GNSS
+{
+  /// \brief   How the reference station observations are aligned to the rover epochs.
+  typedef enum 
+  {
+    GNSS_ALIGNMENT_MATCH = 0,    //!< Only rover epochs with a reference epoch at the same time are used (other rover epochs are skipped).
+    GNSS_ALIGNMENT_INTERPOLATE,  //!< The reference observations are interpolated to the rover time (the reference data is read ahead of the rover).
+    GNSS_ALIGNMENT_EXTRAPOLATE   //!< The reference observations are extrapolated to the rover time (for reference data that arrives late).
+  } GNSS_enumAlignmentMode;
+
+  /**
+  \brief   Aligns the reference station observations to the rover epochs.
+
+  The most recent reference station epochs are kept in a ring buffer. For 
+  each rover epoch, the reference epoch at the same time is used as read. 
+  Otherwise, in the interpolate and extrapolate modes, the pseudorange, ADR, 
+  and Doppler of each reference channel are computed at the rover time with 
+  a Lagrange polynomial through the buffered epochs in which they are valid 
+  (quadratic with three epochs, linear with two). The ADR is only aligned 
+  over continuous phase lock. The buffer is restarted at reference receiver 
+  clock jumps, the jump is passed on with the next aligned epoch.
+
+  In the interpolate mode, the reference data is read until it reaches the 
+  rover time. In the extrapolate mode, the next reference epoch is only read
+  once the rover time is beyond its expected time plus the reference latency, 
+  so a rover with a higher rate or a reference with a data link delay does not
+  hold back the rover epochs.
+
+  The aligned epoch replaces the reference observations in the GNSS_RxData
+  object that was read, with the time differential indices and clock jump 
+  flags relative to the previous aligned epoch.
+
+  \code
+  GNSS_EpochAligner aligner;
+  aligner.Configure( GNSS_ALIGNMENT_INTERPOLATE, 5.0, 0.0 );
+  while( ... )
+  {
+    aligner.LoadNext( rxDataBase, endOfStreamBase, rxData, endOfStreamRover );
+    if( endOfStreamRover || endOfStreamBase )
+      break;
+    ...
+  }
+  \endcode
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_EpochAligner
+  {
+  public:
+
+    /// \brief    The default constructor (GNSS_ALIGNMENT_MATCH).
+    GNSS_EpochAligner();
+
+    /// \brief    The destructor.
+    virtual ~GNSS_EpochAligner();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_EpochAligner( const GNSS_EpochAligner& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_EpochAligner& rhs);
+
+  public:
+
+    /// \brief    Set the alignment mode.
+    /// \return   true if successful, false if error.
+    bool Configure( 
+      const GNSS_enumAlignmentMode mode, //!< The alignment mode.
+      const double maxSpan,              //!< The maximum time spanned by the reference epochs and the rover time in an alignment [s].
+      const double referenceLatency      //!< The extrapolate mode delay allowed for a reference epoch to be available [s].
+      );
+
+    /// \brief    Load the next rover epoch that the reference observations can be aligned to.
+    ///
+    /// Rover epochs that cannot be aligned (e.g. no reference epoch at that time
+    /// in the match mode) are skipped.
+    ///
+    /// \return   true if successful, false if error.
+    bool LoadNext( 
+      GNSS_RxData &rxDataBase,  //!< The reference station receiver data.
+      bool &endOfStreamBase,    //!< A boolean that indicates if the end of the data has been reached for the reference station.
+      GNSS_RxData &rxData,      //!< The rover station receiver data.
+      bool &endOfStreamRover    //!< A boolean that indicates if the end of the data has been reached for the rover station.
+      );
+
+    /// \brief    The alignment mode.
+    GNSS_enumAlignmentMode GetMode() const { return m_Mode; }
+
+  public:
+
+    /// \brief   The alignment counters.
+    struct stAlignmentStatistics
+    {
+      unsigned nrReferenceEpochs; //!< The number of reference epochs read.
+      unsigned nrMatched;         //!< The number of rover epochs with a reference epoch at the same time.
+      unsigned nrInterpolated;    //!< The number of rover epochs within the span of the reference epochs used.
+      unsigned nrExtrapolated;    //!< The number of rover epochs beyond the latest reference epoch used.
+      unsigned nrSkipped;         //!< The number of rover epochs skipped.
+      unsigned nrClockJumps;      //!< The number of reference receiver clock jumps (the buffer was restarted).
+      double maxExtrapolation;    //!< The largest extrapolation interval [s].
+
+      stAlignmentStatistics()
+        : nrReferenceEpochs(0), nrMatched(0), nrInterpolated(0), nrExtrapolated(0),
+        nrSkipped(0), nrClockJumps(0), maxExtrapolation(0)
+      {}
+    };
+
+    /// The alignment counters.
+    stAlignmentStatistics m_Statistics;
+
+  protected:
+
+    /// \brief   A reference station epoch as read.
+    struct stReferenceEpoch
+    {
+      unsigned week;     //!< The GPS week of the epoch [weeks].
+      double tow;        //!< The GPS time of week of the epoch [s].
+      double time;       //!< The GPS time (week and time of week) of the epoch [s].
+      unsigned char nrValidObs; //!< The number of observations.
+      unsigned char nrGPSL1Obs; //!< The number of GPS L1 observations.
+      GNSS_structMeasurement ObsArray[GNSS_RXDATA_NR_CHANNELS]; //!< The observations.
+    };
+
+    /// \brief   Read the next reference epoch into the buffer.
+    /// \return  true if successful, false if error.
+    bool LoadNextReferenceEpoch( 
+      GNSS_RxData &rxDataBase, //!< The reference station receiver data.
+      bool &endOfStreamBase    //!< A boolean that indicates if the end of the data has been reached for the reference station.
+      );
+
+    /// \brief   Set the aligned reference observations at the rover time.
+    /// \return  true if successful, false if error.
+    bool AlignReferenceEpoch( 
+      GNSS_RxData &rxDataBase, //!< The reference station receiver data.
+      const unsigned week,     //!< The rover GPS week [weeks].
+      const double tow,        //!< The rover GPS time of week [s].
+      bool &isAligned          //!< A boolean to indicate if the reference observations could be aligned.
+      );
+
+    /// \brief   Compute one observation at time t with the buffered epochs in which it is valid.
+    /// \return  true if at least two epochs were available, false otherwise.
+    bool AlignObservation(
+      const unsigned nrEpochs,       //!< The number of epochs used (from the latest).
+      const int* channels,           //!< The matching channel in each epoch, -1 if none.
+      const unsigned observable,     //!< 0 pseudorange, 1 ADR, 2 Doppler.
+      const double t,                //!< The rover time [s].
+      double &value                  //!< The aligned observation.
+      );
+
+    /// \brief   The buffered epoch, 0 is the latest.
+    stReferenceEpoch& GetEpoch( const unsigned index )
+    { return m_Epochs[(m_LatestEpoch + GNSS_ALIGNER_NR_EPOCHS - index) % GNSS_ALIGNER_NR_EPOCHS]; }
+
+  protected:
+
+    /// The alignment mode.
+    GNSS_enumAlignmentMode m_Mode;
+
+    /// The maximum time spanned by the reference epochs and the rover time in an alignment [s].
+    double m_MaxSpan;
+
+    /// The extrapolate mode delay allowed for a reference epoch to be available [s].
+    double m_ReferenceLatency;
+
+    /// The ring buffer of reference epochs.
+    stReferenceEpoch m_Epochs[GNSS_ALIGNER_NR_EPOCHS];
+
+    /// The index of the latest epoch in m_Epochs.
+    unsigned m_LatestEpoch;
+
+    /// The number of epochs in m_Epochs.
+    unsigned m_nrEpochs;
+
+    /// The previous aligned epoch, as it was left by the estimator.
+    GNSS_structMeasurement m_prev_ObsArray[GNSS_RXDATA_NR_CHANNELS];
+
+    /// The number of observations in m_prev_ObsArray.
+    unsigned char m_prev_nrValidObs;
+
+    /// The net number of millisecond clock jumps since the previous aligned epoch (positive increases the pseudoranges).
+    int m_PendingMsJumps;
+
+    /// A boolean to indicate if an arbitrary clock jump occured since the previous aligned epoch.
+    bool m_isClockJumpPending;
+
+    /// The arbitrary clock jumps since the previous aligned epoch [m].
+    double m_PendingClockJump;
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_EPOCHALIGNER_H_
@@ -49,7 +49,6 @@ SUCH DAMAGE.
 #include "navigation.h"
 #include "troposphere.h"
 #include "time_conversion.h"
-#include "GNSS_Lambda.h"
 
 //#define DEBUG_THE_ESTIMATOR
 #define GNSS_CYCLESLIP_THREADHOLD 3
@@ -72,7 +71,7 @@ namespace GNSS
 
 
   GNSS_Estimator::GNSS_Estimator()
-   : m_debug(NULL), m_FilterType(GNSS_FILTER_TYPE_INVALID)
+   : m_debug(NULL), m_FilterType(GNSS_FILTER_TYPE_INVALID), m_Profiler(NULL)
   {    
   }
 
@@ -133,6 +132,9 @@ namespace GNSS
     {
       m_RTK.P = pos_P;
     }
+
+    // The ambiguity states are added again as they are observed.
+    ResetAmbiguityStateSlots( m_RTK.P.nrows() );
     return true;
   }
 
@@ -283,6 +285,98 @@ namespace GNSS
   }
 
 
+  bool GNSS_Estimator::PredictLeastSquaresStartingPoint(
+    GNSS_RxData *rxData,     //!< A pointer to the rover receiver data. This must be a valid pointer.
+    const double clockJump,  //!< The clock jump compensation for this epoch [m].
+    bool &isPredicted        //!< A boolean to indicate if the starting point was predicted.
+    )
+  {
+    double t = 0;      // The current epoch time [s].
+    double dT = 0;     // The prediction interval for the position [s].
+    double dT_clk = 0; // The prediction interval for the clock offset [s].
+    double lat = 0;    
+    double lon = 0;
+    double hgt = 0;
+    double clk = 0;
+    GNSS_structPVT *pvt = NULL; // The solution that is predicted.
+    const GEODESY_structLocalFrame* frame = NULL;
+    bool result = false;
+
+    isPredicted = false;
+
+    if( rxData == NULL )
+    {
+      GNSS_ERROR_MSG( "rxData == NULL" );
+      return false;
+    }
+    if( rxData->m_pvt_lsq.isPositionFixed )
+    {
+      return true;
+    }
+
+    t = rxData->m_pvt_lsq.time.gps_week*SECONDS_IN_WEEK + rxData->m_pvt_lsq.time.gps_tow;
+
+    // The filter position is updated at the time of rxData->m_prev_pvt.
+    if( m_FilterType == GNSS_FILTER_TYPE_EKF || m_FilterType == GNSS_FILTER_TYPE_RTK4 || m_FilterType == GNSS_FILTER_TYPE_RTK8 )
+    {
+      dT = t - (rxData->m_prev_pvt.time.gps_week*SECONDS_IN_WEEK + rxData->m_prev_pvt.time.gps_tow);
+      if( dT > 0 && dT <= m_LSQIterationControl.maxWarmStartInterval )
+      {
+        pvt = &(rxData->m_pvt);
+      }
+    }
+    if( m_LSQIterationControl.isPreviousSolutionValid )
+    {
+      dT_clk = t - m_LSQIterationControl.previousSolutionTime;
+      if( dT_clk <= 0 || dT_clk > m_LSQIterationControl.maxWarmStartInterval )
+      {
+        dT_clk = 0;
+      }
+      else if( pvt == NULL )
+      {
+        pvt = &(rxData->m_pvt_lsq);
+        dT = dT_clk;
+      }
+    }
+    if( pvt == NULL )
+    {
+      return true;
+    }
+
+    frame = GetLocalFrame( *rxData, pvt == &(rxData->m_pvt_lsq) );
+    if( frame == NULL )
+    {
+      GNSS_ERROR_MSG( "GetLocalFrame returned NULL." );
+      return false;
+    }
+
+    lat = pvt->latitude  + pvt->vn*dT / ( frame->M + pvt->height );                       // convert from meters to radians.
+    lon = pvt->longitude + pvt->ve*dT / (( frame->N + pvt->height )*cos(pvt->latitude));  // convert from meters to radians.
+    hgt = pvt->height    + pvt->vup*dT;
+    clk = rxData->m_pvt_lsq.clockOffset + clockJump + rxData->m_pvt_lsq.clockDrift*dT_clk;
+
+    result = rxData->UpdatePositionAndRxClock(
+      rxData->m_pvt_lsq,
+      lat,
+      lon,
+      hgt,
+      clk,
+      rxData->m_pvt_lsq.std_lat,
+      rxData->m_pvt_lsq.std_lon,
+      rxData->m_pvt_lsq.std_hgt,
+      rxData->m_pvt_lsq.std_clk
+      );
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "UpdatePositionAndRxClock returned false." );
+      return false;
+    }
+
+    isPredicted = true;
+    return true;
+  }
+
+
   bool GNSS_Estimator::PerformLeastSquares(
     GNSS_RxData *rxData,       //!< A pointer to the rover receiver data. This must be a valid pointer.
     GNSS_RxData *rxBaseData,   //!< A pointer to the reference receiver data if available. NULL if not available.
@@ -316,11 +410,21 @@ namespace GNSS
     double vup = 0;       // rx velocity up [m/s].
     double M = 0;   // The computed meridian radius of curvature [m].
     double N = 0;   // The computed prime vertical radius of curvature [m].
+    const GEODESY_structLocalFrame* frame = NULL; // The local frame at the current position estimate.
     double stdev = 0.0; // A temporary double for getting standard deviation values.
     double speed = 0.0; // The speed estimate [m/s].
+    double clockJump = 0.0; // The clock jump compensation for this epoch [m].
+    double dpos = 0.0;      // The magnitude of the position update [m].
+    double rho = 0.0;       // The shortest computed range [m].
+    double dtmp2 = 0.0;     // A temp double.
+    double prev_dx[3] = {0.0, 0.0, 0.0}; // The previous position update [m].
+    bool isWarmStarted = false;    // This indicates if the iterations started from a predicted position.
+    bool isGeometryReused = false; // This indicates if the design matrix is kept from the previous iteration.
+    bool isConverged = false;      // This indicates if the position iterations converged.
     
     Matrix Ht_p;     // The position design matrix transposed                       [4  x nP].
     Matrix HtW_p;    // An intermediate result                                      [4  x nP].
+    Matrix G_p;      // The gain from the misclosures to the update, (HtWH)^-1 HtW  [4  x nP].
     Matrix Ht_v;     // The velocity design matrix transposed                       [4  x nD].
     Matrix HtW_v;    // An intermediate result                                      [4  x nD].
     //Matrix r_p;      // The psr residuals vector,                                   [nP x  1].
@@ -335,7 +439,7 @@ namespace GNSS
     bool hasRejectionOccurred_p = false; // This indicates if a pseudorange measurement was rejected.
     bool hasRejectionOccurred_v = false; // This indicates if a Doppler measurement was rejected.
 
-    unsigned char indexOfRejected = 0; // The index into rxData.m_ObsArray of a rejected measurement.
+    unsigned char nrRejected = 0; // The number of measurements rejected by fault detection and exclusion.
     
     bool result = false;
 
@@ -346,11 +450,13 @@ namespace GNSS
     }
 
     // Compensate the clock offset clock jumps to reduce iterations.
+    clockJump = rxData->m_pvt.clockOffset;
     if( !DealWithClockJumps( rxData, rxBaseData ) )    
     {
       GNSS_ERROR_MSG( "DealWithClockJumps returned false" );
       return false;    
     }
+    clockJump = rxData->m_pvt.clockOffset - clockJump;
 
     if( !rxData->CheckForCycleSlips_UsingPhaseRatePrediction( GNSS_CYCLESLIP_THREADHOLD ) )
     {
@@ -365,6 +471,24 @@ namespace GNSS
         return false;    
       }
     }
+    if( m_CycleSlipControl.useGeometryFree )
+    {
+      if( !rxData->CheckForCycleSlips_UsingGeometryFreePhase( 
+        m_CycleSlipControl.geometryFreeThreshold, m_CycleSlipControl.geometryFreeThresholdRate, m_CycleSlipControl.geometryFreeMaxGap ) )
+      {
+        GNSS_ERROR_MSG( "CheckForCycleSlips_UsingGeometryFreePhase returned false" );
+        return false;    
+      }
+      if( rxBaseData )
+      {
+        if( !rxBaseData->CheckForCycleSlips_UsingGeometryFreePhase( 
+          m_CycleSlipControl.geometryFreeThreshold, m_CycleSlipControl.geometryFreeThresholdRate, m_CycleSlipControl.geometryFreeMaxGap ) )
+        {
+          GNSS_ERROR_MSG( "CheckForCycleSlips_UsingGeometryFreePhase returned false" );
+          return false;    
+        }
+      }
+    }
    
     if( m_FilterType == GNSS_FILTER_TYPE_LSQ )
     {
@@ -372,6 +496,15 @@ namespace GNSS
       rxData->m_prev_pvt = rxData->m_pvt;
     }
 
+    if( m_LSQIterationControl.useWarmStart )
+    {
+      if( !PredictLeastSquaresStartingPoint( rxData, clockJump, isWarmStarted ) )
+      {
+        GNSS_ERROR_MSG( "PredictLeastSquaresStartingPoint returned false." );
+        return false;
+      }
+    }
+
     lat       = rxData->m_pvt_lsq.latitude;
     lon       = rxData->m_pvt_lsq.longitude;
     hgt       = rxData->m_pvt_lsq.height;
@@ -424,21 +557,12 @@ namespace GNSS
       return false;
     }
 
-    result = DetermineAtmosphericCorrections_GPSL1( *rxData, true );
+    result = DetermineAtmosphericCorrections_GPSL1( *rxData, true, rxBaseData );
     if( !result )
     {
       GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
       return false;
     }
-    if( rxBaseData != NULL )
-    {
-      result = DetermineAtmosphericCorrections_GPSL1( *rxBaseData, false );
-      if( !result )
-      {
-        GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
-        return false;
-      }
-    }
     
     // Check uniqueness
     n = nrValidEph;
@@ -456,7 +580,7 @@ namespace GNSS
     }  
 
     // Iterate through the solution
-    for( iter = 0; iter < 7; iter++ )
+    for( iter = 0; iter < m_LSQIterationControl.maxIterations; iter++ )
     {
       if( !DetermineUsablePseudorangeMeasurementsForThePositionSolution_GPSL1(
         *rxData, 
@@ -547,11 +671,29 @@ namespace GNSS
         GNSS_ERROR_MSG( "if( !m_posLSQ.H.Resize( n, 4 ) )" );
         return false;
       }
-      result = DetermineDesignMatrixElements_GPSL1_Psr( *rxData, true );
-      if( !result )
+      if( isGeometryReused )
       {
-        GNSS_ERROR_MSG( "DetermineDesignMatrixElements_GPSL1_Psr returned false." );
-        return false;
+        // The line of sight changes negligibly for a small position update.
+        // Only the computed ranges are updated, linearly, for the misclosures.
+        for( i = 0; i < rxData->m_nrValidObs; i++ )
+        {
+          if( rxData->m_ObsArray[i].flags.isActive && rxData->m_ObsArray[i].flags.isPsrUsedInSolution )
+          {
+            rxData->m_ObsArray[i].range += rxData->m_ObsArray[i].H_p[0]*prev_dx[0] 
+              + rxData->m_ObsArray[i].H_p[1]*prev_dx[1] 
+              + rxData->m_ObsArray[i].H_p[2]*prev_dx[2];
+          }
+        }
+        m_LSQIterationControl.nrGeometryReuses++;
+      }
+      else
+      {
+        result = DetermineDesignMatrixElements_GPSL1_Psr( *rxData, true );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "DetermineDesignMatrixElements_GPSL1_Psr returned false." );
+          return false;
+        }
       }
       j = 0;
       for( i = 0; i < rxData->m_nrValidObs; i++ )
@@ -720,14 +862,14 @@ namespace GNSS
       PrintMatToDebug( "LSQ Position P", m_posLSQ.P, 3 );
 
       // Compute dx_p.
-      if( !m_posLSQ.dx.Multiply( m_posLSQ.P, HtW_p ) )
+      if( !G_p.Multiply( m_posLSQ.P, HtW_p ) )
       {
-        GNSS_ERROR_MSG( "if( !m_posLSQ.dx.Multiply( m_posLSQ.P, HtW_p ) )" );
+        GNSS_ERROR_MSG( "if( !G_p.Multiply( m_posLSQ.P, HtW_p ) )" );
         return false;
       }
-      if( !m_posLSQ.dx.Inplace_PostMultiply( m_posLSQ.w ) )
+      if( !m_posLSQ.dx.Multiply( G_p, m_posLSQ.w ) )
       {
-        GNSS_ERROR_MSG( "if( !m_posLSQ.dx.Inplace_PostMultiply( m_posLSQ.w ) )" );
+        GNSS_ERROR_MSG( "if( !m_posLSQ.dx.Multiply( G_p, m_posLSQ.w ) )" );
         return false;
       }
 
@@ -737,14 +879,15 @@ namespace GNSS
       clk += m_posLSQ.dx[3];
      
       // The corrections for lat and lon, dx_p, must be converted to [rad] from [m].
-      GEODESY_ComputePrimeVerticalRadiusOfCurvature(
-        GEODESY_REFERENCE_ELLIPSE_WGS84, 
-        rxData->m_pvt_lsq.latitude,
-        &N );
-      GEODESY_ComputeMeridianRadiusOfCurvature(
-        GEODESY_REFERENCE_ELLIPSE_WGS84, 
-        rxData->m_pvt_lsq.latitude,
-        &M );
+      // The radii of curvature at the linearization point are in the local frame.
+      frame = GetLocalFrame( *rxData, true );
+      if( frame == NULL )
+      {
+        GNSS_ERROR_MSG( "GetLocalFrame returned NULL." );
+        return false;
+      }
+      N = frame->N;
+      M = frame->M;
 
       lat += m_posLSQ.dx[0] / ( M + hgt );             // convert from meters to radians.
       lon += m_posLSQ.dx[1] / (( N + hgt )*cos(lat));  // convert from meters to radians.
@@ -767,17 +910,78 @@ namespace GNSS
       }
 
       dtmp1 = fabs(m_posLSQ.dx[0]) + fabs(m_posLSQ.dx[1]) + fabs(m_posLSQ.dx[2]) + fabs(m_posLSQ.dx[3]);
+
+      // The computed ranges at the updated position differ from the linear prediction,
+      // H*dx, by less than dpos^2/rho (rho is at most the semi-major axis to bound the 
+      // curvature of the conversion to latitude and longitude). The next update would 
+      // be at most G_p applied to that error so, if this is below the tolerance, 
+      // the misclosures are updated linearly to the residuals and the iterations stop.
+      dpos = sqrt( m_posLSQ.dx[0]*m_posLSQ.dx[0] + m_posLSQ.dx[1]*m_posLSQ.dx[1] + m_posLSQ.dx[2]*m_posLSQ.dx[2] );
+      prev_dx[0] = m_posLSQ.dx[0];
+      prev_dx[1] = m_posLSQ.dx[1];
+      prev_dx[2] = m_posLSQ.dx[2];
+      if( dtmp1 >= 0.0001 )
+      {
+        rho = GEODESY_REFERENCE_ELLIPSE_WGS84_A;
+        for( i = 0; i < rxData->m_nrValidObs; i++ )
+        {
+          if( rxData->m_ObsArray[i].flags.isActive && rxData->m_ObsArray[i].flags.isPsrUsedInSolution )
+          {
+            if( rxData->m_ObsArray[i].range < rho )
+              rho = rxData->m_ObsArray[i].range;
+          }
+        }
+        dtmp2 = 0;
+        for( i = 0; i < G_p.nrows(); i++ )
+        {
+          for( j = 0; j < G_p.ncols(); j++ )
+          {
+            dtmp2 += fabs( G_p[i][j] );
+          }
+        }
+        if( rho > 0 && dtmp2 * dpos * dpos / rho < 0.0001 )
+        {
+          j = 0;
+          for( i = 0; i < rxData->m_nrValidObs; i++ )
+          {
+            if( rxData->m_ObsArray[i].flags.isActive && rxData->m_ObsArray[i].flags.isPsrUsedInSolution )
+            {
+              dtmp2 = m_posLSQ.H[j][0]*m_posLSQ.dx[0] + m_posLSQ.H[j][1]*m_posLSQ.dx[1] + m_posLSQ.H[j][2]*m_posLSQ.dx[2] + m_posLSQ.H[j][3]*m_posLSQ.dx[3];
+              m_posLSQ.w[j] -= dtmp2;
+              rxData->m_ObsArray[i].psr_misclosure_lsq -= dtmp2;
+              rxData->m_ObsArray[i].range += dtmp2 - m_posLSQ.H[j][3]*m_posLSQ.dx[3];
+              j++;
+            }
+          }
+          for( ; j < n; j++ )
+          {
+            // The constraint misclosures.
+            m_posLSQ.w[j] -= m_posLSQ.H[j][0]*m_posLSQ.dx[0] + m_posLSQ.H[j][1]*m_posLSQ.dx[1] + m_posLSQ.H[j][2]*m_posLSQ.dx[2] + m_posLSQ.H[j][3]*m_posLSQ.dx[3];
+          }
+          // The computed ranges and the misclosures are already at the updated position.
+          m_posLSQ.dx.Zero();
+          prev_dx[0] = 0;
+          prev_dx[1] = 0;
+          prev_dx[2] = 0;
+          dtmp1 = 0;
+          dpos = 0;
+        }
+      }
+
+      // Keep the design matrix for the next iteration if the position update is small.
+      isGeometryReused = dpos < m_LSQIterationControl.geometryReuseThreshold;
+
       if( dtmp1 < 0.0001 )
       {
         if( !rxData->m_pvt_lsq.isPositionConstrained )
         {
           // Test the residuals
-          result = PerformGlobalTestAndTestForMeasurementFaults( 
+          // All clear blunders are excluded at once by downdating the converged 
+          // solution, so the solution is recomputed only once after rejections.
+          result = PerformFaultDetectionAndExclusion_UsingRankOneDowndates( 
             *rxData,
             true,
             m_posLSQ.H,
-            Ht_p,      
-            m_posLSQ.W,
             m_posLSQ.R,
             m_posLSQ.w, // misclosures at convergence are the residuals.
             m_posLSQ.P,
@@ -785,14 +989,14 @@ namespace GNSS
             4,
             avf_p,      
             isGlobalTestPassed_p,
-            hasRejectionOccurred_p,
-            indexOfRejected
+            nrRejected
             );
           if( !result )
           {
-            GNSS_ERROR_MSG( "PerformGlobalTestAndTestForMeasurementFaults returned false." );
+            GNSS_ERROR_MSG( "PerformFaultDetectionAndExclusion_UsingRankOneDowndates returned false." );
             return false;
           }
+          hasRejectionOccurred_p = nrRejected > 0;
 
           if( hasRejectionOccurred_p )
           {
@@ -803,12 +1007,14 @@ namespace GNSS
           else
           {
             // converged to solution.
+            isConverged = true;
             break;
           }
         }
         else
         {
           // converged to solution.
+          isConverged = true;
           break;
         }
 
@@ -816,6 +1022,28 @@ namespace GNSS
     }
     wasPositionComputed = true;
 
+    // Accumulate the iteration statistics.
+    m_LSQIterationControl.nrIterations = isConverged ? iter+1 : iter;
+    m_LSQIterationControl.totalNrIterations += m_LSQIterationControl.nrIterations;
+    if( m_LSQIterationControl.nrIterations > m_LSQIterationControl.maxNrIterations )
+    {
+      m_LSQIterationControl.maxNrIterations = m_LSQIterationControl.nrIterations;
+    }
+    m_LSQIterationControl.nrEpochs++;
+    if( isWarmStarted )
+    {
+      m_LSQIterationControl.nrWarmStarts++;
+    }
+    if( isConverged )
+    {
+      m_LSQIterationControl.isPreviousSolutionValid = true;
+      m_LSQIterationControl.previousSolutionTime = rxData->m_pvt_lsq.time.gps_week*SECONDS_IN_WEEK + rxData->m_pvt_lsq.time.gps_tow;
+    }
+    else
+    {
+      m_LSQIterationControl.nrNotConverged++;
+    }
+
     // Compute the DOP values.
     if( !ComputeDOP( rxData, true ) )
     {
@@ -1169,12 +1397,12 @@ namespace GNSS
         if( !rxData->m_pvt_lsq.isPositionConstrained )
         {
           // Test the residuals
-          result = PerformGlobalTestAndTestForMeasurementFaults( 
+          // All clear blunders are excluded at once by downdating the converged 
+          // solution, so the solution is recomputed only once after rejections.
+          result = PerformFaultDetectionAndExclusion_UsingRankOneDowndates( 
             *rxData,
             false,
             m_velLSQ.H,
-            Ht_v,      
-            m_velLSQ.W,
             m_velLSQ.R,
             m_velLSQ.w, // misclosures at convergence are the residuals.
             m_velLSQ.P,
@@ -1182,14 +1410,14 @@ namespace GNSS
             4,
             avf_v,      
             isGlobalTestPassed_v,
-            hasRejectionOccurred_v,
-            indexOfRejected
+            nrRejected
             );
           if( !result )
           {
-            GNSS_ERROR_MSG( "PerformGlobalTestAndTestForMeasurementFaults returned false." );
+            GNSS_ERROR_MSG( "PerformFaultDetectionAndExclusion_UsingRankOneDowndates returned false." );
             return false;
           }
+          hasRejectionOccurred_v = nrRejected > 0;
 
           if( hasRejectionOccurred_v )
           {
@@ -1322,6 +1550,11 @@ namespace GNSS
     double vx = 0;  // The rover receiver velocity ECEF.
     double vy = 0;  // The rover receiver velocity ECEF.
     double vz = 0;  // The rover receiver velocity ECEF.
+    const GEODESY_structLocalFrame* frame = NULL;     // The rover local frame.
+    const GEODESY_structLocalFrame* baseFrame = NULL; // The reference station local frame.
+    GEODESY_structLocalFrame noFrame;     // Used if the rover position is invalid, the azimuth and elevation are then zero.
+    GEODESY_structLocalFrame noBaseFrame; // Used if the reference position is invalid.
+    GNSS_PROFILE_SCOPE( m_Profiler, GNSS_PROFILE_SATELLITE_PVT );
     
     memset( &eph, 0, sizeof(eph) );
 
@@ -1350,6 +1583,29 @@ namespace GNSS
       vz = rxData->m_pvt.vz;
     }
 
+    // The user position dependent terms are computed once for all satellites.
+    frame = GetLocalFrame( *rxData, isLeastSquares );
+    if( frame == NULL )
+    {
+      memset( &noFrame, 0, sizeof(noFrame) );
+      noFrame.x = x;
+      noFrame.y = y;
+      noFrame.z = z;
+      frame = &noFrame;
+    }
+    if( rxBaseData != NULL )
+    {
+      baseFrame = GetLocalFrame( *rxBaseData, false );
+      if( baseFrame == NULL )
+      {
+        memset( &noBaseFrame, 0, sizeof(noBaseFrame) );
+        noBaseFrame.x = rxBaseData->m_pvt.x;
+        noBaseFrame.y = rxBaseData->m_pvt.y;
+        noBaseFrame.z = rxBaseData->m_pvt.z;
+        baseFrame = &noBaseFrame;
+      }
+    }
+
     if( rxBaseData != NULL )
     {
       // Evaluate the satellite PVT for all channels with GPS L1 observations 
@@ -1426,10 +1682,8 @@ namespace GNSS
             rxBaseData->m_ObsArray[i].flags.isEphemerisValid = true;
 
             // Compute the satellite clock corrections, position, velocity, etc.
-            GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData(
-              rxBaseData->m_pvt.x,
-              rxBaseData->m_pvt.y,
-              rxBaseData->m_pvt.z,
+            GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData_UsingTheLocalFrame(
+              baseFrame,
               rxBaseData->m_ObsArray[i].week,
               rxBaseData->m_ObsArray[i].tow,              
               eph.week,
@@ -1592,10 +1846,8 @@ namespace GNSS
           }
 
           // Compute the satellite clock corrections, position, velocity, etc.
-          GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData(
-            x,
-            y,
-            z,
+          GPS_ComputeSatellitePositionVelocityAzimuthElevationDoppler_BasedOnEphmerisData_UsingTheLocalFrame(
+            frame,
             rxData->m_ObsArray[i].week,
             rxData->m_ObsArray[i].tow,              
             eph.week,
@@ -1682,22 +1934,61 @@ namespace GNSS
     return true;
   }
 
+  bool GNSS_Estimator::DetermineAtmosphericCorrections_GPSL1( 
+    GNSS_RxData &rxData,       //!< The receiver data.
+    const bool isLeastSquares, //!< A boolean to indicate if the rover position and velocity values are from least squares rxData->m_pvt_lsq or from rxData->m_pvt.)
+    GNSS_RxData *rxBaseData    //!< The base station receiver data (m_pvt is used). NULL if not available.
+    )
+  {
+    GNSS_PROFILE_SCOPE( m_Profiler, GNSS_PROFILE_ATMOSPHERE );
+    if( !DetermineAtmosphericCorrections_GPSL1( rxData, isLeastSquares ) )
+    {
+      GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
+      return false;
+    }
+    if( rxBaseData != NULL )
+    {
+      if( !DetermineAtmosphericCorrections_GPSL1( *rxBaseData, false ) )
+      {
+        GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
+        return false;
+      }
+    }
+    return true;
+  }
+
+
   bool GNSS_Estimator::DetermineAtmosphericCorrections_GPSL1( 
     GNSS_RxData &rxData,       //!< The receiver data.
     const bool isLeastSquares  //!< A boolean to indicate if the rover position and velocity values are from least squares rxData->m_pvt_lsq or from rxData->m_pvt.)
     )
   {
     unsigned i = 0;
+    unsigned j = 0;
+    unsigned n = 0;
     double zenith_dry_delay = 0;
     double zenith_wet_delay = 0;
     double dtmp1 = 0;
     double dtmp2 = 0;
+    double dtmp3 = 0;
+    double dry_direct = 0;
+    double wet_direct = 0;
     BOOL result;
 
+    // The satellites to be corrected are gathered into contiguous arrays 
+    // so the batch troposphere and ionosphere kernels can be used.
+    unsigned index[GNSS_RXDATA_NR_CHANNELS];
+    double elevation[GNSS_RXDATA_NR_CHANNELS];
+    double azimuth[GNSS_RXDATA_NR_CHANNELS];
+    double drydelay[GNSS_RXDATA_NR_CHANNELS];
+    double wetdelay[GNSS_RXDATA_NR_CHANNELS];
+    double ionodelay[GNSS_RXDATA_NR_CHANNELS];
+
     double lat = 0;
     double lon = 0;
     double hgt = 0;
     double tow = 0;
+    unsigned short week = 0;
     unsigned short day_of_year = 0;
 
     if( isLeastSquares )
@@ -1706,6 +1997,7 @@ namespace GNSS
       lon = rxData.m_pvt_lsq.longitude;
       hgt = rxData.m_pvt_lsq.height;
       day_of_year = rxData.m_pvt_lsq.time.day_of_year;
+      week = rxData.m_pvt_lsq.time.gps_week;
       tow = rxData.m_pvt_lsq.time.gps_tow;
     }
     else
@@ -1714,19 +2006,11 @@ namespace GNSS
       lon = rxData.m_pvt.longitude;
       hgt = rxData.m_pvt.height;
       day_of_year = rxData.m_pvt.time.day_of_year;
+      week = rxData.m_pvt.time.gps_week;
       tow = rxData.m_pvt.time.gps_tow;
     }
 
-    // Compute the tropospheric delays.
-    TROPOSPHERE_DetermineZenithDelayValues_WAAS_Model(
-      lat,
-      hgt,
-      day_of_year,
-      &zenith_dry_delay,
-      &zenith_wet_delay
-      );
-
-    for( i = 0; i < rxData.m_nrValidObs; i++ )
+    for( i = 0; i < rxData.m_nrValidObs && n < GNSS_RXDATA_NR_CHANNELS; i++ )
     {
       if( rxData.m_ObsArray[i].flags.isActive )
       {
@@ -1734,50 +2018,415 @@ namespace GNSS
         {
           if( rxData.m_ObsArray[i].flags.isEphemerisValid )
           {
-            // Always compute the tropospheric correction (it may not be applied though).
-            TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
-              zenith_dry_delay, 
-              zenith_wet_delay, 
-              rxData.m_ObsArray[i].satellite.elevation,
-              lat,              
-              hgt,
-              &dtmp1,
-              &dtmp2
-              );
-            
-            rxData.m_ObsArray[i].corrections.prcTropoDry = static_cast<float>(dtmp1);
-            rxData.m_ObsArray[i].corrections.prcTropoWet = static_cast<float>(dtmp2);
-
-            if( rxData.m_klobuchar.isValid )
-            {
-              // Always compute the ionospheric correction (it may not be applied though).
-              result = IONOSPHERE_GetL1KlobucharCorrection(
-                rxData.m_klobuchar.alpha0,
-                rxData.m_klobuchar.alpha1,
-                rxData.m_klobuchar.alpha2,
-                rxData.m_klobuchar.alpha3,
-                rxData.m_klobuchar.beta0,
-                rxData.m_klobuchar.beta1,
-                rxData.m_klobuchar.beta2,
-                rxData.m_klobuchar.beta3,
-                lat,
-                lon, 
-                rxData.m_ObsArray[i].satellite.elevation,
-                rxData.m_ObsArray[i].satellite.azimuth,
-                tow,
-                &dtmp1
-                );
-              if( result == FALSE )
-              {
-                GNSS_ERROR_MSG( "IONOSPHERE_GetL1KlobucharCorrection returned FALSE." );
-                return false;
-              }
-              rxData.m_ObsArray[i].corrections.prcIono = static_cast<float>(dtmp1);
-            }
+            index[n] = i;
+            elevation[n] = rxData.m_ObsArray[i].satellite.elevation;
+            azimuth[n] = rxData.m_ObsArray[i].satellite.azimuth;
+            n++;
           }
         }
       }
     }
+    if( n == 0 )
+      return true;
+
+    if( rxData.m_AtmCache.isEnabled )
+    {
+      // Reuse the zenith delays and the mapping table unless the receiver moved.
+      if( !UpdateAtmosphericCorrectionCache( rxData, lat, hgt, day_of_year ) )
+      {
+        GNSS_ERROR_MSG( "UpdateAtmosphericCorrectionCache returned false." );
+        return false;
+      }
+      if( rxData.m_AtmCache.checkAccuracy )
+      {
+        TROPOSPHERE_DetermineZenithDelayValues_WAAS_Model( lat, hgt, day_of_year, &zenith_dry_delay, &zenith_wet_delay );
+      }
+    }
+    else
+    {
+      // Compute the tropospheric delays.
+      TROPOSPHERE_DetermineZenithDelayValues_WAAS_Model(
+        lat,
+        hgt,
+        day_of_year,
+        &zenith_dry_delay,
+        &zenith_wet_delay
+        );
+      TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction_Batch(
+        zenith_dry_delay, 
+        zenith_wet_delay, 
+        elevation,
+        n,
+        lat,              
+        hgt,
+        drydelay,
+        wetdelay
+        );
+    }
+
+    // Always compute the tropospheric correction (it may not be applied though).
+    for( j = 0; j < n; j++ )
+    {
+      i = index[j];
+      if( rxData.m_AtmCache.isEnabled )
+      {
+        GetTroposphericDelayFromCache( rxData, elevation[j], dtmp1, dtmp2 );
+        
+        if( rxData.m_AtmCache.checkAccuracy )
+        {
+          TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
+            zenith_dry_delay, 
+            zenith_wet_delay, 
+            elevation[j],
+            lat,              
+            hgt,
+            &dry_direct,
+            &wet_direct
+            );
+          dtmp3 = fabs( (dtmp1 + dtmp2) - (dry_direct + wet_direct) );
+          if( dtmp3 > rxData.m_AtmCache.maxTropoError )
+            rxData.m_AtmCache.maxTropoError = dtmp3;
+        }
+      }
+      else
+      {
+        dtmp1 = drydelay[j];
+        dtmp2 = wetdelay[j];
+      }
+      rxData.m_ObsArray[i].corrections.prcTropoDry = static_cast<float>(dtmp1);
+      rxData.m_ObsArray[i].corrections.prcTropoWet = static_cast<float>(dtmp2);
+    }
+
+    if( !rxData.m_klobuchar.isValid )
+      return true;
+
+    // Always compute the ionospheric correction (it may not be applied though).
+    if( rxData.m_AtmCache.isEnabled )
+    {
+      for( j = 0; j < n; j++ )
+      {
+        i = index[j];
+        if( !GetIonosphericDelayFromCache( 
+          rxData, 
+          rxData.m_ObsArray[i].id,
+          lat,
+          lon, 
+          elevation[j],
+          azimuth[j],
+          week,
+          tow,
+          dtmp1 ) )
+        {
+          GNSS_ERROR_MSG( "GetIonosphericDelayFromCache returned false." );
+          return false;
+        }
+        rxData.m_ObsArray[i].corrections.prcIono = static_cast<float>(dtmp1);
+      }
+    }
+    else
+    {
+      result = IONOSPHERE_GetL1KlobucharCorrection_Batch(
+        rxData.m_klobuchar.alpha0,
+        rxData.m_klobuchar.alpha1,
+        rxData.m_klobuchar.alpha2,
+        rxData.m_klobuchar.alpha3,
+        rxData.m_klobuchar.beta0,
+        rxData.m_klobuchar.beta1,
+        rxData.m_klobuchar.beta2,
+        rxData.m_klobuchar.beta3,
+        lat,
+        lon, 
+        elevation,
+        azimuth,
+        n,
+        tow,
+        ionodelay
+        );
+      if( result == FALSE )
+      {
+        GNSS_ERROR_MSG( "IONOSPHERE_GetL1KlobucharCorrection_Batch returned FALSE." );
+        return false;
+      }
+      for( j = 0; j < n; j++ )
+      {
+        rxData.m_ObsArray[index[j]].corrections.prcIono = static_cast<float>(ionodelay[j]);
+      }
+    }
+    return true;
+  }
+
+
+  const GEODESY_structLocalFrame* GNSS_Estimator::GetLocalFrame( 
+    GNSS_RxData &rxData,       //!< The receiver data.
+    const bool isLeastSquares  //!< A boolean to indicate if the position is from least squares rxData.m_pvt_lsq or from rxData.m_pvt.
+    )
+  {
+    GNSS_structPVT &pvt = isLeastSquares ? rxData.m_pvt_lsq : rxData.m_pvt;
+    GEODESY_structLocalFrame &frame = isLeastSquares ? rxData.m_LocalFrame_lsq : rxData.m_LocalFrame;
+    BOOL result;
+
+    if( frame.isValid &&
+      frame.latitude == pvt.latitude && 
+      frame.longitude == pvt.longitude && 
+      frame.height == pvt.height &&
+      frame.x == pvt.x && 
+      frame.y == pvt.y && 
+      frame.z == pvt.z )
+    {
+      return &frame;
+    }
+
+    result = GEODESY_ComputeLocalFrame( 
+      GEODESY_REFERENCE_ELLIPSE_WGS84,
+      pvt.latitude,
+      pvt.longitude,
+      pvt.height,
+      &frame );
+    if( result == FALSE )
+    {
+      GNSS_ERROR_MSG( "GEODESY_ComputeLocalFrame returned FALSE." );
+      return NULL;
+    }
+    // Use the stored earth fixed position so the results are identical to using pvt.x, pvt.y, pvt.z directly.
+    frame.x = pvt.x;
+    frame.y = pvt.y;
+    frame.z = pvt.z;
+    
+    return &frame;
+  }
+
+
+  bool GNSS_Estimator::UpdateAtmosphericCorrectionCache( 
+    GNSS_RxData &rxData,              //!< The receiver data.
+    const double latitude,            //!< The user latitude [rad].
+    const double height,              //!< The user height [m].
+    const unsigned short day_of_year  //!< The day of year (1-366) [days].
+    )
+  {
+    unsigned k = 0;
+    double dN = 0;
+    double dU = 0;
+    double elevation = 0;
+    double drymap = 0;
+    double wetmap = 0;
+    double dry_interp = 0;
+    double wet_interp = 0;
+    double dtmp = 0;
+    const double step = GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG*DEG2RAD;
+    GNSS_RxData::struct_AtmosphericCorrectionCache &cache = rxData.m_AtmCache;
+
+    if( cache.isZenithValid && cache.day_of_year == day_of_year )
+    {
+      // The zenith delays and mapping functions depend only on latitude and 
+      // height. The meridian arc is approximated using the semi-major axis.
+      dN = (latitude - cache.latitude) * GEODESY_REFERENCE_ELLIPSE_WGS84_A;
+      dU = height - cache.height;
+      if( dN*dN + dU*dU <= cache.maxDisplacement*cache.maxDisplacement )
+        return true;
+    }
+
+    TROPOSPHERE_DetermineZenithDelayValues_WAAS_Model(
+      latitude,
+      height,
+      day_of_year,
+      &cache.zenith_dry_delay,
+      &cache.zenith_wet_delay
+      );
+
+    // Tabulate the mapping functions from -step to 90 deg + 2*step.
+    for( k = 0; k < GNSS_RxData::struct_AtmosphericCorrectionCache::TABLE_LENGTH; k++ )
+    {
+      elevation = ((double)k - 1.0) * step;
+      TROPOSPHERE_GetDayAndWetMappingValues_UsingThe_UNBabc_MappingFunction(
+        elevation,
+        latitude,
+        height,
+        &cache.drymap[k],
+        &cache.wetmap[k] );
+    }
+
+    cache.latitude = latitude;
+    cache.height = height;
+    cache.day_of_year = day_of_year;
+    cache.isZenithValid = true;
+    cache.nrZenithComputations++;
+
+    // Check the interpolation accuracy against the direct computation at 
+    // the midpoints of the table (the worst case for the spline).
+    cache.maxTableError = 0;
+    for( k = 1; k < GNSS_RxData::struct_AtmosphericCorrectionCache::TABLE_LENGTH-3; k++ )
+    {
+      elevation = ((double)k - 0.5) * step;
+      TROPOSPHERE_GetDayAndWetMappingValues_UsingThe_UNBabc_MappingFunction(
+        elevation,
+        latitude,
+        height,
+        &drymap,
+        &wetmap );
+      GetTroposphericDelayFromCache( rxData, elevation, dry_interp, wet_interp );
+      dtmp = fabs( dry_interp - cache.zenith_dry_delay*drymap ) + fabs( wet_interp - cache.zenith_wet_delay*wetmap );
+      if( dtmp > cache.maxTableError )
+        cache.maxTableError = dtmp;
+    }
+
+    return true;
+  }
+
+
+  void GNSS_Estimator::GetTroposphericDelayFromCache( 
+    GNSS_RxData &rxData,     //!< The receiver data.
+    const double elevation,  //!< The satellite elevation angle [rad].
+    double &drydelay,        //!< The dry delay [m].
+    double &wetdelay         //!< The wet delay [m].
+    )
+  {
+    const double step = GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG*DEG2RAD;
+    GNSS_RxData::struct_AtmosphericCorrectionCache &cache = rxData.m_AtmCache;
+    double u = 0;
+    double t = 0;
+    double t2 = 0;
+    double t3 = 0;
+    double drymap = 0;
+    double wetmap = 0;
+    unsigned k = 0;
+    const double* p = NULL;
+
+    u = elevation/step + 1.0; // The table position.
+    if( u < 1.0 || u >= (double)(GNSS_RxData::struct_AtmosphericCorrectionCache::TABLE_LENGTH-2) )
+    {
+      // Outside the table, e.g. negative elevations.
+      TROPOSPHERE_GetDryAndWetDelay_UsingThe_UNBabc_MappingFunction(
+        cache.zenith_dry_delay, 
+        cache.zenith_wet_delay, 
+        elevation,
+        cache.latitude,
+        cache.height,
+        &drydelay,
+        &wetdelay
+        );
+      return;
+    }
+
+    k = (unsigned)u;
+    t = u - (double)k;
+    t2 = t*t;
+    t3 = t2*t;
+
+    // Catmull-Rom spline through p[-1], p[0], p[1], p[2].
+    p = &cache.drymap[k];
+    drymap = 0.5*( 2.0*p[0] + (p[1]-p[-1])*t + (2.0*p[-1] - 5.0*p[0] + 4.0*p[1] - p[2])*t2 + (3.0*(p[0]-p[1]) + p[2] - p[-1])*t3 );
+    p = &cache.wetmap[k];
+    wetmap = 0.5*( 2.0*p[0] + (p[1]-p[-1])*t + (2.0*p[-1] - 5.0*p[0] + 4.0*p[1] - p[2])*t2 + (3.0*(p[0]-p[1]) + p[2] - p[-1])*t3 );
+
+    drydelay = cache.zenith_dry_delay*drymap;
+    wetdelay = cache.zenith_wet_delay*wetmap;
+  }
+
+
+  bool GNSS_Estimator::GetIonosphericDelayFromCache( 
+    GNSS_RxData &rxData,      //!< The receiver data.
+    const unsigned short prn, //!< The GPS PRN.
+    const double latitude,    //!< The user latitude [rad].
+    const double longitude,   //!< The user longitude [rad].
+    const double elevation,   //!< The satellite elevation angle [rad].
+    const double azimuth,     //!< The satellite azimuth angle [rad].
+    const unsigned short gps_week, //!< The GPS week [weeks].
+    const double gps_tow,     //!< The GPS time of week [s].
+    double &iono              //!< The ionospheric delay [m].
+    )
+  {
+    GNSS_RxData::struct_AtmosphericCorrectionCache &cache = rxData.m_AtmCache;
+    const double t = gps_week*SECONDS_IN_WEEK + gps_tow;
+    double dt = 0;
+    double direct = 0;
+    bool isPrediction = false;
+    unsigned i = 0;
+    BOOL result;
+    const double klobuchar[8] = {
+      rxData.m_klobuchar.alpha0, rxData.m_klobuchar.alpha1, rxData.m_klobuchar.alpha2, rxData.m_klobuchar.alpha3,
+      rxData.m_klobuchar.beta0,  rxData.m_klobuchar.beta1,  rxData.m_klobuchar.beta2,  rxData.m_klobuchar.beta3 };
+
+    // New model parameters invalidate all the passes.
+    for( i = 0; i < 8; i++ )
+    {
+      if( cache.klobuchar[i] != klobuchar[i] )
+        break;
+    }
+    if( i != 8 )
+    {
+      for( i = 0; i < 8; i++ )
+        cache.klobuchar[i] = klobuchar[i];
+      for( i = 0; i < GNSS_RxData::struct_AtmosphericCorrectionCache::NR_PRNS; i++ )
+      {
+        cache.isIonoValid[i] = false;
+        cache.isIonoRateValid[i] = false;
+      }
+    }
+
+    if( prn < GNSS_RxData::struct_AtmosphericCorrectionCache::NR_PRNS && cache.isIonoValid[prn] && cache.isIonoRateValid[prn] )
+    {
+      dt = t - cache.ionoTime[prn];
+      if( dt >= 0 && dt < cache.ionoRefreshInterval )
+      {
+        iono = cache.iono[prn] + cache.ionoRate[prn]*dt;
+        isPrediction = true;
+        cache.nrIonoPredictions++;
+        if( !cache.checkAccuracy )
+          return true;
+      }
+    }
+
+    result = IONOSPHERE_GetL1KlobucharCorrection(
+      rxData.m_klobuchar.alpha0,
+      rxData.m_klobuchar.alpha1,
+      rxData.m_klobuchar.alpha2,
+      rxData.m_klobuchar.alpha3,
+      rxData.m_klobuchar.beta0,
+      rxData.m_klobuchar.beta1,
+      rxData.m_klobuchar.beta2,
+      rxData.m_klobuchar.beta3,
+      latitude,
+      longitude, 
+      elevation,
+      azimuth,
+      gps_tow,
+      &direct
+      );
+    if( result == FALSE )
+    {
+      GNSS_ERROR_MSG( "IONOSPHERE_GetL1KlobucharCorrection returned FALSE." );
+      return false;
+    }
+
+    if( isPrediction )
+    {
+      // Only here if checking the accuracy.
+      if( fabs( iono - direct ) > cache.maxIonoError )
+        cache.maxIonoError = fabs( iono - direct );
+      return true;
+    }
+
+    iono = direct;
+    cache.nrIonoComputations++;
+    if( prn >= GNSS_RxData::struct_AtmosphericCorrectionCache::NR_PRNS )
+      return true;
+
+    // A gap longer than two refresh intervals starts a new pass.
+    dt = t - cache.ionoTime[prn];
+    if( cache.isIonoValid[prn] && dt > 0 && dt <= 2.0*cache.ionoRefreshInterval )
+    {
+      cache.ionoRate[prn] = ( direct - cache.iono[prn] ) / dt;
+      cache.isIonoRateValid[prn] = true;
+    }
+    else
+    {
+      cache.ionoRate[prn] = 0;
+      cache.isIonoRateValid[prn] = false;
+    }
+    cache.iono[prn] = direct;
+    cache.ionoTime[prn] = t;
+    cache.isIonoValid[prn] = true;
+
     return true;
   }
 
@@ -2015,6 +2664,7 @@ namespace GNSS
     double lat = 0;
     double lon = 0;
     double hgt = 0;
+    const GEODESY_structLocalFrame* frame = NULL;
 
     // Check the index.
     if( index < 0 || index >= GNSS_RXDATA_NR_CHANNELS )
@@ -2036,6 +2686,13 @@ namespace GNSS
       hgt = rxData.m_pvt.height;
     }
 
+    frame = GetLocalFrame( rxData, isLeastSquares );
+    if( frame == NULL )
+    {
+      GNSS_ERROR_MSG( "GetLocalFrame returned NULL." );
+      return false;
+    }
+
     // Compute the design matrix for the position solution.
     if( rxData.m_ObsArray[index].flags.isActive )
     {
@@ -2043,10 +2700,8 @@ namespace GNSS
       {
         if( rxData.m_ObsArray[index].flags.isPsrUsedInSolution )
         {
-          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight(
-            lat,
-            lon,
-            hgt,
+          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight_UsingTheLocalFrame(
+            frame,
             rxData.m_ObsArray[index].satellite.x,
             rxData.m_ObsArray[index].satellite.y,
             rxData.m_ObsArray[index].satellite.z,
@@ -2082,6 +2737,8 @@ namespace GNSS
 
   bool GNSS_Estimator::DetermineDesignMatrixElement_GPSL1_Adr( GNSS_RxData &rxData, const unsigned int index )
   {
+    const GEODESY_structLocalFrame* frame = NULL;
+
     // Check the index.
     if( index < 0 || index >= GNSS_RXDATA_NR_CHANNELS )
     {
@@ -2089,6 +2746,13 @@ namespace GNSS
       return false;
     }
 
+    frame = GetLocalFrame( rxData, false );
+    if( frame == NULL )
+    {
+      GNSS_ERROR_MSG( "GetLocalFrame returned NULL." );
+      return false;
+    }
+
     // Compute the design matrix for the position solution.
     if( rxData.m_ObsArray[index].flags.isActive )
     {
@@ -2096,10 +2760,8 @@ namespace GNSS
       {
         if( rxData.m_ObsArray[index].flags.isAdrUsedInSolution )
         {
-          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight(
-            rxData.m_pvt.latitude,
-            rxData.m_pvt.longitude, 
-            rxData.m_pvt.height,
+          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight_UsingTheLocalFrame(
+            frame,
             rxData.m_ObsArray[index].satellite.x,
             rxData.m_ObsArray[index].satellite.y,
             rxData.m_ObsArray[index].satellite.z,
@@ -2380,6 +3042,7 @@ namespace GNSS
   {
     unsigned i = 0;
     unsigned j = 0;
+    int index_base = 0;
 
     if( rxData == NULL || rxBaseData == NULL )
     {
@@ -2410,41 +3073,42 @@ namespace GNSS
       if( rxData->m_ObsArray[i].flags.isActive )
       {
         // Look for a matching differential channel in the base station data.
-        for( j = 0; j < rxBaseData->m_nrValidObs; j++ )
+        index_base = rxBaseData->GetChannelIndex( 
+          rxData->m_ObsArray[i].system, rxData->m_ObsArray[i].id, rxData->m_ObsArray[i].freqType );
+        while( index_base >= 0 && 
+          !( rxBaseData->m_ObsArray[index_base].flags.isActive && 
+          rxData->m_ObsArray[i].codeType == rxBaseData->m_ObsArray[index_base].codeType ) )
         {
-          if( rxBaseData->m_ObsArray[j].flags.isActive )
-          {
-            if( rxData->m_ObsArray[i].system == rxBaseData->m_ObsArray[j].system &&
-              rxData->m_ObsArray[i].codeType == rxBaseData->m_ObsArray[j].codeType &&
-              rxData->m_ObsArray[i].freqType == rxBaseData->m_ObsArray[j].freqType &&
-              rxData->m_ObsArray[i].id       == rxBaseData->m_ObsArray[j].id )
-            {
-              rxData->m_ObsArray[i].index_differential     = j;
-              rxBaseData->m_ObsArray[j].index_differential = i;
-
-              if( rxData->m_ObsArray[i].flags.isPsrUsedInSolution &&
-                rxBaseData->m_ObsArray[j].flags.isPsrUsedInSolution )
-              {
-                rxData->m_ObsArray[i].flags.isDifferentialPsrAvailable = 1;
-                rxBaseData->m_ObsArray[j].flags.isDifferentialPsrAvailable = 1;
-              }
+          // A duplicate channel of this satellite or another code type on this frequency.
+          index_base = rxBaseData->GetNextChannelIndex( index_base );
+        }
+        if( index_base >= 0 &&
+          rxBaseData->m_ObsArray[index_base].flags.isActive &&
+          rxData->m_ObsArray[i].codeType == rxBaseData->m_ObsArray[index_base].codeType )
+        {
+          j = index_base;
+          rxData->m_ObsArray[i].index_differential     = j;
+          rxBaseData->m_ObsArray[j].index_differential = i;
 
-              if( rxData->m_ObsArray[i].flags.isDopplerUsedInSolution &&
-                rxBaseData->m_ObsArray[j].flags.isDopplerUsedInSolution )
-              {
-                rxData->m_ObsArray[i].flags.isDifferentialDopplerAvailable = 1;
-                rxBaseData->m_ObsArray[j].flags.isDifferentialDopplerAvailable = 1;
-              }
+          if( rxData->m_ObsArray[i].flags.isPsrUsedInSolution &&
+            rxBaseData->m_ObsArray[j].flags.isPsrUsedInSolution )
+          {
+            rxData->m_ObsArray[i].flags.isDifferentialPsrAvailable = 1;
+            rxBaseData->m_ObsArray[j].flags.isDifferentialPsrAvailable = 1;
+          }
 
-              if( rxData->m_ObsArray[i].flags.isAdrUsedInSolution &&
-                rxBaseData->m_ObsArray[j].flags.isAdrUsedInSolution )
-              {
-                rxData->m_ObsArray[i].flags.isDifferentialAdrAvailable = 1;
-                rxBaseData->m_ObsArray[j].flags.isDifferentialAdrAvailable = 1;
-              }
+          if( rxData->m_ObsArray[i].flags.isDopplerUsedInSolution &&
+            rxBaseData->m_ObsArray[j].flags.isDopplerUsedInSolution )
+          {
+            rxData->m_ObsArray[i].flags.isDifferentialDopplerAvailable = 1;
+            rxBaseData->m_ObsArray[j].flags.isDifferentialDopplerAvailable = 1;
+          }
 
-              break;
-            }
+          if( rxData->m_ObsArray[i].flags.isAdrUsedInSolution &&
+            rxBaseData->m_ObsArray[j].flags.isAdrUsedInSolution )
+          {
+            rxData->m_ObsArray[i].flags.isDifferentialAdrAvailable = 1;
+            rxBaseData->m_ObsArray[j].flags.isDifferentialAdrAvailable = 1;
           }
         }
       }
@@ -3274,28 +3938,20 @@ namespace GNSS
     const bool isLeastSquares  //!< A boolean to indicate if the rover position and velocity values are from least squares rxData->m_pvt_lsq or from rxData->m_pvt.
     )
   {
-    double lat = 0;
-    double lon = 0;
-    double hgt = 0;
+    const GEODESY_structLocalFrame* frame = NULL;
 
     // Check the index.
     if( index < 0 || index >= GNSS_RXDATA_NR_CHANNELS )
     {
       GNSS_ERROR_MSG( "if( index < 0 || index >= GNSS_RXDATA_NR_CHANNELS )" );
-      return false;
-    }
-
-    if( isLeastSquares )
-    {
-      lat = rxData.m_pvt_lsq.latitude;
-      lon = rxData.m_pvt_lsq.longitude;
-      hgt = rxData.m_pvt_lsq.height;
+      return false;
     }
-    else
+
+    frame = GetLocalFrame( rxData, isLeastSquares );
+    if( frame == NULL )
     {
-      lat = rxData.m_pvt.latitude;
-      lon = rxData.m_pvt.longitude;
-      hgt = rxData.m_pvt.height;
+      GNSS_ERROR_MSG( "GetLocalFrame returned NULL." );
+      return false;
     }
     
     // Compute the design matrix row for the velocity solution.
@@ -3305,10 +3961,8 @@ namespace GNSS
       {
         if( rxData.m_ObsArray[index].flags.isDopplerUsedInSolution )
         {
-          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight(
-            lat,
-            lon, 
-            hgt,
+          NAVIGATION_ComputeDerivativesOf_Range_WithRespectToLatitudeLongitudeHeight_UsingTheLocalFrame(
+            frame,
             rxData.m_ObsArray[index].satellite.x,
             rxData.m_ObsArray[index].satellite.y,
             rxData.m_ObsArray[index].satellite.z,
@@ -3346,93 +4000,68 @@ namespace GNSS
   }
 
 
-  bool GNSS_Estimator::PerformGlobalTestAndTestForMeasurementFaults( 
+  bool GNSS_Estimator::PerformFaultDetectionAndExclusion_UsingRankOneDowndates( 
     GNSS_RxData &rxData,           //!< The receiver data object.
     bool testPsrOrDoppler,         //!< This indicates if the psr misclosures are checked, otherwise the Doppler misclosures are checked. 
     Matrix& H,                     //!< The design matrix, H,                           [n x u].
-    Matrix& Ht,                    //!< The design matrix transposed, H,                [n x u].
-    Matrix& W,                     //!< The observation weight matrix, W,               [n x n].
-    Matrix& R,                     //!< The observation variance-covariance matrix, R,  [n x n].
+    Matrix& R,                     //!< The observation variance-covariance matrix, R,  [n x n] (diagonal).
     Matrix& r,                     //!< The observation residual vector,                [n x 1].
     Matrix& P,                     //!< The state variance-covariance matrix,           [u x u].
     const unsigned char n,         //!< The number of observations, n.
     const unsigned char u,         //!< The number of unknowns, u.
-    double &avf,                   //!< The computed a-posteriori variance factor is returned.
-    bool &isGlobalTestPassed,      //!< This indicates if the global test passed.    
-    bool &hasRejectionOccurred,    //!< This indicates if a rejection occurred. Only one measurement is flagged.
-    unsigned char &indexOfRejected //!< This is the index of the rejected observation.
+    double &avf,                   //!< The a-posteriori variance factor after all exclusions is returned.
+    bool &isGlobalTestPassed,      //!< This indicates if the global test passed after all exclusions.
+    unsigned char &nrRejected      //!< The number of measurements rejected.
     )
   {
-    double v = n-u; // The degree of freedom.
+    const unsigned max_n = GNSS_RXDATA_NR_CHANNELS+4; // The maximum number of rows, measurements and constraints.
 
     unsigned i = 0;
-    unsigned j = 0; 
+    unsigned j = 0;
+    unsigned k = 0;
+    unsigned nrActive = n;   // The number of rows not yet excluded.
+    unsigned nrTestable = 0; // The number of rows that are measurements, constraints are after these and can't be rejected.
     unsigned indexvec[GNSS_RXDATA_NR_CHANNELS]; // An array with the indices measurements that are used in solution.
-
+    
+    bool isActive[max_n];    // Indicates if a row is still in the solution.
+    double res[max_n];       // The residuals, updated with each exclusion.
+    double Cr[max_n];        // The diagonal of the residual variance-covariance matrix, updated with each exclusion.
+    double hg[max_n];        // h_i*g for the current exclusion.
+    double g[8];             // g = P*h_k' for the current exclusion.
+    double Pk[8][8];         // The state variance-covariance matrix, downdated with each exclusion.
+
+    double v = 0;            // The degree of freedom.
+    double sum = 0;          // A temporary sum.
     double rv = 0;           // An unsigned standardized residual value.
     double largest_rv = 0.0; // The largest unsigned standardized residual value.    
-    unsigned char indexOfLargest = 0; // The index of the largest standardized residual value.  
+    unsigned indexOfLargest = 0; // The row index of the largest standardized residual value.  
 
-    double chiSquaredValue = 0;                     // The chi squared test value = look up table value / degrees of freedom.
     double chiSquared005[31] = GNSS_CHISQUARE_00_5; // The chi squared look up table for alpha = 0.005.
     
     // Initial output values.
+    avf = 0.0;
     isGlobalTestPassed = false;
-    hasRejectionOccurred = false;      
-    
-    Matrix Cr;             // The variance-covariance matrix of the residuals [n x n].
-    Matrix rT;             // The residuals vector transposed,                [1 x n]
-    Matrix r_standardized; // The standardized residuals,                     [n x 1].
-    Matrix tmpM;
-
-    i = static_cast<unsigned>(v);
-    if( i == 0 )
-      return true; 
-    
-    rT = r;
-    if( !rT.Inplace_Transpose() )
-    {
-      GNSS_ERROR_MSG( "if( !rT.Inplace_Transpose() )" );
-      return false;
-    }
+    nrRejected = 0;
 
-    // Compute the a-posteriori variance factor.
-    tmpM = rT * W * r;
-    avf = tmpM[0] / v;
-    
-    // Determine the chi squared test statistic value.
-    i = static_cast<unsigned>(v);
-    if( i < 0 || i > 30 )
-    {
-      GNSS_ERROR_MSG( "if( i < 0 || i > 30 )" );
-      return false;
-    }
-    chiSquaredValue = chiSquared005[i];
-    chiSquaredValue /= v;
-    
-    // Perform the Global Test.
-    if( avf < chiSquaredValue )
+    if( n <= u )
     {
-      // The Global test passes. No local test will be performed.
       isGlobalTestPassed = true;
       return true;
     }
-
-    // Check that there is enough redudancy to remove outliers.
-    i = static_cast<unsigned>(v);
-    if( i <= 0 )
+    if( n > max_n || u > 8 )
     {
-      return true;
+      GNSS_ERROR_MSG( "if( n > max_n || u > 8 )" );
+      return false;
+    }
+    if( H.GetNrRows() != n || H.GetNrCols() != u || R.GetNrRows() != n || r.GetNrRows() != n || P.GetNrRows() != u || P.GetNrCols() != u )
+    {
+      GNSS_ERROR_MSG( "Inconsistent matrix dimensions." );
+      return false;
     }
-
-    
-    ////
-    // Perform the local test.
 
     // Determine the indices of the observations that match the
     // values in the residuals vector.
-    j = 0;
-    for( i = 0; i < rxData.m_nrValidObs; i++ )
+    for( i = 0; i < rxData.m_nrValidObs && nrTestable < GNSS_RXDATA_NR_CHANNELS; i++ )
     {
       if( rxData.m_ObsArray[i].flags.isActive )
       {
@@ -3442,92 +4071,154 @@ namespace GNSS
           {
             if( rxData.m_ObsArray[i].flags.isPsrUsedInSolution )
             {
-              indexvec[j] = i;
-              j++;
+              indexvec[nrTestable] = i;
+              nrTestable++;
             }
           }
           else
           {
             if( rxData.m_ObsArray[i].flags.isDopplerUsedInSolution )
             {
-              indexvec[j] = i;
-              j++;
+              indexvec[nrTestable] = i;
+              nrTestable++;
             }
           }
         }        
       }
     }
-    
-    
-    // Compute the variance-covariance of the residuals.
-    Cr = R - H * P * Ht;
-
-    PrintMatToDebug( "Cr", Cr, 3 );
-
+    if( nrTestable > n )
+      nrTestable = n;
 
-    // Check the diagonal of Cr for zero and negative values, an error condition.
-    for( i = 0; i < Cr.GetNrRows(); i++ )
+    for( i = 0; i < u; i++ )
     {
-      if( Cr[i][i] <= 0.0 )
+      for( j = 0; j < u; j++ )
       {
-        GNSS_ERROR_MSG( "if( Cr[i][i] <= 0.0 )" );
-        return false;
+        Pk[i][j] = P[i][j];
       }
     }
 
-    
-    if( !r_standardized.Resize( Cr.GetNrRows(), 1) )
+    // Cr_ii = R_ii - h_i*P*h_i'.
+    for( i = 0; i < n; i++ )
     {
-      GNSS_ERROR_MSG( "if( !r_standardized.Resize( Cr.GetNrRows(), 1) )" );
-      return false;
+      isActive[i] = true;
+      res[i] = r[i];
+      
+      if( R[i][i] <= 0.0 )
+      {
+        GNSS_ERROR_MSG( "if( R[i][i] <= 0.0 )" );
+        return false;
+      }
+      sum = 0.0;
+      for( j = 0; j < u; j++ )
+      {
+        for( k = 0; k < u; k++ )
+        {
+          sum += H[i][j] * Pk[j][k] * H[i][k];
+        }
+      }
+      Cr[i] = R[i][i] - sum;
     }
 
-    // Compute the standardized residuals, r(i) /= Cr(i,i).
-    // Determine the largest standardized residual value.
-    for( i = 0; i < Cr.GetNrRows(); i++ )
+    while( true )
     {
-      r_standardized[i] = r[i] / sqrt( Cr[i][i] );
-
-      rv = fabs( r_standardized[i] );
+      // The Global Test.
+      if( nrActive <= u )
+      {
+        // No redundancy left.
+        isGlobalTestPassed = true;
+        return true;
+      }
+      v = nrActive - u;
+      sum = 0.0;
+      for( i = 0; i < n; i++ )
+      {
+        if( isActive[i] )
+          sum += res[i]*res[i] / R[i][i];
+      }
+      avf = sum / v;
+      if( v > 30 )
+      {
+        // Beyond the look up table, use the value for 30 degrees of freedom.
+        if( avf < chiSquared005[30] / 30.0 )
+        {
+          isGlobalTestPassed = true;
+          return true;
+        }
+      }
+      else if( avf < chiSquared005[static_cast<unsigned>(v)] / v )
+      {
+        isGlobalTestPassed = true;
+        return true;
+      }
 
-      // don't allow the position constraint to be rejected.
-      if( rxData.m_pvt.isPositionConstrained )
+      // The local test.
+      largest_rv = 0.0;
+      for( i = 0; i < nrTestable; i++ )
       {
-        if( i >= Cr.GetNrRows() -3 )
+        if( !isActive[i] )
           continue;
+        if( Cr[i] <= 1.0e-12 * R[i][i] )
+          continue; // This measurement has no redundancy left and can't be tested.
+        rv = fabs( res[i] ) / sqrt( Cr[i] );
+        if( rv > largest_rv )
+        {
+          largest_rv = rv;
+          indexOfLargest = i;
+        }
       }
 
-      if( rv > largest_rv )
+      // In reliability testing, alpha = 0.005, n_(1-alpha/2) = 4.57
+      if( largest_rv <= 4.57 ) // reject only clear blunders
       {
-        largest_rv = rv;
-        indexOfLargest = i; // This is the index into r.
+        return true;
       }
-    }
-    indexOfLargest = indexvec[indexOfLargest]; // This is the index into the observation array.
-
-    // sanity index check
-    if( indexOfLargest >= rxData.m_nrValidObs )
-    {
-      GNSS_ERROR_MSG( "if( indexOfLargest >= rxData.m_nrValidObs )" );
-      return false;
-    }
-
-    PrintMatToDebug( "r", r, 3 );
-    PrintMatToDebug( "r_standardized", r_standardized, 3 );
-    
-    // In reliability testing, alpha = 0.005, n_(1-alpha/2) = 4.57
-    if( largest_rv > 4.57 ) // reject only clear blunders
-    {
-      // An observation will be rejected.
-      hasRejectionOccurred = true;      
 
+      k = indexOfLargest;
+      if( indexvec[k] >= rxData.m_nrValidObs )
+      {
+        GNSS_ERROR_MSG( "if( indexvec[k] >= rxData.m_nrValidObs )" );
+        return false;
+      }
       if( testPsrOrDoppler ) // true is pseudorange
-        rxData.m_ObsArray[indexOfLargest].flags.isNotPsrRejected = 0;
+        rxData.m_ObsArray[indexvec[k]].flags.isNotPsrRejected = 0;
       else
-        rxData.m_ObsArray[indexOfLargest].flags.isNotDopplerRejected = 0;      
-    }
+        rxData.m_ObsArray[indexvec[k]].flags.isNotDopplerRejected = 0;
+      nrRejected++;
 
-    return true;
+      isActive[k] = false;
+      nrActive--;
+      if( nrActive <= u )
+        continue; // no redundancy left, there is nothing more to update.
+
+      // The rank one downdate.
+      for( i = 0; i < u; i++ )
+      {
+        g[i] = 0.0;
+        for( j = 0; j < u; j++ )
+        {
+          g[i] += Pk[i][j] * H[k][j];
+        }
+      }
+      for( i = 0; i < n; i++ )
+      {
+        if( !isActive[i] )
+          continue;
+        hg[i] = 0.0;
+        for( j = 0; j < u; j++ )
+        {
+          hg[i] += H[i][j] * g[j];
+        }
+        res[i] += hg[i] * res[k] / Cr[k];
+        Cr[i]  -= hg[i] * hg[i] / Cr[k];
+      }
+      for( i = 0; i < u; i++ )
+      {
+        for( j = 0; j < u; j++ )
+        {
+          Pk[i][j] += g[i] * g[j] / Cr[k];
+        }
+      }
+    }
   }
 
 
@@ -3599,7 +4290,7 @@ namespace GNSS
       double eVe = 0;
       double eVup = 0;
       double eClkDrift = 0;
-      const unsigned int u = 8 + static_cast<unsigned int>(m_ActiveAmbiguitiesList.size());
+      const unsigned int u = GetStateDimension_RTK( true );
 
       m_RTK.T.Identity( u );
 
@@ -3631,7 +4322,7 @@ namespace GNSS
     }
     else if( m_FilterType == GNSS_FILTER_TYPE_RTK4 )
     {
-      const unsigned int u = 4 + static_cast<unsigned int>(m_ActiveAmbiguitiesList.size());
+      const unsigned int u = GetStateDimension_RTK( false );
       m_RTK.T.Identity( u );
       return true;
     }
@@ -3751,7 +4442,7 @@ namespace GNSS
       double eVup2 = 0;
       double eClkDrift2 = 0;
 
-      const unsigned int u = 8 + static_cast<unsigned int>(m_ActiveAmbiguitiesList.size());
+      const unsigned int u = GetStateDimension_RTK( true );
 
       if( m_RTK.Q.nrows() != u )
       {
@@ -3818,7 +4509,7 @@ namespace GNSS
       const double qHgt = dT * m_FourStateRandomWalkKalmanModel.sigmaUp    * m_FourStateRandomWalkKalmanModel.sigmaUp;    // The process noise value for up.
       const double qClk = dT * m_FourStateRandomWalkKalmanModel.sigmaClock * m_FourStateRandomWalkKalmanModel.sigmaClock; // The process noise value for clock offset.
 
-      const unsigned int u = 4 + static_cast<unsigned int>(m_ActiveAmbiguitiesList.size());
+      const unsigned int u = GetStateDimension_RTK( false );
 
       if( m_RTK.Q.nrows() != u )
       {
@@ -4230,7 +4921,7 @@ namespace GNSS
       GNSS_ERROR_MSG( "DetermineSatellitePVT_GPSL1 returned false." );
       return false;
     }
-    result = DetermineAtmosphericCorrections_GPSL1( *rxData, false );
+    result = DetermineAtmosphericCorrections_GPSL1( *rxData, false, isDifferential ? rxBaseData : NULL );
     if( !result )
     {
       GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
@@ -4269,13 +4960,6 @@ namespace GNSS
 
     if( isDifferential )
     {
-      result = DetermineAtmosphericCorrections_GPSL1( *rxBaseData, false );
-      if( !result )
-      {
-        GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
-        return false;
-      }
-      
       if( !DetermineUsablePseudorangeMeasurementsForThePositionSolution_GPSL1(
         *rxBaseData, 
         rxBaseData->m_pvt.nrPsrObsUsed, 
@@ -4857,7 +5541,7 @@ namespace GNSS
       GNSS_ERROR_MSG( "DetermineSatellitePVT_GPSL1 returned false." );
       return false;
     }
-    result = DetermineAtmosphericCorrections_GPSL1( *rxData, false );
+    result = DetermineAtmosphericCorrections_GPSL1( *rxData, false, isDifferential ? rxBaseData : NULL );
     if( !result )
     {
       GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
@@ -4902,13 +5586,6 @@ namespace GNSS
 
     if( isDifferential )
     {
-      result = DetermineAtmosphericCorrections_GPSL1( *rxBaseData, false );
-      if( !result )
-      {
-        GNSS_ERROR_MSG( "DetermineAtmosphericCorrections_GPSL1 returned false." );
-        return false;
-      }
-
       if( !DetermineUsablePseudorangeMeasurementsForThePositionSolution_GPSL1(
         *rxBaseData, 
         rxBaseData->m_pvt.nrPsrObsUsed, 
@@ -5271,13 +5948,12 @@ namespace GNSS
     if( nrDifferentialAdr > 0 )
       amb.Resize(nrDifferentialAdr,2);
 
-    if( isEightStateModel )
-    {
-      u = 8 + nrDifferentialAdr;
-    }
-    else
+    // The state dimension includes the free ambiguity slots. Their columns in H are zero.
+    u = GetStateDimension_RTK( isEightStateModel );
+    if( m_RTK.P.nrows() != u )
     {
-      u = 4 + nrDifferentialAdr;
+      GNSS_ERROR_MSG( "if( m_RTK.P.nrows() != u )" );
+      return false;
     }
 
     if( !m_RTK.H.Resize( n, u ) )
@@ -5815,30 +6491,38 @@ namespace GNSS
         return false;
       }
 
-      m_RTK.x.Redim( 4+nrDifferentialAdr, 1 );
+      // The ambiguities are at their slots in the state vector, free slots are zero.
+      if( !m_RTK.x.Resize( u, 1 ) )
+      {
+        GNSS_ERROR_MSG( "if( !m_RTK.x.Resize( u, 1 ) )" );
+        return false;
+      }
       m_RTK.x[0] = rxData->m_pvt.latitude;
       m_RTK.x[1] = rxData->m_pvt.longitude;
       m_RTK.x[2] = rxData->m_pvt.height;
       m_RTK.x[3] = rxData->m_pvt.clockOffset;
 
-      k = 4;
       for( i = 0; i < rxData->m_nrValidObs; i++ )
       {
         if( rxData->m_ObsArray[i].flags.isActive &&                    
           rxData->m_ObsArray[i].flags.isAdrUsedInSolution )
         {
-          m_RTK.x[k] = rxData->m_ObsArray[i].ambiguity;
-          k++;
+          if( rxData->m_ObsArray[i].index_ambiguity_state < 0 || 
+            static_cast<unsigned>(rxData->m_ObsArray[i].index_ambiguity_state) >= u )
+          {
+            GNSS_ERROR_MSG( "Unexpected - invalid ambiguity state index." );
+            return false;
+          }
+          m_RTK.x[rxData->m_ObsArray[i].index_ambiguity_state] = rxData->m_ObsArray[i].ambiguity;
         }
       }       
 
       
-      // Form the double difference ambiguities and the transformation matrix for the 
+      // Form the double difference ambiguities and the double difference operator for the 
       // state variance covariance matrix.
-      Matrix D( 4+nrDifferentialAdr-2, 4+nrDifferentialAdr );
 
       // e.g.
-      // D = [1 0 0 0 ...
+      // B = [1 0 0 0 ...
       //      0 1 0 0 ...
       //      0 0 1 0 ...
       //      0 0 0 0 -1 1 0 0 0 0 ...
@@ -5848,10 +6532,12 @@ namespace GNSS
       // Retains the position states. 
       // Removes the clock state. 
       // Performs the ambiguity state differencing.
+      // Only the state indices are kept, B is never formed.
 
-      D[0][0] = 1;
-      D[1][1] = 1;
-      D[2][2] = 1;
+      m_RTKDD.B.Clear();
+      m_RTKDD.B.AddKept( 0 );
+      m_RTKDD.B.AddKept( 1 );
+      m_RTKDD.B.AddKept( 2 );
       
       int state_index_base = rxData->m_ObsArray[index_base].index_ambiguity_state;
       if( state_index_base < 0 )
@@ -5859,10 +6545,9 @@ namespace GNSS
         GNSS_ERROR_MSG( "Unexpected - state index of the base satellite ambiguity is invalid." );        
         return false;
       }
+      m_RTKDD.B.SetBase( state_index_base );
 
-      //m_RTKDD.x.Resize( 3 + nrDifferentialAdr - 1 );
-
-      int state_index = 0;
+      std::vector<unsigned> ambiguityIds; // The satellite of each double difference ambiguity.
       k = 3;
       for( i = 0; i < rxData->m_nrValidObs; i++ )
       {
@@ -5875,26 +6560,31 @@ namespace GNSS
           // compute the double difference ambiguity
           rxData->m_ObsArray[i].ambiguity_dd = rxData->m_ObsArray[i].ambiguity - rxData->m_ObsArray[index_base].ambiguity;
 
-          D[k][state_index_base] = -1;
-          D[k][rxData->m_ObsArray[i].index_ambiguity_state] = 1;
+          m_RTKDD.B.AddDifference( rxData->m_ObsArray[i].index_ambiguity_state );
           rxData->m_ObsArray[i].index_ambiguity_state_dd = k;
+          ambiguityIds.push_back( rxData->m_ObsArray[i].id );
           k++;           
         }
       }  
 
-      // D.Print( "D.txt", 6 );
-
-      m_RTKDD.P = D*m_RTK.P*D.Transpose();
-      m_RTKDD.x = D*m_RTK.x;
+      // m_RTKDD.P = B*m_RTK.P*B^T and m_RTKDD.x = B*m_RTK.x
+      if( !m_RTKDD.B.ApplyToCovariance( m_RTK.P, m_RTKDD.P ) )
+      {
+        GNSS_ERROR_MSG( "if( !m_RTKDD.B.ApplyToCovariance( m_RTK.P, m_RTKDD.P ) )" );
+        return false;
+      }
+      if( !m_RTKDD.B.ApplyToRows( m_RTK.x, m_RTKDD.x ) )
+      {
+        GNSS_ERROR_MSG( "if( !m_RTKDD.B.ApplyToRows( m_RTK.x, m_RTKDD.x ) )" );
+        return false;
+      }
      
       // m_RTK.P.Print( "P.txt", 8 );
       //m_RTKDD.P.Print( "Pdd.txt", 8 );            
 
       Matrix Q;  // Variance/covariance matrux of ambiguities (original)
-      Matrix Z;  // Z-transformation matrix
       Matrix a;  // The ambiguities 
       Matrix afixed;
-      Matrix Qahat;
       Matrix sqnorm;
       
       // Extract Q from P
@@ -5915,14 +6605,34 @@ namespace GNSS
       //a.Print( "a.txt", 18 );
 
       Matrix a_tmp = a;
+      bool isPositiveDefinite = true;
 
-      result = LAMBDA::lambda1( a, Q, 2, afixed, sqnorm, Qahat, Z ); 
+      if( m_DeadlineControl.skipAmbiguitySearch || 
+        ( m_DeadlineControl.searchDeadline > 0 && GNSS_Profiler::GetTime() > m_DeadlineControl.searchDeadline ) )
+      {
+        // Real time degraded mode, the float ambiguities are kept.
+        afixed = a_tmp;
+        m_AmbiguityResolver.m_nrFixed = 0;
+        m_AmbiguityResolver.m_nrSearchNodes = 0;
+        m_DeadlineControl.nrSkippedSearches++;
+        result = true;
+      }
+      else
+      {
+        GNSS_PROFILE_SCOPE( m_Profiler, GNSS_PROFILE_AMBIGUITY );
+        result = m_AmbiguityResolver.Resolve( ambiguityIds, rxData->m_ObsArray[index_base].id, a, Q, 2, afixed, sqnorm, isPositiveDefinite );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "m_AmbiguityResolver.Resolve returned false." );
+          return false;
+        }
+        // If Q is not positive definite, afixed is the float ambiguities 
+        // and nothing is fixed this epoch.
+      }
+      rxData->m_nrFixedAmbiguities = m_AmbiguityResolver.m_nrFixed;
+      rxData->m_nrAmbiguitySearchNodes = m_AmbiguityResolver.m_nrSearchNodes;
 
-      //a.Print( "a_postLambda.txt", 9 );
-      //Q.Print( "Q_postLambda.txt", 9 );
       //afixed.Print( "a_fixed.txt", 9 );    
-      //Qzhat.Print( "Qahat.txt", 9 );
-      //Z.Print( "Z.txt", 4 );
       //sqnorm.Print( "sqnorm.txt", 9 );
 
       // Extract Q from P, Q with meter units
@@ -5930,13 +6640,13 @@ namespace GNSS
 
       // compute the fixed solution 
       Matrix Qba;
-      Matrix Qab;
+      Matrix Qb;
+      Matrix Qb_given_a;
       Matrix delta_b;
       Matrix delta_a;
       result = m_RTKDD.P.ExtractSubMatrix( Qba, 0, 3, 2, n+2 );
-      Qab = Qba.Transpose();
+      result = m_RTKDD.P.ExtractSubMatrix( Qb, 0, 0, 2, 2 );
 
-      //Qab.Print( "Qab.txt" );
       //Qba.Print( "Qba.txt" );
       //a_tmp.Print( "A_tmp.txt" );
       
@@ -5949,7 +6659,46 @@ namespace GNSS
 
       //delta_a.Print( "delta_a_1.txt" );
 
-      delta_b = Qba * Q.Inv() * delta_a;
+      if( m_AmbiguityResolver.m_nrFixed == n )
+      {
+        // delta_b = Qba * inv(Q) * delta_a and Qb_given_a = Qb - Qba * inv(Q) * Qab 
+        // from one factorization of Q.
+        result = GNSS_AmbiguityResolver::ComputeConditionalBaseline( Qb, Qba, Q, delta_a, delta_b, Qb_given_a );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "GNSS_AmbiguityResolver::ComputeConditionalBaseline returned false." );
+          return false;
+        }
+      }
+      else if( m_AmbiguityResolver.m_nrFixed > 0 )
+      {
+        // Partial fix. Condition on the fixed subset zs = Zs^T * a.
+        Matrix Zs;
+        Matrix Qz;
+        Matrix Qbz;
+        Matrix delta_z;
+        if( !m_AmbiguityResolver.GetFixedSubsetTransformation( Zs ) )
+        {
+          GNSS_ERROR_MSG( "m_AmbiguityResolver.GetFixedSubsetTransformation returned false." );
+          return false;
+        }
+        Qz = Zs.Transpose() * Q * Zs;
+        Qbz = Qba * Zs;
+        delta_z = Zs.Transpose() * delta_a;
+        result = GNSS_AmbiguityResolver::ComputeConditionalBaseline( Qb, Qbz, Qz, delta_z, delta_b, Qb_given_a );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "GNSS_AmbiguityResolver::ComputeConditionalBaseline returned false." );
+          return false;
+        }
+      }
+      else
+      {
+        // No subset could be fixed within the search limits. 
+        // The fixed solution is the float solution.
+        delta_b.Resize( 3, 1 );
+        Qb_given_a = Qb;
+      }
 
       //delta_b.Print( "delta_b.txt" );
 
@@ -5961,11 +6710,6 @@ namespace GNSS
       lon_check = rxData->m_pvt.longitude + delta_b[1] / dlon;  // convert from meters to radians.
       hgt_check = rxData->m_pvt.height + delta_b[2];
 
-      Matrix Qb_given_a;
-      Matrix Qb;
-      result = m_RTKDD.P.ExtractSubMatrix( Qb, 0, 0, 2, 2 );
-      Qb_given_a = Qb - Qba*Q.Inv()*Qab;
-
       rxData->m_pvt_fixed = rxData->m_pvt;
       
       rxData->UpdatePositionAndRxClock(
@@ -5980,7 +6724,10 @@ namespace GNSS
         rxData->m_pvt.std_clk
         );
 
-      rxData->m_ambiguity_validation_ratio = sqnorm[1] / sqnorm[0];
+      if( m_AmbiguityResolver.m_nrFixed > 0 )
+        rxData->m_ambiguity_validation_ratio = sqnorm[1] / sqnorm[0];
+      else
+        rxData->m_ambiguity_validation_ratio = 0.0;
 
 
       m_RTKDD.x[0] = lat_check;
@@ -6185,14 +6932,21 @@ namespace GNSS
     double sd_psr_measured = 0;
     double sd_dif = 0;
                   
+    int state_index = 0; // The index of the row and column in P for a new ambiguity.
+                  
     std::list<stAmbiguityInfo>::iterator iter;
     std::list<stAmbiguityInfo>::iterator check_iter;
     std::list<stAmbiguityInfo>::iterator remove_iter;
-    std::list<unsigned int> remove_list;
-    std::list<unsigned int>::const_iterator list_iter;
 
     changeOccured = false;
 
+    if( m_AmbiguitySlots.nrNominalStates != (isEightStateModel ? 8u : 4u) ||
+      P.nrows() != GetStateDimension_RTK( isEightStateModel ) )
+    {
+      GNSS_ERROR_MSG( "The ambiguity state slots are inconsistent with P. Was InitializeStateVarianceCovarianceFromLeastSquares_RTK called?" );
+      return false;
+    }
+
     // At this point the active ambiguities are those that were included in the 
     // estimation of the previous epoch. This will change if some of those ambiguites
     // are no longer included in the observations.
@@ -6221,9 +6975,13 @@ namespace GNSS
       {
         changeOccured = true;
 
-        // Add the state_index to the list of indices to be
-        // removed from state variance covariance matrix.        
-        remove_list.push_back( iter->state_index );
+        // Release the slot of this ambiguity in the state variance covariance matrix.
+        // The other ambiguities keep their state indices.
+        if( !ReleaseAmbiguityStateSlot( P, iter->state_index ) )
+        {
+          GNSS_ERROR_MSG( "ReleaseAmbiguityStateSlot returned false." );
+          return false;
+        }
 
         remove_iter = iter;
         ++iter;
@@ -6235,54 +6993,6 @@ namespace GNSS
       }
     }
 
-    // Deal with removing ambiguities from P.
-    if( remove_list.size() > 0 )
-    {
-      unsigned int *rows = NULL;    
-      unsigned int nrows = static_cast<unsigned int>(remove_list.size());
-      rows = new unsigned int[nrows];
-      if( rows == NULL )
-      {
-        GNSS_ERROR_MSG( "if( rows == NULL )" );
-        return false;
-      }
-
-      i = 0;
-      for( list_iter = remove_list.begin(); list_iter != remove_list.end(); ++list_iter )
-      {
-        rows[i] = *list_iter;
-        i++;
-      }
-
-      //P.Print( "P.now.txt", 10 );
-      if( !P.RemoveRowsAndColumns( nrows, rows, nrows, rows ) )
-      {
-        GNSS_ERROR_MSG( "if( !P.RemoveRowsAndColumns( nrows, rows, nrows, rows ) )" );
-        return false;
-      }
-      //P.Print( "P.after.txt", 10 );
-
-      delete [] rows;      
-    }
-
-    if( remove_list.size() > 0 )
-    {
-      // The state indices are in order of the ambiguity list.
-      j = 0;
-      for( iter = m_ActiveAmbiguitiesList.begin(); iter != m_ActiveAmbiguitiesList.end(); ++iter )
-      {
-        if( isEightStateModel )
-        {
-          iter->state_index = 8+j;
-        }
-        else
-        {
-          iter->state_index = 4+j;
-        }
-        j++;
-      }
-    }
-
     for( i = 0; i < rxData->m_nrValidObs; i++ )
     {
       if( rxData->m_ObsArray[i].flags.isActive && rxData->m_ObsArray[i].flags.isAdrUsedInSolution )
@@ -6300,7 +7010,6 @@ namespace GNSS
         }
       }
     }
-    remove_list.clear();
 
     // Deal with cycle slips
     for( i = 0; i < rxData->m_nrValidObs; i++ )
@@ -6389,18 +7098,18 @@ namespace GNSS
               amb_info.id          = rxData->m_ObsArray[i].id;
               amb_info.system      = rxData->m_ObsArray[i].system;
               amb_info.freqType    = rxData->m_ObsArray[i].freqType;
-              amb_info.state_index = P.nrows(); // This will be the index of the row and column in P for this ambiguity.
-
-              rxData->m_ObsArray[i].index_ambiguity_state = amb_info.state_index;
-              
-              m_ActiveAmbiguitiesList.push_back( amb_info );
 
-              // Add a new row and columgn to the state variance-covariance matrix.
-              if( !P.Redim( P.nrows()+1, P.ncols()+1 ) )
+              // Assign a free slot in the state variance-covariance matrix.
+              if( !AllocateAmbiguityStateSlot( P, state_index ) )
               {
-                GNSS_ERROR_MSG( "if( !P.Redim( P.nrows()+1, P.ncols()+1 ) )" );
+                GNSS_ERROR_MSG( "AllocateAmbiguityStateSlot returned false." );
                 return false;
               }
+              amb_info.state_index = state_index; // This is the index of the row and column in P for this ambiguity.
+
+              rxData->m_ObsArray[i].index_ambiguity_state = amb_info.state_index;
+              
+              m_ActiveAmbiguitiesList.push_back( amb_info );
 
               // Set the initial variance of the ambiguity state [m].
               P[amb_info.state_index][amb_info.state_index] = 1000.0; // KO Arbitrary value, to improve
@@ -6456,6 +7165,96 @@ namespace GNSS
 
     return true;
   }
+
+
+  void GNSS_Estimator::ResetAmbiguityStateSlots( 
+    const unsigned nrNominalStates //!< The number of states before the ambiguity states, 4 or 8.
+    )
+  {
+    unsigned i = 0;
+
+    m_ActiveAmbiguitiesList.clear();
+    m_AmbiguitySlots.nrNominalStates = nrNominalStates;
+    m_AmbiguitySlots.nrSlots = 0;
+    m_AmbiguitySlots.nrActive = 0;
+    for( i = 0; i < GNSS_RXDATA_NR_CHANNELS; i++ )
+    {
+      m_AmbiguitySlots.isActive[i] = false;
+    }
+  }
+
+
+  bool GNSS_Estimator::AllocateAmbiguityStateSlot( 
+    Matrix &P,       //!< The state variance-covariance matrix.
+    int &state_index //!< The index of the row and column of P for the ambiguity.
+    )
+  {
+    unsigned slot = 0;
+
+    state_index = -1;
+
+    // The lowest free slot.
+    for( slot = 0; slot < m_AmbiguitySlots.nrSlots; slot++ )
+    {
+      if( !m_AmbiguitySlots.isActive[slot] )
+        break;
+    }
+
+    if( slot == m_AmbiguitySlots.nrSlots )
+    {
+      // Every slot is in use, add a new row and column to the state variance-covariance matrix.
+      if( m_AmbiguitySlots.nrSlots >= GNSS_RXDATA_NR_CHANNELS )
+      {
+        GNSS_ERROR_MSG( "if( m_AmbiguitySlots.nrSlots >= GNSS_RXDATA_NR_CHANNELS )" );
+        return false;
+      }
+      if( !P.Redim( P.nrows()+1, P.ncols()+1 ) )
+      {
+        GNSS_ERROR_MSG( "if( !P.Redim( P.nrows()+1, P.ncols()+1 ) )" );
+        return false;
+      }
+      m_AmbiguitySlots.nrSlots++;
+    }
+
+    m_AmbiguitySlots.isActive[slot] = true;
+    m_AmbiguitySlots.nrActive++;
+    state_index = static_cast<int>( m_AmbiguitySlots.nrNominalStates + slot );
+    return true;
+  }
+
+
+  bool GNSS_Estimator::ReleaseAmbiguityStateSlot( 
+    Matrix &P,             //!< The state variance-covariance matrix.
+    const int state_index  //!< The index of the row and column of P for the ambiguity.
+    )
+  {
+    unsigned i = 0;
+    unsigned slot = 0;
+    
+    if( state_index < static_cast<int>(m_AmbiguitySlots.nrNominalStates) ||
+      state_index >= static_cast<int>(P.nrows()) )
+    {
+      GNSS_ERROR_MSG( "Invalid ambiguity state index." );
+      return false;
+    }
+    slot = static_cast<unsigned>(state_index) - m_AmbiguitySlots.nrNominalStates;
+    if( slot >= m_AmbiguitySlots.nrSlots || !m_AmbiguitySlots.isActive[slot] )
+    {
+      GNSS_ERROR_MSG( "The ambiguity state slot is not active." );
+      return false;
+    }
+
+    // A free slot must not affect the filter.
+    for( i = 0; i < P.nrows(); i++ )
+    {
+      P[i][state_index] = 0.0;
+      P[state_index][i] = 0.0;
+    }
+
+    m_AmbiguitySlots.isActive[slot] = false;
+    m_AmbiguitySlots.nrActive--;
+    return true;
+  }
       
 
 
@@ -41,6 +41,11 @@ SUCH DAMAGE.
 #include <stdio.h>
 #include <list>
 #include "gnss_types.h"
+#include "geodesy.h"
+#include "GNSS_RxData.h"
+#include "GNSS_AmbiguityResolver.h"
+#include "GNSS_DoubleDifferenceOperator.h"
+#include "GNSS_Profiler.h"
 #include "Matrix.h"
 
 using namespace Zenautics; // for Matrix
@@ -214,6 +219,74 @@ namespace GNSS
       GNSS_RxData &rxData,       //!< The receiver data.
       const bool isLeastSquares  //!< A boolean to indicate if the rover position and velocity values are from least squares rxData->m_pvt_lsq or from rxData->m_pvt.)
     );
+
+    /// \brief    Determine the atmospheric corrections for the rover and, if
+    ///           provided, the base station in one call. Each receiver's
+    ///           satellites are corrected with the batch troposphere and 
+    ///           ionosphere kernels.
+    ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    ///
+    /// \return   true if successful, false if error.
+    bool DetermineAtmosphericCorrections_GPSL1( 
+      GNSS_RxData &rxData,       //!< The receiver data.
+      const bool isLeastSquares, //!< A boolean to indicate if the rover position and velocity values are from least squares rxData->m_pvt_lsq or from rxData->m_pvt.)
+      GNSS_RxData *rxBaseData    //!< The base station receiver data (m_pvt is used). NULL if not available.
+    );
+
+
+    /// \brief    Get the local geodetic frame at the receiver position. The 
+    ///           frame is only recomputed when the position differs from the
+    ///           one it was computed at, so all the satellites at an epoch
+    ///           (and all the design matrix rows) share one computation.
+    ///
+    /// \return   A pointer to rxData.m_LocalFrame_lsq or rxData.m_LocalFrame, NULL if error.
+    const GEODESY_structLocalFrame* GetLocalFrame( 
+      GNSS_RxData &rxData,       //!< The receiver data.
+      const bool isLeastSquares  //!< A boolean to indicate if the position is from least squares rxData.m_pvt_lsq or from rxData.m_pvt.
+      );
+
+
+    /// \brief    Recompute the cached WAAS zenith delays and the tabulated UNBabc
+    ///           mapping functions in rxData.m_AtmCache if the day of year changed
+    ///           or the receiver moved more than rxData.m_AtmCache.maxDisplacement.
+    ///
+    /// \return   true if successful, false if error.
+    bool UpdateAtmosphericCorrectionCache( 
+      GNSS_RxData &rxData,              //!< The receiver data.
+      const double latitude,            //!< The user latitude [rad].
+      const double height,              //!< The user height [m].
+      const unsigned short day_of_year  //!< The day of year (1-366) [days].
+      );
+
+    /// \brief    Get the dry and wet tropospheric delays from the cached zenith 
+    ///           delays and the interpolated mapping function table. 
+    ///           Elevations outside the table are computed directly.
+    void GetTroposphericDelayFromCache( 
+      GNSS_RxData &rxData,     //!< The receiver data.
+      const double elevation,  //!< The satellite elevation angle [rad].
+      double &drydelay,        //!< The dry delay [m].
+      double &wetdelay         //!< The wet delay [m].
+      );
+
+    /// \brief    Get the Klobuchar L1 delay for a satellite from the pass cache.
+    ///           The delay is computed directly every ionoRefreshInterval 
+    ///           seconds and linearly predicted in between.
+    ///
+    /// \return   true if successful, false if error.
+    bool GetIonosphericDelayFromCache( 
+      GNSS_RxData &rxData,      //!< The receiver data.
+      const unsigned short prn, //!< The GPS PRN.
+      const double latitude,    //!< The user latitude [rad].
+      const double longitude,   //!< The user longitude [rad].
+      const double elevation,   //!< The satellite elevation angle [rad].
+      const double azimuth,     //!< The satellite azimuth angle [rad].
+      const unsigned short gps_week, //!< The GPS week [weeks].
+      const double gps_tow,     //!< The GPS time of week [s].
+      double &iono              //!< The ionospheric delay [m].
+      );
   
   
   
@@ -794,42 +867,40 @@ namespace GNSS
       );
 
 
-    /// \brief    Perform the Global Internal Reliability Test, followed by a 
-    ///           search using local testing for a single measurement fault if 
-    ///           the global test fails.
+    /// \brief    Perform the Global Internal Reliability Test and the local 
+    ///           test repeatedly, excluding one measurement fault at a time 
+    ///           until the global test passes, no clear blunder remains, or 
+    ///           there is no redundancy left.
     ///
-    /// The Global Internal Reliability Test: \n
-    /// The aposteriori variance factor is computed and compared to the value 
-    /// generated using Chi^2 lookup table. The aposerteriori variance factor 
-    /// indicates the following: \n
-    /// if( apv ~= 1 ) \n
-    ///   solution and observations are well modelled. \n
-    /// if( apv < 1 ) \n
-    ///   observation variance matrix is pessimistic. \n
-    ///   (observations are better than what you said). \n
-    /// if( apv > 1 ) \n
-    ///   (1) The math model incorrect, (not likely)
-    ///   (2) The weight matrix/observation variance matrix is optimistic 
-    ///      (observations are worse than what you said). \n
-    ///   (3) Their is a blunder in the observations that is skewing the normality 
-    ///       of the solution, and a local test for blunder my be needed. \n
+    /// Each exclusion is a rank one downdate of the converged solution 
+    /// (Sherman-Morrison) rather than a new solution. With g = P*h_k', and
+    /// Cr_kk = R_kk - h_k*g, excluding measurement k gives: \n
+    /// P'     = P + g*g' / Cr_kk \n
+    /// r_i'   = r_i + (h_i*g) * r_k / Cr_kk \n
+    /// Cr_ii' = Cr_ii - (h_i*g)^2 / Cr_kk \n
+    /// so each exclusion costs O(n*u + u^2) and the full Cr = R - H*P*H' is 
+    /// never formed. The rejected measurements are flagged in rxData 
+    /// (flags.isNotPsrRejected or flags.isNotDopplerRejected is cleared). 
+    /// The inputs are not modified, the caller is expected to recompute 
+    /// the solution once after any rejection.
     ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    /// \pre      R must be diagonal.
     /// \return   true if successful, false if error.                    
-    bool PerformGlobalTestAndTestForMeasurementFaults( 
+    bool PerformFaultDetectionAndExclusion_UsingRankOneDowndates( 
       GNSS_RxData &rxData,           //!< The receiver data object.
       bool testPsrOrDoppler,         //!< This indicates if the psr misclosures are checked, otherwise the Doppler misclosures are checked. 
       Matrix& H,                     //!< The design matrix, H,                           [n x u].
-      Matrix& Ht,                    //!< The design matrix transposed, H,                [n x u].
-      Matrix& W,                     //!< The observation weight matrix, W,               [n x n].
-      Matrix& R,                     //!< The observation variance-covariance matrix, R,  [n x n].
+      Matrix& R,                     //!< The observation variance-covariance matrix, R,  [n x n] (diagonal).
       Matrix& r,                     //!< The observation residual vector,                [n x 1].
       Matrix& P,                     //!< The state variance-covariance matrix,           [u x u].
       const unsigned char n,         //!< The number of observations, n.
       const unsigned char u,         //!< The number of unknowns, u.
-      double &avf,                   //!< The computed a-posteriori variance factor is returned.
-      bool &isGlobalTestPassed,      //!< This indicates if the global test passed.    
-      bool &hasRejectionOccurred,    //!< This indicates if a rejection occurred. Only one measurement is flagged.
-      unsigned char &indexOfRejected //!< This is the index of the rejected observation.
+      double &avf,                   //!< The a-posteriori variance factor after all exclusions is returned.
+      bool &isGlobalTestPassed,      //!< This indicates if the global test passed after all exclusions.
+      unsigned char &nrRejected      //!< The number of measurements rejected.
       );
 
 
@@ -889,9 +960,26 @@ namespace GNSS
       );
   
   
+    /// \brief    Predict the least squares position and clock offset to the 
+    ///           current epoch so the iterations start near the solution.
+    ///           The filter position (EKF, RTK4, RTK8) is propagated with its 
+    ///           velocity when it is available, otherwise the previous least 
+    ///           squares position is propagated with the least squares velocity.
+    ///           The clock offset is the least squares clock offset propagated 
+    ///           with the least squares clock drift and the clock jump compensation.
+    ///
+    /// \return   true if successful, false if error.
+    bool PredictLeastSquaresStartingPoint(
+      GNSS_RxData *rxData,     //!< A pointer to the rover receiver data. This must be a valid pointer.
+      const double clockJump,  //!< The clock jump compensation for this epoch [m].
+      bool &isPredicted        //!< A boolean to indicate if the starting point was predicted.
+      );
+  
+  
     /// \brief    Perform least squares using pseudoranges and Doppler 
     ///           measurments to determine the eight states:
     ///           (lat,lon,hgt,vn,ve,vup,clk,clkdrift).
+    ///           The position iterations are controlled by m_LSQIterationControl.
     ///
     /// \return   true if successful, false if error.
     bool PerformLeastSquares(
@@ -907,10 +995,11 @@ namespace GNSS
 
 
 
-    /// \brief    Deal with changes in ambiguities. Remove the 
-    ///           rows and columns from P of the ambiguities that
-    ///           are no longer active. Add rows and columns to P
-    ///           for new ambiguities.
+    /// \brief    Deal with changes in ambiguities. The slots in P of the
+    ///           ambiguities that are no longer active are released and
+    ///           new ambiguities are assigned free slots (see 
+    ///           stAmbiguityStateSlots). P only grows when every slot is
+    ///           in use.
     ///
     /// \return   true if successful, false if error.    
     bool DetermineAmbiguitiesChanges( 
@@ -921,6 +1010,52 @@ namespace GNSS
       bool& changeOccured 
       );
 
+    /// \brief    Clear the ambiguity states and the slot bookkeeping. 
+    ///           The state dimension becomes the number of nominal states.
+    ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    void ResetAmbiguityStateSlots( 
+      const unsigned nrNominalStates //!< The number of states before the ambiguity states, 4 or 8.
+      );
+
+    /// \brief    Assign the lowest free ambiguity slot. P grows by one 
+    ///           row and column only if every slot is in use.
+    ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    /// \return   true if successful, false if error.    
+    bool AllocateAmbiguityStateSlot( 
+      Matrix &P,       //!< The state variance-covariance matrix.
+      int &state_index //!< The index of the row and column of P for the ambiguity.
+      );
+
+    /// \brief    Release the ambiguity slot at state_index. The row 
+    ///           and column of P are zeroed, O(u), and the slot is free
+    ///           for reuse.
+    ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    /// \return   true if successful, false if error.    
+    bool ReleaseAmbiguityStateSlot( 
+      Matrix &P,             //!< The state variance-covariance matrix.
+      const int state_index  //!< The index of the row and column of P for the ambiguity.
+      );
+
+    /// \brief    The RTK state dimension, the nominal states and all 
+    ///           ambiguity slots (active or free).
+    ///
+    /// \author   agent (agent@local)
+    /// \date     2026-10-18
+    /// \since    2026-10-18
+    unsigned GetStateDimension_RTK( 
+      const bool isEightStateModel //!< A boolean indicating if the velocity and clock drift states are included.
+      )
+    { return (isEightStateModel ? 8 : 4) + m_AmbiguitySlots.nrSlots; }
+
   /// \brief	Takes a square matrix and performs U*D*transpose(U)
 	///
 	/// \return true if successful, false if error.
@@ -1039,10 +1174,7 @@ namespace GNSS
       Matrix T;     //!< The transition matrix,                                       [u x u].
       Matrix Q;     //!< The process noise matrix,                                    [u x u].
       Matrix K;   //!< The Kalman gain matrix,                                      [u x n]. 
-      Matrix B;     //!< The double difference operator matrix.                       [n x n-1/2/3].
-      Matrix prevB; //!< The previous double difference operator matrix.              [n_prev x n_prev-1/2/3].
-      Matrix SubB;  //!< The double difference operator matrix for just ambiguities.      
-      Matrix prevSubB; //!< The previuos double difference operator matrix just ambiguities.
+      GNSS_DoubleDifferenceOperator B; //!< The double difference operator from the single difference states, implicit [3+n-1 x u].
       Matrix U_Bierman; //!< The upper triangular matrix UDUt of P                  [u x u].
       Matrix D_Bierman; //!< The diagonal matrix of UDUt of P                       [u x u].
     };
@@ -1097,6 +1229,10 @@ namespace GNSS
     stRTK m_RTK; //!< The RTK estimation matrix information.
     stRTKDD m_RTKDD; //!< The double difference RTK estimation matrix information.
 
+    /// The integer ambiguity resolution for the RTK filters. The Z transformation 
+    /// is kept between epochs while the double difference ambiguity set is unchanged.
+    GNSS_AmbiguityResolver m_AmbiguityResolver;
+
 
     /// Kalman filter model settings for 1st order Gauss Markov
     /// Velocity/ClkDrift states. 8 state PVGM model.
@@ -1129,6 +1265,112 @@ namespace GNSS
 	/// GDM store in RxData?
     std::list<stAmbiguityInfo> m_ActiveAmbiguitiesList;
 
+    /// The ambiguity states occupy slots after the nominal states in the RTK 
+    /// state vector. A slot released when a satellite sets is reused by the next
+    /// new ambiguity, so the state indices of the other ambiguities never change
+    /// and satellites setting or rising is O(u) bookkeeping. Free slots have 
+    /// zero rows and columns in P, identity in T and zero in Q so they do not 
+    /// affect the filter. The state dimension only grows, to at most 
+    /// 8 + GNSS_RXDATA_NR_CHANNELS, when every slot is in use.
+    struct stAmbiguityStateSlots
+    {
+      unsigned nrNominalStates; //!< The number of states before the ambiguity slots, 4 or 8.
+      unsigned nrSlots;         //!< The number of ambiguity slots in the state vector, active or free.
+      unsigned nrActive;        //!< The number of active slots.
+      bool isActive[GNSS_RXDATA_NR_CHANNELS]; //!< The active slot mask.
+
+      stAmbiguityStateSlots()
+        : nrNominalStates(0), nrSlots(0), nrActive(0)
+      {
+        for( unsigned i = 0; i < GNSS_RXDATA_NR_CHANNELS; i++ )
+          isActive[i] = false;
+      }
+    };
+    stAmbiguityStateSlots m_AmbiguitySlots;
+
+    /// The least squares position iterations start from a position predicted 
+    /// to the current epoch (see PredictLeastSquaresStartingPoint). Once the 
+    /// position update is below geometryReuseThreshold, the design matrix is 
+    /// kept and only the computed ranges are updated with it. The iterations 
+    /// stop when the largest change the linearization error of the last update 
+    /// could cause is below the convergence tolerance, so a good prediction 
+    /// converges in one iteration. The iteration statistics are accumulated here.
+    struct stLSQIterationControl
+    {
+      bool useWarmStart;             //!< A boolean to indicate if the iterations start from the predicted position.
+      double maxWarmStartInterval;   //!< The longest interval a previous solution is predicted over [s].
+      double geometryReuseThreshold; //!< The design matrix is kept when the last position update is smaller [m], 0 to always recompute it.
+      unsigned maxIterations;        //!< The maximum number of position iterations per epoch.
+
+      bool isPreviousSolutionValid;  //!< A boolean to indicate if previousSolutionTime is valid.
+      double previousSolutionTime;   //!< The time of the last converged least squares position, gps_week*SECONDS_IN_WEEK + gps_tow [s].
+
+      unsigned nrIterations;         //!< The number of position iterations for the most recent epoch.
+      unsigned maxNrIterations;      //!< The largest number of position iterations for an epoch.
+      unsigned totalNrIterations;    //!< The total number of position iterations.
+      unsigned nrEpochs;             //!< The number of epochs with a position solution.
+      unsigned nrWarmStarts;         //!< The number of epochs started from a predicted position.
+      unsigned nrGeometryReuses;     //!< The number of iterations that kept the design matrix.
+      unsigned nrNotConverged;       //!< The number of epochs that reached maxIterations.
+
+      stLSQIterationControl()
+        : useWarmStart(true), 
+        maxWarmStartInterval(30.0), 
+        geometryReuseThreshold(1.0), 
+        maxIterations(7),
+        isPreviousSolutionValid(false), 
+        previousSolutionTime(0), 
+        nrIterations(0), 
+        maxNrIterations(0), 
+        totalNrIterations(0), 
+        nrEpochs(0), 
+        nrWarmStarts(0), 
+        nrGeometryReuses(0), 
+        nrNotConverged(0)
+      {}
+    };
+    stLSQIterationControl m_LSQIterationControl;
+
+    /// \brief   The real time deadline control of the integer ambiguity search. 
+    /// The search has the largest and most variable cost of an epoch. If it is 
+    /// skipped, the float solution is output for the epoch.
+    struct stDeadlineControl
+    {
+      double searchDeadline;      //!< The time (GNSS_Profiler::GetTime) after which the ambiguity search of the current epoch is skipped, 0 for no deadline [s].
+      bool skipAmbiguitySearch;   //!< A boolean to skip the ambiguity search of the current epoch (e.g. the previous epoch overran its deadline).
+      unsigned nrSkippedSearches; //!< The number of ambiguity searches skipped.
+
+      stDeadlineControl()
+        : searchDeadline(0), 
+        skipAmbiguitySearch(false), 
+        nrSkippedSearches(0)
+      {}
+    };
+    stDeadlineControl m_DeadlineControl;
+
+    /// \brief   The control of the geometry free phase cycle slip check (GPS L1 and L2). 
+    /// The ionosphere changes the geometry free phase between epochs, so the threshold 
+    /// grows with the time between epochs and the check is not done over long gaps.
+    struct stCycleSlipControl
+    {
+      bool useGeometryFree;             //!< A boolean to indicate if the geometry free phase check is done.
+      double geometryFreeThreshold;     //!< The geometry free phase change threshold between consecutive epochs [m].
+      double geometryFreeThresholdRate; //!< The increase of the threshold with the time between epochs [m/s].
+      double geometryFreeMaxGap;        //!< The check is not done if the time between epochs is longer [s].
+
+      stCycleSlipControl()
+        : useGeometryFree(false), 
+        geometryFreeThreshold(0.05), 
+        geometryFreeThresholdRate(0.005), 
+        geometryFreeMaxGap(5.0)
+      {}
+    };
+    stCycleSlipControl m_CycleSlipControl;
+
+    /// The latency profiler of the processing loop, NULL if not profiling. 
+    /// The satellite PVT, atmospheric correction, and ambiguity search stages are timed.
+    GNSS_Profiler* m_Profiler;
+
   protected:
 
     Matrix HtW;  //!< The design matrix, H, transposed times W                      u x n.
@@ -35,6 +35,7 @@ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
 SUCH DAMAGE.
 */
 
+#include <stdio.h>
 #include <memory.h>
 #include "constants.h"
 #include "GNSS_OptionFile.h"
@@ -52,7 +53,11 @@ namespace GNSS
 
 
   GNSS_OptionFile::GNSS_OptionFile()
-    : m_processDGPSOnly(true),
+    : m_PVTOutputFormat("CSV"),
+    m_ColumnarCompression(true),
+    m_processDGPSOnly(true),
+    m_RINEXNavUseBestEphemeris(false),
+    m_MultiRoverNrThreads(0),
     m_RoverIsStatic(true),
     m_elevationMask(0.0),
     m_cnoMask(0.0),
@@ -222,7 +227,90 @@ namespace GNSS
 
     GetValue( "UseDopplerMeasurements", m_UseDopplerMeasurements );
 
+    GetValue( "AtmosphericCache_Enable", m_AtmCacheOptions.isEnabled );
+    GetValue( "AtmosphericCache_CheckAccuracy", m_AtmCacheOptions.checkAccuracy );
+    GetValue( "AtmosphericCache_MaxDisplacement", m_AtmCacheOptions.maxDisplacement );
+    GetValue( "AtmosphericCache_IonoRefreshInterval", m_AtmCacheOptions.ionoRefreshInterval );
+
+    GetValue( "Ambiguity_MaxSearchNodes", m_AmbiguityOptions.maxSearchNodes );
+    GetValue( "Ambiguity_PartialRatioThreshold", m_AmbiguityOptions.partialRatioThreshold );
+    GetValue( "Ambiguity_MinNrPartialAmbiguities", m_AmbiguityOptions.minNrPartialAmbiguities );
+    if( m_AmbiguityOptions.partialRatioThreshold < 0 || m_AmbiguityOptions.minNrPartialAmbiguities < 1 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: Ambiguity_PartialRatioThreshold or Ambiguity_MinNrPartialAmbiguities" );
+      return false;
+    }
+
+    GetValue( "PVT_OutputFormat", m_PVTOutputFormat );
+    if( m_PVTOutputFormat != "CSV" && m_PVTOutputFormat != "BINARY" && m_PVTOutputFormat != "COLUMNAR" )
+    {
+      GNSS_ERROR_MSG( "Invalid option: PVT_OutputFormat" );
+      return false;
+    }
+    GetValue( "PVT_ColumnarCompression", m_ColumnarCompression );
+
+    GetValue( "LSQ_WarmStart", m_LeastSquaresOptions.useWarmStart );
+    GetValue( "LSQ_GeometryReuseThreshold", m_LeastSquaresOptions.geometryReuseThreshold );
+    GetValue( "LSQ_MaxIterations", m_LeastSquaresOptions.maxIterations );
+    GetValue( "LSQ_ReportIterations", m_LeastSquaresOptions.reportIterations );
+    if( m_LeastSquaresOptions.maxIterations < 1 || m_LeastSquaresOptions.geometryReuseThreshold < 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: LSQ_MaxIterations or LSQ_GeometryReuseThreshold" );
+      return false;
+    }
+
+    GetValue( "CycleSlip_GeometryFree", m_CycleSlipOptions.useGeometryFree );
+    GetValue( "CycleSlip_GeometryFreeThreshold", m_CycleSlipOptions.geometryFreeThreshold );
+    GetValue( "CycleSlip_GeometryFreeThresholdRate", m_CycleSlipOptions.geometryFreeThresholdRate );
+    GetValue( "CycleSlip_GeometryFreeMaxGap", m_CycleSlipOptions.geometryFreeMaxGap );
+    if( m_CycleSlipOptions.geometryFreeThreshold <= 0 || m_CycleSlipOptions.geometryFreeThresholdRate < 0 || m_CycleSlipOptions.geometryFreeMaxGap <= 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: CycleSlip_GeometryFreeThreshold, CycleSlip_GeometryFreeThresholdRate, or CycleSlip_GeometryFreeMaxGap" );
+      return false;
+    }
+
+    GetValue( "StaticBatch_Enable", m_StaticBatchOptions.isEnabled );
+    GetValue( "StaticBatch_OutputFilePath", m_StaticBatchOptions.OutputFilePath );
+
+    GetValue( "Smoother_Enable", m_SmootherOptions.isEnabled );
+    GetValue( "Smoother_MaxEpochsInMemory", m_SmootherOptions.maxEpochsInMemory );
+    GetValue( "Smoother_SpillFilePath", m_SmootherOptions.SpillFilePath );
+    if( m_SmootherOptions.maxEpochsInMemory < 2 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: Smoother_MaxEpochsInMemory" );
+      return false;
+    }
+
+    GetValue( "Profile_Enable", m_ProfileOptions.isEnabled );
+    GetValue( "Profile_ReportPath", m_ProfileOptions.ReportFilePath );
+    GetValue( "Profile_TracePath", m_ProfileOptions.TraceFilePath );
+
+    GetValue( "RealTime_Enable", m_RealTimeOptions.isEnabled );
+    GetValue( "RealTime_PollInterval", m_RealTimeOptions.pollInterval );
+    GetValue( "RealTime_Timeout", m_RealTimeOptions.timeout );
+    GetValue( "RealTime_Deadline", m_RealTimeOptions.deadline );
+    if( m_RealTimeOptions.pollInterval <= 0 || m_RealTimeOptions.timeout < 0 || m_RealTimeOptions.deadline < 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: RealTime_PollInterval, RealTime_Timeout, or RealTime_Deadline" );
+      return false;
+    }
+
+    GetValue( "Alignment_Mode", m_AlignmentOptions.Mode );
+    GetValue( "Alignment_MaxSpan", m_AlignmentOptions.maxSpan );
+    GetValue( "Alignment_ReferenceLatency", m_AlignmentOptions.referenceLatency );
+    if( m_AlignmentOptions.Mode != "MATCH" && m_AlignmentOptions.Mode != "INTERPOLATE" && m_AlignmentOptions.Mode != "EXTRAPOLATE" )
+    {
+      GNSS_ERROR_MSG( "Invalid option: Alignment_Mode" );
+      return false;
+    }
+    if( m_AlignmentOptions.maxSpan <= 0 || m_AlignmentOptions.referenceLatency < 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid option: Alignment_MaxSpan or Alignment_ReferenceLatency" );
+      return false;
+    }
+
     GetValue( "RINEXNavigationDataPath", m_RINEXNavDataPath );      
+    GetValue( "RINEXNavigationBestEphemeris", m_RINEXNavUseBestEphemeris );
 
     GetValue( "Reference_DataPath", m_Reference.DataPath );
 
@@ -688,6 +776,12 @@ namespace GNSS
     
     m_Rover.isValid = true;
 
+    if( !ReadAdditionalRoverOptions() )
+    {
+      GNSS_ERROR_MSG( "ReadAdditionalRoverOptions returned false." );
+      return false;
+    }
+
 #ifdef GDM_UWB_RANGE_HACK    
     GetValue( "Rover_UWBFilePath", m_UWBFilePath );      
 
@@ -993,6 +1087,147 @@ namespace GNSS
     return true;
   }
 
+
+  bool GNSS_OptionFile::ReadAdditionalRoverOptions()
+  {
+    unsigned k;
+    unsigned n;
+    double d[4];
+    double value;
+    bool isPositionGiven;
+    BOOL resultBOOL = FALSE;
+    char prefix[32];
+    char msg[128];
+    std::string path;
+
+    m_AdditionalRovers.clear();
+
+    GetValue( "MultiRover_NrThreads", m_MultiRoverNrThreads );
+
+    for( k = 2; k <= GNSS_OPTIONFILE_MAX_ROVERS; k++ )
+    {
+      sprintf( prefix, "Rover%d_", k );
+
+      path.clear();
+      if( !GetValue( std::string(prefix) + "DataPath", path ) )
+        continue;
+      if( path.empty() )
+        continue;
+
+      // Start with the primary rover's options.
+      stStationInformation rover = m_Rover;
+      rover.DataPath = path;
+
+      if( !DoesFileExist( rover.DataPath ) )
+      {
+        sprintf( msg, "Invalid option: %sDataPath", prefix );
+        GNSS_ERROR_MSG( msg );
+        return false;
+      }
+
+      if( GetValue( std::string(prefix) + "DataType", rover.DataTypeStr ) )
+      {
+        StdStringUtils::MakeUpper(rover.DataTypeStr);
+
+        if( rover.DataTypeStr.compare("NOVATELOEM4") == 0 )
+        {
+          rover.DataType = GNSS_RXDATA_NOVATELOEM4;
+        }
+        else if( rover.DataTypeStr.compare("RINEX2.1") == 0 )
+        {
+          rover.DataType = GNSS_RXDATA_RINEX21;
+        }
+        else if( rover.DataTypeStr.compare("RINEX2.11") == 0 )
+        {
+          rover.DataType = GNSS_RXDATA_RINEX211;
+        }
+        else
+        {
+          sprintf( msg, "Invalid option: %sDataType", prefix );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+      }
+
+      // The initial position is optional but all three values must be given.
+      isPositionGiven = false;
+      GetValueArray( std::string(prefix) + "Latitude", d, 4, n );
+      if( n == 1 || n == 3 )
+      {
+        if( n == 1 )
+          rover.latitudeDegrees = d[0];
+        else
+          GetDMSValue( std::string(prefix) + "Latitude", rover.latitudeDegrees );
+        rover.latitudeRads = rover.latitudeDegrees*DEG2RAD;
+
+        GetValueArray( std::string(prefix) + "Longitude", d, 4, n );
+        if( n == 1 )
+        {
+          rover.longitudeDegrees = d[0];
+        }
+        else if( n == 3 )
+        {
+          GetDMSValue( std::string(prefix) + "Longitude", rover.longitudeDegrees );
+        }
+        else
+        {
+          sprintf( msg, "Invalid option: %sLongitude", prefix );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+        rover.longitudeRads = rover.longitudeDegrees*DEG2RAD;
+
+        if( !GetValue( std::string(prefix) + "Height", rover.height ) )
+        {
+          sprintf( msg, "Invalid option: %sHeight", prefix );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+        isPositionGiven = true;
+      }
+
+      if( isPositionGiven )
+      {
+        resultBOOL = GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates(
+          GEODESY_REFERENCE_ELLIPSE_WGS84,
+          rover.latitudeRads,
+          rover.longitudeRads,
+          rover.height,
+          &rover.x,
+          &rover.y,
+          &rover.z 
+          );
+        if( resultBOOL == FALSE )
+        {
+          sprintf( msg, "GEODESY_ConvertGeodeticCurvilinearToEarthFixedCartesianCoordinates returned false. Check %sLatitude, %sLongitude, %sHeight.", prefix, prefix, prefix );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+      }
+
+      if( GetValue( std::string(prefix) + "UncertaintyLatitude", value ) )
+        rover.uncertaintyLatitudeOneSigma = value;
+      if( GetValue( std::string(prefix) + "UncertaintyLongitude", value ) )
+        rover.uncertaintyLongitudeOneSigma = value;
+      if( GetValue( std::string(prefix) + "UncertaintyHeight", value ) )
+        rover.uncertaintyHeightOneSigma = value;
+
+      if( GetValueArray( std::string(prefix) + "ExcludeSatellites", rover.satsToExclude, 64, n ) )
+        rover.nrSatsToExclude = n;
+
+      rover.isValid = true;
+      m_AdditionalRovers.push_back( rover );
+    }
+
+    if( !m_AdditionalRovers.empty() && !m_Reference.isValid )
+    {
+      GNSS_ERROR_MSG( "Additional rovers can only be processed against a valid reference station." );
+      return false;
+    }
+
+    return true;
+  }
+
 } // end of namespace GNSS;
 
 
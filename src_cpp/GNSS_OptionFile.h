@@ -39,10 +39,16 @@ SUCH DAMAGE.
 #define _EGNSS_OPTIONFILE_H_
 
 #include <string>
+#include <vector>
 #include "OptionFile.h"
 #include "gnss_types.h"
 #include "GNSS_RxData.h"
 
+/// The maximum number of rover stations (including the primary rover, 
+/// i.e. Rover_ and Rover2_ to Rover16_) that can be processed against 
+/// the reference station.
+#define GNSS_OPTIONFILE_MAX_ROVERS (16)
+
 namespace GNSS
 {
   /// \brief   A derived option file class for the program.
@@ -70,6 +76,14 @@ namespace GNSS
     /// \return   true if successful, false if error.
     bool ReadAndInterpretOptions( std::string OptionFilePath );
 
+  protected:
+
+    /// \brief    Read the options for the additional rovers (Rover2_ to Rover16_).
+    ///           Options that are not given for an additional rover are taken 
+    ///           from the primary rover.
+    /// \return   true if successful, false if error.
+    bool ReadAdditionalRoverOptions();
+
   public:
 
     struct stStationInformation
@@ -175,6 +189,64 @@ namespace GNSS
       {}
     };
 
+    struct stAmbiguityOptions
+    {
+      unsigned maxSearchNodes;          //!< The maximum number of integer search nodes per epoch, 0 for no limit.
+      double partialRatioThreshold;     //!< The ratio test threshold for partial ambiguity resolution, 0 to fix all ambiguities.
+      unsigned minNrPartialAmbiguities; //!< The smallest subset of ambiguities fixed with partial ambiguity resolution.
+
+      // default constructor
+      stAmbiguityOptions()
+        : maxSearchNodes(0), 
+        partialRatioThreshold(0), 
+        minNrPartialAmbiguities(4)
+      {}
+    };
+
+    struct stLeastSquaresOptions
+    {
+      bool useWarmStart;              //!< A boolean to indicate if the position iterations start from the position predicted to the current epoch.
+      double geometryReuseThreshold;  //!< The design matrix is kept when the last position update is smaller [m], 0 to always recompute it.
+      unsigned maxIterations;         //!< The maximum number of position iterations per epoch.
+      bool reportIterations;          //!< A boolean to indicate if the iteration statistics are reported when processing is complete.
+
+      // default constructor
+      stLeastSquaresOptions()
+        : useWarmStart(true), 
+        geometryReuseThreshold(1.0), 
+        maxIterations(7),
+        reportIterations(false)
+      {}
+    };
+
+    struct stCycleSlipOptions
+    {
+      bool useGeometryFree;             //!< A boolean to indicate if the GPS L1/L2 geometry free phase cycle slip check is done.
+      double geometryFreeThreshold;     //!< The geometry free phase change threshold between consecutive epochs [m].
+      double geometryFreeThresholdRate; //!< The increase of the threshold with the time between epochs [m/s].
+      double geometryFreeMaxGap;        //!< The check is not done if the time between epochs is longer [s].
+
+      // default constructor
+      stCycleSlipOptions()
+        : useGeometryFree(false), 
+        geometryFreeThreshold(0.05), 
+        geometryFreeThresholdRate(0.005), 
+        geometryFreeMaxGap(5.0)
+      {}
+    };
+
+    struct stStaticBatchOptions
+    {
+      bool isEnabled;              //!< A boolean to indicate if a batch least squares position is computed from all epochs (static rover only).
+      std::string OutputFilePath;  //!< The path of the batch solution output file.
+
+      // default constructor
+      stStaticBatchOptions()
+        : isEnabled(false), 
+        OutputFilePath("static_solution.csv")
+      {}
+    };
+
     struct stRoverDatum
     {
       bool isValid;
@@ -187,18 +259,127 @@ namespace GNSS
       {}
     };
 
+    struct stAtmosphericCacheOptions
+    {
+      bool isEnabled;             //!< A boolean to indicate if the atmospheric correction cache is used.
+      bool checkAccuracy;         //!< A boolean to indicate if the cached corrections are compared with the direct computation.
+      double maxDisplacement;     //!< The displacement allowed before the zenith delays are recomputed [m].
+      double ionoRefreshInterval; //!< The time between direct Klobuchar computations for a satellite [s].
+
+      // default constructor
+      stAtmosphericCacheOptions()
+        : isEnabled(false), 
+        checkAccuracy(false), 
+        maxDisplacement(5.0), 
+        ionoRefreshInterval(10.0)
+      {}
+    };
+
+    struct stSmootherOptions
+    {
+      bool isEnabled;              //!< A boolean to indicate if the EKF, RTK4, or RTK8 solution is smoothed with a backward pass.
+      unsigned maxEpochsInMemory;  //!< The number of epochs of filter information kept in memory before spilling to disk.
+      std::string SpillFilePath;   //!< The path of the temporary file for the filter information.
+
+      // default constructor
+      stSmootherOptions()
+        : isEnabled(false), 
+        maxEpochsInMemory(3600), 
+        SpillFilePath("smoother_log.bin")
+      {}
+    };
+
+    struct stProfileOptions
+    {
+      bool isEnabled;              //!< A boolean to indicate if the latency of each processing stage is measured.
+      std::string ReportFilePath;  //!< The path of the latency report (statistics and histograms per stage).
+      std::string TraceFilePath;   //!< The path of the per epoch latency trace, empty for no trace.
+
+      // default constructor
+      stProfileOptions()
+        : isEnabled(false), 
+        ReportFilePath("profile_report.txt")
+      {}
+    };
+
+    struct stRealTimeOptions
+    {
+      bool isEnabled;       //!< A boolean to indicate if the NovAtel OEM4 logs are processed as they are written.
+      double pollInterval;  //!< The time between checks for new data [s].
+      double timeout;       //!< Processing ends if no new data arrives within this time, 0 to wait indefinitely [s].
+      double deadline;      //!< The latency allowed for an epoch before the ambiguity search is skipped, 0 for no deadline [s].
+
+      // default constructor
+      stRealTimeOptions()
+        : isEnabled(false), 
+        pollInterval(0.05), 
+        timeout(10.0),
+        deadline(0.5)
+      {}
+    };
+
+    struct stAlignmentOptions
+    {
+      std::string Mode;        //!< "MATCH", "INTERPOLATE", or "EXTRAPOLATE", how the reference observations are aligned to the rover epochs.
+      double maxSpan;          //!< The maximum time spanned by the reference epochs and the rover time in an alignment [s].
+      double referenceLatency; //!< The extrapolate mode delay allowed for a reference epoch to be available [s].
+
+      // default constructor
+      stAlignmentOptions()
+        : Mode("MATCH"), 
+        maxSpan(5.0), 
+        referenceLatency(0.0)
+      {}
+    };
+
     /// The Kalman filtering options.
     stKalmanOptions m_KalmanOptions;
 
+    /// The least squares iteration options.
+    stLeastSquaresOptions m_LeastSquaresOptions;
+
+    /// The cycle slip detection options.
+    stCycleSlipOptions m_CycleSlipOptions;
+
+    /// The static batch least squares options.
+    stStaticBatchOptions m_StaticBatchOptions;
+
+    /// The integer ambiguity resolution options.
+    stAmbiguityOptions m_AmbiguityOptions;
+
+    /// The atmospheric correction cache options.
+    stAtmosphericCacheOptions m_AtmCacheOptions;
+
+    /// The forward-backward smoother options.
+    stSmootherOptions m_SmootherOptions;
+
+    /// The processing latency profiling options.
+    stProfileOptions m_ProfileOptions;
+
+    /// The real time processing options.
+    stRealTimeOptions m_RealTimeOptions;
+
+    /// The rover and reference epoch alignment options.
+    stAlignmentOptions m_AlignmentOptions;
+
     /// The path to the option file.
     std::string m_OptionFilePath;
 
     /// The path to the output file.
     std::string m_OutputFilePath;
 
+    /// The prefix of the output file names (pvt.csv, obs_XX.csv, ...), set from the command line, empty by default.
+    std::string m_OutputPrefix;
+
     /// A string is used to indicate the processing method.
     std::string m_ProcessingMethod;
 
+    /// The PVT output format, "CSV" (pvt.csv), "BINARY" (pvt.bin), or "COLUMNAR" (pvt.mtc and obs_XX.mtc).
+    std::string m_PVTOutputFormat;
+
+    /// A boolean to indicate if the column blocks of the COLUMNAR output are compressed.
+    bool m_ColumnarCompression;
+
     /// A boolean to indicate if only single difference measurements
     /// between the reference and rover station will be used.
     bool m_processDGPSOnly;
@@ -206,12 +387,24 @@ namespace GNSS
     //!< The path to the navigation datafile (ephemeris), if applicable.
     std::string m_RINEXNavDataPath;  
 
+    /// A boolean to indicate if the best ephemeris valid at each epoch (the closest toe) is used 
+    /// from the navigation data instead of the most recently transmitted one.
+    bool m_RINEXNavUseBestEphemeris;
+
     /// The reference station information.
     stStationInformation m_Reference;
 
     /// The rover station information.
     stStationInformation m_Rover;
 
+    /// The additional rover stations that are processed against the same 
+    /// reference station as m_Rover. Empty if only one rover is processed.
+    std::vector<stStationInformation> m_AdditionalRovers;
+
+    /// The number of worker threads used to process the rovers when there 
+    /// are additional rovers, 0 indicates one thread per processor.
+    unsigned m_MultiRoverNrThreads;
+
     /// A datum for the rover for which position difference calculations are performed.
     stRoverDatum m_RoverDatum;
 
@@ -0,0 +1,461 @@
+/**
+\file    GNSS_PVTWriter.cpp
+\brief   A streaming writer for the position, velocity, and time results 
+         of each epoch, as comma delimited text or binary records.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "gnss_error.h"
+#include "cmatrix.h"
+#include "GNSS_PVTWriter.h"
+
+// The size of the file buffers [bytes].
+#define PVTWRITER_BUFFER_SIZE (1<<16)
+
+// The size of the line buffer used to format CSV records [bytes].
+#define PVTWRITER_LINE_SIZE (2048)
+
+// The number of epochs per chunk of the columnar format.
+#define PVTWRITER_COLUMNAR_CHUNK (4096)
+
+namespace GNSS
+{
+  /// \brief   Seek to an offset in a record file. Offsets may exceed 2 GB.
+  static bool PVTWriter_Seek( FILE* fid, const double offset )
+  {
+#ifdef WIN32
+    return _fseeki64( fid, (__int64)offset, SEEK_SET ) == 0;
+#else
+    return fseeko( fid, (off_t)offset, SEEK_SET ) == 0;
+#endif
+  }
+
+
+  GNSS_PVTWriter::GNSS_PVTWriter()
+    : m_Format(PVT_FORMAT_CSV),
+    m_nrColumns(0),
+    m_nrEpochs(0),
+    m_isUpdatable(false),
+    m_isAtEnd(true),
+    m_isColumnarCompressed(true),
+    m_dataOffset(0),
+    m_File(NULL)
+  {}
+
+  GNSS_PVTWriter::~GNSS_PVTWriter()
+  {
+    Close();
+  }
+
+
+  bool GNSS_PVTWriter::Open( 
+    const char* path,
+    const Format format,
+    const unsigned nrColumns,
+    const char* header,
+    const bool isUpdatable
+    )
+  {
+    const char magic[8] = { 'G', 'N', 'S', 'S', 'P', 'V', 'T', '1' };
+    unsigned int headerInfo[2];
+    char msg[512];
+
+    if( path == NULL || header == NULL )
+    {
+      GNSS_ERROR_MSG( "if( path == NULL || header == NULL )" );
+      return false;
+    }
+    if( nrColumns == 0 )
+    {
+      GNSS_ERROR_MSG( "if( nrColumns == 0 )" );
+      return false;
+    }
+    if( format != PVT_FORMAT_CSV && format != PVT_FORMAT_BINARY && format != PVT_FORMAT_COLUMNAR )
+    {
+      GNSS_ERROR_MSG( "if( format != PVT_FORMAT_CSV && format != PVT_FORMAT_BINARY && format != PVT_FORMAT_COLUMNAR )" );
+      return false;
+    }
+    if( !Close() )
+    {
+      GNSS_ERROR_MSG( "Close returned false." );
+      return false;
+    }
+
+    m_Format = format;
+    m_nrColumns = nrColumns;
+    m_nrEpochs = 0;
+    m_isUpdatable = isUpdatable;
+    m_isAtEnd = true;
+    m_dataOffset = 0;
+    m_Path = path;
+    m_RecordPath.clear();
+    m_Header = header;
+    m_Buffer.resize( PVTWRITER_BUFFER_SIZE );
+
+    if( (m_Format == PVT_FORMAT_CSV && m_isUpdatable) || m_Format == PVT_FORMAT_COLUMNAR )
+    {
+      // The epochs are kept as binary records until the writer is closed.
+      m_RecordPath = m_Path + ".tmp";
+      m_File = fopen( m_RecordPath.c_str(), "w+b" );
+    }
+    else if( m_Format == PVT_FORMAT_CSV )
+    {
+      m_File = fopen( m_Path.c_str(), "w" );
+    }
+    else
+    {
+      m_File = fopen( m_Path.c_str(), m_isUpdatable ? "w+b" : "wb" );
+    }
+    if( m_File == NULL )
+    {
+      sprintf( msg, "Unable to open %.256s", m_RecordPath.empty() ? m_Path.c_str() : m_RecordPath.c_str() );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+    setvbuf( m_File, &m_Buffer[0], _IOFBF, m_Buffer.size() );
+
+    if( m_Format == PVT_FORMAT_BINARY )
+    {
+      headerInfo[0] = m_nrColumns;
+      headerInfo[1] = (unsigned int)m_Header.length();
+      if( fwrite( magic, 1, 8, m_File ) != 8 ||
+        fwrite( headerInfo, sizeof(unsigned int), 2, m_File ) != 2 ||
+        fwrite( m_Header.c_str(), 1, m_Header.length(), m_File ) != m_Header.length() )
+      {
+        GNSS_ERROR_MSG( "Unable to write the PVT file header." );
+        return false;
+      }
+      m_dataOffset = 8 + 2*sizeof(unsigned int) + (double)m_Header.length();
+    }
+    else if( m_Format == PVT_FORMAT_CSV && !m_isUpdatable )
+    {
+      if( fprintf( m_File, "%s\n", m_Header.c_str() ) < 0 )
+      {
+        GNSS_ERROR_MSG( "Unable to write the PVT file header." );
+        return false;
+      }
+    }
+    return true;
+  }
+
+
+  bool GNSS_PVTWriter::WriteDelimited( FILE* fid, const double* data )
+  {
+    char line[PVTWRITER_LINE_SIZE];
+    unsigned n = 0;
+    unsigned length = 0;
+    unsigned j = 0;
+
+    // Each line is formatted with MTX_ValueToString_g ("%.12g") and written with one fwrite.
+    for( j = 0; j < m_nrColumns; j++ )
+    {
+      if( !MTX_ValueToString_g( data[j], 12, line+n, PVTWRITER_LINE_SIZE-n, &length ) )
+      {
+        GNSS_ERROR_MSG( "MTX_ValueToString_g returned FALSE." );
+        return false;
+      }
+      n += length;
+      line[n++] = j+1 < m_nrColumns ? ',' : '\n';
+      
+      // Very wide records are written in pieces.
+      if( PVTWRITER_LINE_SIZE - n < 64 || j+1 == m_nrColumns )
+      {
+        if( fwrite( line, 1, n, fid ) != n )
+        {
+          GNSS_ERROR_MSG( "Unable to write the PVT record." );
+          return false;
+        }
+        n = 0;
+      }
+    }
+    return true;
+  }
+
+
+  bool GNSS_PVTWriter::WriteEpoch( const double* data )
+  {
+    if( m_File == NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_File == NULL )" );
+      return false;
+    }
+    if( data == NULL )
+    {
+      GNSS_ERROR_MSG( "if( data == NULL )" );
+      return false;
+    }
+
+    if( m_Format == PVT_FORMAT_CSV && !m_isUpdatable )
+    {
+      if( !WriteDelimited( m_File, data ) )
+      {
+        GNSS_ERROR_MSG( "WriteDelimited returned false." );
+        return false;
+      }
+    }
+    else
+    {
+      if( !m_isAtEnd )
+      {
+        if( fseek( m_File, 0, SEEK_END ) != 0 )
+        {
+          GNSS_ERROR_MSG( "Unable to seek to the end of the PVT records." );
+          return false;
+        }
+        m_isAtEnd = true;
+      }
+      if( fwrite( data, sizeof(double), m_nrColumns, m_File ) != m_nrColumns )
+      {
+        GNSS_ERROR_MSG( "Unable to write the PVT record." );
+        return false;
+      }
+    }
+    m_nrEpochs++;
+    return true;
+  }
+
+
+  bool GNSS_PVTWriter::Flush()
+  {
+    if( m_File == NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_File == NULL )" );
+      return false;
+    }
+    if( fflush( m_File ) != 0 )
+    {
+      GNSS_ERROR_MSG( "if( fflush( m_File ) != 0 )" );
+      return false;
+    }
+    return true;
+  }
+
+
+  bool GNSS_PVTWriter::UpdateEpoch( 
+    const unsigned epoch,
+    const unsigned firstColumn,
+    const double* data,
+    const unsigned n
+    )
+  {
+    double offset = 0;
+
+    if( m_File == NULL || !m_isUpdatable )
+    {
+      GNSS_ERROR_MSG( "if( m_File == NULL || !m_isUpdatable )" );
+      return false;
+    }
+    if( data == NULL )
+    {
+      GNSS_ERROR_MSG( "if( data == NULL )" );
+      return false;
+    }
+    if( epoch >= m_nrEpochs || firstColumn + n > m_nrColumns )
+    {
+      GNSS_ERROR_MSG( "if( epoch >= m_nrEpochs || firstColumn + n > m_nrColumns )" );
+      return false;
+    }
+
+    offset = m_dataOffset + ((double)epoch*m_nrColumns + firstColumn)*sizeof(double);
+    if( !PVTWriter_Seek( m_File, offset ) )
+    {
+      GNSS_ERROR_MSG( "Unable to seek to the PVT record." );
+      return false;
+    }
+    m_isAtEnd = false;
+    if( fwrite( data, sizeof(double), n, m_File ) != n )
+    {
+      GNSS_ERROR_MSG( "Unable to write the PVT record." );
+      return false;
+    }
+    return true;
+  }
+
+
+  bool GNSS_PVTWriter::ConvertRecords()
+  {
+    FILE* fid = NULL;
+    std::vector<double> record( m_nrColumns );
+    std::vector<char> buffer( PVTWRITER_BUFFER_SIZE );
+    unsigned i = 0;
+    char msg[512];
+    bool result = true;
+
+    if( !PVTWriter_Seek( m_File, 0 ) )
+    {
+      GNSS_ERROR_MSG( "Unable to seek to the first PVT record." );
+      return false;
+    }
+
+    fid = fopen( m_Path.c_str(), "w" );
+    if( fid == NULL )
+    {
+      sprintf( msg, "Unable to open %.256s", m_Path.c_str() );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+    setvbuf( fid, &buffer[0], _IOFBF, buffer.size() );
+
+    if( fprintf( fid, "%s\n", m_Header.c_str() ) < 0 )
+    {
+      GNSS_ERROR_MSG( "Unable to write the PVT file header." );
+      result = false;
+    }
+    for( i = 0; i < m_nrEpochs && result; i++ )
+    {
+      if( fread( &record[0], sizeof(double), m_nrColumns, m_File ) != m_nrColumns )
+      {
+        GNSS_ERROR_MSG( "Unable to read the PVT record." );
+        result = false;
+        break;
+      }
+      if( !WriteDelimited( fid, &record[0] ) )
+      {
+        GNSS_ERROR_MSG( "WriteDelimited returned false." );
+        result = false;
+      }
+    }
+    if( fclose( fid ) != 0 )
+    {
+      GNSS_ERROR_MSG( "Unable to close the PVT file." );
+      result = false;
+    }
+    return result;
+  }
+
+
+  bool GNSS_PVTWriter::ConvertRecordsToColumnar()
+  {
+    MTX chunk;
+    std::vector<double> record( m_nrColumns );
+    unsigned nr = 0;
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    bool result = true;
+
+    if( !PVTWriter_Seek( m_File, 0 ) )
+    {
+      GNSS_ERROR_MSG( "Unable to seek to the first PVT record." );
+      return false;
+    }
+
+    // Each chunk of epochs is transposed to columns and appended to the output file.
+    MTX_Init( &chunk );
+    for( i = 0; i < m_nrEpochs && result; i += nr )
+    {
+      nr = m_nrEpochs - i;
+      if( nr > PVTWRITER_COLUMNAR_CHUNK )
+        nr = PVTWRITER_COLUMNAR_CHUNK;
+
+      if( !MTX_Malloc( &chunk, nr, m_nrColumns, TRUE ) )
+      {
+        GNSS_ERROR_MSG( "MTX_Malloc returned FALSE." );
+        result = false;
+        break;
+      }
+      for( k = 0; k < nr; k++ )
+      {
+        if( fread( &record[0], sizeof(double), m_nrColumns, m_File ) != m_nrColumns )
+        {
+          GNSS_ERROR_MSG( "Unable to read the PVT record." );
+          result = false;
+          break;
+        }
+        for( j = 0; j < m_nrColumns; j++ )
+        {
+          chunk.data[j][k] = record[j];
+        }
+      }
+      if( !result )
+        break;
+
+      if( !MTX_SaveColumnar( &chunk, m_Path.c_str(), m_Header.c_str(), nr, m_isColumnarCompressed, i > 0 ) )
+      {
+        GNSS_ERROR_MSG( "MTX_SaveColumnar returned FALSE." );
+        result = false;
+      }
+    }
+    MTX_Free( &chunk );
+    return result;
+  }
+
+
+  bool GNSS_PVTWriter::Close()
+  {
+    bool result = true;
+
+    if( m_File == NULL )
+    {
+      return true;
+    }
+
+    if( !m_RecordPath.empty() && m_nrEpochs > 0 )
+    {
+      if( m_Format == PVT_FORMAT_COLUMNAR )
+      {
+        if( !ConvertRecordsToColumnar() )
+        {
+          GNSS_ERROR_MSG( "ConvertRecordsToColumnar returned false." );
+          result = false;
+        }
+      }
+      else if( !ConvertRecords() )
+      {
+        GNSS_ERROR_MSG( "ConvertRecords returned false." );
+        result = false;
+      }
+    }
+    if( fclose( m_File ) != 0 )
+    {
+      GNSS_ERROR_MSG( "Unable to close the PVT file." );
+      result = false;
+    }
+    m_File = NULL;
+
+    if( !m_RecordPath.empty() )
+    {
+      remove( m_RecordPath.c_str() );
+      m_RecordPath.clear();
+    }
+    else if( m_nrEpochs == 0 )
+    {
+      remove( m_Path.c_str() );
+    }
+    return result;
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,188 @@
+/**
+\file    GNSS_PVTWriter.h
+\brief   A streaming writer for the position, velocity, and time results 
+         of each epoch, as comma delimited text or binary records.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_PVTWRITER_H_
+#define _GNSS_PVTWRITER_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace GNSS
+{
+  /**
+  \brief   A streaming writer for the PVT results.
+
+  Each epoch is written when it is produced, through a large file 
+  buffer, so the memory used does not grow with the length of the 
+  session. 
+
+  The comma delimited format has a header line followed by one line 
+  per epoch (each value formatted with %.12g). The binary format has 
+  a header, followed by one record of nrColumns doubles (native byte 
+  order) per epoch:
+  \code
+  char     magic[8];      "GNSSPVT1"
+  unsigned nrColumns;     32 bit
+  unsigned headerLength;  32 bit, the number of characters in the column names
+  char     header[headerLength]; the comma delimited column names
+  \endcode
+
+  If the writer is opened as updatable, the values of epochs already 
+  written can be replaced (e.g. by a smoother) until the writer is closed. 
+  The binary records are updated in place. For the comma delimited format,
+  the epochs are kept in a binary record file that is converted to text 
+  and removed when the writer is closed.
+
+  The columnar format (MTX_SaveColumnar) stores chunks of epochs with each 
+  column as a separate, optionally compressed, block so that analysis tools 
+  can read only the columns and time range needed (MTX_ReadColumnar). The 
+  epochs are kept in a binary record file until the writer is closed.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_PVTWriter
+  {
+  public:
+
+    enum Format
+    {
+      PVT_FORMAT_CSV = 0,     //!< Comma delimited text.
+      PVT_FORMAT_BINARY = 1,  //!< Binary records.
+      PVT_FORMAT_COLUMNAR = 2 //!< Columnar matrix file (MTX_SaveColumnar).
+    };
+
+  public:
+
+    /// \brief    The default constructor (not open).
+    GNSS_PVTWriter();
+
+    /// \brief    The destructor. The writer is closed.
+    virtual ~GNSS_PVTWriter();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_PVTWriter( const GNSS_PVTWriter& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_PVTWriter& rhs);
+
+  public:
+
+    /// \brief    Open the output file and write the header.
+    /// \return   true if successful, false if error.
+    bool Open( 
+      const char* path,          //!< The output file path.
+      const Format format,       //!< The output format.
+      const unsigned nrColumns,  //!< The number of values per epoch.
+      const char* header,        //!< The comma delimited column names (without a line ending).
+      const bool isUpdatable     //!< A boolean to indicate if UpdateEpoch is used. For the comma delimited format, the record file is path with ".tmp" appended.
+      );
+
+    /// \brief    Write the values of the next epoch.
+    /// \return   true if successful, false if error.
+    bool WriteEpoch( 
+      const double* data  //!< The values of the epoch [nrColumns].
+      );
+
+    /// \brief    Replace some of the values of an epoch already written. 
+    ///           Only available if the writer was opened as updatable.
+    /// \return   true if successful, false if error.
+    bool UpdateEpoch( 
+      const unsigned epoch,        //!< The epoch index, in the order written, starting at 0.
+      const unsigned firstColumn,  //!< The first column replaced.
+      const double* data,          //!< The new values.
+      const unsigned n             //!< The number of values replaced.
+      );
+
+    /// \brief    Write the buffered epochs to the file (e.g. for real time output).
+    ///           The comma delimited and binary formats can then be read as 
+    ///           they are written. The columnar format is written by Close.
+    /// \return   true if successful, false if error.
+    bool Flush();
+
+    /// \brief    Complete the output file and close it. The output file is 
+    ///           removed if no epochs were written.
+    /// \return   true if successful, false if error.
+    bool Close();
+
+    /// \brief    Enable or disable the compression of the columnar format (enabled by default).
+    ///           Applies to the next Open.
+    void SetColumnarCompression( const bool isCompressed ) { m_isColumnarCompressed = isCompressed; }
+
+    /// \brief    The number of epochs written.
+    unsigned GetNrEpochs() const { return m_nrEpochs; }
+
+    /// \brief    Is the writer open.
+    bool IsOpen() const { return m_File != NULL; }
+
+  protected:
+
+    /// \brief    Write the values of one epoch as a comma delimited line.
+    /// \return   true if successful, false if error.
+    bool WriteDelimited( FILE* fid, const double* data );
+
+    /// \brief    Convert the binary record file to the comma delimited output file.
+    /// \return   true if successful, false if error.
+    bool ConvertRecords();
+
+    /// \brief    Convert the binary record file to the columnar output file.
+    /// \return   true if successful, false if error.
+    bool ConvertRecordsToColumnar();
+
+  protected:
+
+    Format m_Format;              //!< The output format.
+    unsigned m_nrColumns;         //!< The number of values per epoch.
+    unsigned m_nrEpochs;          //!< The number of epochs written.
+    bool m_isUpdatable;           //!< Are epochs updated before the writer is closed.
+    bool m_isAtEnd;               //!< Is the record file positioned at the end.
+    bool m_isColumnarCompressed;  //!< Are the column blocks of the columnar format compressed.
+    double m_dataOffset;          //!< The offset of the first record in the record file [bytes].
+    std::string m_Path;           //!< The output file path.
+    std::string m_RecordPath;     //!< The path of the record file if it is not the output file.
+    std::string m_Header;         //!< The comma delimited column names.
+    FILE* m_File;                 //!< The file written for each epoch, NULL if not open.
+    std::vector<char> m_Buffer;   //!< The buffer of m_File.
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_PVTWRITER_H_
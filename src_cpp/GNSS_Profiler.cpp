@@ -0,0 +1,356 @@
+/**
+\file    GNSS_Profiler.cpp
+\brief   Per stage latency instrumentation for the processing loop.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include <math.h>
+#include <string.h>
+#include "gnss_error.h"
+#include "cmatrix.h"
+#include "GNSS_Profiler.h"
+
+/// The upper edge of the first histogram bin [s].
+#define GNSS_PROFILE_FIRST_BIN_EDGE (1.0e-06)
+
+/// The number of histogram bins per octave (factor of two in duration).
+#define GNSS_PROFILE_BINS_PER_OCTAVE (3)
+
+namespace GNSS
+{
+  GNSS_Profiler::GNSS_Profiler()
+    : m_isEnabled(false),
+    m_TraceFile(NULL),
+    m_isInEpoch(false),
+    m_isEpochTimeSet(false),
+    m_EpochStart(0),
+    m_EpochStartAllocations(0),
+    m_gpsWeek(0),
+    m_gpsTow(0),
+    m_nrEpochs(0)
+  {
+    unsigned i = 0;
+    memset( m_Stages, 0, sizeof(m_Stages) );
+    for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+    {
+      m_EpochStageTime[i] = 0;
+    }
+  }
+
+
+  GNSS_Profiler::~GNSS_Profiler()
+  {
+    if( m_TraceFile != NULL )
+    {
+      fclose( m_TraceFile );
+      m_TraceFile = NULL;
+    }
+  }
+
+
+  bool GNSS_Profiler::Enable( const std::string& tracePath )
+  {
+#ifdef GNSS_NO_PROFILING
+    GNSS_ERROR_MSG( "Profiling was removed at compile time (GNSS_NO_PROFILING)." );
+    return false;
+#else
+    unsigned i = 0;
+    if( !tracePath.empty() )
+    {
+      if( m_TraceFile != NULL )
+      {
+        fclose( m_TraceFile );
+      }
+      m_TraceFile = fopen( tracePath.c_str(), "w" );
+      if( m_TraceFile == NULL )
+      {
+        GNSS_ERROR_MSG( "if( m_TraceFile == NULL )" );
+        return false;
+      }
+      fprintf( m_TraceFile, "gps_week,gps_tow" );
+      for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+      {
+        fprintf( m_TraceFile, ",%s_us", GetStageName( (GNSS_enumProfileStage)i ) );
+      }
+      fprintf( m_TraceFile, ",matrix_allocations\n" );
+    }
+    m_isEnabled = true;
+    return true;
+#endif
+  }
+
+
+  void GNSS_Profiler::BeginEpoch()
+  {
+    unsigned i = 0;
+    if( !m_isEnabled )
+      return;
+    if( m_isInEpoch )
+    {
+      // The previous epoch was skipped (e.g. no valid observations) without ending it.
+      EndEpoch();
+    }
+    for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+    {
+      m_EpochStageTime[i] = 0;
+    }
+    m_isInEpoch = true;
+    m_isEpochTimeSet = false;
+    m_EpochStartAllocations = GetNrAllocations();
+    m_EpochStart = GetTime();
+  }
+
+
+  void GNSS_Profiler::SetEpochTime( const unsigned short gpsWeek, const double gpsTow )
+  {
+    if( !m_isEnabled || !m_isInEpoch )
+      return;
+    m_gpsWeek = gpsWeek;
+    m_gpsTow = gpsTow;
+    m_isEpochTimeSet = true;
+  }
+
+
+  bool GNSS_Profiler::EndEpoch()
+  {
+    unsigned i = 0;
+    unsigned nrAllocations = 0;
+    if( !m_isEnabled || !m_isInEpoch )
+      return true;
+
+    if( !m_isEpochTimeSet )
+    {
+      m_isInEpoch = false;
+      return true;
+    }
+
+    nrAllocations = GetNrAllocations() - m_EpochStartAllocations;
+    AddStageTime( GNSS_PROFILE_EPOCH, GetTime() - m_EpochStart, nrAllocations );
+    m_isInEpoch = false;
+    m_nrEpochs++;
+
+    if( m_TraceFile != NULL )
+    {
+      fprintf( m_TraceFile, "%d,%.3lf", m_gpsWeek, m_gpsTow );
+      for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+      {
+        fprintf( m_TraceFile, ",%.1lf", m_EpochStageTime[i]*1.0e6 );
+      }
+      if( fprintf( m_TraceFile, ",%u\n", nrAllocations ) < 0 )
+      {
+        GNSS_ERROR_MSG( "if( fprintf( m_TraceFile, ... ) < 0 )" );
+        return false;
+      }
+    }
+    return true;
+  }
+
+
+  void GNSS_Profiler::AddStageTime( const GNSS_enumProfileStage stage, const double duration, const unsigned nrAllocations )
+  {
+    unsigned bin = 0;
+    double edge = GNSS_PROFILE_FIRST_BIN_EDGE;
+    const double factor = pow( 2.0, 1.0/GNSS_PROFILE_BINS_PER_OCTAVE );
+
+    if( stage >= GNSS_PROFILE_NR_STAGES )
+      return;
+
+    stStageStatistics& stats = m_Stages[stage];
+    if( stats.count == 0 || duration < stats.minimum )
+      stats.minimum = duration;
+    if( stats.count == 0 || duration > stats.maximum )
+      stats.maximum = duration;
+    stats.count++;
+    stats.total += duration;
+    stats.nrAllocations += nrAllocations;
+
+    // The geometric bins, the last one is open ended.
+    while( bin < GNSS_PROFILE_NR_BINS-1 && duration > edge )
+    {
+      bin++;
+      edge *= factor;
+    }
+    stats.histogram[bin]++;
+
+    if( m_isInEpoch )
+      m_EpochStageTime[stage] += duration;
+  }
+
+
+  double GNSS_Profiler::GetBinUpperEdge( const unsigned bin )
+  {
+    return GNSS_PROFILE_FIRST_BIN_EDGE * pow( 2.0, (double)bin / GNSS_PROFILE_BINS_PER_OCTAVE );
+  }
+
+
+  double GNSS_Profiler::GetPercentile( const stStageStatistics& stats, const double fraction ) const
+  {
+    unsigned bin = 0;
+    unsigned sum = 0;
+    double edge = 0;
+    const double target = fraction * stats.count;
+
+    if( stats.count == 0 )
+      return 0;
+    for( bin = 0; bin < GNSS_PROFILE_NR_BINS; bin++ )
+    {
+      sum += stats.histogram[bin];
+      if( sum >= target && sum > 0 )
+        break;
+    }
+    if( bin >= GNSS_PROFILE_NR_BINS-1 )
+      return stats.maximum;
+    edge = GetBinUpperEdge( bin );
+    if( edge > stats.maximum )
+      return stats.maximum;
+    return edge;
+  }
+
+
+  void GNSS_Profiler::PrintReport( FILE* fid, const bool includeHistograms ) const
+  {
+    unsigned i = 0;
+    unsigned bin = 0;
+    if( fid == NULL )
+      return;
+
+    fprintf( fid, "\nProcessing latency per stage (%u epochs), times in microseconds.\n", m_nrEpochs );
+    fprintf( fid, "%-14s %8s %10s %10s %10s %10s %10s %10s %12s\n", 
+      "stage", "count", "mean", "min", "p50", "p95", "p99", "max", "allocations" );
+    for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+    {
+      const stStageStatistics& stats = m_Stages[i];
+      if( stats.count == 0 )
+        continue;
+      fprintf( fid, "%-14s %8u %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf %10.1lf %12u\n",
+        GetStageName( (GNSS_enumProfileStage)i ),
+        stats.count,
+        stats.total / stats.count * 1.0e6,
+        stats.minimum * 1.0e6,
+        GetPercentile( stats, 0.50 ) * 1.0e6,
+        GetPercentile( stats, 0.95 ) * 1.0e6,
+        GetPercentile( stats, 0.99 ) * 1.0e6,
+        stats.maximum * 1.0e6,
+        stats.nrAllocations );
+    }
+
+    if( !includeHistograms )
+      return;
+    for( i = 0; i < GNSS_PROFILE_NR_STAGES; i++ )
+    {
+      const stStageStatistics& stats = m_Stages[i];
+      if( stats.count == 0 )
+        continue;
+      fprintf( fid, "\nHistogram of %s (upper bin edge in microseconds, count).\n", GetStageName( (GNSS_enumProfileStage)i ) );
+      for( bin = 0; bin < GNSS_PROFILE_NR_BINS; bin++ )
+      {
+        if( stats.histogram[bin] == 0 )
+          continue;
+        if( bin == GNSS_PROFILE_NR_BINS-1 )
+          fprintf( fid, "%12s %8u\n", "inf", stats.histogram[bin] );
+        else
+          fprintf( fid, "%12.1lf %8u\n", GetBinUpperEdge( bin )*1.0e6, stats.histogram[bin] );
+      }
+    }
+  }
+
+
+  bool GNSS_Profiler::WriteReport( const std::string& path ) const
+  {
+    FILE* fid = NULL;
+    fid = fopen( path.c_str(), "w" );
+    if( fid == NULL )
+    {
+      GNSS_ERROR_MSG( "if( fid == NULL )" );
+      return false;
+    }
+    PrintReport( fid, true );
+    fclose( fid );
+    return true;
+  }
+
+
+  double GNSS_Profiler::GetTime()
+  {
+#ifdef WIN32
+    static LARGE_INTEGER frequency;
+    static bool isFrequencySet = false;
+    LARGE_INTEGER counter;
+    if( !isFrequencySet )
+    {
+      QueryPerformanceFrequency( &frequency );
+      isFrequencySet = true;
+    }
+    QueryPerformanceCounter( &counter );
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + ts.tv_nsec*1.0e-9;
+#endif
+  }
+
+
+  unsigned GNSS_Profiler::GetNrAllocations()
+  {
+    unsigned nrAllocations = 0;
+    MTX_GetAllocationCounters( &nrAllocations, NULL );
+    return nrAllocations;
+  }
+
+
+  const char* GNSS_Profiler::GetStageName( const GNSS_enumProfileStage stage )
+  {
+    switch( stage )
+    {
+    case GNSS_PROFILE_EPOCH:          return "epoch";
+    case GNSS_PROFILE_LOAD:           return "load";
+    case GNSS_PROFILE_LEAST_SQUARES:  return "least_squares";
+    case GNSS_PROFILE_SATELLITE_PVT:  return "satellite_pvt";
+    case GNSS_PROFILE_ATMOSPHERE:     return "atmosphere";
+    case GNSS_PROFILE_PREDICT:        return "predict";
+    case GNSS_PROFILE_KALMAN_UPDATE:  return "kalman_update";
+    case GNSS_PROFILE_AMBIGUITY:      return "ambiguity";
+    case GNSS_PROFILE_OUTPUT:         return "output";
+    case GNSS_PROFILE_END_TO_END:     return "end_to_end";
+    default:                          return "unknown";
+    }
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,277 @@
+/**
+\file    GNSS_Profiler.h
+\brief   Per stage latency instrumentation for the processing loop.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_PROFILER_H_
+#define _GNSS_PROFILER_H_
+
+#include <stdio.h>
+#include <string>
+
+namespace GNSS
+{
+  /// \brief   The processing stages timed by GNSS_Profiler. 
+  /// The satellite PVT, atmosphere, and ambiguity stages are nested within the
+  /// least squares and Kalman update stages, all stages are within the epoch.
+  typedef enum 
+  {
+    GNSS_PROFILE_EPOCH = 0,     //!< The whole epoch, from loading the measurements to the output.
+    GNSS_PROFILE_LOAD,          //!< LoadNext or GetNextSetOfSynchronousMeasurements.
+    GNSS_PROFILE_LEAST_SQUARES, //!< PerformLeastSquares.
+    GNSS_PROFILE_SATELLITE_PVT, //!< DetermineSatellitePVT_GPSL1.
+    GNSS_PROFILE_ATMOSPHERE,    //!< DetermineAtmosphericCorrections_GPSL1.
+    GNSS_PROFILE_PREDICT,       //!< PredictAhead_EKF or PredictAhead_RTK.
+    GNSS_PROFILE_KALMAN_UPDATE, //!< Kalman_Update_EKF, Kalman_Update_RTK, or the triple difference solution.
+    GNSS_PROFILE_AMBIGUITY,     //!< The integer ambiguity search.
+    GNSS_PROFILE_OUTPUT,        //!< OutputPVT and OutputObservationData.
+    GNSS_PROFILE_END_TO_END,    //!< Real time only, from the epoch's measurements being available to its PVT being written.
+    GNSS_PROFILE_NR_STAGES
+  } GNSS_enumProfileStage;
+
+  /// The number of histogram bins per stage, three per octave from 1 us (the last bin is open ended).
+#define GNSS_PROFILE_NR_BINS (64)
+
+  /**
+  \brief   Per stage latency statistics and an optional per epoch trace.
+
+  Each stage keeps the number of calls, the total, minimum, and maximum 
+  duration, the number of matrix allocations (MTX_GetAllocationCounters), 
+  and a histogram of the durations from which the percentiles are reported.
+  Stages are timed with GNSS_PROFILE_SCOPE, which is removed at compile 
+  time when GNSS_NO_PROFILING is defined. When the profiler is not enabled
+  the timers only test a flag.
+
+  \code
+  GNSS_Profiler profiler;
+  profiler.Enable( "profile_trace.csv" );
+  while( ... )
+  {
+    profiler.BeginEpoch();
+    {
+      GNSS_PROFILE_SCOPE( &profiler, GNSS_PROFILE_LOAD );
+      rxData.LoadNext( endOfStream );
+    }
+    profiler.SetEpochTime( rxData.m_pvt.time.gps_week, rxData.m_pvt.time.gps_tow );
+    ...
+    profiler.EndEpoch();
+  }
+  profiler.PrintReport( stdout, false );
+  \endcode
+
+  Not thread safe, use one profiler per processing thread.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_Profiler
+  {
+  public:
+
+    /// \brief    The default constructor (not enabled).
+    GNSS_Profiler();
+
+    /// \brief    The destructor. The trace file is closed.
+    virtual ~GNSS_Profiler();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_Profiler( const GNSS_Profiler& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_Profiler& rhs);
+
+  public:
+
+    /// \brief    Enable the profiler. 
+    /// \return   true if successful, false if error (or if profiling was removed at compile time).
+    bool Enable( 
+      const std::string& tracePath //!< The path of the per epoch trace (csv), empty for no trace.
+      );
+
+    /// \brief    Is the profiler enabled?
+    bool IsEnabled() const { return m_isEnabled; }
+
+    /// \brief    Start an epoch. If the previous epoch was not ended, it is ended first.
+    void BeginEpoch();
+
+    /// \brief    Set the time of the current epoch. Epochs that end before 
+    ///           their time is set (e.g. no valid observations or the end of 
+    ///           the data) are not counted, only their stages are.
+    void SetEpochTime( 
+      const unsigned short gpsWeek, //!< The GPS week.
+      const double gpsTow           //!< The GPS time of week [s].
+      );
+
+    /// \brief    End the current epoch, update the epoch statistics and write the trace line.
+    /// \return   true if successful, false if error.
+    bool EndEpoch();
+
+    /// \brief    Add one execution of a stage.
+    void AddStageTime( 
+      const GNSS_enumProfileStage stage, //!< The stage.
+      const double duration,             //!< The duration [s].
+      const unsigned nrAllocations       //!< The number of matrix allocations during the stage.
+      );
+
+    /// \brief    Print the per stage statistics.
+    void PrintReport( 
+      FILE* fid,                   //!< The output file (e.g. stdout).
+      const bool includeHistograms //!< Print the non empty histogram bins of each stage.
+      ) const;
+
+    /// \brief    Write the per stage statistics and histograms to a file.
+    /// \return   true if successful, false if error.
+    bool WriteReport( const std::string& path ) const;
+
+    /// \brief    The number of epochs with a time.
+    unsigned GetNrEpochs() const { return m_nrEpochs; }
+
+    /// \brief    The monotonic time [s] (QueryPerformanceCounter or CLOCK_MONOTONIC).
+    static double GetTime();
+
+    /// \brief    The number of matrix allocations so far.
+    static unsigned GetNrAllocations();
+
+    /// \brief    The name of a stage.
+    static const char* GetStageName( const GNSS_enumProfileStage stage );
+
+  protected:
+
+    /// \brief   The statistics of one stage.
+    struct stStageStatistics
+    {
+      unsigned count;                       //!< The number of executions.
+      double total;                         //!< The total duration [s].
+      double minimum;                       //!< The shortest duration [s].
+      double maximum;                       //!< The longest duration [s].
+      unsigned nrAllocations;               //!< The total number of matrix allocations.
+      unsigned histogram[GNSS_PROFILE_NR_BINS]; //!< The number of executions in each duration bin.
+    };
+
+    /// \brief   The duration [s] at the given fraction (0 to 1) of the executions of a stage.
+    ///          The upper edge of the histogram bin, limited to the maximum.
+    double GetPercentile( const stStageStatistics& stats, const double fraction ) const;
+
+    /// \brief   The upper edge of a histogram bin [s].
+    static double GetBinUpperEdge( const unsigned bin );
+
+  protected:
+
+    /// A boolean to indicate if the profiler is enabled.
+    bool m_isEnabled;
+
+    /// The per epoch trace file, NULL if none.
+    FILE* m_TraceFile;
+
+    /// The statistics of each stage.
+    stStageStatistics m_Stages[GNSS_PROFILE_NR_STAGES];
+
+    /// The time of each stage within the current epoch [s].
+    double m_EpochStageTime[GNSS_PROFILE_NR_STAGES];
+
+    /// A boolean to indicate if an epoch is being timed.
+    bool m_isInEpoch;
+
+    /// A boolean to indicate if the time of the current epoch is set.
+    bool m_isEpochTimeSet;
+
+    /// The start of the current epoch (GetTime) [s].
+    double m_EpochStart;
+
+    /// The number of matrix allocations at the start of the current epoch.
+    unsigned m_EpochStartAllocations;
+
+    /// The GPS week of the current epoch.
+    unsigned short m_gpsWeek;
+
+    /// The GPS time of week of the current epoch [s].
+    double m_gpsTow;
+
+    /// The number of epochs with a time.
+    unsigned m_nrEpochs;
+  };
+
+
+  /**
+  \brief   Times a stage from construction to destruction (see GNSS_PROFILE_SCOPE).
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_ProfileTimer
+  {
+  public:
+
+    /// \brief    Start timing the stage if the profiler is enabled.
+    GNSS_ProfileTimer( GNSS_Profiler* profiler, const GNSS_enumProfileStage stage )
+      : m_Profiler(NULL), m_Stage(stage), m_Start(0), m_StartAllocations(0)
+    {
+      if( profiler != NULL && profiler->IsEnabled() )
+      {
+        m_Profiler = profiler;
+        m_StartAllocations = GNSS_Profiler::GetNrAllocations();
+        m_Start = GNSS_Profiler::GetTime();
+      }
+    }
+
+    /// \brief    Add the duration of the stage to the profiler.
+    ~GNSS_ProfileTimer()
+    {
+      if( m_Profiler != NULL )
+      {
+        m_Profiler->AddStageTime( m_Stage, GNSS_Profiler::GetTime() - m_Start, GNSS_Profiler::GetNrAllocations() - m_StartAllocations );
+      }
+    }
+
+  protected:
+    GNSS_Profiler* m_Profiler;       //!< The profiler, NULL if not enabled.
+    GNSS_enumProfileStage m_Stage;   //!< The stage timed.
+    double m_Start;                  //!< The start time [s].
+    unsigned m_StartAllocations;     //!< The number of matrix allocations at the start.
+  };
+
+} // end namespace GNSS
+
+
+/// Time the enclosing scope as the given stage (a GNSS_enumProfileStage value, 
+/// without the namespace). Removed at compile time if GNSS_NO_PROFILING is defined.
+#ifndef GNSS_NO_PROFILING
+#define GNSS_PROFILE_SCOPE( profiler, stage ) GNSS::GNSS_ProfileTimer gnss_profile_timer_##stage( (profiler), GNSS::stage )
+#else
+#define GNSS_PROFILE_SCOPE( profiler, stage )
+#endif
+
+#endif // _GNSS_PROFILER_H_
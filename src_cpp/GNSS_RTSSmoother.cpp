@@ -0,0 +1,588 @@
+/**
+\file    GNSS_RTSSmoother.cpp
+\brief   A Rauch-Tung-Striebel fixed interval smoother for post processed
+         trajectories from the EKF, RTK4, and RTK8 filters.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include "gnss_error.h"
+#include "geodesy.h"
+#include "GNSS_RTSSmoother.h"
+
+// The offsets of the fields in an epoch record [doubles].
+#define RTS_TAG       (0)
+#define RTS_WEEK      (1)
+#define RTS_TOW       (2)
+#define RTS_XP        (3)  // The predicted solution, lat, lon, hgt, vn, ve, vup, clk, clkdrift.
+#define RTS_XF        (11) // The updated solution, lat, lon, hgt, vn, ve, vup, clk, clkdrift.
+#define RTS_STDF      (19) // The standard deviations of the updated solution.
+#define RTS_MATRICES  (27) // The packed predicted and updated covariances followed by the transition matrix.
+
+namespace GNSS
+{
+  /// \brief   Pack the upper triangle of the leading n x n block of P.
+  static void RTSSmoother_PackCovariance( Matrix& P, const unsigned n, double* packed )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    for( i = 0; i < n; i++ )
+    {
+      for( j = i; j < n; j++ )
+      {
+        packed[k] = P[i][j];
+        k++;
+      }
+    }
+  }
+
+  /// \brief   Unpack a covariance matrix stored with RTSSmoother_PackCovariance.
+  static bool RTSSmoother_UnpackCovariance( const double* packed, const unsigned n, Matrix& P )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    if( P.GetNrRows() != n || P.GetNrCols() != n )
+    {
+      if( !P.Resize( n, n ) )
+      {
+        GNSS_ERROR_MSG( "if( !P.Resize( n, n ) )" );
+        return false;
+      }
+    }
+    for( i = 0; i < n; i++ )
+    {
+      for( j = i; j < n; j++ )
+      {
+        P[i][j] = packed[k];
+        P[j][i] = packed[k];
+        k++;
+      }
+    }
+    return true;
+  }
+
+  /// \brief   Unpack a square matrix stored row by row.
+  static bool RTSSmoother_UnpackSquare( const double* data, const unsigned n, Matrix& M )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    if( M.GetNrRows() != n || M.GetNrCols() != n )
+    {
+      if( !M.Resize( n, n ) )
+      {
+        GNSS_ERROR_MSG( "if( !M.Resize( n, n ) )" );
+        return false;
+      }
+    }
+    for( i = 0; i < n; i++ )
+    {
+      for( j = 0; j < n; j++ )
+      {
+        M[i][j] = data[i*n+j];
+      }
+    }
+    return true;
+  }
+
+  /// \brief   Seek to an offset in the spill file. Offsets may exceed 2 GB.
+  static bool RTSSmoother_Seek( FILE* fid, const double offset )
+  {
+#ifdef WIN32
+    return _fseeki64( fid, (__int64)offset, SEEK_SET ) == 0;
+#else
+    return fseeko( fid, (off_t)offset, SEEK_SET ) == 0;
+#endif
+  }
+
+
+  GNSS_RTSSmoother::GNSS_RTSSmoother()
+    : m_nrStates(0),
+    m_recordLength(0),
+    m_maxEpochsInMemory(0),
+    m_nrEpochs(0),
+    m_nrInBlock(0),
+    m_nrBlocksSpilled(0),
+    m_SpillFile(NULL)
+  {
+    unsigned i = 0;
+    for( i = 0; i < 8; i++ )
+      m_stateIndex[i] = i;
+  }
+
+  GNSS_RTSSmoother::~GNSS_RTSSmoother()
+  {
+    CloseSpillFile();
+  }
+
+
+  void GNSS_RTSSmoother::CloseSpillFile()
+  {
+    if( m_SpillFile != NULL )
+    {
+      fclose( m_SpillFile );
+      m_SpillFile = NULL;
+      remove( m_SpillFilePath.c_str() );
+    }
+    m_nrBlocksSpilled = 0;
+  }
+
+
+  bool GNSS_RTSSmoother::Initialize( 
+    const unsigned nrStates,
+    const unsigned maxEpochsInMemory,
+    const char* spillFilePath
+    )
+  {
+    const unsigned fourStateIndex[4] = { 0, 1, 2, 6 }; // lat, lon, hgt, clk
+    unsigned i = 0;
+
+    if( nrStates != 4 && nrStates != 8 )
+    {
+      GNSS_ERROR_MSG( "if( nrStates != 4 && nrStates != 8 )" );
+      return false;
+    }
+    if( maxEpochsInMemory < 2 )
+    {
+      GNSS_ERROR_MSG( "if( maxEpochsInMemory < 2 )" );
+      return false;
+    }
+    if( spillFilePath == NULL )
+    {
+      GNSS_ERROR_MSG( "if( spillFilePath == NULL )" );
+      return false;
+    }
+
+    CloseSpillFile();
+
+    m_nrStates = nrStates;
+    for( i = 0; i < nrStates; i++ )
+    {
+      if( nrStates == 4 )
+        m_stateIndex[i] = fourStateIndex[i];
+      else
+        m_stateIndex[i] = i;
+    }
+    m_recordLength = RTS_MATRICES + nrStates*(nrStates+1) + nrStates*nrStates;
+    m_maxEpochsInMemory = maxEpochsInMemory;
+    m_nrEpochs = 0;
+    m_nrInBlock = 0;
+    m_SpillFilePath = spillFilePath;
+    m_Block.resize( m_recordLength*m_maxEpochsInMemory );
+    return true;
+  }
+
+
+  bool GNSS_RTSSmoother::AddEpoch( 
+    const unsigned tag,
+    const double dT,
+    const GNSS_structPVT& predicted,
+    Matrix& P_predicted,
+    Matrix& T,
+    const GNSS_structPVT& filtered,
+    Matrix& P_filtered
+    )
+  {
+    const unsigned n = m_nrStates;
+    const unsigned nP = n*(n+1)/2;
+    double* record = NULL;
+    unsigned i = 0;
+    unsigned j = 0;
+
+    if( n == 0 )
+    {
+      GNSS_ERROR_MSG( "if( n == 0 )" );
+      return false;
+    }
+    if( P_predicted.GetNrRows() < n || P_predicted.GetNrCols() < n 
+      || P_filtered.GetNrRows() < n || P_filtered.GetNrCols() < n )
+    {
+      GNSS_ERROR_MSG( "The state variance-covariance matrices are too small." );
+      return false;
+    }
+    if( dT != 0.0 && (T.GetNrRows() < n || T.GetNrCols() < n) )
+    {
+      GNSS_ERROR_MSG( "if( dT != 0.0 && (T.GetNrRows() < n || T.GetNrCols() < n) )" );
+      return false;
+    }
+
+    if( m_nrInBlock == m_maxEpochsInMemory )
+    {
+      if( !SpillBlock() )
+      {
+        GNSS_ERROR_MSG( "SpillBlock returned false." );
+        return false;
+      }
+    }
+
+    record = &m_Block[m_nrInBlock*m_recordLength];
+
+    record[RTS_TAG]  = tag;
+    record[RTS_WEEK] = filtered.time.gps_week;
+    record[RTS_TOW]  = filtered.time.gps_tow;
+
+    record[RTS_XP+0] = predicted.latitude;
+    record[RTS_XP+1] = predicted.longitude;
+    record[RTS_XP+2] = predicted.height;
+    record[RTS_XP+3] = predicted.vn;
+    record[RTS_XP+4] = predicted.ve;
+    record[RTS_XP+5] = predicted.vup;
+    record[RTS_XP+6] = predicted.clockOffset;
+    record[RTS_XP+7] = predicted.clockDrift;
+
+    record[RTS_XF+0] = filtered.latitude;
+    record[RTS_XF+1] = filtered.longitude;
+    record[RTS_XF+2] = filtered.height;
+    record[RTS_XF+3] = filtered.vn;
+    record[RTS_XF+4] = filtered.ve;
+    record[RTS_XF+5] = filtered.vup;
+    record[RTS_XF+6] = filtered.clockOffset;
+    record[RTS_XF+7] = filtered.clockDrift;
+
+    record[RTS_STDF+0] = filtered.std_lat;
+    record[RTS_STDF+1] = filtered.std_lon;
+    record[RTS_STDF+2] = filtered.std_hgt;
+    record[RTS_STDF+3] = filtered.std_vn;
+    record[RTS_STDF+4] = filtered.std_ve;
+    record[RTS_STDF+5] = filtered.std_vup;
+    record[RTS_STDF+6] = filtered.std_clk;
+    record[RTS_STDF+7] = filtered.std_clkdrift;
+
+    RTSSmoother_PackCovariance( P_predicted, n, record + RTS_MATRICES );
+    RTSSmoother_PackCovariance( P_filtered, n, record + RTS_MATRICES + nP );
+
+    // The filters do not compute the transition matrix when dT is zero.
+    for( i = 0; i < n; i++ )
+    {
+      for( j = 0; j < n; j++ )
+      {
+        if( dT == 0.0 )
+          record[RTS_MATRICES + 2*nP + i*n + j] = (i == j) ? 1.0 : 0.0;
+        else
+          record[RTS_MATRICES + 2*nP + i*n + j] = T[i][j];
+      }
+    }
+
+    m_nrInBlock++;
+    m_nrEpochs++;
+    return true;
+  }
+
+
+  bool GNSS_RTSSmoother::SpillBlock()
+  {
+    size_t nrWritten = 0;
+    if( m_SpillFile == NULL )
+    {
+      m_SpillFile = fopen( m_SpillFilePath.c_str(), "w+b" );
+      if( m_SpillFile == NULL )
+      {
+        char msg[512];
+        sprintf( msg, "Unable to open the smoother spill file: %.256s", m_SpillFilePath.c_str() );
+        GNSS_ERROR_MSG( msg );
+        return false;
+      }
+    }
+    nrWritten = fwrite( &m_Block[0], sizeof(double), m_recordLength*m_nrInBlock, m_SpillFile );
+    if( nrWritten != m_recordLength*m_nrInBlock )
+    {
+      GNSS_ERROR_MSG( "Unable to write to the smoother spill file." );
+      return false;
+    }
+    m_nrBlocksSpilled++;
+    m_nrInBlock = 0;
+    return true;
+  }
+
+
+  bool GNSS_RTSSmoother::ReadBlock( const unsigned block )
+  {
+    const double blockSize = (double)m_recordLength * m_maxEpochsInMemory * sizeof(double);
+    size_t nrRead = 0;
+
+    if( m_SpillFile == NULL || block >= m_nrBlocksSpilled )
+    {
+      GNSS_ERROR_MSG( "if( m_SpillFile == NULL || block >= m_nrBlocksSpilled )" );
+      return false;
+    }
+    if( !RTSSmoother_Seek( m_SpillFile, block*blockSize ) )
+    {
+      GNSS_ERROR_MSG( "Unable to seek in the smoother spill file." );
+      return false;
+    }
+    nrRead = fread( &m_Block[0], sizeof(double), m_recordLength*m_maxEpochsInMemory, m_SpillFile );
+    if( nrRead != m_recordLength*m_maxEpochsInMemory )
+    {
+      GNSS_ERROR_MSG( "Unable to read from the smoother spill file." );
+      return false;
+    }
+    return true;
+  }
+
+
+  bool GNSS_RTSSmoother::Smooth( OutputFunction output, void* arg )
+  {
+    const unsigned n = m_nrStates;
+    const unsigned nP = n*(n+1)/2;
+    unsigned i = 0;
+    unsigned block = 0;
+    unsigned nrInBlock = 0;
+    int r = 0;
+    bool isLastEpoch = true;
+    double* record = NULL;
+    double M = 0; // The meridian radius of curvature [m].
+    double N = 0; // The prime vertical radius of curvature [m].
+
+    double xs[8];      // The smoothed solution.
+    double stdev[8];   // The standard deviations of the smoothed solution.
+    double xs_next[8]; // The smoothed solution of the following epoch.
+    double xp_next[8]; // The predicted solution of the following epoch.
+
+    Matrix Pf;      // The updated state variance-covariance.
+    Matrix Ps;      // The smoothed state variance-covariance.
+    Matrix Pp_next; // The predicted state variance-covariance of the following epoch.
+    Matrix T_next;  // The transition matrix to the following epoch.
+    Matrix Ps_next; // The smoothed state variance-covariance of the following epoch.
+    Matrix C;       // The smoother gain.
+    Matrix invPp;
+    Matrix d(n);    // The difference between the smoothed and predicted states of the following epoch.
+    Matrix dx;
+    Matrix dP;
+    stSmoothedEpoch epoch;
+
+    if( output == NULL )
+    {
+      GNSS_ERROR_MSG( "if( output == NULL )" );
+      return false;
+    }
+    if( m_nrEpochs == 0 )
+      return true;
+
+    // The block in memory follows the spilled blocks.
+    for( block = m_nrBlocksSpilled+1; block > 0; block-- )
+    {
+      if( block-1 == m_nrBlocksSpilled )
+      {
+        nrInBlock = m_nrInBlock;
+      }
+      else
+      {
+        if( !ReadBlock( block-1 ) )
+        {
+          GNSS_ERROR_MSG( "ReadBlock returned false." );
+          return false;
+        }
+        nrInBlock = m_maxEpochsInMemory;
+      }
+
+      for( r = (int)nrInBlock-1; r >= 0; r-- )
+      {
+        record = &m_Block[r*m_recordLength];
+
+        for( i = 0; i < 8; i++ )
+          xs[i] = record[RTS_XF+i];
+        if( !RTSSmoother_UnpackCovariance( record + RTS_MATRICES + nP, n, Pf ) )
+        {
+          GNSS_ERROR_MSG( "RTSSmoother_UnpackCovariance returned false." );
+          return false;
+        }
+
+        if( isLastEpoch )
+        {
+          // The smoothed solution at the last epoch is the filtered solution.
+          if( !Ps.Copy( Pf ) )
+          {
+            GNSS_ERROR_MSG( "if( !Ps.Copy( Pf ) )" );
+            return false;
+          }
+          isLastEpoch = false;
+        }
+        else
+        {
+          // C = Pf * T_next^T * inv(Pp_next)
+          if( !invPp.Copy( Pp_next ) )
+          {
+            GNSS_ERROR_MSG( "if( !invPp.Copy( Pp_next ) )" );
+            return false;
+          }
+          if( !invPp.Inplace_Invert() )
+          {
+            GNSS_ERROR_MSG( "if( !invPp.Inplace_Invert() )" );
+            return false;
+          }
+          if( !C.Copy( Pf ) )
+          {
+            GNSS_ERROR_MSG( "if( !C.Copy( Pf ) )" );
+            return false;
+          }
+          if( !C.Inplace_PostMultiplyTranspose( T_next ) )
+          {
+            GNSS_ERROR_MSG( "if( !C.Inplace_PostMultiplyTranspose( T_next ) )" );
+            return false;
+          }
+          if( !C.Inplace_PostMultiply( invPp ) )
+          {
+            GNSS_ERROR_MSG( "if( !C.Inplace_PostMultiply( invPp ) )" );
+            return false;
+          }
+
+          // The difference between the smoothed and predicted states of 
+          // the following epoch in the filter's units, [m] for latitude and longitude.
+          GEODESY_ComputeMeridianRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, xp_next[0], &M );
+          GEODESY_ComputePrimeVerticalRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, xp_next[0], &N );
+          d[0] = (xs_next[0] - xp_next[0]) * (M + xp_next[2]);
+          d[1] = (xs_next[1] - xp_next[1]) * (N + xp_next[2]) * cos(xp_next[0]);
+          for( i = 2; i < n; i++ )
+            d[i] = xs_next[m_stateIndex[i]] - xp_next[m_stateIndex[i]];
+
+          // dx = C * d
+          if( !dx.Copy( C ) )
+          {
+            GNSS_ERROR_MSG( "if( !dx.Copy( C ) )" );
+            return false;
+          }
+          if( !dx.Inplace_PostMultiply( d ) )
+          {
+            GNSS_ERROR_MSG( "if( !dx.Inplace_PostMultiply( d ) )" );
+            return false;
+          }
+
+          // Apply the correction to the filtered solution. The height is 
+          // corrected first as it is needed to convert the latitude and longitude corrections.
+          for( i = 2; i < n; i++ )
+            xs[m_stateIndex[i]] += dx[i];
+          GEODESY_ComputeMeridianRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, xs[0], &M );
+          GEODESY_ComputePrimeVerticalRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, xs[0], &N );
+          xs[1] += dx[1] / ((N + xs[2]) * cos(xs[0]));
+          xs[0] += dx[0] / (M + xs[2]);
+
+          // Ps = Pf + C * (Ps_next - Pp_next) * C^T
+          if( !dP.Copy( Ps_next ) )
+          {
+            GNSS_ERROR_MSG( "if( !dP.Copy( Ps_next ) )" );
+            return false;
+          }
+          if( !dP.Inplace_Subtract( Pp_next ) )
+          {
+            GNSS_ERROR_MSG( "if( !dP.Inplace_Subtract( Pp_next ) )" );
+            return false;
+          }
+          if( !dP.Inplace_PreMultiply( C ) )
+          {
+            GNSS_ERROR_MSG( "if( !dP.Inplace_PreMultiply( C ) )" );
+            return false;
+          }
+          if( !dP.Inplace_PostMultiplyTranspose( C ) )
+          {
+            GNSS_ERROR_MSG( "if( !dP.Inplace_PostMultiplyTranspose( C ) )" );
+            return false;
+          }
+          if( !Ps.Copy( Pf ) )
+          {
+            GNSS_ERROR_MSG( "if( !Ps.Copy( Pf ) )" );
+            return false;
+          }
+          if( !Ps.Inplace_Add( dP ) )
+          {
+            GNSS_ERROR_MSG( "if( !Ps.Inplace_Add( dP ) )" );
+            return false;
+          }
+        }
+
+        epoch.tag  = (unsigned)record[RTS_TAG];
+        epoch.week = (unsigned short)record[RTS_WEEK];
+        epoch.tow  = record[RTS_TOW];
+        epoch.latitude    = xs[0];
+        epoch.longitude   = xs[1];
+        epoch.height      = xs[2];
+        epoch.vn          = xs[3];
+        epoch.ve          = xs[4];
+        epoch.vup         = xs[5];
+        epoch.clockOffset = xs[6];
+        epoch.clockDrift  = xs[7];
+
+        // The states that are not smoothed keep the filtered uncertainty.
+        for( i = 0; i < 8; i++ )
+          stdev[i] = record[RTS_STDF+i];
+        for( i = 0; i < n; i++ )
+          stdev[m_stateIndex[i]] = Ps[i][i] > 0.0 ? sqrt( Ps[i][i] ) : 0.0;
+        epoch.std_lat      = stdev[0];
+        epoch.std_lon      = stdev[1];
+        epoch.std_hgt      = stdev[2];
+        epoch.std_vn       = stdev[3];
+        epoch.std_ve       = stdev[4];
+        epoch.std_vup      = stdev[5];
+        epoch.std_clk      = stdev[6];
+        epoch.std_clkdrift = stdev[7];
+
+        if( !output( epoch, arg ) )
+        {
+          GNSS_ERROR_MSG( "The smoother output function returned false." );
+          return false;
+        }
+
+        // Keep the information needed for the preceding epoch.
+        for( i = 0; i < 8; i++ )
+        {
+          xs_next[i] = xs[i];
+          xp_next[i] = record[RTS_XP+i];
+        }
+        if( !RTSSmoother_UnpackCovariance( record + RTS_MATRICES, n, Pp_next ) )
+        {
+          GNSS_ERROR_MSG( "RTSSmoother_UnpackCovariance returned false." );
+          return false;
+        }
+        if( !RTSSmoother_UnpackSquare( record + RTS_MATRICES + 2*nP, n, T_next ) )
+        {
+          GNSS_ERROR_MSG( "RTSSmoother_UnpackSquare returned false." );
+          return false;
+        }
+        if( !Ps_next.Copy( Ps ) )
+        {
+          GNSS_ERROR_MSG( "if( !Ps_next.Copy( Ps ) )" );
+          return false;
+        }
+      }
+    }
+
+    // The block in memory has been overwritten by the spilled blocks.
+    m_nrEpochs = 0;
+    m_nrInBlock = 0;
+    CloseSpillFile();
+    return true;
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,189 @@
+/**
+\file    GNSS_RTSSmoother.h
+\brief   A Rauch-Tung-Striebel fixed interval smoother for post processed
+         trajectories from the EKF, RTK4, and RTK8 filters.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_RTSSMOOTHER_H_
+#define _GNSS_RTSSMOOTHER_H_
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "gnss_types.h"
+#include "Matrix.h"
+
+using namespace Zenautics; // for Matrix
+
+namespace GNSS
+{
+  /**
+  \brief   A Rauch-Tung-Striebel fixed interval smoother.
+
+  The forward filter adds the predicted and updated navigation states 
+  and covariances for each epoch. After the last epoch, the backward 
+  pass produces the smoothed states from the last epoch to the first.
+
+  Only the navigation states are smoothed: latitude, longitude, height, 
+  velocity, clock offset, and clock drift for the eight state models, or 
+  latitude, longitude, height, and clock offset for RTK4. The ambiguity 
+  states of the RTK filters are not logged, so the gain is formed from 
+  the navigation blocks of the covariance matrices.
+
+  Each epoch is stored in a compact record (the covariances are packed 
+  upper triangles). The records are kept in a block of a fixed number 
+  of epochs. When the block is full it is written to a spill file, so 
+  the memory used does not grow with the length of the session. The 
+  backward pass reads the spilled blocks in reverse order.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_RTSSmoother
+  {
+  public:
+
+    /// \brief   The smoothed navigation solution for one epoch.
+    struct stSmoothedEpoch
+    {
+      unsigned tag;         //!< The tag given to AddEpoch (e.g. the output row).
+      unsigned short week;  //!< The GPS week [weeks].
+      double tow;           //!< The GPS time of week [s].
+      double latitude;      //!< The latitude [rad].
+      double longitude;     //!< The longitude [rad].
+      double height;        //!< The height [m].
+      double vn;            //!< The northing velocity [m/s].
+      double ve;            //!< The easting velocity [m/s].
+      double vup;           //!< The up velocity [m/s].
+      double clockOffset;   //!< The clock offset [m].
+      double clockDrift;    //!< The clock drift [m/s].
+      double std_lat;       //!< The standard deviation of the latitude [m].
+      double std_lon;       //!< The standard deviation of the longitude [m].
+      double std_hgt;       //!< The standard deviation of the height [m].
+      double std_vn;        //!< The standard deviation of the northing velocity [m/s].
+      double std_ve;        //!< The standard deviation of the easting velocity [m/s].
+      double std_vup;       //!< The standard deviation of the up velocity [m/s].
+      double std_clk;       //!< The standard deviation of the clock offset [m].
+      double std_clkdrift;  //!< The standard deviation of the clock drift [m/s].
+    };
+
+    /// \brief   A function that receives the smoothed epochs during the backward pass.
+    /// \return  true if successful, false if error (the backward pass stops).
+    typedef bool (*OutputFunction)( const stSmoothedEpoch& epoch, void* arg );
+
+  public:
+
+    /// \brief    The default constructor (no data).
+    GNSS_RTSSmoother();
+
+    /// \brief    The destructor. The spill file is removed.
+    virtual ~GNSS_RTSSmoother();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_RTSSmoother( const GNSS_RTSSmoother& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_RTSSmoother& rhs);
+
+  public:
+
+    /// \brief    Set the number of states smoothed and the storage limits.
+    ///           Any epochs already added are discarded.
+    /// \return   true if successful, false if error.
+    bool Initialize( 
+      const unsigned nrStates,            //!< The number of navigation states, 4 (RTK4) or 8 (EKF, RTK8).
+      const unsigned maxEpochsInMemory,   //!< The number of epochs kept in memory before a block is spilled to disk.
+      const char* spillFilePath           //!< The path of the spill file.
+      );
+
+    /// \brief    Add the forward filter information for one epoch.
+    ///
+    /// \pre      The state variance-covariance matrices must have the 
+    ///           navigation states first, in the order used by the filters.
+    /// \return   true if successful, false if error.
+    bool AddEpoch( 
+      const unsigned tag,                //!< A value returned with the smoothed epoch (e.g. the output row).
+      const double dT,                   //!< The time since the previous epoch [s]. If zero, the transition matrix is taken as identity.
+      const GNSS_structPVT& predicted,   //!< The predicted solution (after the time update).
+      Matrix& P_predicted,               //!< The predicted state variance-covariance matrix.
+      Matrix& T,                         //!< The transition matrix from the previous epoch.
+      const GNSS_structPVT& filtered,    //!< The updated solution (after the measurement update).
+      Matrix& P_filtered                 //!< The updated state variance-covariance matrix.
+      );
+
+    /// \brief    Run the backward pass. The output function is called 
+    ///           for each epoch from the last to the first. The stored 
+    ///           epochs are released afterwards.
+    /// \return   true if successful, false if error.
+    bool Smooth( OutputFunction output, void* arg );
+
+    /// \brief    The number of epochs added.
+    unsigned GetNrEpochs() const { return m_nrEpochs; }
+
+    /// \brief    The number of blocks written to the spill file.
+    unsigned GetNrBlocksSpilled() const { return m_nrBlocksSpilled; }
+
+  protected:
+
+    /// \brief    Write the block of records in memory to the spill file.
+    /// \return   true if successful, false if error.
+    bool SpillBlock();
+
+    /// \brief    Read a block of records from the spill file into memory.
+    /// \return   true if successful, false if error.
+    bool ReadBlock( const unsigned block );
+
+    /// \brief    Remove the spill file.
+    void CloseSpillFile();
+
+  protected:
+
+    unsigned m_nrStates;          //!< The number of navigation states smoothed.
+    unsigned m_stateIndex[8];     //!< The position of each smoothed state in the order lat, lon, hgt, vn, ve, vup, clk, clkdrift.
+    unsigned m_recordLength;      //!< The number of doubles in one epoch record.
+    unsigned m_maxEpochsInMemory; //!< The number of records in a block.
+    unsigned m_nrEpochs;          //!< The number of epochs added.
+    unsigned m_nrInBlock;         //!< The number of records in the block in memory.
+    unsigned m_nrBlocksSpilled;   //!< The number of blocks in the spill file.
+    std::vector<double> m_Block;  //!< The block of records in memory.
+    std::string m_SpillFilePath;  //!< The path of the spill file.
+    FILE* m_SpillFile;            //!< The spill file, NULL if not open.
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_RTSSMOOTHER_H_
@@ -37,12 +37,20 @@ SUCH DAMAGE.
 
 #include <memory.h>
 #include <math.h>
+#include <algorithm>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "GNSS_RxData.h"
+#include "GNSS_Profiler.h"
 #include "gnss_error.h"
 #include "novatel.h" 
 #include "constants.h"
 #include "geodesy.h"
+#include "cycle_slip.h"
 #include "Matrix.h"
 
 using namespace Zenautics; // for Matrix
@@ -326,6 +334,41 @@ namespace GNSS
   }
 
 
+  bool GPS_BroadcastEphemerisAndAlmanacArray::CopyOrbitParameters(
+    const unsigned short prn,                          //!< The desired GPS PRN. (1-32 GPS, 120-138 SBAS).
+    const GPS_BroadcastEphemerisAndAlmanacArray& src  //!< The source array.
+    )
+  {
+    unsigned short index = 0;
+
+    if( &src == this )
+      return true;
+
+    // Nothing to copy.
+    if( src.m_arrayLength == 0 )
+      return true;
+
+    if( m_arrayLength == 0 )
+    {
+      if( !AllocateArray() )
+      {
+        GNSS_ERROR_MSG( "AllocateArray returned false." );
+        return false;
+      }
+    }
+
+    if( !GetIndexGivenPRN( prn, index ) )
+    {
+      GNSS_ERROR_MSG( "GetIndexGivenPRN returned false." );
+      return false;
+    }
+
+    m_array[index] = src.m_array[index];
+
+    return true;
+  }
+
+
 
   bool GPS_BroadcastEphemerisAndAlmanacArray::GetIndexGivenPRN( const unsigned short prn, unsigned short &index )
   {
@@ -385,13 +428,365 @@ namespace GNSS
   }
 
 
+
+  /// A sort predicate ordering record indices by an associated time key.
+  struct GPS_EphemerisStore_TimeKeyLess
+  {
+    const double* key;
+    GPS_EphemerisStore_TimeKeyLess( const double* k ) : key(k) {}
+    bool operator()( const unsigned a, const unsigned b ) const { return key[a] < key[b]; }
+  };
+
+
+  GPS_EphemerisStore::GPS_EphemerisStore()
+  : m_eph_array(NULL),
+    m_array_length(0),
+    m_index_by_tx(NULL),
+    m_tx_time(NULL),
+    m_index_by_toe(NULL),
+    m_toe_time(NULL)
+  {
+    memset( m_prn_offset, 0, sizeof(m_prn_offset) );
+    memset( &m_iono_model, 0, sizeof(GNSS_structKlobuchar) );
+  }
+
+
+  GPS_EphemerisStore::~GPS_EphemerisStore()
+  {
+    Clear();
+  }
+
+
+  void GPS_EphemerisStore::Clear()
+  {
+    if( m_eph_array != NULL )
+      delete[] m_eph_array;
+    if( m_index_by_tx != NULL )
+      delete[] m_index_by_tx;
+    if( m_tx_time != NULL )
+      delete[] m_tx_time;
+    if( m_index_by_toe != NULL )
+      delete[] m_index_by_toe;
+    if( m_toe_time != NULL )
+      delete[] m_toe_time;
+
+    m_eph_array = NULL;
+    m_index_by_tx = NULL;
+    m_tx_time = NULL;
+    m_index_by_toe = NULL;
+    m_toe_time = NULL;
+    m_array_length = 0;
+    memset( m_prn_offset, 0, sizeof(m_prn_offset) );
+  }
+
+
+  bool GPS_EphemerisStore::LoadRINEXNavigationFile( const char* filepath )
+  {
+    // First estimate the size of the ephemeris array needed based on the number of lines
+    // in the data file after the header.
+    char line[GNSS_RXDATA_MSG_LENGTH];
+    unsigned line_count = 0;
+    unsigned estimated_nr_eph = 0;
+    unsigned nr_eph = 0;
+    BOOL result = 0;
+    GPS_structEphemeris* eph_array = NULL;
+
+    if( filepath == NULL )
+    {
+      GNSS_ERROR_MSG( "if( filepath == NULL )" );
+      return false;
+    }
+
+    FILE* fid = NULL;
+    fid = fopen( filepath, "r" );
+    if( fid == NULL )
+    {
+      GNSS_ERROR_MSG( "if( fid == NULL )" );
+      return false;
+    }
+
+    // Advance over the header.
+    while( !feof(fid) && ferror(fid)==0 )
+    {
+      if( fgets( line, GNSS_RXDATA_MSG_LENGTH, fid ) == NULL )
+        break;
+      if( strstr( line, "END OF HEADER" ) != NULL )
+        break;
+    }
+
+    // Count the number of lines in the remaining data.
+    while( !feof(fid) && ferror(fid)==0 )
+    {
+      if( fgets( line, GNSS_RXDATA_MSG_LENGTH, fid ) == NULL )
+        break;
+      line_count++;
+    }
+
+    fclose(fid);
+
+    // There are 8 lines per ephemeris record generally.
+    estimated_nr_eph = line_count/8;
+
+    estimated_nr_eph += 32; // for good measure.
+
+    // Allocate enough memory for the ephemeris array.
+    eph_array = new GPS_structEphemeris[estimated_nr_eph];
+    if( eph_array == NULL )
+    {
+      GNSS_ERROR_MSG( "if( eph_array == NULL )" );
+      return false;
+    }
+    
+    result = RINEX_DecodeGPSNavigationFile(
+      filepath,
+      &m_iono_model,
+      eph_array,
+      estimated_nr_eph,
+      &nr_eph
+      );
+    if( result == FALSE )
+    {
+      delete[] eph_array;
+      GNSS_ERROR_MSG( "RINEX_DecodeGPSNavigationFile returned FALSE." );
+      return false;
+    }
+
+    Clear();
+    m_eph_array = eph_array;
+    m_array_length = nr_eph;
+
+    if( !BuildIndices() )
+    {
+      GNSS_ERROR_MSG( "BuildIndices returned false." );
+      return false;
+    }
+    return true;
+  }
+
+
+  bool GPS_EphemerisStore::SetEphemerisRecords( 
+    const GPS_structEphemeris* eph_array, //!< The array of ephemeris records.
+    const unsigned nr_eph                 //!< The number of records in eph_array.
+    )
+  {
+    unsigned i = 0;
+
+    if( eph_array == NULL && nr_eph > 0 )
+    {
+      GNSS_ERROR_MSG( "if( eph_array == NULL && nr_eph > 0 )" );
+      return false;
+    }
+
+    Clear();
+    if( nr_eph == 0 )
+      return true;
+
+    m_eph_array = new GPS_structEphemeris[nr_eph];
+    if( m_eph_array == NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_eph_array == NULL )" );
+      return false;
+    }
+    for( i = 0; i < nr_eph; i++ )
+    {
+      m_eph_array[i] = eph_array[i];
+    }
+    m_array_length = nr_eph;
+
+    if( !BuildIndices() )
+    {
+      GNSS_ERROR_MSG( "BuildIndices returned false." );
+      return false;
+    }
+    return true;
+  }
+
+
+  bool GPS_EphemerisStore::BuildIndices()
+  {
+    unsigned i = 0;
+    unsigned k = 0;
+    unsigned prn_count[NR_PRNS];
+    unsigned prn_fill[NR_PRNS];
+    double* tx_key = NULL;
+    double* toe_key = NULL;
+
+    if( m_array_length == 0 )
+      return true;
+
+    m_index_by_tx  = new unsigned[m_array_length];
+    m_index_by_toe = new unsigned[m_array_length];
+    m_tx_time      = new double[m_array_length];
+    m_toe_time     = new double[m_array_length];
+    tx_key         = new double[m_array_length];
+    toe_key        = new double[m_array_length];
+    if( m_index_by_tx == NULL || m_index_by_toe == NULL || m_tx_time == NULL || m_toe_time == NULL || tx_key == NULL || toe_key == NULL )
+    {
+      if( tx_key != NULL )
+        delete[] tx_key;
+      if( toe_key != NULL )
+        delete[] toe_key;
+      GNSS_ERROR_MSG( "new failed" );
+      return false;
+    }
+
+    // Count the records per PRN. Unsupported PRNs are not indexed.
+    memset( prn_count, 0, sizeof(prn_count) );
+    for( i = 0; i < m_array_length; i++ )
+    {
+      tx_key[i]  = m_eph_array[i].tow_week*SECONDS_IN_WEEK + m_eph_array[i].tow;
+      toe_key[i] = m_eph_array[i].week*SECONDS_IN_WEEK + m_eph_array[i].toe;
+      if( m_eph_array[i].prn >= 1 && m_eph_array[i].prn <= NR_PRNS )
+        prn_count[m_eph_array[i].prn-1]++;
+    }
+
+    m_prn_offset[0] = 0;
+    for( k = 0; k < NR_PRNS; k++ )
+    {
+      m_prn_offset[k+1] = m_prn_offset[k] + prn_count[k];
+      prn_fill[k] = m_prn_offset[k];
+    }
+
+    // Group the records by PRN, keeping the file order within a group.
+    for( i = 0; i < m_array_length; i++ )
+    {
+      if( m_eph_array[i].prn >= 1 && m_eph_array[i].prn <= NR_PRNS )
+      {
+        k = m_eph_array[i].prn-1;
+        m_index_by_tx[prn_fill[k]]  = i;
+        m_index_by_toe[prn_fill[k]] = i;
+        prn_fill[k]++;
+      }
+    }
+
+    // Sort each group by time. A stable sort retains the file order for equal times.
+    for( k = 0; k < NR_PRNS; k++ )
+    {
+      std::stable_sort( m_index_by_tx+m_prn_offset[k],  m_index_by_tx+m_prn_offset[k+1],  GPS_EphemerisStore_TimeKeyLess(tx_key) );
+      std::stable_sort( m_index_by_toe+m_prn_offset[k], m_index_by_toe+m_prn_offset[k+1], GPS_EphemerisStore_TimeKeyLess(toe_key) );
+    }
+    for( i = 0; i < m_prn_offset[NR_PRNS]; i++ )
+    {
+      m_tx_time[i]  = tx_key[m_index_by_tx[i]];
+      m_toe_time[i] = toe_key[m_index_by_toe[i]];
+    }
+
+    delete[] tx_key;
+    delete[] toe_key;
+    return true;
+  }
+
+
+  bool GPS_EphemerisStore::GetMostRecentEphemeris( 
+    const unsigned short prn,      //!< The desired GPS PRN (1-37).
+    const unsigned short gps_week, //!< The GPS week [weeks].
+    const double gps_tow,          //!< The GPS time of week [s].
+    GPS_structEphemeris &eph,      //!< A reference to an ephemeris struct in which to store the data.
+    bool &isAvailable              //!< This boolean indicates if ephemeris data is available or not.
+    ) const
+  {
+    const double t = gps_week*SECONDS_IN_WEEK + gps_tow;
+    const double* first = NULL;
+    const double* last = NULL;
+    const double* it = NULL;
+
+    isAvailable = false;
+    if( prn == 0 )
+    {
+      GNSS_ERROR_MSG( "if( prn == 0 )" );
+      return false;
+    }
+    if( prn > NR_PRNS || m_array_length == 0 )
+      return true;
+
+    // The first record transmitted at or after t, the record before it is the 
+    // most recent one transmitted prior to t.
+    first = m_tx_time + m_prn_offset[prn-1];
+    last  = m_tx_time + m_prn_offset[prn];
+    it = std::lower_bound( first, last, t );
+    if( it == first )
+      return true; // Nothing transmitted yet.
+    
+    eph = m_eph_array[ m_index_by_tx[ (it - m_tx_time) - 1 ] ];
+    isAvailable = true;
+    return true;
+  }
+
+
+  bool GPS_EphemerisStore::GetBestEphemeris( 
+    const unsigned short prn,      //!< The desired GPS PRN (1-37).
+    const unsigned short gps_week, //!< The GPS week [weeks].
+    const double gps_tow,          //!< The GPS time of week [s].
+    GPS_structEphemeris &eph,      //!< A reference to an ephemeris struct in which to store the data.
+    bool &isAvailable              //!< This boolean indicates if ephemeris data is available or not.
+    ) const
+  {
+    const double t = gps_week*SECONDS_IN_WEEK + gps_tow;
+    const double* first = NULL;
+    const double* last = NULL;
+    const double* it = NULL;
+    const double* candidate[2] = { NULL, NULL };
+    double dt = 0;
+    double best_dt = 0;
+    unsigned i = 0;
+    unsigned index = 0;
+
+    isAvailable = false;
+    if( prn == 0 )
+    {
+      GNSS_ERROR_MSG( "if( prn == 0 )" );
+      return false;
+    }
+    if( prn > NR_PRNS || m_array_length == 0 )
+      return true;
+
+    first = m_toe_time + m_prn_offset[prn-1];
+    last  = m_toe_time + m_prn_offset[prn];
+    if( first == last )
+      return true;
+
+    // Only the records either side of the insertion point can be closest. 
+    // For equal reference times the last record (e.g. the latest upload) is used.
+    it = std::upper_bound( first, last, t );
+    if( it != first )
+      candidate[0] = it-1;
+    if( it != last )
+      candidate[1] = it;
+
+    for( i = 0; i < 2; i++ )
+    {
+      if( candidate[i] == NULL )
+        continue;
+      dt = fabs( t - *candidate[i] );
+      index = m_index_by_toe[ candidate[i] - m_toe_time ];
+
+      // The ephemeris is valid for half the curve fit interval either side of toe (2 h or 3 h).
+      if( dt > ( m_eph_array[index].fit_interval_flag ? 10800.0 : 7200.0 ) )
+        continue;
+      if( !isAvailable || dt < best_dt )
+      {
+        eph = m_eph_array[index];
+        best_dt = dt;
+        isAvailable = true;
+      }
+    }
+    return true;
+  }
+
+
   GNSS_RxData::GNSS_RxData()
   : m_nrValidObs(0), 
     m_prev_nrValidObs(0),
+    m_ambiguity_validation_ratio(0),
+    m_probability_of_correct_ambiguities(0),
+    m_norm(0.0),
+    m_nrFixedAmbiguities(0),
+    m_nrAmbiguitySearchNodes(0),
     m_elevationMask(5.0*DEG2RAD),
     m_cnoMask(28.0),
     m_locktimeMask(0.0),
     m_maxAgeEphemeris(14400), // 4 hours
+    m_RINEX_use_best_eph(false),
     m_DisableTropoCorrection(false),
     m_DisableIonoCorrection(false),
     m_msJumpDetected_Positive(false),
@@ -401,29 +796,25 @@ namespace GNSS
     m_isStatic(false),
     m_heightConstraint(false),
     m_heightConstraintStdev(0.0),
+    m_default_stdev_GPSL1_psr(0.8),
+    m_default_stdev_GPSL1_doppler(0.09),
+    m_default_stdev_GPSL1_adr(0.03),
     m_fid(NULL),
     m_messageLength(0),
     m_rxDataType(GNSS_RXDATA_UNKNOWN),
     m_CheckRinexObservationHeader(false),
     m_RINEX_use_eph(false),
-    m_RINEX_eph_index(0),
-    m_ambiguity_validation_ratio(0),
-    m_probability_of_correct_ambiguities(0),
-    m_norm(0.0),
-    m_default_stdev_GPSL1_psr(0.8),
-    m_default_stdev_GPSL1_doppler(0.09),
-    m_default_stdev_GPSL1_adr(0.03)    
+    m_RINEX_eph_store_owned(NULL),
+    m_RINEX_eph_store(NULL)
   { 
     m_message[0] = '\0';
     ZeroAllMeasurements();
     ZeroPVT();
 
     memset( &m_klobuchar, 0, sizeof(GNSS_structKlobuchar) );
+    memset( &m_LocalFrame, 0, sizeof(GEODESY_structLocalFrame) );
+    memset( &m_LocalFrame_lsq, 0, sizeof(GEODESY_structLocalFrame) );
     memset( &m_RINEX_obs_header, 0, sizeof(RINEX_structDecodedHeader) );
-    
-    m_RINEX_eph.eph_array = NULL;
-    m_RINEX_eph.array_length = 0;
-    m_RINEX_eph.max_array_length = 0;
   }
 
 
@@ -433,11 +824,12 @@ namespace GNSS
     {
       fclose( m_fid );
     }
-    if( m_RINEX_eph.eph_array != NULL )
+    if( m_RINEX_eph_store_owned != NULL )
     {
-      delete[] m_RINEX_eph.eph_array;
-      m_RINEX_eph.eph_array = NULL;
+      delete m_RINEX_eph_store_owned;
+      m_RINEX_eph_store_owned = NULL;
     }
+    m_RINEX_eph_store = NULL;
   }
 
 
@@ -1455,50 +1847,182 @@ namespace GNSS
       m_ObsArray[i].index_differential = -1;
       m_prev_ObsArray[i].index_differential = -1;
     }
+    // Every entry is -1, no channel.
+    memset( m_channelLookup, 0xFF, sizeof(m_channelLookup) );
+    memset( m_prev_channelLookup, 0xFF, sizeof(m_prev_channelLookup) );
+    memset( m_channelNext, 0xFF, sizeof(m_channelNext) );
+    memset( m_prev_channelNext, 0xFF, sizeof(m_prev_channelNext) );
     return true;
   }
 
 
-  bool GNSS_RxData::ZeroPVT()
+  /// \brief  Is this (system, id, frequency) within the lookup table dimensions.
+  static bool IsInChannelLookupRange( 
+    const GNSS_enumSystem system, 
+    const unsigned short id, 
+    const GNSS_enumFrequency freqType )
   {
-    memset( &m_pvt, 0, sizeof(GNSS_structPVT) );
-    memset( &m_prev_pvt, 0, sizeof(GNSS_structPVT) );
-    memset( &m_datum_pvt, 0, sizeof(GNSS_structPVT) );
-    memset( &m_pvt_lsq, 0, sizeof(GNSS_structPVT) );
-    memset( &m_pvt_fixed, 0, sizeof(GNSS_structPVT) );
-    return true;
+    return (unsigned)system < GNSS_RXDATA_LOOKUP_NR_SYSTEMS && 
+      id < GNSS_RXDATA_LOOKUP_NR_IDS && 
+      (unsigned)freqType < GNSS_RXDATA_LOOKUP_NR_FREQUENCIES;
   }
 
-
-  bool GNSS_RxData::Initialize( 
-    const char* path,                  //!< The path to the Observation data file. 
-    bool &isValidPath,                 //!< A boolean to indicate if the path is valid.
-    const GNSS_enumRxDataType rxType,  //!< The receiver data type.
-    const char* RINEX_ephemeris_path   //!< The path to a RINEX ephemeris file, NULL if not available.
-    )
+  /// \brief  Fill a channel lookup table from an observation array.
+  /// The table has the first channel of each (system, id, frequency) and the 
+  /// duplicated channels (e.g. the same PRN tracked twice, or L2 P and L2C) are 
+  /// chained in the order of the array, so that a caller can select a channel 
+  /// by its state or code type as the scan of the array did.
+  static void FillChannelLookup( 
+    short lookup[GNSS_RXDATA_LOOKUP_NR_SYSTEMS][GNSS_RXDATA_LOOKUP_NR_IDS][GNSS_RXDATA_LOOKUP_NR_FREQUENCIES],
+    short next[GNSS_RXDATA_NR_CHANNELS],
+    const GNSS_structMeasurement* obsArray,
+    const unsigned nrObs )
   {
-    bool isRinexValid = false;
-    isValidPath = false;
-    
-    if( path == NULL )
+    unsigned i = 0;
+    short* entry = NULL;
+
+    // Every entry is -1, no channel.
+    memset( lookup, 0xFF, sizeof(short)*GNSS_RXDATA_LOOKUP_NR_SYSTEMS*GNSS_RXDATA_LOOKUP_NR_IDS*GNSS_RXDATA_LOOKUP_NR_FREQUENCIES );
+    memset( next, 0xFF, sizeof(short)*GNSS_RXDATA_NR_CHANNELS );
+    for( i = nrObs; i > 0; i-- )
     {
-      GNSS_ERROR_MSG( "if( path == NULL )" );
-      return false;
+      // In reverse order so that the entry is the first channel and the chain is in order.
+      if( !IsInChannelLookupRange( obsArray[i-1].system, obsArray[i-1].id, obsArray[i-1].freqType ) )
+        continue;
+      entry = &(lookup[obsArray[i-1].system][obsArray[i-1].id][obsArray[i-1].freqType]);
+      next[i-1] = *entry;
+      *entry = static_cast<short>(i-1);
     }
-    if( rxType == GNSS_RXDATA_UNKNOWN )
+  }
+
+  /// \brief  Find a channel with the lookup table, or by searching the 
+  /// observation array when the key is outside the table dimensions.
+  static int FindChannel( 
+    const short lookup[GNSS_RXDATA_LOOKUP_NR_SYSTEMS][GNSS_RXDATA_LOOKUP_NR_IDS][GNSS_RXDATA_LOOKUP_NR_FREQUENCIES],
+    const GNSS_structMeasurement* obsArray,
+    const unsigned nrObs,
+    const GNSS_enumSystem system, 
+    const unsigned short id, 
+    const GNSS_enumFrequency freqType )
+  {
+    unsigned i = 0;
+
+    if( IsInChannelLookupRange( system, id, freqType ) )
+      return lookup[system][id][freqType];
+
+    for( i = 0; i < nrObs; i++ )
     {
-      GNSS_ERROR_MSG( "if( rxType == GNSS_RXDATA_UNKNOWN )" );
-      return false;
+      if( obsArray[i].system == system && obsArray[i].id == id && obsArray[i].freqType == freqType )
+        return i;
     }
+    return -1;
+  }
 
-    m_rxDataType = rxType;
-    
-    if( rxType == GNSS_RXDATA_RINEX21 || rxType == GNSS_RXDATA_RINEX211 )
+  /// \brief  Find the next channel with the same (system, id, frequency) as channel 
+  /// index with the chain of the lookup table, or by searching the rest of the 
+  /// observation array when the key is outside the table dimensions.
+  static int FindNextChannel( 
+    const short next[GNSS_RXDATA_NR_CHANNELS],
+    const GNSS_structMeasurement* obsArray,
+    const unsigned nrObs,
+    const int index )
+  {
+    unsigned i = 0;
+
+    if( index < 0 || index >= (int)nrObs )
+      return -1;
+
+    if( IsInChannelLookupRange( obsArray[index].system, obsArray[index].id, obsArray[index].freqType ) )
+      return next[index];
+
+    for( i = index+1; i < nrObs; i++ )
     {
-      if( !CheckRINEXObservationHeader( path, isRinexValid ) )
-      {
-        GNSS_ERROR_MSG( "CheckRINEXObservationHeader returned false." );
-        return false;
+      if( obsArray[i].system == obsArray[index].system && obsArray[i].id == obsArray[index].id && obsArray[i].freqType == obsArray[index].freqType )
+        return i;
+    }
+    return -1;
+  }
+
+
+  void GNSS_RxData::BuildChannelLookup()
+  {
+    FillChannelLookup( m_channelLookup, m_channelNext, m_ObsArray, m_nrValidObs );
+    FillChannelLookup( m_prev_channelLookup, m_prev_channelNext, m_prev_ObsArray, m_prev_nrValidObs );
+  }
+
+
+  int GNSS_RxData::GetChannelIndex( 
+    const GNSS_enumSystem system,
+    const unsigned short id,
+    const GNSS_enumFrequency freqType
+    ) const
+  {
+    return FindChannel( m_channelLookup, m_ObsArray, m_nrValidObs, system, id, freqType );
+  }
+
+
+  int GNSS_RxData::GetNextChannelIndex( const int index ) const
+  {
+    return FindNextChannel( m_channelNext, m_ObsArray, m_nrValidObs, index );
+  }
+
+
+  int GNSS_RxData::GetPreviousChannelIndex( 
+    const GNSS_enumSystem system,
+    const unsigned short id,
+    const GNSS_enumFrequency freqType
+    ) const
+  {
+    return FindChannel( m_prev_channelLookup, m_prev_ObsArray, m_prev_nrValidObs, system, id, freqType );
+  }
+
+
+  int GNSS_RxData::GetNextPreviousChannelIndex( const int index ) const
+  {
+    return FindNextChannel( m_prev_channelNext, m_prev_ObsArray, m_prev_nrValidObs, index );
+  }
+
+
+  bool GNSS_RxData::ZeroPVT()
+  {
+    memset( &m_pvt, 0, sizeof(GNSS_structPVT) );
+    memset( &m_prev_pvt, 0, sizeof(GNSS_structPVT) );
+    memset( &m_datum_pvt, 0, sizeof(GNSS_structPVT) );
+    memset( &m_pvt_lsq, 0, sizeof(GNSS_structPVT) );
+    memset( &m_pvt_fixed, 0, sizeof(GNSS_structPVT) );
+    return true;
+  }
+
+
+  bool GNSS_RxData::Initialize( 
+    const char* path,                  //!< The path to the Observation data file. 
+    bool &isValidPath,                 //!< A boolean to indicate if the path is valid.
+    const GNSS_enumRxDataType rxType,  //!< The receiver data type.
+    const char* RINEX_ephemeris_path   //!< The path to a RINEX ephemeris file, NULL if not available.
+    )
+  {
+    bool isRinexValid = false;
+    isValidPath = false;
+    
+    if( path == NULL )
+    {
+      GNSS_ERROR_MSG( "if( path == NULL )" );
+      return false;
+    }
+    if( rxType == GNSS_RXDATA_UNKNOWN )
+    {
+      GNSS_ERROR_MSG( "if( rxType == GNSS_RXDATA_UNKNOWN )" );
+      return false;
+    }
+
+    m_rxDataType = rxType;
+    
+    if( rxType == GNSS_RXDATA_RINEX21 || rxType == GNSS_RXDATA_RINEX211 )
+    {
+      if( !CheckRINEXObservationHeader( path, isRinexValid ) )
+      {
+        GNSS_ERROR_MSG( "CheckRINEXObservationHeader returned false." );
+        return false;
       }
       if( !isRinexValid )
       {
@@ -1509,7 +2033,7 @@ namespace GNSS
 
     if( RINEX_ephemeris_path != NULL )
     {
-      m_RINEX_eph.filepath = RINEX_ephemeris_path;
+      m_RINEX_eph_filepath = RINEX_ephemeris_path;
       
       if( !LoadRINEXNavigationData() )
       {
@@ -1566,6 +2090,7 @@ namespace GNSS
   {
     unsigned i = 0;
     unsigned j = 0;
+    int index_prev = 0;
     double psr_difference = 0;
     bool result = false;
     char msg[256];
@@ -1618,68 +2143,66 @@ namespace GNSS
       if( m_ObsArray[i].flags.isActive && 
         m_ObsArray[i].flags.isPsrValid )
       {
-        for( j = 0; j < m_prev_nrValidObs; j++ )
+        index_prev = GetPreviousChannelIndex( m_ObsArray[i].system, m_ObsArray[i].id, m_ObsArray[i].freqType );
+        while( index_prev >= 0 && !( m_prev_ObsArray[index_prev].flags.isActive && m_prev_ObsArray[index_prev].flags.isPsrValid ) )
+          index_prev = GetNextPreviousChannelIndex( index_prev ); // a duplicate channel of this satellite
+        if( index_prev >= 0 &&
+          m_prev_ObsArray[index_prev].flags.isActive && 
+          m_prev_ObsArray[index_prev].flags.isPsrValid )
         {
-          if( m_prev_ObsArray[j].flags.isActive && 
-            m_prev_ObsArray[j].flags.isPsrValid )
+          j = index_prev;
+          m_ObsArray[i].index_time_differential = j;
+
+          current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
+          prev_time = m_prev_ObsArray[j].tow + m_prev_ObsArray[j].week*SECONDS_IN_WEEK;
+          dT = current_time - prev_time;
+
+          mean_doppler = 0;
+          if( m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid )
           {
-            if( m_ObsArray[i].id == m_prev_ObsArray[j].id )
-            {
-              m_ObsArray[i].index_time_differential = j;
+            mean_doppler = m_ObsArray[i].doppler + m_prev_ObsArray[j].doppler;
+            mean_doppler /= 2.0;
+          }
+          else if( m_ObsArray[i].flags.isDopplerValid )
+          {
+            mean_doppler = m_ObsArray[i].doppler;
+          }
+          if( m_ObsArray[i].freqType == GNSS_GPSL1 )
+          {
+            estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL1*dT;
+          }
+          else if( m_ObsArray[i].freqType == GNSS_GPSL2 )
+          {
+            estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL2*dT;
+          }
+          else
+          {
+            estimated_psr = m_prev_ObsArray[j].psr;
+          }
 
-              current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
-              prev_time = m_prev_ObsArray[j].tow + m_prev_ObsArray[j].week*SECONDS_IN_WEEK;
-              dT = current_time - prev_time;
+          psr_difference = m_ObsArray[i].psr - estimated_psr;
 
-              mean_doppler = 0;
-              if( m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid )
-              {
-                mean_doppler = m_ObsArray[i].doppler + m_prev_ObsArray[j].doppler;
-                mean_doppler /= 2.0;
-              }
-              else if( m_ObsArray[i].flags.isDopplerValid )
-              {
-                mean_doppler = m_ObsArray[i].doppler;
-              }
-              if( m_ObsArray[i].freqType == GNSS_GPSL1 )
-              {
-                estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL1*dT;
-              }
-              else if( m_ObsArray[i].freqType == GNSS_GPSL2 )
-              {
-                estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL2*dT;
-              }
-              else
+          if( fabs( psr_difference ) > ONE_MS_IN_M/2.0 )
+          {
+            // detect allowing 10 km psr changes between epochs
+            if( psr_difference > 0 )
+            {
+              if( (psr_difference > (ONE_MS_IN_M - 10000.0)) && (psr_difference < (ONE_MS_IN_M + 10000.0)) )
               {
-                estimated_psr = m_prev_ObsArray[j].psr;
+                sprintf( msg, "%.1Lf  %d  Clock Jump of %.1Lf m, %.6Lf ms detected.", m_pvt.time.gps_tow, m_pvt.time.gps_week, psr_difference, psr_difference/ONE_MS_IN_M );
+                GNSS_ERROR_MSG( msg );
+                m_msJumpDetected_Positive = true;
               }
-
-              psr_difference = m_ObsArray[i].psr - estimated_psr;
-
-              if( fabs( psr_difference ) > ONE_MS_IN_M/2.0 )
+            }
+            else
+            {
+              psr_difference *= -1.0;
+              if( (psr_difference > (ONE_MS_IN_M - 10000.0)) && (psr_difference < (ONE_MS_IN_M + 10000.0)) )
               {
-                // detect allowing 10 km psr changes between epochs
-                if( psr_difference > 0 )
-                {
-                  if( (psr_difference > (ONE_MS_IN_M - 10000.0)) && (psr_difference < (ONE_MS_IN_M + 10000.0)) )
-                  {
-                    sprintf( msg, "%.1Lf  %d  Clock Jump of %.1Lf m, %.6Lf ms detected.", m_pvt.time.gps_tow, m_pvt.time.gps_week, psr_difference, psr_difference/ONE_MS_IN_M );
-                    GNSS_ERROR_MSG( msg );
-                    m_msJumpDetected_Positive = true;
-                  }
-                }
-                else
-                {
-                  psr_difference *= -1.0;
-                  if( (psr_difference > (ONE_MS_IN_M - 10000.0)) && (psr_difference < (ONE_MS_IN_M + 10000.0)) )
-                  {
-                    sprintf( msg, "%.1Lf  %d  Clock Jump of %.1Lf m, %.6Lf ms detected.", m_pvt.time.gps_tow, m_pvt.time.gps_week, psr_difference, psr_difference/ONE_MS_IN_M );
-                    GNSS_ERROR_MSG( msg );                  
-                    m_msJumpDetected_Negative = true;
-                  }
-                }
+                sprintf( msg, "%.1Lf  %d  Clock Jump of %.1Lf m, %.6Lf ms detected.", m_pvt.time.gps_tow, m_pvt.time.gps_week, psr_difference, psr_difference/ONE_MS_IN_M );
+                GNSS_ERROR_MSG( msg );                  
+                m_msJumpDetected_Negative = true;
               }
-              break;
             }
           }
         }
@@ -1702,54 +2225,52 @@ namespace GNSS
         if( m_ObsArray[i].flags.isActive && 
           m_ObsArray[i].flags.isPsrValid )
         {
-          for( j = 0; j < m_prev_nrValidObs; j++ )
+          index_prev = GetPreviousChannelIndex( m_ObsArray[i].system, m_ObsArray[i].id, m_ObsArray[i].freqType );
+          while( index_prev >= 0 && !( m_prev_ObsArray[index_prev].flags.isActive && m_prev_ObsArray[index_prev].flags.isPsrValid ) )
+            index_prev = GetNextPreviousChannelIndex( index_prev ); // a duplicate channel of this satellite
+          if( index_prev >= 0 &&
+            m_prev_ObsArray[index_prev].flags.isActive && 
+            m_prev_ObsArray[index_prev].flags.isPsrValid )
           {
-            if( m_prev_ObsArray[j].flags.isActive && 
-              m_prev_ObsArray[j].flags.isPsrValid )
-            {
-              if( m_ObsArray[i].id == m_prev_ObsArray[j].id )
-              {
-                m_ObsArray[i].index_time_differential = j;
+            j = index_prev;
+            m_ObsArray[i].index_time_differential = j;
 
-                current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
-                prev_time = m_prev_ObsArray[j].tow + m_prev_ObsArray[j].week*SECONDS_IN_WEEK;
-                dT = current_time - prev_time;
+            current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
+            prev_time = m_prev_ObsArray[j].tow + m_prev_ObsArray[j].week*SECONDS_IN_WEEK;
+            dT = current_time - prev_time;
 
-                mean_doppler = 0;
-                if( m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid )
-                {
-                  mean_doppler = m_ObsArray[i].doppler + m_prev_ObsArray[j].doppler;
-                  mean_doppler /= 2.0;
-                }
-                else if( m_ObsArray[i].flags.isDopplerValid )
-                {
-                  mean_doppler = m_ObsArray[i].doppler;
-                }
-                if( m_ObsArray[i].freqType == GNSS_GPSL1 )
-                {
-                  estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL1*dT;
-                }
-                else if( m_ObsArray[i].freqType == GNSS_GPSL2 )
-                {
-                  estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL2*dT;
-                }
-                else
-                {
-                  estimated_psr = m_prev_ObsArray[j].psr;
-                }
+            mean_doppler = 0;
+            if( m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid )
+            {
+              mean_doppler = m_ObsArray[i].doppler + m_prev_ObsArray[j].doppler;
+              mean_doppler /= 2.0;
+            }
+            else if( m_ObsArray[i].flags.isDopplerValid )
+            {
+              mean_doppler = m_ObsArray[i].doppler;
+            }
+            if( m_ObsArray[i].freqType == GNSS_GPSL1 )
+            {
+              estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL1*dT;
+            }
+            else if( m_ObsArray[i].freqType == GNSS_GPSL2 )
+            {
+              estimated_psr = m_prev_ObsArray[j].psr - mean_doppler*GPS_WAVELENGTHL2*dT;
+            }
+            else
+            {
+              estimated_psr = m_prev_ObsArray[j].psr;
+            }
 
-                psr_difference = m_ObsArray[i].psr - estimated_psr;
+            psr_difference = m_ObsArray[i].psr - estimated_psr;
 
-                // Look for any arbitrary clock jumps larger than 1/2 millisecond
-                if( fabs(psr_difference) > ONE_MS_IN_M/2.0 )
-                {
-                  mean_n++;
-                  mean_val += psr_difference;
-                  m_clockJumpDetected = true;                  
-                }              
-                break;
-              }
-            }
+            // Look for any arbitrary clock jumps larger than 1/2 millisecond
+            if( fabs(psr_difference) > ONE_MS_IN_M/2.0 )
+            {
+              mean_n++;
+              mean_val += psr_difference;
+              m_clockJumpDetected = true;                  
+            }              
           }
         }
       }
@@ -1833,6 +2354,65 @@ namespace GNSS
     return result;
   }
 
+  bool GNSS_RxData::LoadNextFromReceiverData( const GNSS_RxData& source )
+  {
+    unsigned i = 0;
+
+    if( &source == this )
+    {
+      GNSS_ERROR_MSG( "if( &source == this )" );
+      return false;
+    }
+    if( source.m_nrValidObs > GNSS_RXDATA_NR_CHANNELS )
+    {
+      GNSS_ERROR_MSG( "if( source.m_nrValidObs > GNSS_RXDATA_NR_CHANNELS )" );
+      return false;
+    }
+
+    // Copy the current observations into the previous storage.
+    // The index_time_differential values copied from the source refer to 
+    // the source's previous observation set which has the same ordering.
+    m_prev_nrValidObs = m_nrValidObs;
+    for( i = 0; i < m_nrValidObs; i++ )
+    {
+      m_prev_ObsArray[i] = m_ObsArray[i];
+    }
+
+    m_nrValidObs = source.m_nrValidObs;
+    m_nrGPSL1Obs = source.m_nrGPSL1Obs;
+    for( i = 0; i < m_nrValidObs; i++ )
+    {
+      m_ObsArray[i] = source.m_ObsArray[i];
+
+      if( m_ObsArray[i].system == GNSS_GPS )
+      {
+        if( !m_EphAlmArray.CopyOrbitParameters( m_ObsArray[i].id, source.m_EphAlmArray ) )
+        {
+          GNSS_ERROR_MSG( "m_EphAlmArray.CopyOrbitParameters returned false." );
+          return false;
+        }
+      }
+    }
+
+    // Set the receiver time of the observation set.
+    m_pvt.time.gps_week = source.m_pvt.time.gps_week;
+    m_pvt.time.gps_tow  = source.m_pvt.time.gps_tow;
+
+    // It's the same for the least squares container.
+    m_pvt_lsq.time.gps_week = source.m_pvt.time.gps_week;
+    m_pvt_lsq.time.gps_tow  = source.m_pvt.time.gps_tow;
+
+    m_msJumpDetected_Positive = source.m_msJumpDetected_Positive;
+    m_msJumpDetected_Negative = source.m_msJumpDetected_Negative;
+    m_clockJumpDetected       = source.m_clockJumpDetected;
+    m_clockJump               = source.m_clockJump;
+
+    BuildChannelLookup();
+
+    return true;
+  }
+
+
   bool GNSS_RxData::CheckRINEXObservationHeader( const char *filepath, bool &isValid )
   {
     BOOL result;
@@ -1921,6 +2501,7 @@ namespace GNSS
     unsigned short rx_gps_week = 0;
     double rx_gps_tow = 0.0;     
 
+    int index_prev = 0;
     double current_time = 0;
     double prev_time = 0;
     double delta_time = 0;
@@ -2049,35 +2630,32 @@ namespace GNSS
 #endif
     
 
+    BuildChannelLookup();
+
     // Search for matching observations in the previous set of data to pass on static information
     // like ambiguities.
     for( i = 0; i < m_nrValidObs; i++ )
     {
       delta_time = 0;
-      for( j = 0; j < m_prev_nrValidObs; j++ )
+      index_prev = GetPreviousChannelIndex( m_ObsArray[i].system, m_ObsArray[i].id, m_ObsArray[i].freqType );
+      while( index_prev >= 0 && m_ObsArray[i].codeType != m_prev_ObsArray[index_prev].codeType )
+        index_prev = GetNextPreviousChannelIndex( index_prev ); // another code type on this frequency
+      if( index_prev >= 0 &&
+        m_ObsArray[i].codeType == m_prev_ObsArray[index_prev].codeType ) // Note should also check that channels are the same if real time!
       {
-        if( m_ObsArray[i].codeType == m_prev_ObsArray[j].codeType &&
-          m_ObsArray[i].freqType == m_prev_ObsArray[j].freqType &&
-          m_ObsArray[i].system == m_prev_ObsArray[j].system &&
-          m_ObsArray[i].id == m_prev_ObsArray[j].id ) // Note should also check that channels are the same if real time!
-        {
-          m_ObsArray[i].sd_ambiguity = m_prev_ObsArray[j].sd_ambiguity;
+        m_ObsArray[i].sd_ambiguity = m_prev_ObsArray[index_prev].sd_ambiguity;
 
-          current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
-          prev_time    = m_prev_ObsArray[j].tow + m_prev_ObsArray[j].week*SECONDS_IN_WEEK;
-          delta_time   = current_time - prev_time;
-          
-          if( m_ObsArray[i].flags.isAdrValid && m_ObsArray[i].flags.isPhaseLocked )
-          {
-            m_ObsArray[i].locktime = m_prev_ObsArray[j].locktime + static_cast<float>(delta_time);
-          }
-          else
-          {
-            m_ObsArray[i].locktime = 0;
-          }
-          //if( m_prev_ObsArray[j].ambiguity != 0 )
-            //printf( "%10.1Lf    %2d %12.1Lf\n", m_pvt.time.gps_tow, m_ObsArray[i].id, m_ObsArray[i].ambiguity );
-          break;
+        current_time = m_ObsArray[i].tow + m_ObsArray[i].week*SECONDS_IN_WEEK;
+        prev_time    = m_prev_ObsArray[index_prev].tow + m_prev_ObsArray[index_prev].week*SECONDS_IN_WEEK;
+        delta_time   = current_time - prev_time;
+        
+        if( m_ObsArray[i].flags.isAdrValid && m_ObsArray[i].flags.isPhaseLocked )
+        {
+          m_ObsArray[i].locktime = m_prev_ObsArray[index_prev].locktime + static_cast<float>(delta_time);
+        }
+        else
+        {
+          m_ObsArray[i].locktime = 0;
         }
       }
       if( delta_time == 0 )
@@ -2089,6 +2667,89 @@ namespace GNSS
     return true;
   }  
 
+  bool GNSS_RxData::EnableRealTimeInput( const double pollInterval, const double timeout )
+  {
+    if( m_fid == NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_fid == NULL )" );
+      return false;
+    }
+    if( m_rxDataType != GNSS_RXDATA_NOVATELOEM4 )
+    {
+      GNSS_ERROR_MSG( "Real time input is only supported for GNSS_RXDATA_NOVATELOEM4 data." );
+      return false;
+    }
+    if( pollInterval <= 0 || timeout < 0 )
+    {
+      GNSS_ERROR_MSG( "if( pollInterval <= 0 || timeout < 0 )" );
+      return false;
+    }
+    m_RealTime.isEnabled = true;
+    m_RealTime.isPipe = ftell( m_fid ) < 0; // A pipe cannot be positioned.
+    m_RealTime.pollInterval = pollInterval;
+    m_RealTime.timeout = timeout;
+    return true;
+  }
+
+
+  bool GNSS_RxData::WaitForRealTimeData( const long searchPosition, bool &isTimedOut )
+  {
+    long endPosition = 0;
+    long size = 0;
+    const double start = GNSS_Profiler::GetTime();
+    double now = start;
+
+    isTimedOut = false;
+
+    // The search stopped at the end of the file, so this is the size of the 
+    // file when the search ended. Data written since then is detected at once.
+    endPosition = ftell( m_fid );
+    if( endPosition < searchPosition )
+    {
+      GNSS_ERROR_MSG( "if( endPosition < searchPosition )" );
+      return false;
+    }
+
+    while( true )
+    {
+      // Clear the end of file indicator and discard the read buffer.
+      clearerr( m_fid );
+      if( fseek( m_fid, 0, SEEK_END ) != 0 )
+      {
+        GNSS_ERROR_MSG( "fseek failed." );
+        return false;
+      }
+      size = ftell( m_fid );
+      m_RealTime.nrPolls++;
+      if( size > endPosition )
+        break;
+
+      now = GNSS_Profiler::GetTime();
+      if( m_RealTime.timeout > 0 && now - start >= m_RealTime.timeout )
+      {
+        isTimedOut = true;
+        break;
+      }
+#ifdef WIN32
+      Sleep( (DWORD)(m_RealTime.pollInterval*1000.0) );
+#else
+      usleep( (useconds_t)(m_RealTime.pollInterval*1.0e6) );
+#endif
+    }
+    m_RealTime.wasWaiting = true;
+    m_RealTime.totalWaitTime += GNSS_Profiler::GetTime() - start;
+    if( isTimedOut )
+      return true;
+
+    if( fseek( m_fid, searchPosition, SEEK_SET ) != 0 )
+    {
+      GNSS_ERROR_MSG( "fseek failed." );
+      return false;
+    }
+    return true;
+  }
+
+
   bool GNSS_RxData::LoadNext_NOVATELOEM4( bool &endOfStream )
   {
     BOOL result = FALSE;
@@ -2115,10 +2776,14 @@ namespace GNSS
     unsigned nrValidObs;
     unsigned i = 0;
     unsigned j = 0;
+    int index_prev = 0;
     bool isAvailable;  // A boolean used in checking if ephemeris is available.
+    long searchPosition = -1; // The file position at the start of a message search (real time input only, -1 for a pipe).
+    bool isTimedOut = false;  // A boolean to indicate if the real time input timed out.
 
 
     endOfStream = false;
+    m_RealTime.wasWaiting = false;
 
     if( m_fid == NULL )
     {
@@ -2140,21 +2805,64 @@ namespace GNSS
       {  
         while( !wasEndOfFileReached && !wasMessageFound )
         {
-          result = NOVATELOEM4_FindNextMessageInFile( 
-            m_fid,
-            m_message,
-            GNSS_RXDATA_MSG_LENGTH,
-            &wasEndOfFileReached,
-            &wasMessageFound,
-            &filePosition,
-            &m_messageLength,
-            &messageID,
-            &numberBadCRC 
-            );
-          if( result == FALSE )
+          if( m_RealTime.isEnabled && m_RealTime.isPipe )
           {
-            GNSS_ERROR_MSG( "NOVATELOEM4_FindNextMessageInFile returned false." );
-            return false;
+            // Blocks until the next message is written or the pipe is closed.
+            result = NOVATELOEM4_FindNextMessageInStream( 
+              m_fid,
+              m_message,
+              GNSS_RXDATA_MSG_LENGTH,
+              &wasEndOfFileReached,
+              &wasMessageFound,
+              &m_messageLength,
+              &messageID,
+              &numberBadCRC 
+              );
+            if( result == FALSE )
+            {
+              GNSS_ERROR_MSG( "NOVATELOEM4_FindNextMessageInStream returned false." );
+              return false;
+            }
+          }
+          else
+          {
+            if( m_RealTime.isEnabled )
+            {
+              searchPosition = ftell( m_fid );
+            }
+
+            result = NOVATELOEM4_FindNextMessageInFile( 
+              m_fid,
+              m_message,
+              GNSS_RXDATA_MSG_LENGTH,
+              &wasEndOfFileReached,
+              &wasMessageFound,
+              &filePosition,
+              &m_messageLength,
+              &messageID,
+              &numberBadCRC 
+              );
+            if( result == FALSE )
+            {
+              GNSS_ERROR_MSG( "NOVATELOEM4_FindNextMessageInFile returned false." );
+              return false;
+            }
+          }
+
+          if( wasEndOfFileReached && m_RealTime.isEnabled && searchPosition >= 0 )
+          {
+            // The rest of the log may not be written yet. 
+            // Wait for it and search again from the same position.
+            if( !WaitForRealTimeData( searchPosition, isTimedOut ) )
+            {
+              GNSS_ERROR_MSG( "WaitForRealTimeData returned false." );
+              return false;
+            }
+            if( !isTimedOut )
+            {
+              wasEndOfFileReached = FALSE;
+              continue;
+            }
           }
           
           messageType = (NOVATELOEM4_enumMessageType)messageID;
@@ -2376,20 +3084,19 @@ namespace GNSS
     }
 
 
+    BuildChannelLookup();
+
     // Search for matching observations in the previous set of data to pass on static information
     // like ambiguities.
     for( i = 0; i < m_nrValidObs; i++ )
     {
-      for( j = 0; j < m_prev_nrValidObs; j++ )
+      index_prev = GetPreviousChannelIndex( m_ObsArray[i].system, m_ObsArray[i].id, m_ObsArray[i].freqType );
+      while( index_prev >= 0 && m_ObsArray[i].codeType != m_prev_ObsArray[index_prev].codeType )
+        index_prev = GetNextPreviousChannelIndex( index_prev ); // another code type on this frequency
+      if( index_prev >= 0 &&
+        m_ObsArray[i].codeType == m_prev_ObsArray[index_prev].codeType ) // Note should also check that channels are the same if real time!
       {
-        if( m_ObsArray[i].codeType == m_prev_ObsArray[j].codeType &&
-          m_ObsArray[i].freqType == m_prev_ObsArray[j].freqType &&
-          m_ObsArray[i].system == m_prev_ObsArray[j].system &&
-          m_ObsArray[i].id == m_prev_ObsArray[j].id ) // Note should also check that channels are the same if real time!
-        {
-          m_ObsArray[i].sd_ambiguity = m_prev_ObsArray[j].sd_ambiguity;
-          break;
-        }
+        m_ObsArray[i].sd_ambiguity = m_prev_ObsArray[index_prev].sd_ambiguity;
       }
     }
 
@@ -2699,18 +3406,25 @@ namespace GNSS
   {
     unsigned i = 0;
     unsigned j = 0;
+    unsigned n = 0;
+    int k = 0;
     double t_prev = 0.0;
     double t = 0.0;
     double dt = 0.0;
-    double phase_diff = 0.0; // The difference between the predicted phase and the measured phase.
-    double predicted_phase = 0.0;
-    double mean_doppler = 0.0;
     double cmc = 0.0;
     double cmc_prev = 0.0;
     double cmc_diff = 0.0;
     char msg[256];
 
-    static double max_dif = 0.0;
+    // The channels checked with the phase rate prediction, aligned with their previous observation.
+    unsigned index[GNSS_RXDATA_NR_CHANNELS];
+    unsigned index_prev[GNSS_RXDATA_NR_CHANNELS];
+    double previous_Doppler[GNSS_RXDATA_NR_CHANNELS];
+    double previous_adr[GNSS_RXDATA_NR_CHANNELS];
+    double current_Doppler[GNSS_RXDATA_NR_CHANNELS];
+    double current_adr[GNSS_RXDATA_NR_CHANNELS];
+    BOOL wasSlipDetected[GNSS_RXDATA_NR_CHANNELS];
+    double sizeOfSlipInCycles[GNSS_RXDATA_NR_CHANNELS];
 
     t_prev = m_prev_pvt.time.gps_week*SECONDS_IN_WEEK + m_prev_pvt.time.gps_tow;
     t = m_pvt.time.gps_week*SECONDS_IN_WEEK + m_pvt.time.gps_tow;
@@ -2730,94 +3444,218 @@ namespace GNSS
       return true;
     }
 
+    // Match the current and previous observations. Channels with a valid Doppler
+    // are checked together below, the others are checked with code - carrier.
     for( i = 0; i < m_nrValidObs; i++ )
     {
-      for( j = 0; j < m_prev_nrValidObs; j++ )
+      if( m_ObsArray[i].freqType != GNSS_GPSL1 ||
+        !m_ObsArray[i].flags.isNoCycleSlipDetected ) // cycle slip already detected
+        continue;
+
+      k = GetPreviousChannelIndex( m_ObsArray[i].system, m_ObsArray[i].id, GNSS_GPSL1 );
+      if( k < 0 )
+        continue;
+      j = k;
+
+      // channel matching is not performed.
+      // This should be done if this a real time receiver data.
+      // However, since the data source is generally not known for
+      // post processing software, it is not performed here.
+      if( m_ObsArray[i].flags.isPhaseLocked && m_prev_ObsArray[j].flags.isPhaseLocked &&
+        m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid &&
+        m_ObsArray[i].flags.isAdrValid && m_prev_ObsArray[j].flags.isAdrValid &&
+        m_ObsArray[i].flags.isParityValid && m_prev_ObsArray[j].flags.isParityValid )            
       {
-        if( m_ObsArray[i].system == m_prev_ObsArray[j].system &&
-          m_ObsArray[i].id == m_prev_ObsArray[j].id &&
-          m_ObsArray[i].freqType == GNSS_GPSL1 &&
-          m_ObsArray[i].freqType == m_prev_ObsArray[j].freqType &&
-          m_ObsArray[i].flags.isNoCycleSlipDetected ) // no cycle slip already detected
+        index[n] = i;
+        index_prev[n] = j;
+        previous_Doppler[n] = m_prev_ObsArray[j].doppler;
+        previous_adr[n] = m_prev_ObsArray[j].adr;
+        if( m_clockJumpDetected )
         {
-          // channel matching is not performed.
-          // This should be done if this a real time receiver data.
-          // However, since the data source is generally not known for
-          // post processing software, it is not performed here.
-          if( m_ObsArray[i].flags.isPhaseLocked && m_prev_ObsArray[j].flags.isPhaseLocked &&
-            m_ObsArray[i].flags.isDopplerValid && m_prev_ObsArray[j].flags.isDopplerValid &&
-            m_ObsArray[i].flags.isAdrValid && m_prev_ObsArray[j].flags.isAdrValid &&
-            m_ObsArray[i].flags.isParityValid && m_prev_ObsArray[j].flags.isParityValid )            
-          {
-            mean_doppler = (m_ObsArray[i].doppler + m_prev_ObsArray[j].doppler)/2.0;
-
-            predicted_phase = m_prev_ObsArray[j].adr - mean_doppler * dt; // GDM_BEWARE Doppler sign convention
-            if( m_clockJumpDetected )
-            {
-              predicted_phase += m_clockJump/GPS_WAVELENGTHL1;
-            }
-
-            phase_diff = predicted_phase - m_ObsArray[i].adr;
-
-            if( fabs(phase_diff) > max_dif )
-              max_dif = fabs(phase_diff);
-            if( fabs(phase_diff) > nrThresholdCycles*dt )
-            {
-              // Compare using code - carrier.
-              cmc_prev = m_prev_ObsArray[j].psr - m_prev_ObsArray[j].adr*GPS_WAVELENGTHL1;
-              cmc = m_ObsArray[i].psr - m_ObsArray[i].adr*GPS_WAVELENGTHL1;
-              cmc_diff = cmc - cmc_prev;
+          previous_adr[n] += m_clockJump/GPS_WAVELENGTHL1;
+        }
+        current_Doppler[n] = m_ObsArray[i].doppler;
+        current_adr[n] = m_ObsArray[i].adr;
+        n++;
+      }        
+      else
+      {
+        if( m_ObsArray[i].flags.isPhaseLocked && m_prev_ObsArray[j].flags.isPhaseLocked &&
+          m_ObsArray[i].flags.isPsrValid && m_prev_ObsArray[j].flags.isPsrValid &&
+          m_ObsArray[i].flags.isCodeLocked && m_prev_ObsArray[j].flags.isCodeLocked &&
+          m_ObsArray[i].flags.isAdrValid && m_prev_ObsArray[j].flags.isAdrValid &&
+          m_ObsArray[i].flags.isParityValid && m_prev_ObsArray[j].flags.isParityValid )
+        {
+          // Compare using code - carrier.
+          cmc_prev = m_prev_ObsArray[j].psr - m_prev_ObsArray[j].adr*GPS_WAVELENGTHL1;
+          cmc = m_ObsArray[i].psr - m_ObsArray[i].adr*GPS_WAVELENGTHL1;
+          cmc_diff = cmc - cmc_prev;
 
-              if( cmc_diff < 5.0 )
-              {
-                m_ObsArray[i].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
-              }
-              else
-              {
-                sprintf( msg, "%.1Lf %d GPS L1 cycle slip detected\n PRN %d Phase rate method difference= %.1Lf cycles, Time difference code-carrier = %.1Lf m",  m_pvt.time.gps_tow, m_pvt.time.gps_week, m_ObsArray[i].id, phase_diff, cmc_diff );
-                GNSS_ERROR_MSG( msg );
-                m_ObsArray[i].flags.isNoCycleSlipDetected = 0; // Indicate a cycle slip has occured.
-              }
-            }
-            else
-            {
-              m_ObsArray[i].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
-            }
-            break;
-          }        
+          if( fabs(cmc_diff) > 5.0 )
+          {
+            sprintf( msg, "%.1Lf %d GPS L1 cycle slip detected\n PRN %d Time difference code-carrier = %.1Lf m",  m_pvt.time.gps_tow, m_pvt.time.gps_week, m_ObsArray[i].id, cmc_diff );
+            GNSS_ERROR_MSG( msg );
+            m_ObsArray[i].flags.isNoCycleSlipDetected = 0; // Indicate a cycle slip has occured.
+          }
           else
           {
-            if( m_ObsArray[i].flags.isPhaseLocked && m_prev_ObsArray[j].flags.isPhaseLocked &&
-              m_ObsArray[i].flags.isPsrValid && m_prev_ObsArray[j].flags.isPsrValid &&
-              m_ObsArray[i].flags.isCodeLocked && m_prev_ObsArray[j].flags.isCodeLocked &&
-              m_ObsArray[i].flags.isAdrValid && m_prev_ObsArray[j].flags.isAdrValid &&
-              m_ObsArray[i].flags.isParityValid && m_prev_ObsArray[j].flags.isParityValid )
-            {
-              // Compare using code - carrier.
-              cmc_prev = m_prev_ObsArray[j].psr - m_prev_ObsArray[j].adr*GPS_WAVELENGTHL1;
-              cmc = m_ObsArray[i].psr - m_ObsArray[i].adr*GPS_WAVELENGTHL1;
-              cmc_diff = cmc - cmc_prev;
-
-              if( fabs(cmc_diff) > 5.0 )
-              {
-                sprintf( msg, "%.1Lf %d GPS L1 cycle slip detected\n PRN %d Time difference code-carrier = %.1Lf m",  m_pvt.time.gps_tow, m_pvt.time.gps_week, m_ObsArray[i].id, cmc_diff );
-                GNSS_ERROR_MSG( msg );
-                m_ObsArray[i].flags.isNoCycleSlipDetected = 0; // Indicate a cycle slip has occured.
-              }
-              else
-              {
-                m_ObsArray[i].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
-              }
-            }
+            m_ObsArray[i].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
           }
         }
       }
     }
+    if( n == 0 )
+      return true;
+
+    if( !CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch( 
+      dt, previous_Doppler, previous_adr, current_Doppler, current_adr, n, nrThresholdCycles*dt, wasSlipDetected, sizeOfSlipInCycles ) )
+    {
+      GNSS_ERROR_MSG( "CYCLESLIP_CheckForCycleSlipUsingPhaseRatePrediction_Batch returned false." );
+      return false;
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+      if( wasSlipDetected[i] )
+      {
+        // Compare using code - carrier.
+        j = index_prev[i];
+        cmc_prev = m_prev_ObsArray[j].psr - m_prev_ObsArray[j].adr*GPS_WAVELENGTHL1;
+        cmc = m_ObsArray[index[i]].psr - m_ObsArray[index[i]].adr*GPS_WAVELENGTHL1;
+        cmc_diff = cmc - cmc_prev;
+
+        if( cmc_diff < 5.0 )
+        {
+          m_ObsArray[index[i]].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
+        }
+        else
+        {
+          sprintf( msg, "%.1Lf %d GPS L1 cycle slip detected\n PRN %d Phase rate method difference= %.1Lf cycles, Time difference code-carrier = %.1Lf m",  m_pvt.time.gps_tow, m_pvt.time.gps_week, m_ObsArray[index[i]].id, sizeOfSlipInCycles[i], cmc_diff );
+          GNSS_ERROR_MSG( msg );
+          m_ObsArray[index[i]].flags.isNoCycleSlipDetected = 0; // Indicate a cycle slip has occured.
+        }
+      }
+      else
+      {
+        m_ObsArray[index[i]].flags.isNoCycleSlipDetected = 1; // No cycle slip detected.
+      }
+    }
 
     return true;
   }
 
 
+  /// \brief  Is this observation's phase usable for geometry free cycle slip detection.
+  static bool IsPhaseUsableForSlipDetection( const GNSS_structMeasurement &obs )
+  {
+    return obs.flags.isPhaseLocked && obs.flags.isAdrValid && obs.flags.isParityValid;
+  }
+
+
+  bool GNSS_RxData::CheckForCycleSlips_UsingGeometryFreePhase( 
+    const double thresholdInMeters,
+    const double thresholdRate,
+    const double maxGap
+    )
+  {
+    unsigned i = 0;
+    unsigned n = 0;
+    int indexL2 = 0;
+    int indexL1_prev = 0;
+    int indexL2_prev = 0;
+    double t_prev = 0.0;
+    double t = 0.0;
+    double dt = 0.0;
+    char msg[256];
+
+    // The satellites with L1 and L2 phase at both epochs.
+    unsigned indexL1[GNSS_RXDATA_NR_CHANNELS];
+    unsigned indexL2_current[GNSS_RXDATA_NR_CHANNELS];
+    double previous_adr_L1[GNSS_RXDATA_NR_CHANNELS];
+    double previous_adr_L2[GNSS_RXDATA_NR_CHANNELS];
+    double current_adr_L1[GNSS_RXDATA_NR_CHANNELS];
+    double current_adr_L2[GNSS_RXDATA_NR_CHANNELS];
+    BOOL wasSlipDetected[GNSS_RXDATA_NR_CHANNELS];
+    double sizeOfSlipInMeters[GNSS_RXDATA_NR_CHANNELS];
+
+    t_prev = m_prev_pvt.time.gps_week*SECONDS_IN_WEEK + m_prev_pvt.time.gps_tow;
+    t = m_pvt.time.gps_week*SECONDS_IN_WEEK + m_pvt.time.gps_tow;
+    dt = t - t_prev;
+    if( dt == 0.0 )
+    {
+      // nothing to check.
+      return true; 
+    }
+    if( dt < 0.0 )
+    {    
+      GNSS_ERROR_MSG( "if( dt < 0.0 )" );
+      return false;
+    }
+    if( dt > maxGap ) // The ionosphere may change by more than the threshold.
+    {
+      return true;
+    }
+
+    for( i = 0; i < m_nrValidObs; i++ )
+    {
+      if( m_ObsArray[i].system != GNSS_GPS || m_ObsArray[i].freqType != GNSS_GPSL1 )
+        continue;
+      if( !IsPhaseUsableForSlipDetection( m_ObsArray[i] ) )
+        continue;
+
+      // The first usable L2 channel of this satellite.
+      indexL2 = GetChannelIndex( GNSS_GPS, m_ObsArray[i].id, GNSS_GPSL2 );
+      while( indexL2 >= 0 && !IsPhaseUsableForSlipDetection( m_ObsArray[indexL2] ) )
+        indexL2 = GetNextChannelIndex( indexL2 ); // a duplicate channel of this satellite
+      if( indexL2 < 0 )
+        continue;
+
+      // The previous L1 and L2 channels with the same code type (the same 
+      // phase tracking) as the current ones, as the ambiguities are carried over.
+      indexL1_prev = GetPreviousChannelIndex( GNSS_GPS, m_ObsArray[i].id, GNSS_GPSL1 );
+      while( indexL1_prev >= 0 && 
+        !( m_prev_ObsArray[indexL1_prev].codeType == m_ObsArray[i].codeType && IsPhaseUsableForSlipDetection( m_prev_ObsArray[indexL1_prev] ) ) )
+        indexL1_prev = GetNextPreviousChannelIndex( indexL1_prev ); // a duplicate channel of this satellite
+      indexL2_prev = GetPreviousChannelIndex( GNSS_GPS, m_ObsArray[i].id, GNSS_GPSL2 );
+      while( indexL2_prev >= 0 && 
+        !( m_prev_ObsArray[indexL2_prev].codeType == m_ObsArray[indexL2].codeType && IsPhaseUsableForSlipDetection( m_prev_ObsArray[indexL2_prev] ) ) )
+        indexL2_prev = GetNextPreviousChannelIndex( indexL2_prev ); // a duplicate channel of this satellite
+      if( indexL1_prev < 0 || indexL2_prev < 0 )
+        continue;
+
+      indexL1[n] = i;
+      indexL2_current[n] = indexL2;
+      previous_adr_L1[n] = m_prev_ObsArray[indexL1_prev].adr;
+      previous_adr_L2[n] = m_prev_ObsArray[indexL2_prev].adr;
+      current_adr_L1[n] = m_ObsArray[i].adr;
+      current_adr_L2[n] = m_ObsArray[indexL2].adr;
+      n++;
+    }
+    if( n == 0 )
+      return true;
+
+    if( !CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch( 
+      previous_adr_L1, previous_adr_L2, current_adr_L1, current_adr_L2, n, 
+      GPS_WAVELENGTHL1, GPS_WAVELENGTHL2, thresholdInMeters + thresholdRate*dt, wasSlipDetected, sizeOfSlipInMeters ) )
+    {
+      GNSS_ERROR_MSG( "CYCLESLIP_CheckForCycleSlipUsingGeometryFreePhase_Batch returned false." );
+      return false;
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+      if( wasSlipDetected[i] )
+      {
+        sprintf( msg, "%.1lf %d GPS L1/L2 cycle slip detected\n PRN %d Geometry free phase change = %.3lf m",  m_pvt.time.gps_tow, m_pvt.time.gps_week, m_ObsArray[indexL1[i]].id, sizeOfSlipInMeters[i] );
+        GNSS_ERROR_MSG( msg );
+        m_ObsArray[indexL1[i]].flags.isNoCycleSlipDetected = 0; // Indicate a cycle slip has occured.
+        m_ObsArray[indexL2_current[i]].flags.isNoCycleSlipDetected = 0;
+      }
+    }
+    return true;
+  }
+
+
   bool GNSS_RxData::DebugPrintObservationArray( const char *filepath )
   {
     unsigned i = 0;
@@ -3112,206 +3950,124 @@ namespace GNSS
 
   bool GNSS_RxData::LoadRINEXNavigationData(void)
   {
-    // First estimate the size of the ephemeris array needed based on the number of lines
-    // in the data file after the header.
-    unsigned line_count = 0;
-    unsigned estimated_nr_eph = 0;
-    BOOL result = 0;
-
-    FILE* fid = NULL;
-    fid = fopen( m_RINEX_eph.filepath.c_str(), "r" );
-    if( fid == NULL )
-    {
-      GNSS_ERROR_MSG( "if( fid == NULL )" );
-      return false;
-    }
-
-    // Advance over the header.
-    while( !feof(fid) && ferror(fid)==0 )
+    if( m_RINEX_eph_store_owned == NULL )
     {
-      if( fgets( (char*)m_message, GNSS_RXDATA_MSG_LENGTH, fid ) == NULL )
-        break;
-      if( strstr( (char*)m_message, "END OF HEADER" ) != NULL )
-        break;
+      m_RINEX_eph_store_owned = new GPS_EphemerisStore;
+      if( m_RINEX_eph_store_owned == NULL )
+      {
+        GNSS_ERROR_MSG( "if( m_RINEX_eph_store_owned == NULL )" );
+        return false;
+      }
     }
-
-    // Count the number of lines in the remaining data.
-    while( !feof(fid) && ferror(fid)==0 )
+    
+    if( !m_RINEX_eph_store_owned->LoadRINEXNavigationFile( m_RINEX_eph_filepath.c_str() ) )
     {
-      if( fgets( (char*)m_message, GNSS_RXDATA_MSG_LENGTH, fid ) == NULL )
-        break;
-      line_count++;
+      GNSS_ERROR_MSG( "m_RINEX_eph_store_owned->LoadRINEXNavigationFile returned false." );
+      return false;
     }
+    m_RINEX_eph_store = m_RINEX_eph_store_owned;
 
-    fclose(fid);
-
-    // There are 8 lines per ephemeris record generally.
-    estimated_nr_eph = line_count/8;
+    return true;
+  }
 
-    estimated_nr_eph += 32; // for good measure.
 
-    // Allocate enough memory for the ephemeris array.
-    m_RINEX_eph.eph_array = NULL;
-    m_RINEX_eph.eph_array = new GPS_structEphemeris[estimated_nr_eph];
-    if( m_RINEX_eph.eph_array == NULL )
+  bool GNSS_RxData::SetRINEXEphemerisStore( const GPS_EphemerisStore* store )
+  {
+    if( store == NULL )
     {
-      GNSS_ERROR_MSG( "if( m_RINEX_eph.eph_array == NULL )" );
+      GNSS_ERROR_MSG( "if( store == NULL )" );
       return false;
     }
-     
-    m_RINEX_eph.max_array_length = estimated_nr_eph;
-    
-    result = RINEX_DecodeGPSNavigationFile(
-      m_RINEX_eph.filepath.c_str(),
-      &m_RINEX_eph.iono_model,
-      m_RINEX_eph.eph_array,
-      m_RINEX_eph.max_array_length,
-      &m_RINEX_eph.array_length
-      );
-    if( result == FALSE )
+    if( m_RINEX_eph_store_owned != NULL && m_RINEX_eph_store_owned != store )
     {
-      GNSS_ERROR_MSG( "RINEX_DecodeGPSNavigationFile returned FALSE." );
-      return false;
+      delete m_RINEX_eph_store_owned;
+      m_RINEX_eph_store_owned = NULL;
     }
-
+    m_RINEX_eph_store = store;
+    m_RINEX_use_eph = true;
     return true;
   }
 
+
   bool GNSS_RxData::UpdateTheEphemerisArrayWithUsingRINEX()
   {
-    int RINEX_eph_index = -1;
-    unsigned i = 0;
     unsigned j = 0;
-    unsigned k = 0;
-    unsigned short eph_week = 0;
-    unsigned eph_tow = 0;
     bool result = false;
-    double eph_time = 0;
-    double current_eph_time = 0;
-    const double rx_time = m_pvt.time.gps_week*SECONDS_IN_WEEK + m_pvt.time.gps_tow;
-    bool isEphUpToDate;
-    bool isAvailable;
+    bool isAvailable = false;
+    bool isCurrentAvailable = false;
+    GPS_structEphemeris eph;
+    GPS_structEphemeris current_eph;
 
-    // GDM CONTINUE HERE
+    if( m_RINEX_eph_store == NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_RINEX_eph_store == NULL )" );
+      return false;
+    }
 
     /*
-    - Only update thte active satellites
+    - Only update the active satellites
     - Update the ephemeris object as if the data is real time.
-    - i.e. Not the best ephemeris but the most up to date.
+    - i.e. Not the best ephemeris but the most up to date, 
+      unless m_RINEX_use_best_eph is set (the closest toe).
+    - The store is searched by time so this works for any epoch order.
     */
     for( j = 0; j < m_nrValidObs; j++ )
     {
-      RINEX_eph_index = -1; // Not available.
-      eph_time = 0;
-      current_eph_time = 0;
-      isEphUpToDate = false;
-      isAvailable = false;
       if( m_ObsArray[j].flags.isActive )
       {
         if( m_ObsArray[j].system == GNSS_GPS )
         {
-          // Check if new ephemeris information is available. 
-          // Process as if the data is real-time.
-    
-          result = m_EphAlmArray.GetEphemerisTOW(
-            m_ObsArray[j].id, 
-            isAvailable,
-            eph_week,
-            eph_tow
-            );
-          if( !result )
+          if( m_RINEX_use_best_eph )
           {
-            GNSS_ERROR_MSG( "m_EphAlmArray.GetEphemerisTOW returned false." );
-            return false;
+            result = m_RINEX_eph_store->GetBestEphemeris( 
+              m_ObsArray[j].id,
+              m_pvt.time.gps_week,
+              m_pvt.time.gps_tow,
+              eph,
+              isAvailable
+              );
+            if( !result )
+            {
+              GNSS_ERROR_MSG( "m_RINEX_eph_store->GetBestEphemeris returned false." );
+              return false;
+            }
           }
-
-          if( isAvailable )
+          else
           {
-            current_eph_time = eph_week*SECONDS_IN_WEEK + eph_tow;
+            result = m_RINEX_eph_store->GetMostRecentEphemeris( 
+              m_ObsArray[j].id,
+              m_pvt.time.gps_week,
+              m_pvt.time.gps_tow,
+              eph,
+              isAvailable
+              );
+            if( !result )
+            {
+              GNSS_ERROR_MSG( "m_RINEX_eph_store->GetMostRecentEphemeris returned false." );
+              return false;
+            }
           }
+          if( !isAvailable )
+            continue; // There are no ephemeris records for this rx time yet.
 
-          // Go through the entire ephemeris array. This algorihtms assumes
-          // the ephemeris records are increasing in time.
-          for( k = 0; k < m_RINEX_eph.array_length; k++ )
+          result = m_EphAlmArray.GetEphemeris( m_ObsArray[j].id, current_eph, isCurrentAvailable );
+          if( !result )
           {
-            if( m_RINEX_eph.eph_array[k].prn == m_ObsArray[j].id )
-            {
-              eph_time = m_RINEX_eph.eph_array[k].tow_week*SECONDS_IN_WEEK + m_RINEX_eph.eph_array[k].tow;
-
-              if( !isAvailable )
-              {
-                if( rx_time > eph_time )
-                {
-                  RINEX_eph_index = k;
-                }
-                else
-                {
-                  if( RINEX_eph_index >= 0 )
-                  {
-                    result = m_EphAlmArray.AddEphemeris( 
-                      m_RINEX_eph.eph_array[RINEX_eph_index].prn, 
-                      m_RINEX_eph.eph_array[RINEX_eph_index]
-                    );
-                    if( !result )
-                    {
-                      GNSS_ERROR_MSG( "m_EphAlmArray.AddEphemeris returned false." );
-                      return false;
-                    }
-                    isEphUpToDate = true;
-                    break;
-                  }
-                  else
-                  {
-                    // There are no ephemeris records for this rx time yet.                    
-                    break;
-                  }                  
-                }
-              }
-              else
-              {
-                if( rx_time > eph_time )
-                {
-                  if( current_eph_time < eph_time )
-                  {
-                    RINEX_eph_index = k;
-                  }
-                }
-                else
-                {
-                  if( RINEX_eph_index >= 0 )
-                  {
-                    result = m_EphAlmArray.AddEphemeris( 
-                      m_RINEX_eph.eph_array[RINEX_eph_index].prn, 
-                      m_RINEX_eph.eph_array[RINEX_eph_index]
-                    );
-                    if( !result )
-                    {
-                      GNSS_ERROR_MSG( "m_EphAlmArray.AddEphemeris returned false." );
-                      return false;
-                    }
-                    isEphUpToDate = true;                    
-                  }
-                  break;
-                }
-              }
-            }
+            GNSS_ERROR_MSG( "m_EphAlmArray.GetEphemeris returned false." );
+            return false;
           }
 
-          // Deal with end of file ephemeris records, no records are greater in time.
-          if( !isEphUpToDate )
+          // Only add the record if it differs from the one in use.
+          if( !isCurrentAvailable 
+            || current_eph.tow_week != eph.tow_week 
+            || current_eph.tow != eph.tow 
+            || current_eph.iode != eph.iode )
           {
-            if( RINEX_eph_index >= 0 )
+            result = m_EphAlmArray.AddEphemeris( eph.prn, eph );
+            if( !result )
             {
-              result = m_EphAlmArray.AddEphemeris( 
-                m_RINEX_eph.eph_array[RINEX_eph_index].prn, 
-                m_RINEX_eph.eph_array[RINEX_eph_index]
-              );
-              if( !result )
-              {
-                GNSS_ERROR_MSG( "m_EphAlmArray.AddEphemeris returned false." );
-                return false;
-              }
-              isEphUpToDate = true;
+              GNSS_ERROR_MSG( "m_EphAlmArray.AddEphemeris returned false." );
+              return false;
             }
           }
         }
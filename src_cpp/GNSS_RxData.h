@@ -42,6 +42,7 @@ SUCH DAMAGE.
 #include <string>
 #include "gnss_types.h"
 #include "gps.h"
+#include "geodesy.h"
 #include "rinex.h"
 
 
@@ -50,6 +51,16 @@ SUCH DAMAGE.
 #define GNSS_RXDATA_NR_CHANNELS (48)
 #define GNSS_RXDATA_MAX_OBS (GNSS_RXDATA_NR_CHANNELS*3) // psr, doppler, adr
 
+/// The dimensions of the (system, id, frequency) to channel lookup tables
+/// of GNSS_RxData. Observations outside these ranges are found by search.
+#define GNSS_RXDATA_LOOKUP_NR_SYSTEMS     (4)   // GPS, GLONASS, WAAS, Pseudolite
+#define GNSS_RXDATA_LOOKUP_NR_IDS         (256)
+#define GNSS_RXDATA_LOOKUP_NR_FREQUENCIES (2)   // L1, L2
+
+/// The elevation spacing [deg] of the tabulated tropospheric mapping 
+/// functions in GNSS_RxData::m_AtmCache.
+#define GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG (0.1)
+
 /// This is the buffer length (in bytes) for a data message buffer used
 /// by the receiver object in decoding data.
 #define GNSS_RXDATA_MSG_LENGTH  (16384)
@@ -162,6 +173,19 @@ namespace GNSS
       unsigned &tow             //!< The time of week based on the Z-count in the Hand Over Word.
       );
 
+    /**
+    \brief    Copy the orbit information (the current and previous ephemeris
+              and the almanac) for the prn specified from another array.
+    \author   agent (agent@local)
+    \date     2026-10-18
+    \remarks  The source array is only read.
+    \return   true if successful, false if error.
+    */
+    bool CopyOrbitParameters(
+      const unsigned short prn,                          //!< The desired GPS PRN. (1-32 GPS, 120-138 SBAS).
+      const GPS_BroadcastEphemerisAndAlmanacArray& src  //!< The source array.
+      );
+
   private:
     /// \brief   The copy constructor. Disabled!
     GPS_BroadcastEphemerisAndAlmanacArray( const GPS_BroadcastEphemerisAndAlmanacArray& rhs );
@@ -198,6 +222,127 @@ namespace GNSS
   };
 
 
+  //============================================================================
+  /// \class   GPS_EphemerisStore
+  /// \brief   A time indexed store of GPS broadcast ephemeris records, e.g. 
+  ///          all the records of a RINEX GPS navigation file.
+  ///
+  /// The records are indexed per PRN and sorted by transmission time 
+  /// (tow_week, tow) and by reference time (week, toe) so that the ephemeris 
+  /// applicable at an arbitrary time is found with a binary search. Epochs may therefore be processed in any order (e.g. after a 
+  /// seek) without rescanning the navigation data.
+  ///
+  /// Once loaded, the store is only read. A single store may be shared 
+  /// by several GNSS_RxData objects (see GNSS_RxData::SetRINEXEphemerisStore).
+  ///
+  /// PRN 1-37 are supported (GPS and pseudolites).
+  ///
+  /// \author  agent (agent@local)
+  /// \date    2026-10-18
+  /// \since   2026-10-18
+  ///
+  class GPS_EphemerisStore
+  {
+  public:
+
+    /// \brief    The default constructor (no data allocated yet).
+    GPS_EphemerisStore();
+
+    /// \brief    The destructor.
+    virtual ~GPS_EphemerisStore();
+
+    /// \brief    Load all the ephemeris records of a RINEX GPS navigation 
+    ///           file and build the time indices.
+    /// \return   true if successful, false if error.
+    bool LoadRINEXNavigationFile( const char* filepath );
+
+    /// \brief    Set the store from an array of ephemeris records (any order)
+    ///           and build the time indices. Any existing records are replaced.
+    /// \return   true if successful, false if error.
+    bool SetEphemerisRecords( 
+      const GPS_structEphemeris* eph_array, //!< The array of ephemeris records.
+      const unsigned nr_eph                 //!< The number of records in eph_array.
+      );
+
+    /// \brief    Get the most recently transmitted ephemeris prior to the time
+    ///           specified, i.e. the ephemeris a real-time receiver would be 
+    ///           using at that time.
+    /// \return   true if successful, false if error.
+    bool GetMostRecentEphemeris( 
+      const unsigned short prn,      //!< The desired GPS PRN (1-37).
+      const unsigned short gps_week, //!< The GPS week [weeks].
+      const double gps_tow,          //!< The GPS time of week [s].
+      GPS_structEphemeris &eph,      //!< A reference to an ephemeris struct in which to store the data.
+      bool &isAvailable              //!< This boolean indicates if ephemeris data is available or not.
+      ) const;
+
+    /// \brief    Get the best ephemeris valid at the time specified, i.e. the 
+    ///           ephemeris with the reference time (toe) closest to the time 
+    ///           for which the time is within the curve fit interval (four hours, 
+    ///           or six hours if the fit interval flag is set).
+    /// \return   true if successful, false if error.
+    bool GetBestEphemeris( 
+      const unsigned short prn,      //!< The desired GPS PRN (1-37).
+      const unsigned short gps_week, //!< The GPS week [weeks].
+      const double gps_tow,          //!< The GPS time of week [s].
+      GPS_structEphemeris &eph,      //!< A reference to an ephemeris struct in which to store the data.
+      bool &isAvailable              //!< This boolean indicates if ephemeris data is available or not.
+      ) const;
+
+    /// \brief    The ionospheric model decoded from the navigation file header.
+    const GNSS_structKlobuchar& GetIonoModel() const { return m_iono_model; }
+
+    /// \brief    The total number of ephemeris records in the store.
+    unsigned GetNumberOfRecords() const { return m_array_length; }
+
+  private:
+    /// \brief   The copy constructor. Disabled!
+    GPS_EphemerisStore( const GPS_EphemerisStore& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GPS_EphemerisStore& rhs);
+
+  protected:
+
+    /// \brief   Free all the arrays.
+    void Clear();
+
+    /// \brief   Build the per PRN time indices of m_eph_array.
+    /// \return  true if successful, false if error.
+    bool BuildIndices();
+
+  protected:
+
+    /// The number of PRN slots in the store (PRN 1-37).
+    enum { NR_PRNS = 37 };
+
+    /// The ephemeris records.
+    GPS_structEphemeris* m_eph_array;
+
+    /// The number of valid records in m_eph_array.
+    unsigned m_array_length;
+
+    /// The first position in the sorted index arrays for each PRN (PRN-1). 
+    /// The records of PRN p occupy [m_prn_offset[p-1], m_prn_offset[p]).
+    unsigned m_prn_offset[NR_PRNS+1];
+
+    /// Indices into m_eph_array grouped by PRN and sorted by transmission time.
+    unsigned* m_index_by_tx;
+
+    /// The transmission time [s] (continuous GPS time) corresponding to m_index_by_tx.
+    double* m_tx_time;
+
+    /// Indices into m_eph_array grouped by PRN and sorted by reference time (toe).
+    unsigned* m_index_by_toe;
+
+    /// The reference time [s] (continuous GPS time) corresponding to m_index_by_toe.
+    double* m_toe_time;
+
+    /// The ionospheric model decoded from the navigation file header.
+    GNSS_structKlobuchar m_iono_model;
+  };
+
+
 #ifdef ASDFASDF
 
   /**
@@ -492,6 +637,43 @@ namespace GNSS
     bool LoadNext( bool &endOfStream );
 
 
+    /**
+    \brief   Enable real time input. The end of the input file is then not 
+             the end of the stream. The file is polled until the rest of the 
+             next epoch has been written (e.g. a log that is being recorded), 
+             or until no new data has arrived within the timeout.
+    \author  agent (agent@local)
+    \date    2026-10-18
+    \remarks (1) Only GNSS_RXDATA_NOVATELOEM4 data is supported. \n
+             (2) A named pipe is read as it is written, the end of the 
+             stream is when the writer closes it. \n
+             (3) Must be called after Initialize.
+    \return  true if successful, false if error.
+    */
+    bool EnableRealTimeInput( 
+      const double pollInterval, //!< The time between checks for new data [s].
+      const double timeout       //!< The end of the stream is reached if no new data arrives within this time, 0 to wait indefinitely [s].
+      );
+
+
+    /**
+    \brief   Load the next epoch of data from another receiver data object
+             that has already decoded it. e.g. A reference station stream
+             is decoded once and broadcast to several rover pipelines.
+    \author  agent (agent@local)
+    \date    2026-10-18
+    \remarks (1) The observations, the receiver time, the clock jump
+             indicators and the orbit information for the observed
+             satellites are copied. \n
+             (2) The source is only read, so several objects may load from
+             the same source concurrently. \n
+             (3) This must be called for every epoch loaded by the source
+             so that the previous observation set matches the source's.
+    \return  true if successful, false if error.
+    */
+    bool LoadNextFromReceiverData( const GNSS_RxData& source );
+
+
     /// \brief   Load the next epoch of data of GNSS_RXDATA_NOVATELOEM4 data.
     /// \return  true if successful, false if error.
     /// \param   endOfStream - indicates if the end of the input source 
@@ -538,10 +720,61 @@ namespace GNSS
              Load m_EphAlmArray appropriately based on the current receiver time.
     \author  Glenn D. MacGougan
     \date    2007-12-07
+    \remarks The ephemeris store is searched by time so epochs need not be
+             processed in increasing time order.
     \return  true if successful, false if error.
     */
     bool UpdateTheEphemerisArrayWithUsingRINEX();
 
+    /**
+    \brief   Use a RINEX ephemeris store that was loaded elsewhere (e.g. by 
+             another GNSS_RxData object) instead of loading a RINEX GPS 
+             Navigation file. The store is not owned and must outlive this object.
+    \author  agent (agent@local)
+    \date    2026-10-18
+    \return  true if successful, false if error.
+    */
+    bool SetRINEXEphemerisStore( const GPS_EphemerisStore* store );
+
+    /// \brief   The RINEX ephemeris store in use, NULL if none.
+    const GPS_EphemerisStore* GetRINEXEphemerisStore() const { return m_RINEX_eph_store; }
+
+    /// \brief   Rebuild the (system, id, frequency) to channel lookup tables
+    ///          for m_ObsArray and m_prev_ObsArray. This is done by each LoadNext 
+    ///          call and must be done again if either array is modified directly.
+    void BuildChannelLookup();
+
+    /// \brief   Find the first channel in m_ObsArray with this system, id and frequency.
+    /// \return  The channel index, -1 if there is no such channel.
+    int GetChannelIndex( 
+      const GNSS_enumSystem system,      //!< The satellite system.
+      const unsigned short id,           //!< The satellite id (eg PRN for GPS).
+      const GNSS_enumFrequency freqType  //!< The frequency type.
+      ) const;
+
+    /// \brief   Find the next channel in m_ObsArray with the same system, id and 
+    ///          frequency as the channel given (e.g. a duplicate PRN channel or 
+    ///          another code type), in the order of the array.
+    /// \return  The channel index, -1 if there is no such channel.
+    int GetNextChannelIndex( 
+      const int index  //!< A channel index from GetChannelIndex or GetNextChannelIndex.
+      ) const;
+
+    /// \brief   Find the first channel in m_prev_ObsArray with this system, id and frequency.
+    /// \return  The channel index, -1 if there is no such channel.
+    int GetPreviousChannelIndex( 
+      const GNSS_enumSystem system,      //!< The satellite system.
+      const unsigned short id,           //!< The satellite id (eg PRN for GPS).
+      const GNSS_enumFrequency freqType  //!< The frequency type.
+      ) const;
+
+    /// \brief   Find the next channel in m_prev_ObsArray with the same system, id 
+    ///          and frequency as the channel given, in the order of the array.
+    /// \return  The channel index, -1 if there is no such channel.
+    int GetNextPreviousChannelIndex( 
+      const int index  //!< A channel index from GetPreviousChannelIndex or GetNextPreviousChannelIndex.
+      ) const;
+
     /// \brief  Check for cycle slips using the phase rate prediction method.
     ///
     /// \post   m_ObsArray[i].flags.isNoCycleSlipDetected is set for each observation.
@@ -552,6 +785,21 @@ namespace GNSS
       );
 
 
+    /// \brief  Check for cycle slips on GPS satellites with L1 and L2 phase
+    /// using the change in the geometry free phase combination between
+    /// the previous and current epochs. Both the L1 and L2 channels are 
+    /// flagged when a slip is detected. The threshold is increased by 
+    /// thresholdRate times the time between the epochs for the change 
+    /// of the ionosphere, and the check is not done over longer gaps than maxGap.
+    ///
+    /// \return true if successful, false if error.
+    bool CheckForCycleSlips_UsingGeometryFreePhase( 
+      const double thresholdInMeters, //!< The geometry free phase change threshold used to detect a slip between consecutive epochs [m].
+      const double thresholdRate,     //!< The increase of the threshold with the time between epochs [m/s].
+      const double maxGap             //!< The maximum time between epochs for the check [s].
+      );
+
+
     /// \brief  A debugging function for printing all of the observation array
     /// to a file.
     ///
@@ -599,6 +847,12 @@ namespace GNSS
     // GDM_TODO rename and recomment later.
     double m_norm;
 
+    /// The number of double difference ambiguities fixed (all of them unless partial ambiguity resolution is used).
+    unsigned m_nrFixedAmbiguities;
+
+    /// The number of integer search nodes visited to fix the ambiguities.
+    unsigned m_nrAmbiguitySearchNodes;
+
     /// The receiver's previous position, velocity, and time information.
     GNSS_structPVT  m_prev_pvt;
 
@@ -629,6 +883,11 @@ namespace GNSS
     /// The default is 4 hours (3600*4).
     unsigned m_maxAgeEphemeris; 
 
+    /// A boolean to indicate if the best RINEX ephemeris valid at the receiver time
+    /// (the closest toe) is used instead of the most recently transmitted one.
+    /// The default is false (the ephemeris a real time receiver would be using).
+    bool m_RINEX_use_best_eph;
+
 
     /// A boolean to indicate if the tropospheric correction is to be disabled for all satellites.
     bool m_DisableTropoCorrection;
@@ -637,6 +896,105 @@ namespace GNSS
     bool m_DisableIonoCorrection;
 
 
+    /// \brief  Cached atmospheric correction terms used by 
+    ///         GNSS_Estimator::DetermineAtmosphericCorrections_GPSL1 when enabled.
+    ///
+    /// The WAAS zenith delays and a table of the UNBabc mapping functions 
+    /// (tabulated by elevation and interpolated with a cubic Catmull-Rom spline)
+    /// are reused while the receiver moves less than maxDisplacement. The 
+    /// Klobuchar delay for each satellite pass is recomputed directly every 
+    /// ionoRefreshInterval seconds and linearly predicted in between.
+    /// If checkAccuracy is set, the direct computations are also performed 
+    /// and the largest differences are retained.
+    struct struct_AtmosphericCorrectionCache
+    {
+      enum { 
+        NR_PRNS = 38,          //!< The iono pass cache is indexed by PRN (1-37).
+        TABLE_LENGTH = 904     //!< The mapping table covers [-0.1, 90.2] deg at GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG.
+      };
+
+      bool isEnabled;             //!< A boolean to indicate if the cache is used.
+      bool checkAccuracy;         //!< A boolean to indicate if the cached values are compared with the direct computation.
+      double maxDisplacement;     //!< The change in position (latitude and height) allowed before the zenith delays and mapping table are recomputed [m].
+      double ionoRefreshInterval; //!< The time between direct Klobuchar computations for a satellite [s].
+      
+      bool   isZenithValid;       //!< Are the zenith delays and mapping table valid.
+      double latitude;            //!< The latitude at which the zenith delays and table were computed [rad].
+      double height;              //!< The height at which the zenith delays and table were computed [m].
+      unsigned short day_of_year; //!< The day of year at which the zenith delays were computed [days].
+      double zenith_dry_delay;    //!< The dry zenith delay [m].
+      double zenith_wet_delay;    //!< The wet zenith delay [m].
+      
+      double drymap[TABLE_LENGTH]; //!< The dry mapping function, drymap[k] is at elevation (k-1)*GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG.
+      double wetmap[TABLE_LENGTH]; //!< The wet mapping function, wetmap[k] is at elevation (k-1)*GNSS_RXDATA_ATMCACHE_TABLE_STEP_DEG.
+      double maxTableError;        //!< The largest mapping table interpolation error found at the table midpoints, scaled by the zenith delays [m].
+
+      double klobuchar[8];               //!< The Klobuchar parameters that the iono pass values were computed with.
+      bool   isIonoValid[NR_PRNS];       //!< Is the iono pass information valid for this PRN.
+      bool   isIonoRateValid[NR_PRNS];   //!< Is the iono rate valid for this PRN (two direct computations in this pass).
+      double ionoTime[NR_PRNS];          //!< The time of the last direct Klobuchar computation [s] (continuous GPS time).
+      double iono[NR_PRNS];              //!< The Klobuchar delay at ionoTime [m].
+      double ionoRate[NR_PRNS];          //!< The rate of change of the Klobuchar delay [m/s].
+
+      unsigned nrZenithComputations;     //!< The number of times the zenith delays and table were computed.
+      unsigned nrIonoComputations;       //!< The number of direct Klobuchar computations.
+      unsigned nrIonoPredictions;        //!< The number of Klobuchar predictions.
+      double maxTropoError;              //!< The largest |cached - direct| tropospheric delay when checkAccuracy is set [m].
+      double maxIonoError;               //!< The largest |cached - direct| ionospheric delay when checkAccuracy is set [m].
+
+      /// A simple constructor.
+      struct_AtmosphericCorrectionCache() 
+        : isEnabled(false), checkAccuracy(false), maxDisplacement(5.0), ionoRefreshInterval(10.0),
+        isZenithValid(false), latitude(0), height(0), day_of_year(0), zenith_dry_delay(0), zenith_wet_delay(0),
+        maxTableError(0), nrZenithComputations(0), nrIonoComputations(0), nrIonoPredictions(0), 
+        maxTropoError(0), maxIonoError(0)
+      {
+        unsigned i;
+        for( i = 0; i < 8; i++ )
+          klobuchar[i] = 0;
+        for( i = 0; i < NR_PRNS; i++ )
+        {
+          isIonoValid[i] = false;
+          isIonoRateValid[i] = false;
+          ionoTime[i] = 0;
+          iono[i] = 0;
+          ionoRate[i] = 0;
+        }
+      }
+    };
+
+    /// The atmospheric correction cache. see struct_AtmosphericCorrectionCache for details.
+    struct_AtmosphericCorrectionCache m_AtmCache;
+
+    /// \brief The real time input settings and statistics, see EnableRealTimeInput.
+    struct struct_RealTimeInput
+    {
+      bool isEnabled;          //!< A boolean to indicate if the input file is polled at its end.
+      bool isPipe;             //!< A boolean to indicate if the input is a pipe (read as it is written, not polled).
+      double pollInterval;     //!< The time between checks for new data [s].
+      double timeout;          //!< The end of the stream is reached if no new data arrives within this time, 0 to wait indefinitely [s].
+      bool wasWaiting;         //!< A boolean to indicate if the last LoadNext waited for data (it was not read from a backlog).
+      unsigned nrPolls;        //!< The number of checks for new data.
+      double totalWaitTime;    //!< The total time spent waiting for data [s].
+
+      /// A simple constructor.
+      struct_RealTimeInput()
+        : isEnabled(false), isPipe(false), pollInterval(0.05), timeout(10.0), wasWaiting(false), nrPolls(0), totalWaitTime(0)
+      {}
+    };
+
+    /// The real time input. see struct_RealTimeInput for details.
+    struct_RealTimeInput m_RealTime;
+
+    /// The local geodetic frame at the m_pvt position. It is recomputed by 
+    /// GNSS_Estimator::GetLocalFrame() only when the position changes and is
+    /// shared by the satellite azimuth/elevation and design matrix computations.
+    GEODESY_structLocalFrame m_LocalFrame;
+
+    /// The local geodetic frame at the m_pvt_lsq position. see m_LocalFrame.
+    GEODESY_structLocalFrame m_LocalFrame_lsq;
+
+
     /// This boolean indicates that a positive millisecond jump (the psr increased by 1 ms * c) occurred at this epoch.
     bool m_msJumpDetected_Positive;
 
@@ -782,6 +1140,13 @@ namespace GNSS
 
   protected:
 
+    /// \brief   Wait for more data to be written to the input file.
+    /// \return  true if successful, false if error.
+    bool WaitForRealTimeData( 
+      const long searchPosition, //!< The file position at which the message search restarts.
+      bool &isTimedOut           //!< A boolean to indicate if no new data arrived within the timeout.
+      );
+
     /// A file pointer to the input.
     FILE* m_fid;
 
@@ -794,6 +1159,18 @@ namespace GNSS
     /// The receiver data type.
     GNSS_enumRxDataType m_rxDataType;
 
+    /// The channel index in m_ObsArray of each (system, id, frequency), -1 if not tracked.
+    short m_channelLookup[GNSS_RXDATA_LOOKUP_NR_SYSTEMS][GNSS_RXDATA_LOOKUP_NR_IDS][GNSS_RXDATA_LOOKUP_NR_FREQUENCIES];
+
+    /// The channel index in m_prev_ObsArray of each (system, id, frequency), -1 if not tracked.
+    short m_prev_channelLookup[GNSS_RXDATA_LOOKUP_NR_SYSTEMS][GNSS_RXDATA_LOOKUP_NR_IDS][GNSS_RXDATA_LOOKUP_NR_FREQUENCIES];
+
+    /// The next channel index in m_ObsArray with the same (system, id, frequency), -1 if none.
+    short m_channelNext[GNSS_RXDATA_NR_CHANNELS];
+
+    /// The next channel index in m_prev_ObsArray with the same (system, id, frequency), -1 if none.
+    short m_prev_channelNext[GNSS_RXDATA_NR_CHANNELS];
+
 
   protected: // RINEX related parameters
   
@@ -806,27 +1183,15 @@ namespace GNSS
     /// A boolean to indicate RINEX ephemeris information is used.
     bool m_RINEX_use_eph;
 
-    struct 
-    {
-      /// The file path to the RINEX ephemeris data.
-      std::string filepath;
-
-      /// All of the RINEX ephemeris data is loaded into a single array at start up.
-      GPS_structEphemeris *eph_array;
-
-      /// The length of the m_RINEX_eph_array.
-      unsigned max_array_length;
-
-      /// The length of the m_RINEX_eph_array.
-      unsigned array_length;
+    /// The file path to the RINEX ephemeris data.
+    std::string m_RINEX_eph_filepath;
 
-      /// An associated ionospheric model.
-      GNSS_structKlobuchar iono_model;
-    } m_RINEX_eph;
+    /// The RINEX ephemeris store loaded by this object, NULL if not loaded 
+    /// or if a shared store is used.
+    GPS_EphemerisStore* m_RINEX_eph_store_owned;
 
-    /// An index into m_RINEX_eph.eph_array that is used to keep track of
-    /// operations.
-    unsigned m_RINEX_eph_index;
+    /// The RINEX ephemeris store in use (owned or shared), NULL if not available.
+    const GPS_EphemerisStore* m_RINEX_eph_store;
 
     
   };
@@ -0,0 +1,236 @@
+/**
+\file    GNSS_StaticBatchSolver.cpp
+\brief   A batch least squares position solution for a static receiver 
+         with the receiver clock offsets eliminated epoch by epoch.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#include <math.h>
+#include "gnss_error.h"
+#include "geodesy.h"
+#include "GNSS_StaticBatchSolver.h"
+
+namespace GNSS
+{
+  GNSS_StaticBatchSolver::GNSS_StaticBatchSolver()
+  {
+    Reset();
+  }
+
+  GNSS_StaticBatchSolver::~GNSS_StaticBatchSolver()
+  {}
+
+
+  void GNSS_StaticBatchSolver::Reset()
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    for( i = 0; i < 3; i++ )
+    {
+      for( j = 0; j < 3; j++ )
+        m_N[i][j] = 0.0;
+      m_u[i] = 0.0;
+    }
+    m_wtWw = 0.0;
+    m_nrEpochs = 0;
+    m_nrObs = 0;
+    m_nrClocks = 0;
+    m_refLatitude = 0.0;
+    m_refLongitude = 0.0;
+    m_refHeight = 0.0;
+    m_refM = 0.0;
+    m_refN = 0.0;
+  }
+
+
+  bool GNSS_StaticBatchSolver::AddEpoch( 
+    const double latitude,
+    const double longitude,
+    const double height,
+    Matrix& H,
+    Matrix& W,
+    Matrix& w,
+    Matrix& dx,
+    const unsigned nrObs
+    )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    unsigned k = 0;
+    double offset[3];   // The linearization point of this epoch relative to the common one [m].
+    double Ncp[3];      // The clock-position block of this epoch's normal matrix.
+    double Ncc = 0;     // The clock-clock block of this epoch's normal matrix.
+    double uc = 0;      // The clock element of this epoch's normal vector.
+    double p = 0;
+    double wi = 0;
+
+    if( nrObs == 0 )
+      return true;
+    if( H.GetNrCols() != 4 || H.GetNrRows() < nrObs || W.GetNrRows() < nrObs 
+      || W.GetNrCols() < nrObs || w.GetNrRows() < nrObs || dx.GetNrRows() != 4 )
+    {
+      GNSS_ERROR_MSG( "Inconsistent matrix dimensions." );
+      return false;
+    }
+
+    if( m_nrEpochs == 0 )
+    {
+      m_refLatitude = latitude;
+      m_refLongitude = longitude;
+      m_refHeight = height;
+      if( !GEODESY_ComputeMeridianRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, latitude, &m_refM ) )
+      {
+        GNSS_ERROR_MSG( "GEODESY_ComputeMeridianRadiusOfCurvature returned FALSE." );
+        return false;
+      }
+      if( !GEODESY_ComputePrimeVerticalRadiusOfCurvature( GEODESY_REFERENCE_ELLIPSE_WGS84, latitude, &m_refN ) )
+      {
+        GNSS_ERROR_MSG( "GEODESY_ComputePrimeVerticalRadiusOfCurvature returned FALSE." );
+        return false;
+      }
+    }
+
+    // The misclosures were computed at the position before the update dx.
+    offset[0] = ( latitude - m_refLatitude ) * ( m_refM + m_refHeight ) - dx[0];
+    offset[1] = ( longitude - m_refLongitude ) * ( m_refN + m_refHeight ) * cos( m_refLatitude ) - dx[1];
+    offset[2] = ( height - m_refHeight ) - dx[2];
+
+    for( k = 0; k < 3; k++ )
+      Ncp[k] = 0.0;
+
+    for( i = 0; i < nrObs; i++ )
+    {
+      p = W[i][i];
+      
+      // The misclosure at the common linearization point.
+      wi = w[i] + H[i][0]*offset[0] + H[i][1]*offset[1] + H[i][2]*offset[2];
+
+      for( j = 0; j < 3; j++ )
+      {
+        for( k = 0; k <= j; k++ )
+          m_N[j][k] += p * H[i][j] * H[i][k];
+        m_u[j] += p * H[i][j] * wi;
+        Ncp[j] += p * H[i][3] * H[i][j];
+      }
+      Ncc += p * H[i][3] * H[i][3];
+      uc += p * H[i][3] * wi;
+      m_wtWw += p * wi * wi;
+    }
+
+    // Eliminate the clock offset of this epoch.
+    if( Ncc > 0.0 )
+    {
+      for( j = 0; j < 3; j++ )
+      {
+        for( k = 0; k <= j; k++ )
+          m_N[j][k] -= Ncp[j] * Ncp[k] / Ncc;
+        m_u[j] -= Ncp[j] * uc / Ncc;
+      }
+      m_wtWw -= uc * uc / Ncc;
+      m_nrClocks++;
+    }
+    for( j = 0; j < 3; j++ )
+    {
+      for( k = 0; k < j; k++ )
+        m_N[k][j] = m_N[j][k];
+    }
+
+    m_nrObs += nrObs;
+    m_nrEpochs++;
+    return true;
+  }
+
+
+  bool GNSS_StaticBatchSolver::Solve( 
+    double& latitude,
+    double& longitude,
+    double& height,
+    Matrix& P,
+    double& apvf
+    )
+  {
+    unsigned i = 0;
+    unsigned j = 0;
+    double dx[3];
+    double vtWv = 0;
+
+    if( m_nrEpochs == 0 )
+    {
+      GNSS_ERROR_MSG( "if( m_nrEpochs == 0 )" );
+      return false;
+    }
+    if( m_nrObs < m_nrClocks + 3 )
+    {
+      GNSS_ERROR_MSG( "Not enough observations for a unique solution." );
+      return false;
+    }
+
+    if( !P.Resize( 3, 3 ) )
+    {
+      GNSS_ERROR_MSG( "if( !P.Resize( 3, 3 ) )" );
+      return false;
+    }
+    for( i = 0; i < 3; i++ )
+    {
+      for( j = 0; j < 3; j++ )
+        P[i][j] = m_N[i][j];
+    }
+    if( !P.Inplace_Invert() )
+    {
+      GNSS_ERROR_MSG( "if( !P.Inplace_Invert() )" );
+      return false;
+    }
+
+    vtWv = m_wtWw;
+    for( i = 0; i < 3; i++ )
+    {
+      dx[i] = 0;
+      for( j = 0; j < 3; j++ )
+        dx[i] += P[i][j] * m_u[j];
+      vtWv -= dx[i] * m_u[i];
+    }
+
+    // The corrections for lat and lon must be converted to [rad] from [m].
+    height = m_refHeight + dx[2];
+    latitude = m_refLatitude + dx[0] / ( m_refM + m_refHeight );
+    longitude = m_refLongitude + dx[1] / ( ( m_refN + m_refHeight ) * cos( m_refLatitude ) );
+
+    if( m_nrObs > m_nrClocks + 3 )
+      apvf = vtWv / (double)( m_nrObs - m_nrClocks - 3 );
+    else
+      apvf = 0.0;
+    return true;
+  }
+
+} // end namespace GNSS
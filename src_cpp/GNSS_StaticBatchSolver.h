@@ -0,0 +1,135 @@
+/**
+\file    GNSS_StaticBatchSolver.h
+\brief   A batch least squares position solution for a static receiver 
+         with the receiver clock offsets eliminated epoch by epoch.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_STATICBATCHSOLVER_H_
+#define _GNSS_STATICBATCHSOLVER_H_
+
+#include "Matrix.h"
+
+using namespace Zenautics; // for Matrix
+
+namespace GNSS
+{
+  /**
+  \brief   A batch least squares solution for the position of a static 
+           receiver from all of the epochs of a session.
+
+  The unknowns are the position, common to all epochs, and a receiver 
+  clock offset for each epoch. Each epoch's clock offset is eliminated 
+  from the normal equations as the epoch is added (a Schur complement 
+  of a 1 x 1 block), so only the reduced 3 x 3 normal equations of the 
+  position are kept and the memory used does not depend on the length 
+  of the session. The position is solved once after the last epoch.
+
+  The epochs are given as the converged least squares design matrix and 
+  misclosures of each epoch. The misclosures are moved to a common 
+  linearization point, the first epoch's position, with the design 
+  matrix. The position offsets are small for a static receiver so this 
+  is equivalent to relinearizing.
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_StaticBatchSolver
+  {
+  public:
+
+    /// \brief    The default constructor (no data).
+    GNSS_StaticBatchSolver();
+
+    /// \brief    The destructor.
+    virtual ~GNSS_StaticBatchSolver();
+
+  public:
+
+    /// \brief    Discard all of the epochs.
+    void Reset();
+
+    /// \brief    Add one epoch of pseudorange observations.
+    ///
+    /// \pre      The first nrObs rows of H, W and w are the observations. 
+    ///           H has the columns northing [m], easting [m], height [m] 
+    ///           and clock offset [m]. W is diagonal. The misclosures are 
+    ///           the observed minus computed values at the position from 
+    ///           which dx was computed.
+    /// \return   true if successful, false if error.
+    bool AddEpoch( 
+      const double latitude,  //!< The position after the update dx [rad].
+      const double longitude, //!< The position after the update dx [rad].
+      const double height,    //!< The position after the update dx [m].
+      Matrix& H,              //!< The design matrix [n x 4].
+      Matrix& W,              //!< The weight matrix [n x n].
+      Matrix& w,              //!< The misclosure vector [n x 1].
+      Matrix& dx,             //!< The last update to the states [4 x 1].
+      const unsigned nrObs    //!< The number of observation rows in H, W and w (any constraint rows follow).
+      );
+
+    /// \brief    Solve for the position from all of the epochs added.
+    /// \return   true if successful, false if error.
+    bool Solve( 
+      double& latitude,   //!< The position [rad].
+      double& longitude,  //!< The position [rad].
+      double& height,     //!< The position [m].
+      Matrix& P,          //!< The position variance-covariance matrix (northing, easting, height) [m^2], [3 x 3].
+      double& apvf        //!< The a-posteriori variance factor, 0 if there is no redundancy.
+      );
+
+    /// \brief    The number of epochs added.
+    unsigned GetNrEpochs() const { return m_nrEpochs; }
+
+    /// \brief    The number of observations added.
+    unsigned GetNrObservations() const { return m_nrObs; }
+
+  protected:
+
+    double m_N[3][3];           //!< The reduced normal matrix of the position.
+    double m_u[3];              //!< The reduced normal vector of the position.
+    double m_wtWw;              //!< The reduced weighted sum of squared misclosures.
+    unsigned m_nrEpochs;        //!< The number of epochs added.
+    unsigned m_nrObs;           //!< The number of observations added.
+    unsigned m_nrClocks;        //!< The number of clock offsets eliminated.
+    double m_refLatitude;       //!< The linearization point, the first epoch's position [rad].
+    double m_refLongitude;      //!< The linearization point, the first epoch's position [rad].
+    double m_refHeight;         //!< The linearization point, the first epoch's position [m].
+    double m_refM;              //!< The meridian radius of curvature at the linearization point [m].
+    double m_refN;              //!< The prime vertical radius of curvature at the linearization point [m].
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_STATICBATCHSOLVER_H_
@@ -0,0 +1,467 @@
+/**
+\file    GNSS_ThreadPool.cpp
+\brief   A small portable thread pool with work stealing.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifdef WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sched.h>
+#endif
+#include "gnss_error.h"
+#include "GNSS_ThreadPool.h"
+
+namespace GNSS
+{
+  /// \brief   The synchronization objects shared by the workers of a pool.
+  struct stThreadPoolSync
+  {
+#ifdef WIN32
+    CRITICAL_SECTION lock; //!< Guards the pool counters.
+    HANDLE workAvailable;  //!< A semaphore counting the queued tasks.
+    HANDLE allDone;        //!< A manual reset event set when no tasks are pending.
+#else
+    pthread_mutex_t lock;          //!< Guards the pool counters.
+    pthread_cond_t  workAvailable; //!< Signalled when a task is queued or the pool is stopping.
+    pthread_cond_t  allDone;       //!< Signalled when no tasks are pending.
+#endif
+  };
+
+  static void* ThreadPool_CreateLock()
+  {
+#ifdef WIN32
+    CRITICAL_SECTION* lock = new CRITICAL_SECTION;
+    InitializeCriticalSection( lock );
+#else
+    pthread_mutex_t* lock = new pthread_mutex_t;
+    pthread_mutex_init( lock, NULL );
+#endif
+    return lock;
+  }
+
+  static void ThreadPool_DestroyLock( void* lock )
+  {
+#ifdef WIN32
+    DeleteCriticalSection( (CRITICAL_SECTION*)lock );
+    delete (CRITICAL_SECTION*)lock;
+#else
+    pthread_mutex_destroy( (pthread_mutex_t*)lock );
+    delete (pthread_mutex_t*)lock;
+#endif
+  }
+
+  static void ThreadPool_Lock( void* lock )
+  {
+#ifdef WIN32
+    EnterCriticalSection( (CRITICAL_SECTION*)lock );
+#else
+    pthread_mutex_lock( (pthread_mutex_t*)lock );
+#endif
+  }
+
+  static void ThreadPool_Unlock( void* lock )
+  {
+#ifdef WIN32
+    LeaveCriticalSection( (CRITICAL_SECTION*)lock );
+#else
+    pthread_mutex_unlock( (pthread_mutex_t*)lock );
+#endif
+  }
+
+
+  GNSS_ThreadPool::GNSS_ThreadPool()
+    : m_Sync(NULL),
+    m_nextWorker(0),
+    m_nrPending(0),
+    m_nrQueued(0),
+    m_nrTasksStolen(0),
+    m_isStopping(false)
+  {
+  }
+
+
+  GNSS_ThreadPool::~GNSS_ThreadPool()
+  {
+    Stop();
+  }
+
+
+  unsigned GNSS_ThreadPool::GetNrProcessors()
+  {
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    if( info.dwNumberOfProcessors < 1 )
+      return 1;
+    return static_cast<unsigned>(info.dwNumberOfProcessors);
+#else
+    long n = sysconf( _SC_NPROCESSORS_ONLN );
+    if( n < 1 )
+      return 1;
+    return static_cast<unsigned>(n);
+#endif
+  }
+
+
+  bool GNSS_ThreadPool::Start( const unsigned nrThreads )
+  {
+    unsigned i = 0;
+    unsigned n = nrThreads;
+    stWorker* worker = NULL;
+    stThreadPoolSync* sync = NULL;
+
+    if( m_Sync != NULL )
+    {
+      GNSS_ERROR_MSG( "if( m_Sync != NULL )" );
+      return false;
+    }
+    if( n == 0 )
+      n = GetNrProcessors();
+
+    sync = new stThreadPoolSync;
+    if( sync == NULL )
+    {
+      GNSS_ERROR_MSG( "new failed" );
+      return false;
+    }
+#ifdef WIN32
+    InitializeCriticalSection( &sync->lock );
+    sync->workAvailable = CreateSemaphore( NULL, 0, 0x7FFFFFFF, NULL );
+    sync->allDone = CreateEvent( NULL, TRUE, TRUE, NULL );
+    if( sync->workAvailable == NULL || sync->allDone == NULL )
+    {
+      GNSS_ERROR_MSG( "if( sync->workAvailable == NULL || sync->allDone == NULL )" );
+      if( sync->workAvailable != NULL )
+        CloseHandle( sync->workAvailable );
+      if( sync->allDone != NULL )
+        CloseHandle( sync->allDone );
+      DeleteCriticalSection( &sync->lock );
+      delete sync;
+      return false;
+    }
+#else
+    pthread_mutex_init( &sync->lock, NULL );
+    pthread_cond_init( &sync->workAvailable, NULL );
+    pthread_cond_init( &sync->allDone, NULL );
+#endif
+    m_Sync = sync;
+    m_nextWorker = 0;
+    m_nrPending = 0;
+    m_nrQueued = 0;
+    m_nrTasksStolen = 0;
+    m_isStopping = false;
+
+    // All of the workers must exist before any thread can try to steal.
+    // On failure, Stop() joins the threads already started and frees 
+    // the workers and the synchronization objects.
+    for( i = 0; i < n; i++ )
+    {
+      worker = new stWorker;
+      if( worker == NULL )
+      {
+        GNSS_ERROR_MSG( "new failed" );
+        Stop();
+        return false;
+      }
+      worker->pool = this;
+      worker->index = i;
+      worker->lock = ThreadPool_CreateLock();
+      worker->thread = NULL;
+      m_Workers.push_back( worker );
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+      worker = m_Workers[i];
+#ifdef WIN32
+      worker->thread = (void*)_beginthreadex( NULL, 0, ThreadEntry, worker, 0, NULL );
+      if( worker->thread == NULL )
+      {
+        GNSS_ERROR_MSG( "_beginthreadex failed." );
+        Stop();
+        return false;
+      }
+#else
+      pthread_t* thread = new pthread_t;
+      if( pthread_create( thread, NULL, ThreadEntry, worker ) != 0 )
+      {
+        delete thread;
+        GNSS_ERROR_MSG( "pthread_create failed." );
+        Stop();
+        return false;
+      }
+      worker->thread = thread;
+#endif
+    }
+    return true;
+  }
+
+
+  bool GNSS_ThreadPool::Stop()
+  {
+    unsigned i = 0;
+    stThreadPoolSync* sync = (stThreadPoolSync*)m_Sync;
+
+    if( sync == NULL )
+      return true; // not started
+
+    WaitForAll();
+
+    ThreadPool_Lock( &sync->lock );
+    m_isStopping = true;
+#ifdef WIN32
+    ReleaseSemaphore( sync->workAvailable, static_cast<LONG>(m_Workers.size()), NULL );
+#else
+    pthread_cond_broadcast( &sync->workAvailable );
+#endif
+    ThreadPool_Unlock( &sync->lock );
+
+    for( i = 0; i < m_Workers.size(); i++ )
+    {
+      if( m_Workers[i]->thread != NULL )
+      {
+#ifdef WIN32
+        WaitForSingleObject( (HANDLE)m_Workers[i]->thread, INFINITE );
+        CloseHandle( (HANDLE)m_Workers[i]->thread );
+#else
+        pthread_join( *((pthread_t*)m_Workers[i]->thread), NULL );
+        delete (pthread_t*)m_Workers[i]->thread;
+#endif
+      }
+      ThreadPool_DestroyLock( m_Workers[i]->lock );
+      delete m_Workers[i];
+    }
+    m_Workers.clear();
+
+#ifdef WIN32
+    CloseHandle( sync->workAvailable );
+    CloseHandle( sync->allDone );
+    DeleteCriticalSection( &sync->lock );
+#else
+    pthread_cond_destroy( &sync->workAvailable );
+    pthread_cond_destroy( &sync->allDone );
+    pthread_mutex_destroy( &sync->lock );
+#endif
+    delete sync;
+    m_Sync = NULL;
+    return true;
+  }
+
+
+  bool GNSS_ThreadPool::Submit( GNSS_ThreadPoolTaskFunction function, void* arg )
+  {
+    stTask task;
+    stWorker* worker = NULL;
+    stThreadPoolSync* sync = (stThreadPoolSync*)m_Sync;
+
+    if( sync == NULL || m_Workers.empty() )
+    {
+      GNSS_ERROR_MSG( "if( sync == NULL || m_Workers.empty() )" );
+      return false;
+    }
+    if( function == NULL )
+    {
+      GNSS_ERROR_MSG( "if( function == NULL )" );
+      return false;
+    }
+    task.function = function;
+    task.arg = arg;
+
+    // Deal the task to the next worker's queue.
+    worker = m_Workers[m_nextWorker];
+    m_nextWorker++;
+    if( m_nextWorker >= m_Workers.size() )
+      m_nextWorker = 0;
+
+    ThreadPool_Lock( worker->lock );
+    worker->queue.push_back( task );
+    ThreadPool_Unlock( worker->lock );
+
+    // The task is only taken by a worker once it is counted as queued.
+    ThreadPool_Lock( &sync->lock );
+    m_nrPending++;
+    m_nrQueued++;
+#ifdef WIN32
+    ResetEvent( sync->allDone );
+    ReleaseSemaphore( sync->workAvailable, 1, NULL );
+#else
+    pthread_cond_signal( &sync->workAvailable );
+#endif
+    ThreadPool_Unlock( &sync->lock );
+    return true;
+  }
+
+
+  bool GNSS_ThreadPool::WaitForAll()
+  {
+    stThreadPoolSync* sync = (stThreadPoolSync*)m_Sync;
+    if( sync == NULL )
+    {
+      GNSS_ERROR_MSG( "if( sync == NULL )" );
+      return false;
+    }
+#ifdef WIN32
+    if( WaitForSingleObject( sync->allDone, INFINITE ) != WAIT_OBJECT_0 )
+    {
+      GNSS_ERROR_MSG( "WaitForSingleObject failed." );
+      return false;
+    }
+#else
+    pthread_mutex_lock( &sync->lock );
+    while( m_nrPending != 0 )
+      pthread_cond_wait( &sync->allDone, &sync->lock );
+    pthread_mutex_unlock( &sync->lock );
+#endif
+    return true;
+  }
+
+
+  bool GNSS_ThreadPool::GetTask( stWorker* worker, stTask& task )
+  {
+    unsigned k = 0;
+    unsigned n = static_cast<unsigned>(m_Workers.size());
+    stWorker* victim = NULL;
+
+    // The most recently queued task in the worker's own queue.
+    ThreadPool_Lock( worker->lock );
+    if( !worker->queue.empty() )
+    {
+      task = worker->queue.back();
+      worker->queue.pop_back();
+      ThreadPool_Unlock( worker->lock );
+      return true;
+    }
+    ThreadPool_Unlock( worker->lock );
+
+    // Steal the oldest task from another worker.
+    for( k = 1; k < n; k++ )
+    {
+      victim = m_Workers[(worker->index + k) % n];
+      ThreadPool_Lock( victim->lock );
+      if( !victim->queue.empty() )
+      {
+        task = victim->queue.front();
+        victim->queue.pop_front();
+        ThreadPool_Unlock( victim->lock );
+
+        ThreadPool_Lock( &((stThreadPoolSync*)m_Sync)->lock );
+        m_nrTasksStolen++;
+        ThreadPool_Unlock( &((stThreadPoolSync*)m_Sync)->lock );
+        return true;
+      }
+      ThreadPool_Unlock( victim->lock );
+    }
+    return false;
+  }
+
+
+  void GNSS_ThreadPool::RunWorker( stWorker* worker )
+  {
+    stTask task;
+    stThreadPoolSync* sync = (stThreadPoolSync*)m_Sync;
+#ifdef WIN32
+    bool isStopping = false;
+#endif
+
+    while( true )
+    {
+      // Reserve one of the queued tasks.
+#ifdef WIN32
+      WaitForSingleObject( sync->workAvailable, INFINITE );
+      ThreadPool_Lock( &sync->lock );
+      if( m_nrQueued == 0 )
+      {
+        isStopping = m_isStopping;
+        ThreadPool_Unlock( &sync->lock );
+        if( isStopping )
+          return;
+        continue;
+      }
+#else
+      pthread_mutex_lock( &sync->lock );
+      while( m_nrQueued == 0 && !m_isStopping )
+        pthread_cond_wait( &sync->workAvailable, &sync->lock );
+      if( m_nrQueued == 0 )
+      {
+        pthread_mutex_unlock( &sync->lock );
+        return; // stopping
+      }
+#endif
+      m_nrQueued--;
+      ThreadPool_Unlock( &sync->lock );
+
+      // A reserved task is in one of the queues but another worker may take 
+      // it first, in which case that worker's reserved task is still queued.
+      while( !GetTask( worker, task ) )
+      {
+#ifdef WIN32
+        Sleep( 0 );
+#else
+        sched_yield();
+#endif
+      }
+
+      task.function( task.arg );
+
+      ThreadPool_Lock( &sync->lock );
+      m_nrPending--;
+      if( m_nrPending == 0 )
+      {
+#ifdef WIN32
+        SetEvent( sync->allDone );
+#else
+        pthread_cond_broadcast( &sync->allDone );
+#endif
+      }
+      ThreadPool_Unlock( &sync->lock );
+    }
+  }
+
+
+#ifdef WIN32
+  unsigned __stdcall GNSS_ThreadPool::ThreadEntry( void* arg )
+#else
+  void* GNSS_ThreadPool::ThreadEntry( void* arg )
+#endif
+  {
+    stWorker* worker = (stWorker*)arg;
+    worker->pool->RunWorker( worker );
+    return 0;
+  }
+
+} // end namespace GNSS
@@ -0,0 +1,178 @@
+/**
+\file    GNSS_ThreadPool.h
+\brief   A small portable thread pool with work stealing.
+
+\author  agent (agent@local)
+\date    2026-10-18
+\since   2026-10-18
+
+\b "LICENSE INFORMATION" \n
+Copyright (c) 2026, refer to 'author' doxygen tags \n
+All rights reserved. \n
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided the following conditions are met: \n
+
+- Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer. \n
+- Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution. \n
+- The name(s) of the contributor(s) may not be used to endorse or promote 
+  products derived from this software without specific prior written 
+  permission. \n
+
+THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS 
+OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED 
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR 
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT 
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY 
+OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF 
+SUCH DAMAGE.
+*/
+
+#ifndef _GNSS_THREADPOOL_H_
+#define _GNSS_THREADPOOL_H_
+
+#include <deque>
+#include <vector>
+
+namespace GNSS
+{
+  /// \brief   The function type of a task run by GNSS_ThreadPool.
+  typedef void (*GNSS_ThreadPoolTaskFunction)( void* arg );
+
+  /**
+  \brief   A fixed size pool of worker threads with work stealing.
+
+  Each worker owns a double ended task queue. Submitted tasks are dealt to 
+  the worker queues in turn. A worker runs tasks from the back of its own 
+  queue and, when its queue is empty, steals from the front of the other 
+  workers' queues so that uneven task costs do not leave threads idle.
+  WaitForAll() blocks until every submitted task has completed, which 
+  makes a batch of tasks usable as a barrier.
+  
+  \code
+  GNSS_ThreadPool pool;
+  pool.Start( 0 ); // one thread per processor
+  for( i = 0; i < n; i++ )
+    pool.Submit( ProcessOne, &items[i] );
+  pool.WaitForAll();
+  pool.Stop();
+  \endcode
+
+  \author  agent (agent@local)
+  \date    2026-10-18
+  */
+  class GNSS_ThreadPool
+  {
+  public:
+
+    /// \brief    The default constructor (no threads started yet).
+    GNSS_ThreadPool();
+
+    /// \brief    The destructor. The threads are stopped.
+    virtual ~GNSS_ThreadPool();
+
+  private:
+
+    /// \brief   The copy constructor. Disabled!
+    GNSS_ThreadPool( const GNSS_ThreadPool& rhs );
+
+    /// \brief   The assignment operator. Disabled!
+    void operator=(const GNSS_ThreadPool& rhs);
+
+  public:
+
+    /// \brief    Start the worker threads.
+    /// \return   true if successful, false if error.
+    bool Start( 
+      const unsigned nrThreads //!< The number of worker threads, 0 indicates one per processor.
+      );
+
+    /// \brief    Stop the worker threads once the queued tasks have completed.
+    /// \return   true if successful, false if error.
+    bool Stop();
+
+    /// \brief    Queue a task.
+    /// \return   true if successful, false if error.
+    bool Submit( 
+      GNSS_ThreadPoolTaskFunction function, //!< The task function.
+      void* arg                             //!< The argument passed to the task function.
+      );
+
+    /// \brief    Wait until all of the submitted tasks have completed.
+    /// \return   true if successful, false if error.
+    bool WaitForAll();
+
+    /// \brief    The number of worker threads running.
+    unsigned GetNrThreads() const { return static_cast<unsigned>(m_Workers.size()); }
+
+    /// \brief    The number of tasks run by a worker other than the one they were queued to.
+    unsigned GetNrTasksStolen() const { return m_nrTasksStolen; }
+
+    /// \brief    The number of processors available, 1 if unknown.
+    static unsigned GetNrProcessors();
+
+  protected:
+
+    struct stTask
+    {
+      GNSS_ThreadPoolTaskFunction function; //!< The task function.
+      void* arg;                            //!< The argument passed to the task function.
+    };
+
+    /// \brief   The information for one worker thread.
+    struct stWorker
+    {
+      GNSS_ThreadPool* pool;    //!< The pool that owns the worker.
+      unsigned index;           //!< The index of the worker in m_Workers.
+      std::deque<stTask> queue; //!< The worker's task queue.
+      void* lock;               //!< The platform lock that guards the queue.
+      void* thread;             //!< The platform thread.
+    };
+
+    /// \brief   The thread entry point, runs tasks until the pool is stopped.
+    void RunWorker( stWorker* worker );
+
+    /// \brief   Take a task from the worker's own queue or steal one from another worker.
+    /// \return  true if a task was found.
+    bool GetTask( stWorker* worker, stTask& task );
+
+#ifdef WIN32
+    static unsigned __stdcall ThreadEntry( void* arg );
+#else
+    static void* ThreadEntry( void* arg );
+#endif
+
+  protected:
+
+    /// The worker threads.
+    std::vector<stWorker*> m_Workers;
+
+    /// The platform synchronization objects shared by the workers (see GNSS_ThreadPool.cpp).
+    void* m_Sync;
+
+    /// The worker that receives the next submitted task.
+    unsigned m_nextWorker;
+
+    /// The number of tasks submitted that have not completed.
+    unsigned m_nrPending;
+
+    /// The number of tasks that are queued and not yet taken by a worker.
+    unsigned m_nrQueued;
+
+    /// The number of tasks run by a worker other than the one they were queued to.
+    unsigned m_nrTasksStolen;
+
+    /// A boolean to indicate that the workers must exit.
+    bool m_isStopping;
+  };
+
+} // end namespace GNSS
+
+#endif // _GNSS_THREADPOOL_H_
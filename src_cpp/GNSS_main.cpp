@@ -35,13 +35,25 @@ SUCH DAMAGE.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <vector>
+#include <algorithm>
 #include "gnss_error.h"
 #include "constants.h"
 #include "geodesy.h"
 #include "GNSS_RxData.h"
 #include "GNSS_Estimator.h"
 #include "GNSS_OptionFile.h"
+#include "GNSS_ThreadPool.h"
+#include "GNSS_BatchProcessor.h"
+#include "GNSS_RTSSmoother.h"
+#include "GNSS_StaticBatchSolver.h"
+#include "GNSS_PVTWriter.h"
+#include "GNSS_Profiler.h"
+#include "GNSS_EpochAligner.h"
+#include "StdStringUtils.h"
 
 //#define _CRT_SECURE_NO_DEPRECATE
 #ifndef WIN32
@@ -52,6 +64,9 @@ using namespace GNSS;
 
 //#define EXTRACTSVDATA 
 
+// The number of values output for each epoch by OutputPVT.
+#define GNSS_PVT_NR_COLUMNS (50)
+
 
 bool OutputPVT(
   FILE* fid,            //!< The output file. This must already be open.
@@ -63,7 +78,7 @@ bool OutputPVT(
   );
 
 bool OutputPVT(
-  Matrix &PVT,
+  GNSS_PVTWriter &pvtWriter, //!< The PVT output, one epoch is written.
   GNSS_RxData& rxData,  //!< The receiver data.
   const double datumLatitudeRads,  //!< Used to compute a position difference.
   const double datumLongitudeRads, //!< Used to compute a position difference.
@@ -82,6 +97,7 @@ bool OutputObservationData(
 /// \brief    Try to sychronize the base and rover measurement sources.
 /// \return   true if successful, false if error.
 bool GetNextSetOfSynchronousMeasurements( 
+  GNSS_EpochAligner &aligner, //!< The alignment of the base station observations to the rover epochs.
   GNSS_RxData &rxDataBase,  //!< The base station receiver data.
   bool &endOfStreamBase,    //!< A boolean that indicates if the end of the data has been reached for the base station.
   GNSS_RxData &rxData, //!< The rover station receiver data.
@@ -89,70 +105,209 @@ bool GetNextSetOfSynchronousMeasurements(
   bool &isSynchronized      //!< A boolean to indicate if the base and rover are synchronized.
   );
 
+/// \brief    The PVT results updated by OutputSmoothedPVT.
+struct stSmoothedPVTOutput
+{
+  GNSS_PVTWriter* PVT;       //!< The PVT output, opened as updatable.
+  double datumLatitudeRads;  //!< Used to compute a position difference.
+  double datumLongitudeRads; //!< Used to compute a position difference.
+  double datumHeight;        //!< Used to compute a position difference.
+};
+
+/// \brief    A GNSS_RTSSmoother output function that replaces the filtered 
+///           solution in the PVT results with the smoothed solution.
+/// \return   true if successful, false if error.
+bool OutputSmoothedPVT( 
+  const GNSS_RTSSmoother::stSmoothedEpoch& epoch, //!< The smoothed solution, the tag is the PVT epoch index.
+  void* arg                                       //!< A pointer to a stSmoothedPVTOutput.
+  );
+
+/// \brief    Open the PVT output, pvt.csv, pvt.bin, or pvt.mtc, with the column names 
+///           as the header. Each epoch is then written by OutputPVT.
+/// \return   true if successful, false if error.
+bool OpenPVTWriter( 
+  GNSS_PVTWriter &pvtWriter,  //!< The PVT output.
+  const char* name,           //!< The output file name without the extension.
+  const std::string& format,  //!< The output format, "CSV", "BINARY", or "COLUMNAR".
+  bool isCompressed,          //!< Indicates if the COLUMNAR output is compressed.
+  bool isStatic,              //!< Indicates if the rover receiver is in static mode.
+  bool isUpdatable            //!< Indicates if the epochs are updated by the smoother.
+  );
+
+/// \brief    Add the converged least squares position solution of the 
+///           current epoch to the static batch solution.
+/// \return   true if successful, false if error.
+bool AddStaticBatchEpoch( 
+  GNSS_StaticBatchSolver& batch, //!< The static batch solution.
+  GNSS_Estimator& Estimator,     //!< The estimator after PerformLeastSquares.
+  GNSS_RxData& rxData            //!< The rover receiver data.
+  );
+
+/// \brief    Solve the static batch solution and write it to a comma 
+///           delimited file with a header line.
+/// \return   true if successful, false if error.
+bool WriteStaticBatchSolution( 
+  GNSS_StaticBatchSolver& batch,   //!< The static batch solution.
+  const char* path,                //!< The output file path.
+  const double datumLatitudeRads,  //!< Used to compute a position difference.
+  const double datumLongitudeRads, //!< Used to compute a position difference.
+  const double datumHeight         //!< Used to compute a position difference.
+  );
+
+/// \brief    The processing state of one rover. The primary rover is 
+///           processed by main() and additional rovers are processed 
+///           against a reference station shared with other rovers.
+struct stRoverPipeline
+{
+  unsigned index;                 //!< The rover number, 1 is the primary rover.
+  std::string OutputSuffix;       //!< The suffix of the output file names, e.g. "_rover2", empty for the primary rover.
+  GNSS_OptionFile* opt;           //!< The options.
+  GNSS_OptionFile::stStationInformation station; //!< The rover station information.
+  const GNSS_RxData* rxDataBaseSource; //!< The shared reference station data. It is only read. NULL if rxDataBase is loaded directly.
+  GNSS_RxData rxDataBase;         //!< The reference station data, a copy of rxDataBaseSource if it is not NULL.
+  GNSS_RxData rxData;             //!< The rover receiver data.
+  GNSS_Estimator Estimator;       //!< This rover's estimator.
+  GNSS_Profiler* profiler;        //!< The profiler of the processing stages, NULL if not used.
+  bool useEKF;                    //!< Is the EKF used.
+  bool useRTK;                    //!< Is the RTK filter used.
+  bool useTripleDiff;             //!< Is the triple difference solution used.
+  bool isEightStateModel;         //!< Are the velocity and clock drift states included as well as the position and clock offset states in the RTK model.
+  bool useSmoother;               //!< Is the filtered solution smoothed.
+  bool useStaticBatch;            //!< Is the static batch solution computed.
+  bool isFilterInitialized;       //!< Is the filter initialized.
+  bool skipEpochForTripleDiff;    //!< Is the triple difference solution skipped at the next epoch.
+  bool isAtFirstEpoch;            //!< Has no epoch been processed yet.
+  bool isRoverEpochPending;       //!< Is a rover epoch loaded that is ahead of the reference time.
+  bool isFinished;                //!< Is processing complete for this rover.
+  bool isOK;                      //!< Is false if an error occurred.
+  double time_prev;               //!< The time of the previous processed epoch [s].
+  double start_time;              //!< The processing start time [s].
+  double end_time;                //!< The processing end time [s].
+  GNSS_OptionFile::stRoverDatum datum; //!< The datum for position differences.
+  GNSS_PVTWriter PVT;             //!< The PVT output.
+  Matrix SatObs[33];              //!< GPS L1, C/A code, observation information, index by prn, SatObs[0] is empty.
+  GNSS_RTSSmoother smoother;      //!< The smoother, if useSmoother.
+  GNSS_structPVT smootherPredictedPVT; //!< The solution after the time update.
+  Matrix smootherPredictedP;      //!< The state variance-covariance after the time update.
+  GNSS_StaticBatchSolver staticBatch; //!< The static batch solution, if useStaticBatch.
+
+  stRoverPipeline() 
+    : index(0), opt(NULL), rxDataBaseSource(NULL), profiler(NULL), useEKF(false), useRTK(false), 
+    useTripleDiff(false), isEightStateModel(false), useSmoother(false), useStaticBatch(false), 
+    isFilterInitialized(false), skipEpochForTripleDiff(true), isAtFirstEpoch(true), isRoverEpochPending(false), 
+    isFinished(false), isOK(true), time_prev(0), start_time(0), end_time(0)
+  {}
+};
+
+/// \brief    Set the corrections, the masks, and the initial position of 
+///           initialized receiver data from the options.
+/// \return   true if successful, false if error.
+bool ConfigureReceiverData( 
+  GNSS_RxData& rxData,        //!< The initialized receiver data.
+  const GNSS_OptionFile& opt, //!< The options.
+  const GNSS_OptionFile::stStationInformation& station, //!< The station information.
+  const bool isReference      //!< Is this the reference station. Its position is fixed.
+  );
+
+/// \brief    Configure the estimator and initialize the rover data of a 
+///           rover pipeline. If rxDataBase is not NULL, the reference 
+///           station data of the pipeline is set up as a copy of it, 
+///           otherwise the caller initializes and loads the reference 
+///           station data of the pipeline directly.
+/// \return   true if successful, false if error.
+bool InitializeRoverPipeline( 
+  stRoverPipeline& pipeline,  //!< The rover pipeline.
+  GNSS_OptionFile& opt,       //!< The options.
+  const GNSS_OptionFile::stStationInformation& station, //!< The rover station information.
+  const unsigned index,       //!< The rover number, 1 is the primary rover.
+  const GNSS_RxData* rxDataBase //!< The shared reference station data, NULL if not shared.
+  );
+
+/// \brief    Process the rover epoch loaded in a rover pipeline (and the 
+///           matching reference station epoch): the least squares 
+///           solution, the filter, the smoother, and the output.
+/// \return   true if successful, false if error.
+bool ProcessEpoch( 
+  stRoverPipeline& pipeline, //!< The rover pipeline.
+  const double time,         //!< The time of the epoch [s].
+  bool& wasOutput            //!< Is the solution of this epoch output. It is not output until the filter is initialized.
+  );
+
+/// \brief    Process the epoch currently loaded in the shared reference 
+///           station data for one rover pipeline.
+/// \return   true if successful, false if error.
+bool ProcessRoverEpoch( stRoverPipeline& pipeline );
+
+/// \brief    A GNSS_ThreadPool task that calls ProcessRoverEpoch.
+void ProcessRoverEpochTask( void* arg );
+
+/// \brief    Write the observation information of each satellite of a 
+///           rover pipeline, obs_XX.csv or obs_XX.mtc (with the output 
+///           suffix of the rover).
+/// \return   true if successful, false if error.
+bool WriteObservationData( 
+  stRoverPipeline& pipeline //!< The rover pipeline.
+  );
+
+/// \brief    Process several rovers against the reference station. The 
+///           reference station data is decoded once per epoch and shared 
+///           by the rover pipelines which run on a thread pool. The rovers 
+///           process each reference epoch in lockstep, so an epoch takes 
+///           as long as its slowest rover, and the reference station data 
+///           is decoded by one thread between the epochs.
+/// \return   The program exit code, 0 if successful.
+int ProcessMultipleRovers( 
+  GNSS_OptionFile& opt,     //!< The options.
+  GNSS_RxData& rxDataBase   //!< The initialized reference station data.
+  );
+
+/// \brief    Process all the option files listed in a batch manifest, 
+///           each in a separate process, and write batch_summary.csv 
+///           next to the manifest.
+/// \return   The program exit code, 0 if all jobs were successful.
+int RunBatch( int argc, char* argv[] );
+
 
 int main( int argc, char* argv[] )
 {
-  GNSS_RxData rxDataBase;
-  GNSS_RxData rxData;  
-  GNSS_Estimator Estimator;
+  stRoverPipeline rover;
+  GNSS_RxData& rxDataBase = rover.rxDataBase;
+  GNSS_RxData& rxData = rover.rxData;
+  GNSS_Estimator& Estimator = rover.Estimator;
   bool isValidPath;
   bool result;
   bool endOfStreamBase = false;
   bool endOfStreamRover = false;
   bool isSynchronized = false;
-  bool isEightStateModel = false; // A boolean indicating if the velocity and clock drift states are included as well as the position and clock offset states in the RTK model.
+  bool wasOutput = false;
 
   char msg[256];
-  char supermsg[8192];
-  unsigned nrBytesInBuffer = 0;
-
-  supermsg[0] = 0;
-
-
-  unsigned i = 0;
-  unsigned j = 0;
-  //unsigned k = 0;
 
-  double dT = 0.0;
   double time = 0.0;
-  double time_prev = 0.0;
-  
-  double start_time = 0.0;
-  double end_time = 604800.0;
-
-  bool wasPositionComputed = false;
-  bool wasVelocityComputed = false;
-
-  FILE *fid = NULL; 
-  FILE *fid_pvt = NULL;
-  FILE *fid_obs = NULL;
   
   GNSS_OptionFile opt;
 
   std::string OptionFilePath;
 
-  bool useLSQ = true;
-  bool useEKF = false;
-  bool useRTK = false;
-  bool useTripleDiff = false;
-  bool isFilterInitialized = false;
-
-  bool skipEpochForTripleDiff = true;
-  
-  bool isAtFirstEpoch = true;
-
-  char fname[24];
-
-  double lsq_accuracy = 0;
-  double opt_accuracy = 0;          
+  char fname[256];
 
-  Matrix PVT;
-  Matrix SatObs[33]; // GPS L1, C/A code, observation information, index by prn, SatObs[0] is empty
+  stSmoothedPVTOutput smoothedOutput;
+  GNSS_Profiler profiler;              // The latency of each processing stage.
+  GNSS_EpochAligner aligner;           // The alignment of the reference observations to the rover epochs.
+  double epochAvailableTime = 0;       // The time at which the measurements of the epoch were available (GNSS_Profiler::GetTime) [s].
+  double epochLatency = 0;             // The time from the measurements of the epoch being available to its PVT being written [s].
+  std::vector<double> epochLatencies;  // The real time latency of each epoch [s], for the percentiles.
+  unsigned nrDeadlineOverruns = 0;     // The number of real time epochs with a latency over the deadline.
 
   try
   {
-    printf( "\nUSAGE: EGNSS <option file path>\n" );
-    if( argc != 2 )
+    printf( "\nUSAGE: EGNSS <option file path> [output file name prefix]\n" );
+    printf( "       EGNSS -batch <manifest path> [nr of jobs at once] [memory limit per job (MB)]\n" );
+    if( argc >= 2 && strcmp( argv[1], "-batch" ) == 0 )
+    {
+      return RunBatch( argc, argv );
+    }
+    if( argc != 2 && argc != 3 )
     {      
       sprintf( msg, "Invalid arguments: you must specify the option file.", fname );
       GNSS_ERROR_MSG( msg );
@@ -165,12 +320,8 @@ int main( int argc, char* argv[] )
       GNSS_ERROR_MSG( "Invalid option file." );
       return 1;
     }
-
-    rxData.SetDefaultMeasurementStdev_GPSL1(
-      opt.m_Rover.stdev_GPSL1_psr,
-      opt.m_Rover.stdev_GPSL1_doppler,
-      opt.m_Rover.stdev_GPSL1_adr 
-      );
+    if( argc == 3 )
+      opt.m_OutputPrefix = argv[2];
 
     rxDataBase.SetDefaultMeasurementStdev_GPSL1(
       opt.m_Reference.stdev_GPSL1_psr,
@@ -178,74 +329,6 @@ int main( int argc, char* argv[] )
       opt.m_Reference.stdev_GPSL1_adr 
       );
 
-    // Set the start time.
-    start_time = opt.m_StartTime.GPSWeek*SECONDS_IN_WEEK + opt.m_StartTime.GPSTimeOfWeek;
-
-    // Set the end time.
-    end_time = opt.m_EndTime.GPSWeek*SECONDS_IN_WEEK + opt.m_EndTime.GPSTimeOfWeek;
-
-    if( opt.m_ProcessingMethod == "LSQ" )
-    {
-      useLSQ = true; // least squares is used for the first epoch
-      useEKF = false;
-      useRTK = false;
-      Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_LSQ;
-      isFilterInitialized = true;
-    }
-    else if( opt.m_ProcessingMethod == "EKF" )
-    {
-      useLSQ = true; // least squares is used for the first epoch
-      useEKF = true;
-      useRTK = false;
-      Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_EKF;
-    }
-    else if( opt.m_ProcessingMethod == "RTK4" )
-    {
-      useLSQ = true; // least squares is used for the first epoch
-      useEKF = false;
-      useRTK  = true;
-      isEightStateModel = false;
-      Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_RTK4;
-    }
-    else if( opt.m_ProcessingMethod == "RTK8" )
-    {
-      useLSQ = true; // least squares is used for the first epoch
-      useEKF = false;
-      useRTK  = true;
-      isEightStateModel = true;
-      Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_RTK8;
-    }
-    else if( opt.m_ProcessingMethod == "TRIPLEDIFF" )
-    {
-      useLSQ = true; // least squares is used for the first epoch
-      useTripleDiff = true;
-      Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_TRIPLEDIFF;
-    }
-    else 
-    {
-      GNSS_ERROR_MSG( "Unexpected." );
-      return 1;      
-    }
-
-    if( opt.m_ProcessingMethod == "RTK4" )
-    {
-      Estimator.m_FourStateRandomWalkKalmanModel.sigmaNorth = opt.m_KalmanOptions.RTK4_sigmaNorth;
-      Estimator.m_FourStateRandomWalkKalmanModel.sigmaEast = opt.m_KalmanOptions.RTK4_sigmaEast;
-      Estimator.m_FourStateRandomWalkKalmanModel.sigmaUp = opt.m_KalmanOptions.RTK4_sigmaUp;
-      Estimator.m_FourStateRandomWalkKalmanModel.sigmaClock = opt.m_KalmanOptions.RTK4_sigmaClock;
-    }
-    else if( opt.m_ProcessingMethod == "EKF" || opt.m_ProcessingMethod == "RTK8" )
-    {
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVn       = opt.m_KalmanOptions.alphaVn;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVe       = opt.m_KalmanOptions.alphaVe;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVup      = opt.m_KalmanOptions.alphaVup;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaClkDrift = opt.m_KalmanOptions.alphaClkDrift;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVn       = opt.m_KalmanOptions.sigmaVn;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVe       = opt.m_KalmanOptions.sigmaVe;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVup      = opt.m_KalmanOptions.sigmaVup;
-      Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaClkDrift = opt.m_KalmanOptions.sigmaClkDrift;
-    }
-
     if( opt.m_Reference.isValid )
     {
       if( opt.m_RINEXNavDataPath.length() != 0 )
@@ -262,36 +345,7 @@ int main( int argc, char* argv[] )
         return 1;
       }
 
-      if( opt.m_klobuchar.isValid )
-      {
-        rxDataBase.m_klobuchar = opt.m_klobuchar;
-        if( !opt.m_Reference.useIono )
-          rxDataBase.m_DisableIonoCorrection = true;
-      }
-      else
-      {
-        rxDataBase.m_DisableIonoCorrection = true;
-      }
-      rxDataBase.m_elevationMask = opt.m_elevationMask*DEG2RAD;
-      rxDataBase.m_locktimeMask  = opt.m_locktimeMask;
-      rxDataBase.m_cnoMask       = opt.m_cnoMask;
-
-      if( !opt.m_Reference.useTropo )
-      {
-        rxDataBase.m_DisableTropoCorrection = true;
-      }
-
-      result = rxDataBase.SetInitialPVT(
-        opt.m_Reference.latitudeRads,
-        opt.m_Reference.longitudeRads,
-        opt.m_Reference.height,
-        0.0, 0.0, 0.0,
-        0.0, 0.0,
-        0.0, 0.0, 0.0,  // The reference position is fixed.
-        0.0, 0.0, 0.0,
-        100.0,
-        10.0 ); // The reference position is fixed but the clock is still unknown.
-      if( !result )
+      if( !ConfigureReceiverData( rxDataBase, opt, opt.m_Reference, true ) )
       {
         GNSS_ERROR_MSG( "Failed to initialize the reference receiver object." );
         return 1;
@@ -303,69 +357,120 @@ int main( int argc, char* argv[] )
       return 1;
     }
 
-    if( !opt.m_Reference.isValid && opt.m_RINEXNavDataPath.length() != 0 )
+    if( !opt.m_AdditionalRovers.empty() )
     {
-      // Stand-Alone mode
-      result = rxData.Initialize( opt.m_Rover.DataPath.c_str(), isValidPath, opt.m_Rover.DataType, opt.m_RINEXNavDataPath.c_str() );
+      // Several rovers are processed against the shared reference station.
+      if( opt.m_SmootherOptions.isEnabled )
+        printf( "Smoothing is not available when additional rovers are processed.\n" );
+      if( opt.m_StaticBatchOptions.isEnabled )
+        printf( "The static batch solution is not available when additional rovers are processed.\n" );
+      if( opt.m_ProfileOptions.isEnabled )
+        printf( "Profiling is not available when additional rovers are processed.\n" );
+      if( opt.m_RealTimeOptions.isEnabled )
+        printf( "Real time processing is not available when additional rovers are processed.\n" );
+      if( opt.m_AlignmentOptions.Mode != "MATCH" )
+        printf( "Only matching reference epochs are used when additional rovers are processed.\n" );
+      return ProcessMultipleRovers( opt, rxDataBase );
     }
-    else
+
+    if( !InitializeRoverPipeline( rover, opt, opt.m_Rover, 1, NULL ) )
     {
-      result = rxData.Initialize( opt.m_Rover.DataPath.c_str(), isValidPath, opt.m_Rover.DataType, NULL );
+      GNSS_ERROR_MSG( "InitializeRoverPipeline returned false." );
+      return 1;
     }
-    if( !result )
+
+    if( opt.m_StaticBatchOptions.isEnabled )
     {
-      GNSS_ERROR_MSG( "Failed to initialize the rover receiver object." );
-      return 1;
+      if( opt.m_RoverIsStatic )
+        rover.useStaticBatch = true;
+      else
+        printf( "The static batch solution is only available for a static rover (Rover_IsStatic).\n" );
     }
-    if( opt.m_klobuchar.isValid )
+
+    if( opt.m_RealTimeOptions.isEnabled && opt.m_SmootherOptions.isEnabled )
     {
-      rxData.m_klobuchar = opt.m_klobuchar;
-      if( !opt.m_Reference.useIono )
-        rxData.m_DisableIonoCorrection = true;
+      printf( "Smoothing is not available for real time processing.\n" );
+      opt.m_SmootherOptions.isEnabled = false;
     }
-    else
+
+    if( opt.m_SmootherOptions.isEnabled )
     {
-      rxData.m_DisableIonoCorrection = true;
+      if( rover.useEKF || rover.useRTK )
+      {
+        result = rover.smoother.Initialize( 
+          (rover.useEKF || rover.isEightStateModel) ? 8 : 4, 
+          opt.m_SmootherOptions.maxEpochsInMemory, 
+          opt.m_SmootherOptions.SpillFilePath.c_str() );
+        if( !result )
+        {
+          GNSS_ERROR_MSG( "smoother.Initialize returned false." );
+          return 1;
+        }
+        rover.useSmoother = true;
+      }
+      else
+      {
+        printf( "Smoothing is only available for the EKF, RTK4, and RTK8 processing methods.\n" );
+      }
     }
-    rxData.m_elevationMask = opt.m_elevationMask*DEG2RAD;
-    rxData.m_locktimeMask  = opt.m_locktimeMask;
-    rxData.m_cnoMask       = opt.m_cnoMask;
 
-    if( !opt.m_Rover.useTropo )
+    if( opt.m_ProfileOptions.isEnabled || opt.m_RealTimeOptions.isEnabled )
     {
-      rxData.m_DisableTropoCorrection = true;
+      // Real time processing reports the end to end latency with the stage latencies.
+      // The end to end latency percentiles are also reported without the profiler.
+      if( profiler.Enable( opt.m_ProfileOptions.TraceFilePath ) )
+      {
+        Estimator.m_Profiler = &profiler;
+        rover.profiler = &profiler;
+      }
+      else if( opt.m_ProfileOptions.isEnabled )
+      {
+        GNSS_ERROR_MSG( "profiler.Enable returned false." );
+        return 1;
+      }
+      else
+      {
+        printf( "The stage latencies are not reported in real time mode, the profiler is not available.\n" );
+      }
     }
-    
-    result = rxData.SetInitialPVT(
-      opt.m_Rover.latitudeRads,
-      opt.m_Rover.longitudeRads,
-      opt.m_Rover.height,
-      0.0, 0.0, 0.0,
-      0.0, 0.0, 
-      opt.m_Rover.uncertaintyLatitudeOneSigma, 
-      opt.m_Rover.uncertaintyLongitudeOneSigma, 
-      opt.m_Rover.uncertaintyHeightOneSigma, 
-      1.0, 1.0, 1.0,
-      1000.0,
-      1.0e9 );
+
+    if( opt.m_AlignmentOptions.Mode == "INTERPOLATE" )
+      result = aligner.Configure( GNSS_ALIGNMENT_INTERPOLATE, opt.m_AlignmentOptions.maxSpan, opt.m_AlignmentOptions.referenceLatency );
+    else if( opt.m_AlignmentOptions.Mode == "EXTRAPOLATE" )
+      result = aligner.Configure( GNSS_ALIGNMENT_EXTRAPOLATE, opt.m_AlignmentOptions.maxSpan, opt.m_AlignmentOptions.referenceLatency );
+    else
+      result = aligner.Configure( GNSS_ALIGNMENT_MATCH, opt.m_AlignmentOptions.maxSpan, opt.m_AlignmentOptions.referenceLatency );
     if( !result )
     {
-      GNSS_ERROR_MSG( "Failed to initialize the rover receiver object." );
-      return 1; 
+      GNSS_ERROR_MSG( "aligner.Configure returned false." );
+      return 1;
     }
 
-    // GDM_HACK
-    // For comparing the computed rover position
-    if( opt.m_RoverDatum.isValid )
+    if( !OpenPVTWriter( rover.PVT, (opt.m_OutputPrefix + "pvt").c_str(), opt.m_PVTOutputFormat, opt.m_ColumnarCompression, opt.m_RoverIsStatic, rover.useSmoother ) )
     {
-      result = rxData.SetDatumPVT(
-        opt.m_RoverDatum.latitudeRads,
-        opt.m_RoverDatum.longitudeRads,
-        opt.m_RoverDatum.height );
-      if( !result )
+      GNSS_ERROR_MSG( "OpenPVTWriter returned false." );
+      return 1;
+    }
+
+    if( opt.m_RealTimeOptions.isEnabled )
+    {
+      if( opt.m_PVTOutputFormat == "COLUMNAR" )
+        printf( "The columnar PVT output is written when real time processing ends.\n" );
+
+      // Both streams are polled, GetNextSetOfSynchronousMeasurements then
+      // returns each epoch as soon as the rover and reference data are available.
+      if( !rxData.EnableRealTimeInput( opt.m_RealTimeOptions.pollInterval, opt.m_RealTimeOptions.timeout ) )
       {
-        GNSS_ERROR_MSG( "Failed to initialize the rover receiver object's datum point." );
-        return 1; 
+        GNSS_ERROR_MSG( "rxData.EnableRealTimeInput returned false (NovAtel OEM4 rover data is required)." );
+        return 1;
+      }
+      if( opt.m_Reference.isValid )
+      {
+        if( !rxDataBase.EnableRealTimeInput( opt.m_RealTimeOptions.pollInterval, opt.m_RealTimeOptions.timeout ) )
+        {
+          GNSS_ERROR_MSG( "rxDataBase.EnableRealTimeInput returned false (NovAtel OEM4 reference data is required)." );
+          return 1;
+        }
       }
     }
 
@@ -398,14 +503,14 @@ int main( int argc, char* argv[] )
 
     while( !endOfStreamRover )
     {
-      if( !isAtFirstEpoch ) 
-      {
-        time_prev = rxData.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxData.m_pvt.time.gps_tow;
-      }
+      // Epochs skipped below are ended by the next BeginEpoch.
+      profiler.BeginEpoch();
 
       if( opt.m_Reference.isValid )
       {
+        GNSS_PROFILE_SCOPE( &profiler, GNSS_PROFILE_LOAD );
         result = GetNextSetOfSynchronousMeasurements( 
+          aligner,
           rxDataBase,
           endOfStreamBase,
           rxData,
@@ -419,6 +524,7 @@ int main( int argc, char* argv[] )
       }
       else
       {
+        GNSS_PROFILE_SCOPE( &profiler, GNSS_PROFILE_LOAD );
         result = rxData.LoadNext( endOfStreamRover );
         if( !result )
         {
@@ -436,446 +542,58 @@ int main( int argc, char* argv[] )
           break;
       }
 
+      epochAvailableTime = GNSS_Profiler::GetTime();
+      if( opt.m_RealTimeOptions.isEnabled && opt.m_RealTimeOptions.deadline > 0 )
+      {
+        Estimator.m_DeadlineControl.searchDeadline = epochAvailableTime + opt.m_RealTimeOptions.deadline;
+      }
+
       if( rxData.m_nrValidObs == 0 )
         continue;
 
       // Check that the processing time is within the processing interval.
       time = rxData.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxData.m_pvt.time.gps_tow;
-      if( time < start_time )
+      if( time < rover.start_time )
         continue;
-      if( time > end_time )
+      if( time > rover.end_time )
         break;
+      profiler.SetEpochTime( rxData.m_pvt.time.gps_week, rxData.m_pvt.time.gps_tow );
 
-
-      // GDM_DEBUG breakpoint times
-      if( rxData.m_pvt.time.gps_tow > 320039 )
-        int gaa = 99;
-
-      if( rxData.m_pvt.time.gps_tow > 320414 )
-        int ggga = 99;
-
-      if( isAtFirstEpoch )
-      {
-        isAtFirstEpoch = false;
-        dT = 0.0;
-      }
-      else
-      {
-        dT = time - time_prev;      
-        if( dT < 0.0 )
-        {
-          // should never happen
-          GNSS_ERROR_MSG( "dT is negative." );
-          return 1; 
-        }        
-      }
-
-      if( !opt.m_UseDopplerMeasurements )
-      {
-        // Disable all the Doppler measurements on the rover.
-        for( i = 0; i < rxData.m_nrValidObs; i++ )
-        {
-          rxData.m_ObsArray[i].flags.isDopplerValid = false;
-          rxData.m_ObsArray[i].flags.isDopplerUsedInSolution = false;          
-        }
-
-        if( opt.m_Reference.isValid )
-        {
-          // Disable all the Doppler measurements on the base station.
-          for( i = 0; i < rxDataBase.m_nrValidObs; i++ )
-          {
-            rxDataBase.m_ObsArray[i].flags.isDopplerValid = false;
-            rxDataBase.m_ObsArray[i].flags.isDopplerUsedInSolution = false;            
-          }
-        }          
-      }
-        
-      // exclude satellites as indicated in the option file
-      for( j = 0; j < opt.m_Rover.nrSatsToExclude; j++ )
-      {
-        for( i = 0; i < rxData.m_nrValidObs; i++ )
-        {
-          if( rxData.m_ObsArray[i].id == opt.m_Rover.satsToExclude[j] )
-          {
-            rxData.m_ObsArray[i].flags.isNotUserRejected = 0;
-          }
-        }
-      } 
-
-      if( opt.m_Reference.isValid )
-      {
-        // exclude satellites as indicated in the option file
-        for( j = 0; j < opt.m_Reference.nrSatsToExclude; j++ )
-        {
-          for( i = 0; i < rxDataBase.m_nrValidObs; i++ )
-          {
-            if( rxDataBase.m_ObsArray[i].id == opt.m_Reference.satsToExclude[j] )
-            {
-              rxDataBase.m_ObsArray[i].flags.isNotUserRejected = 0;
-            }
-          }
-        } 
-      }
-
-      if( opt.m_RoverIsStatic )
-      {
-        // Enable cycle slip detection using the triple difference method.
-        rxData.m_isStatic = true;
-      }
-
-      // Enable constraints if any.
-      if( opt.m_isPositionFixed )
-      {
-        rxData.m_pvt_lsq.isHeightConstrained = false;
-        rxData.m_pvt.isHeightConstrained = false;        
-        rxData.m_pvt_lsq.isPositionFixed = true;
-        rxData.m_pvt.isPositionFixed = true;
-        
-        // Enable cycle slip detection using the triple difference method.
-        rxData.m_isStatic = true;
-      }
-      else if( opt.m_isHeightConstrained )
-      {
-        rxData.m_pvt_lsq.isHeightConstrained = true;
-        rxData.m_heightConstraint = opt.m_Rover.height;
-        rxData.m_heightConstraintStdev = opt.m_Rover.uncertaintyHeightOneSigma;
-        rxData.m_pvt.isHeightConstrained = true;
-        rxData.m_pvt_lsq.isPositionFixed = false;
-        rxData.m_pvt.isPositionFixed = false;
-      }
-
-      // Always perfom least squares.
-      if( opt.m_Reference.isValid )
-      {
-        result = Estimator.PerformLeastSquares(
-          &rxData,
-          &rxDataBase,
-          wasPositionComputed,
-          wasVelocityComputed );
-        if( !result )
-        {
-          sprintf( msg, "%.1Lf %d LSQ returned false\n", rxData.m_pvt_lsq.time.gps_tow, rxData.m_pvt_lsq.time.gps_tow );
-          GNSS_ERROR_MSG( msg );
-          return 2;
-        }        
-      }
-      else
-      {
-        result = Estimator.PerformLeastSquares(
-          &rxData,
-          NULL,
-          wasPositionComputed,
-          wasVelocityComputed );
-        if( !result )
-        {
-          sprintf( msg, "%.1Lf %d LSQ returned false\n", rxData.m_pvt_lsq.time.gps_tow, rxData.m_pvt_lsq.time.gps_tow );
-          GNSS_ERROR_MSG( msg );
-          return 2;
-        }
-      }
-
-      if( !isFilterInitialized )
-      {
-        // Is there a 'valid' least squares position estimate?
-        if( !( wasPositionComputed && rxData.m_pvt_lsq.didGlobalTestPassForPosition ) )
-        {
-          continue;
-        }
-        else
-        {
-          if( opt.m_isPositionFixed )
-          {
-            result = rxData.UpdatePositionAndRxClock(
-              rxData.m_pvt,
-              opt.m_Rover.latitudeRads,
-              opt.m_Rover.longitudeRads,
-              opt.m_Rover.height,
-              rxData.m_pvt.clockOffset,
-              opt.m_Rover.uncertaintyLatitudeOneSigma, 
-              opt.m_Rover.uncertaintyLongitudeOneSigma, 
-              opt.m_Rover.uncertaintyHeightOneSigma, 
-              rxData.m_pvt.std_clk
-              );
-
-            // The least squares covariance matrix is still used to seed the filter.
-            Estimator.m_posLSQ.P.Zero();
-            Estimator.m_posLSQ.P[0][0] = opt.m_Rover.uncertaintyLatitudeOneSigma*opt.m_Rover.uncertaintyLatitudeOneSigma;
-            Estimator.m_posLSQ.P[1][1] = opt.m_Rover.uncertaintyLongitudeOneSigma*opt.m_Rover.uncertaintyLongitudeOneSigma;
-            Estimator.m_posLSQ.P[2][2] = opt.m_Rover.uncertaintyHeightOneSigma*opt.m_Rover.uncertaintyHeightOneSigma;
-            Estimator.m_posLSQ.P[3][3] = 2.0*rxData.m_pvt.std_clk*rxData.m_pvt.std_clk;
-          }
-          else
-          {
-            // Seed with either least squares or the option file solution
-            // whichever is more precise
-
-            lsq_accuracy  = rxData.m_pvt_lsq.std_lat*rxData.m_pvt_lsq.std_lat;
-            lsq_accuracy += rxData.m_pvt_lsq.std_lon*rxData.m_pvt_lsq.std_lon;
-            lsq_accuracy += rxData.m_pvt_lsq.std_hgt*rxData.m_pvt_lsq.std_hgt;
-            lsq_accuracy  = sqrt(lsq_accuracy);
-            opt_accuracy  = opt.m_Rover.uncertaintyLatitudeOneSigma*opt.m_Rover.uncertaintyLatitudeOneSigma;
-            opt_accuracy += opt.m_Rover.uncertaintyLongitudeOneSigma*opt.m_Rover.uncertaintyLongitudeOneSigma;
-            opt_accuracy += opt.m_Rover.uncertaintyHeightOneSigma*opt.m_Rover.uncertaintyHeightOneSigma;
-            opt_accuracy  = sqrt(opt_accuracy);
-
-            if( opt_accuracy <= lsq_accuracy )
-            {
-              result = rxData.UpdatePositionAndRxClock(
-                rxData.m_pvt,
-                opt.m_Rover.latitudeRads,
-                opt.m_Rover.longitudeRads,
-                opt.m_Rover.height,
-                rxData.m_pvt.clockOffset,
-                opt.m_Rover.uncertaintyLatitudeOneSigma, 
-                opt.m_Rover.uncertaintyLongitudeOneSigma, 
-                opt.m_Rover.uncertaintyHeightOneSigma, 
-                rxData.m_pvt.std_clk
-                );
-
-              Estimator.m_posLSQ.P.Zero();
-              Estimator.m_posLSQ.P[0][0] = opt.m_Rover.uncertaintyLatitudeOneSigma*opt.m_Rover.uncertaintyLatitudeOneSigma;
-              Estimator.m_posLSQ.P[1][1] = opt.m_Rover.uncertaintyLongitudeOneSigma*opt.m_Rover.uncertaintyLongitudeOneSigma;
-              Estimator.m_posLSQ.P[2][2] = opt.m_Rover.uncertaintyHeightOneSigma*opt.m_Rover.uncertaintyHeightOneSigma;
-              Estimator.m_posLSQ.P[3][3] = 2.0*rxData.m_pvt.std_clk*rxData.m_pvt.std_clk;
-            }
-            else
-            {
-              // Seed the filter with the least squares solution.
-              rxData.m_pvt = rxData.m_pvt_lsq;
-            }
-          }
-            
-          if( useRTK )
-          {
-            result = Estimator.InitializeStateVarianceCovarianceFromLeastSquares_RTK(
-              Estimator.m_posLSQ.P,
-              Estimator.m_velLSQ.P
-              );
-            if( !result )
-            {
-              GNSS_ERROR_MSG( "Estimator.InitializeStateVarianceCovarianceFromLeastSquares_RTK returned false." );
-              return 1;
-            }
-          }
-          else if( useEKF )
-          {            
-            result = Estimator.InitializeStateVarianceCovariance_EKF(
-              Estimator.m_posLSQ.P,
-              Estimator.m_velLSQ.P
-              );
-            if( !result )
-            {
-              GNSS_ERROR_MSG( "Estimator.InitializeStateVarianceCovariance_EKF returned false." );
-              return 1;
-            }
-          }
-          else if( useTripleDiff )
-          {            
-            skipEpochForTripleDiff = true;
-
-            // Estimator.m_posLSQ.P contains either the least squares covariance info
-            // or the option file specified covariance information.
-            Estimator.m_TD.Cx.Resize(3,3);
-            if( lsq_accuracy < opt_accuracy )
-            {
-              Estimator.m_TD.Cx[0][0] = 6.0*Estimator.m_posLSQ.P[0][0];
-              Estimator.m_TD.Cx[1][1] = 6.0*Estimator.m_posLSQ.P[1][1];
-              Estimator.m_TD.Cx[2][2] = 6.0*Estimator.m_posLSQ.P[2][2];
-            }
-            else
-            {
-              Estimator.m_TD.Cx[0][0] = Estimator.m_posLSQ.P[0][0];
-              Estimator.m_TD.Cx[1][1] = Estimator.m_posLSQ.P[1][1];
-              Estimator.m_TD.Cx[2][2] = Estimator.m_posLSQ.P[2][2];
-            }
-          }
-          else
-          {
-            GNSS_ERROR_MSG( "Unexpected." );
-            return 1;
-          }
-          isFilterInitialized = true;
-        }
-      }
-
-      if( useTripleDiff )
+      if( !ProcessEpoch( rover, time, wasOutput ) )
       {
-        if( !skipEpochForTripleDiff )
-        {
-          // copy the velocity and clock drift information to the triple difference solution
-          rxData.m_pvt.clockOffset = rxData.m_pvt_lsq.clockOffset;
-          rxData.m_pvt.std_clk = rxData.m_pvt_lsq.std_clk;
-
-          rxData.UpdateVelocityAndClockDrift(
-            rxData.m_pvt, 
-            rxData.m_pvt_lsq.vn, 
-            rxData.m_pvt_lsq.ve, 
-            rxData.m_pvt_lsq.vup, 
-            rxData.m_pvt_lsq.clockDrift,
-            rxData.m_pvt_lsq.std_vn,
-            rxData.m_pvt_lsq.std_ve,
-            rxData.m_pvt_lsq.std_vup,
-            rxData.m_pvt_lsq.std_clkdrift );
-
-          rxData.m_pvt.nrDopplerObsAvailable = rxData.m_pvt_lsq.nrDopplerObsAvailable;
-          rxData.m_pvt.nrDopplerObsRejected = rxData.m_pvt_lsq.nrDopplerObsRejected;
-          rxData.m_pvt.nrDopplerObsUsed = rxData.m_pvt_lsq.nrDopplerObsUsed;
-          
-          result = Estimator.EstimateTripleDifferenceSolution(
-            &rxData,
-            &rxDataBase,
-            wasPositionComputed
-            );
-          skipEpochForTripleDiff = true;
-        }
-        else
-        {
-          skipEpochForTripleDiff = false;
-        }
+        GNSS_ERROR_MSG( "ProcessEpoch returned false." );
+        return 1;
       }
-      else if( useEKF )
-      {
-        result = Estimator.PredictAhead_EKF(
-          rxData,
-          dT
-          );
-        if( !result )
-        {
-          GNSS_ERROR_MSG( "Estimator.PredictAhead_EKF returned false." );
-          return 1;
-        }
+      if( !wasOutput )
+        continue;
 
-        if( opt.m_Reference.isValid )
-        {
-          result = Estimator.Kalman_Update_EKF(
-            &rxData,
-            &rxDataBase
-            );
-          if( !result )
-          {
-            GNSS_ERROR_MSG( "Estimator.Kalman_Update_EKF returned false." );
-            return -1;
-          }
-        }
-        else
-        {
-          result = Estimator.Kalman_Update_EKF(
-            &rxData,
-            NULL
-            );
-          if( !result )
-          {
-            GNSS_ERROR_MSG( "Estimator.Kalman_Update_EKF returned false." );
-            return -1;
-          }
-        }
-      }
-      else if( useRTK )
+      if( opt.m_RealTimeOptions.isEnabled )
       {
-        if( Estimator.m_FilterType == GNSS_Estimator::GNSS_FILTER_TYPE_RTK4 )
-        {
-          // copy the velocity and clock drift information to the rtk solution
-          rxData.UpdateVelocityAndClockDrift(
-            rxData.m_pvt, 
-            rxData.m_pvt_lsq.vn, 
-            rxData.m_pvt_lsq.ve, 
-            rxData.m_pvt_lsq.vup, 
-            rxData.m_pvt_lsq.clockDrift,
-            rxData.m_pvt_lsq.std_vn,
-            rxData.m_pvt_lsq.std_ve,
-            rxData.m_pvt_lsq.std_vup,
-            rxData.m_pvt_lsq.std_clkdrift );
-
-          rxData.m_pvt.nrDopplerObsAvailable = rxData.m_pvt_lsq.nrDopplerObsAvailable;
-          rxData.m_pvt.nrDopplerObsRejected = rxData.m_pvt_lsq.nrDopplerObsRejected;
-          rxData.m_pvt.nrDopplerObsUsed = rxData.m_pvt_lsq.nrDopplerObsUsed;
-
-          // Bump the clock state using the least squares solution
-          // to reduce innovation values for the pseudoranges if
-          // the clock is not really being filtered.
-          if( opt.m_KalmanOptions.RTK4_sigmaClock > 50.0 )
-          {
-            if( rxData.m_pvt_lsq.std_clk < 50.0 )
-            {
-              rxData.m_pvt.clockOffset = rxData.m_pvt_lsq.clockOffset;
-              Estimator.m_RTK.P[3][3] = rxData.m_pvt_lsq.std_clk*rxData.m_pvt_lsq.std_clk;
-            }
-          }
-        }
-
-        result = Estimator.PredictAhead_RTK( rxData, dT );
-        if( !result )
+        if( !rover.PVT.Flush() )
         {
-          GNSS_ERROR_MSG( "Estimator.PredictAhead_RTK returned false." );
+          GNSS_ERROR_MSG( "PVT.Flush returned false." );
           return 1;
         }
+        epochLatency = GNSS_Profiler::GetTime() - epochAvailableTime;
+        profiler.AddStageTime( GNSS_PROFILE_END_TO_END, epochLatency, 0 );
+        epochLatencies.push_back( epochLatency );
 
-        if( opt.m_Reference.isValid )
-        {
-          result = Estimator.Kalman_Update_RTK( &rxData, &rxDataBase );
-          if( !result )
-          {
-            GNSS_ERROR_MSG( "Estimator.Kalman_Update_RTK returned false." );
-            return 1;
-          }
-        }
-        else
+        // Degrade the next epoch if this one overran its deadline.
+        Estimator.m_DeadlineControl.skipAmbiguitySearch = false;
+        if( opt.m_RealTimeOptions.deadline > 0 && epochLatency > opt.m_RealTimeOptions.deadline )
         {
-          GNSS_ERROR_MSG( "Only differential supported." );
-          return 1;
+          nrDeadlineOverruns++;
+          Estimator.m_DeadlineControl.skipAmbiguitySearch = true;
         }
-      }	       
-
-
-      /*
-      printf( "%12.3lf %5d %d %d %d \n", 
-        rxData.m_pvt.time.gps_tow, 
-        rxData.m_pvt.time.gps_week,         
-        rxData.m_pvt.nrPsrObsUsed,
-        rxData.m_pvt.nrDopplerObsUsed,
-        rxData.m_pvt.nrAdrObsUsed );    
-        */
-
-      /*
-      char supermsg[8192];
-      unsigned nrBytesInBuffer;
-      rxData.Debug_WriteSuperMsg80CharsWide( 
-      supermsg,
-      8192,
-      51.0916666667*DEG2RAD,
-      -114.0000000000*DEG2RAD,
-      1000.000,
-      nrBytesInBuffer );
-
-      printf( supermsg );
-      */
-
-      
-      rxData.m_prev_pvt = rxData.m_pvt;
-      rxDataBase.m_prev_pvt = rxDataBase.m_pvt;
-
-      if( !opt.m_RoverDatum.isValid )
-      {
-        opt.m_RoverDatum.latitudeRads = rxData.m_pvt.latitude;
-        opt.m_RoverDatum.longitudeRads = rxData.m_pvt.longitude;
-        opt.m_RoverDatum.height = rxData.m_pvt.height;
-        opt.m_RoverDatum.isValid = true;
-      }
-      // Output the PVT results.
-      if( !OutputPVT( PVT, rxData, opt.m_RoverDatum.latitudeRads, opt.m_RoverDatum.longitudeRads, opt.m_RoverDatum.height, opt.m_RoverIsStatic ) )
-      {
-        sprintf( msg, "%.3Lf %d OutputPVT Failed\n", rxData.m_pvt.time.gps_tow, rxData.m_pvt.time.gps_week );
-        GNSS_ERROR_MSG( msg );
-        return 1;
       }
 
-      if( !OutputObservationData( SatObs, 32, &rxData, true, Estimator.m_FilterType ) )
+      if( !profiler.EndEpoch() )
       {
-        sprintf( msg, "%.3Lf %d OutputObservationData returned false.\n", rxData.m_pvt.time.gps_tow, rxData.m_pvt.time.gps_week );
-        GNSS_ERROR_MSG( msg );
+        GNSS_ERROR_MSG( "profiler.EndEpoch returned false." );
         return 1;
       }
     }    
+    profiler.EndEpoch();
   }
   catch( MatrixException& matrixException )
   {
@@ -886,102 +604,122 @@ int main( int argc, char* argv[] )
     printf( "\nCaught unknown exception\n" );
   }
 
-  if( !PVT.isEmpty() )
+  if( rxData.m_AtmCache.isEnabled && rxData.m_AtmCache.checkAccuracy )
   {
-    if( !PVT.Inplace_Transpose() )
-    {
-      GNSS_ERROR_MSG( "if( !PVT.Inplace_Transpose() )" );
-      return 1;
-    }
+    printf( "Atmospheric correction cache (rover): %u zenith computations, %u iono computations, %u iono predictions\n", 
+      rxData.m_AtmCache.nrZenithComputations, rxData.m_AtmCache.nrIonoComputations, rxData.m_AtmCache.nrIonoPredictions );
+    printf( "Atmospheric correction cache (rover): max table error %.6f m, max tropo error %.6f m, max iono error %.6f m\n", 
+      rxData.m_AtmCache.maxTableError, rxData.m_AtmCache.maxTropoError, rxData.m_AtmCache.maxIonoError );
+  }
+  if( opt.m_Reference.isValid && rxDataBase.m_AtmCache.isEnabled && rxDataBase.m_AtmCache.checkAccuracy )
+  {
+    printf( "Atmospheric correction cache (reference): %u zenith computations, %u iono computations, %u iono predictions\n", 
+      rxDataBase.m_AtmCache.nrZenithComputations, rxDataBase.m_AtmCache.nrIonoComputations, rxDataBase.m_AtmCache.nrIonoPredictions );
+    printf( "Atmospheric correction cache (reference): max table error %.6f m, max tropo error %.6f m, max iono error %.6f m\n", 
+      rxDataBase.m_AtmCache.maxTableError, rxDataBase.m_AtmCache.maxTropoError, rxDataBase.m_AtmCache.maxIonoError );
+  }
+
+  if( opt.m_LeastSquaresOptions.reportIterations && Estimator.m_LSQIterationControl.nrEpochs > 0 )
+  {
+    printf( "Least squares iterations: %.2f per epoch, %u maximum, %u epochs, %u warm starts, %u design matrix reuses, %u not converged\n", 
+      (double)Estimator.m_LSQIterationControl.totalNrIterations / (double)Estimator.m_LSQIterationControl.nrEpochs,
+      Estimator.m_LSQIterationControl.maxNrIterations,
+      Estimator.m_LSQIterationControl.nrEpochs,
+      Estimator.m_LSQIterationControl.nrWarmStarts,
+      Estimator.m_LSQIterationControl.nrGeometryReuses,
+      Estimator.m_LSQIterationControl.nrNotConverged );
+  }
 
-    // Open the PVT output file
-    fid_pvt = fopen( "pvt.csv", "w" );
-    if( !fid_pvt )
+  if( opt.m_RealTimeOptions.isEnabled )
+  {
+    printf( "Real time: %u epochs over the %.3f s deadline, %u ambiguity searches skipped, %.1f s waiting for data (%u polls)\n", 
+      nrDeadlineOverruns,
+      opt.m_RealTimeOptions.deadline,
+      Estimator.m_DeadlineControl.nrSkippedSearches,
+      rxData.m_RealTime.totalWaitTime + rxDataBase.m_RealTime.totalWaitTime,
+      rxData.m_RealTime.nrPolls + rxDataBase.m_RealTime.nrPolls );
+    if( epochLatencies.size() > 0 )
     {
-      printf( "Please close pvt.csv and type GO: " );
-      gets( msg );
-      fid_pvt = fopen( "pvt.csv", "w" );
-      if( !fid_pvt )
-      {
-        sprintf( msg, "Unable to open pvt.csv." );
-        GNSS_ERROR_MSG( msg );
-        return 1;
-      }
+      std::sort( epochLatencies.begin(), epochLatencies.end() );
+      printf( "Real time latency: %u epochs, 50%% %.3f ms, 95%% %.3f ms, 99%% %.3f ms, max %.3f ms\n", 
+        (unsigned)epochLatencies.size(),
+        epochLatencies[ (epochLatencies.size()-1) * 50 / 100 ] * 1.0e3,
+        epochLatencies[ (epochLatencies.size()-1) * 95 / 100 ] * 1.0e3,
+        epochLatencies[ (epochLatencies.size()-1) * 99 / 100 ] * 1.0e3,
+        epochLatencies.back() * 1.0e3 );
     }
-    fprintf( fid_pvt, "GPS time of week(s), GPS week, latitude (deg), longitude (deg), height (m), Velocity North (m/s), Velocity East (m/s), Velocity Up (m/s), Ground Speed (km/hr), Clock Offset (m), Clock Drift (m/s), " );
-    if( opt.m_RoverIsStatic )
-      fprintf( fid_pvt, "Error North (m), Error East (m), Error Up (m),");
-    else
-      fprintf( fid_pvt, "Northing (m), Easting (m), Up (m),");
-    fprintf( fid_pvt, "STDEV latitude (m), STDEV longitude (m), STDEV height (m), STDEV Velocity North (m/s), STDEV Velocity East (m/s), STDEV Velocity Up (m/s), STDEV Clock Offset (m), STDEV Clock Drift (m/s), " );
-    fprintf( fid_pvt, "NR PSR Available, NR PSR Used, NR Doppler Available, NR Doppler Used, NR ADR Available, NR ADR Used," );
-    fprintf( fid_pvt, "NDOP,EDOP,VDOP,HDOP,PDOP,TDOP,GDOP,");    
-    fprintf( fid_pvt, "LSQ APVF Position, LSQ Pos Global Test, APVF Velocity, LSQ Vel Global Test, FixedSoln latitude (deg), FixedSoln longitude (deg), FixedSoln height (m),");    
-    if( opt.m_RoverIsStatic )
-      fprintf( fid_pvt, "FixedSoln ErrN (m), FixedSoln ErrE (m), FixedSoln ErrUp (m),");
-    else
-      fprintf( fid_pvt, "FixedSoln Northing (m), FixedSoln Easting (m), FixedSoln Up (m),");
-    fprintf( fid_pvt, "ambiguity ratio, P(a_check=a)\n");    
-    
-    fclose( fid_pvt );
+  }
+
+  if( opt.m_Reference.isValid && aligner.GetMode() != GNSS_ALIGNMENT_MATCH )
+  {
+    printf( "Alignment: %u reference epochs, %u rover epochs matched, %u interpolated, %u extrapolated (max %.3f s), %u skipped, %u reference clock jumps\n", 
+      aligner.m_Statistics.nrReferenceEpochs,
+      aligner.m_Statistics.nrMatched,
+      aligner.m_Statistics.nrInterpolated,
+      aligner.m_Statistics.nrExtrapolated,
+      aligner.m_Statistics.maxExtrapolation,
+      aligner.m_Statistics.nrSkipped,
+      aligner.m_Statistics.nrClockJumps );
+  }
 
-    if( !PVT.PrintDelimited( "pvt.csv", 12, ',', true )  )
+  if( profiler.IsEnabled() )
+  {
+    profiler.PrintReport( stdout, false );
+    if( !profiler.WriteReport( opt.m_ProfileOptions.ReportFilePath ) )
     {
-      GNSS_ERROR_MSG( "if( !PVT.PrintDelimited( \"pvt.csv\", 12, ',', true )  )" );
+      GNSS_ERROR_MSG( "profiler.WriteReport returned false." );
       return 1;
     }
   }
 
-  for( i = 1; i <= 32; i++ )
+  if( rover.useSmoother && rover.smoother.GetNrEpochs() > 0 && rover.PVT.GetNrEpochs() > 0 )
   {
-    if( !SatObs[i].isEmpty() )
+    printf( "Smoothing %u epochs (%u blocks written to %s).\n", 
+      rover.smoother.GetNrEpochs(), rover.smoother.GetNrBlocksSpilled(), opt.m_SmootherOptions.SpillFilePath.c_str() );
+
+    smoothedOutput.PVT = &rover.PVT;
+    smoothedOutput.datumLatitudeRads = rover.datum.latitudeRads;
+    smoothedOutput.datumLongitudeRads = rover.datum.longitudeRads;
+    smoothedOutput.datumHeight = rover.datum.height;
+    if( !rover.smoother.Smooth( OutputSmoothedPVT, &smoothedOutput ) )
     {
-      sprintf( fname, "obs_%02d.csv", i );
-      fid_obs = fopen( fname, "w" );
-      if( !fid_obs )
-      {
-        printf( "Please close %s and type GO: ", fname );
-        gets( msg );
-        fid_obs = fopen( fname, "w" );
-        if( !fid_obs )
-        {
-          sprintf( msg, "Unable to open %s.", fname );
-          GNSS_ERROR_MSG( msg );
-          return 1;
-        }
-      }
+      GNSS_ERROR_MSG( "smoother.Smooth returned false." );
+      return 1;
+    }
+  }
 
-      fprintf( fid_obs, "GPS time of week(s),GPS week,ID,Channel," );
-      fprintf( fid_obs, "System,Code Type,Frequency Type," );
-      fprintf( fid_obs, "Elevation (deg), Azimuth (deg)," );
-      fprintf( fid_obs, "PSR (m), ADR (cycles), PSR-ADR (m), Doppler (Hz),C/No (dB-Hz),Lock Time (s)," );
-      fprintf( fid_obs, "isActive,isCodeLocked,isPhaseLocked,isParityValid,isPsrValid,isAdrValid,isDopplerValid,isGrouped,isAutoAssigned,isCarrierSmoothed," );
-      fprintf( fid_obs, "isEphemerisValid,isAlmanacValid,isAboveElevationMask,isAboveCNoMask,isAboveLockTimeMask,isNotUserRejected,isNotPsrRejected,isNotAdrRejected,isNotDopplerRejected,isNoCycleSlipDetected," );
-      fprintf( fid_obs, "isPsrUsedInSolution,isDopplerUsedInSolution,isAdrUsedInSolution,isDifferentialPsrAvailable,isDifferentialDopplerAvailable,isDifferentialAdrAvailable,useTropoCorrection,useBroadcastIonoCorrection,isBaseSatellite," );
-      fprintf( fid_obs, "stdev PSR (m),stdev adr (cycles),stdev Doppler (Hz)," );
-      fprintf( fid_obs, "PSR misclosure (m), Doppler misclosure (m/s), ADR misclosure (m)," );
-      fprintf( fid_obs, "SD_ambiguity (m), DD_ambiguity (m), DD_fixed_ambiguity (cycles), SD ADR residual (m), DD ADR residual (m), DD ADR residual fixed (m)\n" );
-      fclose( fid_obs );
+  if( !rover.PVT.Close() )
+  {
+    GNSS_ERROR_MSG( "PVT.Close returned false." );
+    return 1;
+  }
 
-      if( !SatObs[i].Inplace_Transpose() )
-      {
-        GNSS_ERROR_MSG( "if( !SatObs[i].Inplace_Transpose() )" );
-        return 1;
-      }
-      if( !SatObs[i].PrintDelimited( fname, 12, ',', true )  )
-      {
-        GNSS_ERROR_MSG( "if( !SatObs[i].PrintDelimited( fname, 12, ',', true )  )" );
-        return 1;
-      }
+  if( rover.useStaticBatch && rover.staticBatch.GetNrEpochs() > 0 )
+  {
+    if( !WriteStaticBatchSolution( 
+      rover.staticBatch, 
+      opt.m_StaticBatchOptions.OutputFilePath.c_str(), 
+      rover.datum.latitudeRads, 
+      rover.datum.longitudeRads, 
+      rover.datum.height ) )
+    {
+      GNSS_ERROR_MSG( "WriteStaticBatchSolution returned false." );
+      return 1;
     }
   }
 
+  if( !WriteObservationData( rover ) )
+  {
+    GNSS_ERROR_MSG( "WriteObservationData returned false." );
+    return 1;
+  }
+
   return 0;
 }
 
 
 bool OutputPVT(
-  Matrix &PVT,
+  GNSS_PVTWriter &pvtWriter, //!< The PVT output, one epoch is written.
   GNSS_RxData& rxData,  //!< The receiver data.
   const double datumLatitudeRads,  //!< Used to compute a position difference.
   const double datumLongitudeRads, //!< Used to compute a position difference.
@@ -995,8 +733,7 @@ bool OutputPVT(
   double easting = 0.0;
   double up = 0.0;
   unsigned i = 0;
-  const unsigned nr_items = 48;
-  Matrix data(nr_items,1);
+  double data[GNSS_PVT_NR_COLUMNS];
 
   result = GEODESY_ComputePositionDifference(
     GEODESY_REFERENCE_ELLIPSE_WGS84,
@@ -1100,12 +837,13 @@ bool OutputPVT(
   data[i] = rxData.m_ambiguity_validation_ratio; i++;  
   data[i] = rxData.m_probability_of_correct_ambiguities; i++;  
   data[i] = rxData.m_norm; i++;
+  data[i] = rxData.m_nrFixedAmbiguities; i++;
+  data[i] = rxData.m_nrAmbiguitySearchNodes; i++;
 
-  result = PVT.Concatonate( data );
-  if( !result )
+  if( !pvtWriter.WriteEpoch( data ) )
   {
-    GNSS_ERROR_MSG( "result = PVT.Concatonate( data );" );
-    return true;
+    GNSS_ERROR_MSG( "pvtWriter.WriteEpoch returned false." );
+    return false;
   }
   return true;
 }
@@ -1254,6 +992,7 @@ bool OutputObservationData(
 
 
 bool GetNextSetOfSynchronousMeasurements( 
+  GNSS_EpochAligner &aligner, //!< The alignment of the base station observations to the rover epochs.
   GNSS_RxData &rxDataBase,  //!< The base station receiver data.
   bool &endOfStreamBase,    //!< A boolean that indicates if the end of the data has been reached for the base station.
   GNSS_RxData &rxData,      //!< The rover station receiver data.
@@ -1262,63 +1001,21 @@ bool GetNextSetOfSynchronousMeasurements(
   )
 {
   bool result = false;
-  double timeBase = 0;
-  double timeRover = 0;
-  double timeDiff = 0;
 
   isSynchronized = false;
 
-  result = rxDataBase.LoadNext( endOfStreamBase );
-  if( !result )
-  {
-    GNSS_ERROR_MSG( "rxDataBase.LoadNext returned false." );
-    return false;
-  }
-  if( endOfStreamBase )
-    return true;
-
-  result = rxData.LoadNext( endOfStreamRover );
+  // The rover epochs are read in turn and the base station observations
+  // are matched, interpolated, or extrapolated to each rover epoch.
+  result = aligner.LoadNext( rxDataBase, endOfStreamBase, rxData, endOfStreamRover );
   if( !result )
   {
-    GNSS_ERROR_MSG( "rxData.LoadNext returned false." );
+    GNSS_ERROR_MSG( "aligner.LoadNext returned false." );
     return false;
   }
-
-  if( endOfStreamRover )
+  if( endOfStreamBase || endOfStreamRover )
     return true;
 
-  while( !endOfStreamBase && !endOfStreamRover )
-  {
-    timeBase  = rxDataBase.m_pvt.time.gps_week*SECONDS_IN_WEEK  + rxDataBase.m_pvt.time.gps_tow;
-    timeRover = rxData.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxData.m_pvt.time.gps_tow;
-    timeDiff = timeBase - timeRover;
-
-    if( fabs(timeDiff) < 0.020 ) // must match to 20 ms
-    {
-      isSynchronized = true;
-      break; // synchronized
-    }
-
-    if( timeDiff < 0 )
-    {
-      // The rover time is ahead of the base time.
-      result = rxDataBase.LoadNext( endOfStreamRover );
-      if( !result )
-      {
-        GNSS_ERROR_MSG( "rxDataBase.LoadNext returned false." );
-        return false;
-      }
-    }
-    else
-    {
-      result = rxData.LoadNext( endOfStreamRover );
-      if( !result )
-      {
-        GNSS_ERROR_MSG( "rxData.LoadNext returned false." );
-        return false;
-      }
-    }
-  }
+  isSynchronized = true;
 
 //#define GDM_HACK_ADD_PSR_BLUNDER 1
 #ifdef GDM_HACK_ADD_PSR_BLUNDER  
@@ -1349,10 +1046,1297 @@ bool GetNextSetOfSynchronousMeasurements(
 }
 
 
+bool OutputSmoothedPVT( 
+  const GNSS_RTSSmoother::stSmoothedEpoch& epoch,
+  void* arg
+  )
+{
+  stSmoothedPVTOutput* output = (stSmoothedPVTOutput*)arg;
+  double data[20];
+  double northing = 0.0;
+  double easting = 0.0;
+  double up = 0.0;
+  BOOL result;
+
+  if( output == NULL || output->PVT == NULL )
+  {
+    GNSS_ERROR_MSG( "if( output == NULL || output->PVT == NULL )" );
+    return false;
+  }
+
+  result = GEODESY_ComputePositionDifference(
+    GEODESY_REFERENCE_ELLIPSE_WGS84,
+    output->datumLatitudeRads,
+    output->datumLongitudeRads,
+    output->datumHeight,
+    epoch.latitude,
+    epoch.longitude,
+    epoch.height,
+    &northing,
+    &easting,
+    &up );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "GEODESY_ComputePositionDifference returned FALSE." );
+    return false;
+  }
+
+  // The columns 2 to 21 in the order written by OutputPVT.
+  data[0]  = epoch.latitude*RAD2DEG;
+  data[1]  = epoch.longitude*RAD2DEG;
+  data[2]  = epoch.height;
+  data[3]  = epoch.vn;
+  data[4]  = epoch.ve;
+  data[5]  = epoch.vup;
+  data[6]  = sqrt( epoch.vn*epoch.vn + epoch.ve*epoch.ve )*3.6;
+  data[7]  = epoch.clockOffset;
+  data[8]  = epoch.clockDrift;
+  data[9]  = northing;
+  data[10] = easting;
+  data[11] = up;
+  data[12] = epoch.std_lat;
+  data[13] = epoch.std_lon;
+  data[14] = epoch.std_hgt;
+  data[15] = epoch.std_vn;
+  data[16] = epoch.std_ve;
+  data[17] = epoch.std_vup;
+  data[18] = epoch.std_clk;
+  data[19] = epoch.std_clkdrift;
+
+  if( !output->PVT->UpdateEpoch( epoch.tag, 2, data, 20 ) )
+  {
+    GNSS_ERROR_MSG( "output->PVT->UpdateEpoch returned false." );
+    return false;
+  }
+  return true;
+}
+
+
+bool OpenPVTWriter( 
+  GNSS_PVTWriter &pvtWriter,
+  const char* name,
+  const std::string& format,
+  bool isCompressed,
+  bool isStatic,
+  bool isUpdatable
+  )
+{
+  GNSS_PVTWriter::Format pvtFormat = GNSS_PVTWriter::PVT_FORMAT_CSV;
+  std::string path;
+  std::string header;
+  char msg[256];
+
+  if( name == NULL )
+  {
+    GNSS_ERROR_MSG( "if( name == NULL )" );
+    return false;
+  }
+
+  path = name;
+  if( format == "BINARY" )
+  {
+    pvtFormat = GNSS_PVTWriter::PVT_FORMAT_BINARY;
+    path += ".bin";
+  }
+  else if( format == "COLUMNAR" )
+  {
+    pvtFormat = GNSS_PVTWriter::PVT_FORMAT_COLUMNAR;
+    path += ".mtc";
+  }
+  else
+  {
+    path += ".csv";
+  }
+
+  header = "GPS time of week(s), GPS week, latitude (deg), longitude (deg), height (m), Velocity North (m/s), Velocity East (m/s), Velocity Up (m/s), Ground Speed (km/hr), Clock Offset (m), Clock Drift (m/s), ";
+  if( isStatic )
+    header += "Error North (m), Error East (m), Error Up (m),";
+  else
+    header += "Northing (m), Easting (m), Up (m),";
+  header += "STDEV latitude (m), STDEV longitude (m), STDEV height (m), STDEV Velocity North (m/s), STDEV Velocity East (m/s), STDEV Velocity Up (m/s), STDEV Clock Offset (m), STDEV Clock Drift (m/s), ";
+  header += "NR PSR Available, NR PSR Used, NR Doppler Available, NR Doppler Used, NR ADR Available, NR ADR Used,";
+  header += "NDOP,EDOP,VDOP,HDOP,PDOP,TDOP,GDOP,";
+  header += "LSQ APVF Position, LSQ Pos Global Test, APVF Velocity, LSQ Vel Global Test, FixedSoln latitude (deg), FixedSoln longitude (deg), FixedSoln height (m),";
+  if( isStatic )
+    header += "FixedSoln ErrN (m), FixedSoln ErrE (m), FixedSoln ErrUp (m),";
+  else
+    header += "FixedSoln Northing (m), FixedSoln Easting (m), FixedSoln Up (m),";
+  header += "ambiguity ratio, P(a_check=a), norm, NR Fixed Ambiguities, NR Ambiguity Search Nodes";
+
+  pvtWriter.SetColumnarCompression( isCompressed );
+  if( !pvtWriter.Open( path.c_str(), pvtFormat, GNSS_PVT_NR_COLUMNS, header.c_str(), isUpdatable ) )
+  {
+    printf( "Please close %s and type GO: ", path.c_str() );
+    gets( msg );
+    if( !pvtWriter.Open( path.c_str(), pvtFormat, GNSS_PVT_NR_COLUMNS, header.c_str(), isUpdatable ) )
+    {
+      sprintf( msg, "Unable to open %.200s.", path.c_str() );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+  }
+  return true;
+}
+
+
+bool AddStaticBatchEpoch( 
+  GNSS_StaticBatchSolver& batch,
+  GNSS_Estimator& Estimator,
+  GNSS_RxData& rxData
+  )
+{
+  unsigned i = 0;
+  unsigned nrObs = 0;
+
+  // The pseudorange rows come first in the least squares design matrix,
+  // followed by any constraints.
+  for( i = 0; i < rxData.m_nrValidObs; i++ )
+  {
+    if( rxData.m_ObsArray[i].flags.isActive && rxData.m_ObsArray[i].flags.isPsrUsedInSolution )
+      nrObs++;
+  }
+  if( nrObs > Estimator.m_posLSQ.H.GetNrRows() )
+  {
+    GNSS_ERROR_MSG( "if( nrObs > Estimator.m_posLSQ.H.GetNrRows() )" );
+    return false;
+  }
+
+  return batch.AddEpoch(
+    rxData.m_pvt_lsq.latitude,
+    rxData.m_pvt_lsq.longitude,
+    rxData.m_pvt_lsq.height,
+    Estimator.m_posLSQ.H,
+    Estimator.m_posLSQ.W,
+    Estimator.m_posLSQ.w,
+    Estimator.m_posLSQ.dx,
+    nrObs );
+}
+
+
+bool WriteStaticBatchSolution( 
+  GNSS_StaticBatchSolver& batch,
+  const char* path,
+  const double datumLatitudeRads,
+  const double datumLongitudeRads,
+  const double datumHeight
+  )
+{
+  FILE* fid = NULL;
+  double latitude = 0;
+  double longitude = 0;
+  double height = 0;
+  double apvf = 0;
+  double northing = 0;
+  double easting = 0;
+  double up = 0;
+  Matrix P;
+  BOOL result = FALSE;
+
+  if( path == NULL )
+  {
+    GNSS_ERROR_MSG( "if( path == NULL )" );
+    return false;
+  }
+
+  if( !batch.Solve( latitude, longitude, height, P, apvf ) )
+  {
+    GNSS_ERROR_MSG( "batch.Solve returned false." );
+    return false;
+  }
+
+  result = GEODESY_ComputePositionDifference(
+    GEODESY_REFERENCE_ELLIPSE_WGS84,
+    datumLatitudeRads,
+    datumLongitudeRads,
+    datumHeight,
+    latitude,
+    longitude,
+    height,
+    &northing,
+    &easting,
+    &up );
+  if( result == FALSE )
+  {
+    GNSS_ERROR_MSG( "GEODESY_ComputePositionDifference returned FALSE." );
+    return false;
+  }
+
+  printf( "Static batch solution from %u epochs and %u pseudoranges: %.9lf %.9lf %.4lf\n", 
+    batch.GetNrEpochs(), batch.GetNrObservations(), latitude*RAD2DEG, longitude*RAD2DEG, height );
+
+  fid = fopen( path, "w" );
+  if( !fid )
+  {
+    GNSS_ERROR_MSG( "Unable to open the static batch solution file." );
+    return false;
+  }
+  fprintf( fid, "latitude (deg), longitude (deg), height (m), Error North (m), Error East (m), Error Up (m), " );
+  fprintf( fid, "STDEV latitude (m), STDEV longitude (m), STDEV height (m), NR Epochs, NR PSR Used, APVF\n" );
+  fprintf( fid, "%.12lf, %.12lf, %.4lf, %.4lf, %.4lf, %.4lf, %.4lf, %.4lf, %.4lf, %u, %u, %.4lf\n",
+    latitude*RAD2DEG, longitude*RAD2DEG, height, northing, easting, up,
+    sqrt(P[0][0]), sqrt(P[1][1]), sqrt(P[2][2]), 
+    batch.GetNrEpochs(), batch.GetNrObservations(), apvf );
+  fclose( fid );
+  return true;
+}
+
+
+bool ConfigureReceiverData( 
+  GNSS_RxData& rxData,        //!< The initialized receiver data.
+  const GNSS_OptionFile& opt, //!< The options.
+  const GNSS_OptionFile::stStationInformation& station, //!< The station information.
+  const bool isReference      //!< Is this the reference station. Its position is fixed.
+  )
+{
+  bool result = false;
+
+  if( opt.m_klobuchar.isValid )
+  {
+    rxData.m_klobuchar = opt.m_klobuchar;
+    if( !opt.m_Reference.useIono )
+      rxData.m_DisableIonoCorrection = true;
+  }
+  else
+  {
+    rxData.m_DisableIonoCorrection = true;
+  }
+  rxData.m_elevationMask = opt.m_elevationMask*DEG2RAD;
+  rxData.m_locktimeMask  = opt.m_locktimeMask;
+  rxData.m_cnoMask       = opt.m_cnoMask;
+  rxData.m_RINEX_use_best_eph = opt.m_RINEXNavUseBestEphemeris;
+
+  rxData.m_AtmCache.isEnabled           = opt.m_AtmCacheOptions.isEnabled;
+  rxData.m_AtmCache.checkAccuracy       = opt.m_AtmCacheOptions.checkAccuracy;
+  rxData.m_AtmCache.maxDisplacement     = opt.m_AtmCacheOptions.maxDisplacement;
+  rxData.m_AtmCache.ionoRefreshInterval = opt.m_AtmCacheOptions.ionoRefreshInterval;
+
+  if( !station.useTropo )
+  {
+    rxData.m_DisableTropoCorrection = true;
+  }
+
+  if( isReference )
+  {
+    result = rxData.SetInitialPVT(
+      station.latitudeRads,
+      station.longitudeRads,
+      station.height,
+      0.0, 0.0, 0.0,
+      0.0, 0.0,
+      0.0, 0.0, 0.0,  // The reference position is fixed.
+      0.0, 0.0, 0.0,
+      100.0,
+      10.0 ); // The reference position is fixed but the clock is still unknown.
+  }
+  else
+  {
+    result = rxData.SetInitialPVT(
+      station.latitudeRads,
+      station.longitudeRads,
+      station.height,
+      0.0, 0.0, 0.0,
+      0.0, 0.0, 
+      station.uncertaintyLatitudeOneSigma, 
+      station.uncertaintyLongitudeOneSigma, 
+      station.uncertaintyHeightOneSigma, 
+      1.0, 1.0, 1.0,
+      1000.0,
+      1.0e9 );
+  }
+  if( !result )
+  {
+    GNSS_ERROR_MSG( "rxData.SetInitialPVT returned false." );
+    return false;
+  }
+  return true;
+}
+
+
+bool InitializeRoverPipeline( 
+  stRoverPipeline& pipeline,  //!< The rover pipeline.
+  GNSS_OptionFile& opt,       //!< The options.
+  const GNSS_OptionFile::stStationInformation& station, //!< The rover station information.
+  const unsigned index,       //!< The rover number, 1 is the primary rover.
+  const GNSS_RxData* rxDataBase //!< The shared reference station data, NULL if not shared.
+  )
+{
+  bool result = false;
+  bool isValidPath = false;
+  GNSS_RxData& rxData = pipeline.rxData;
+  GNSS_Estimator& Estimator = pipeline.Estimator;
+  char suffix[64];
+
+  pipeline.index = index;
+  pipeline.opt = &opt;
+  pipeline.station = station;
+  pipeline.rxDataBaseSource = rxDataBase;
+  pipeline.start_time = opt.m_StartTime.GPSWeek*SECONDS_IN_WEEK + opt.m_StartTime.GPSTimeOfWeek;
+  pipeline.end_time = opt.m_EndTime.GPSWeek*SECONDS_IN_WEEK + opt.m_EndTime.GPSTimeOfWeek;
+
+  // Only the primary rover uses the option file datum.
+  if( index == 1 )
+  {
+    pipeline.datum = opt.m_RoverDatum;
+    pipeline.OutputSuffix = "";
+  }
+  else
+  {
+    sprintf( suffix, "_rover%u", index );
+    pipeline.OutputSuffix = suffix;
+  }
+
+  if( opt.m_ProcessingMethod == "LSQ" )
+  {
+    Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_LSQ;
+    pipeline.isFilterInitialized = true;
+  }
+  else if( opt.m_ProcessingMethod == "EKF" )
+  {
+    pipeline.useEKF = true;
+    Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_EKF;
+  }
+  else if( opt.m_ProcessingMethod == "RTK4" )
+  {
+    pipeline.useRTK = true;
+    pipeline.isEightStateModel = false;
+    Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_RTK4;
+  }
+  else if( opt.m_ProcessingMethod == "RTK8" )
+  {
+    pipeline.useRTK = true;
+    pipeline.isEightStateModel = true;
+    Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_RTK8;
+  }
+  else if( opt.m_ProcessingMethod == "TRIPLEDIFF" )
+  {
+    pipeline.useTripleDiff = true;
+    Estimator.m_FilterType = GNSS_Estimator::GNSS_FILTER_TYPE_TRIPLEDIFF;
+  }
+  else 
+  {
+    GNSS_ERROR_MSG( "Unexpected." );
+    return false;
+  }
+
+  if( opt.m_ProcessingMethod == "RTK4" )
+  {
+    Estimator.m_FourStateRandomWalkKalmanModel.sigmaNorth = opt.m_KalmanOptions.RTK4_sigmaNorth;
+    Estimator.m_FourStateRandomWalkKalmanModel.sigmaEast = opt.m_KalmanOptions.RTK4_sigmaEast;
+    Estimator.m_FourStateRandomWalkKalmanModel.sigmaUp = opt.m_KalmanOptions.RTK4_sigmaUp;
+    Estimator.m_FourStateRandomWalkKalmanModel.sigmaClock = opt.m_KalmanOptions.RTK4_sigmaClock;
+  }
+  else if( opt.m_ProcessingMethod == "EKF" || opt.m_ProcessingMethod == "RTK8" )
+  {
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVn       = opt.m_KalmanOptions.alphaVn;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVe       = opt.m_KalmanOptions.alphaVe;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaVup      = opt.m_KalmanOptions.alphaVup;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.alphaClkDrift = opt.m_KalmanOptions.alphaClkDrift;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVn       = opt.m_KalmanOptions.sigmaVn;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVe       = opt.m_KalmanOptions.sigmaVe;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaVup      = opt.m_KalmanOptions.sigmaVup;
+    Estimator.m_FirstOrderGaussMarkovKalmanModel.sigmaClkDrift = opt.m_KalmanOptions.sigmaClkDrift;
+  }
 
+  Estimator.m_AmbiguityResolver.m_MaxSearchNodes = opt.m_AmbiguityOptions.maxSearchNodes;
+  Estimator.m_AmbiguityResolver.m_PartialRatioThreshold = opt.m_AmbiguityOptions.partialRatioThreshold;
+  Estimator.m_AmbiguityResolver.m_MinNrPartialAmbiguities = opt.m_AmbiguityOptions.minNrPartialAmbiguities;
 
+  Estimator.m_LSQIterationControl.useWarmStart = opt.m_LeastSquaresOptions.useWarmStart;
+  Estimator.m_LSQIterationControl.geometryReuseThreshold = opt.m_LeastSquaresOptions.geometryReuseThreshold;
+  Estimator.m_LSQIterationControl.maxIterations = opt.m_LeastSquaresOptions.maxIterations;
 
+  Estimator.m_CycleSlipControl.useGeometryFree = opt.m_CycleSlipOptions.useGeometryFree;
+  Estimator.m_CycleSlipControl.geometryFreeThreshold = opt.m_CycleSlipOptions.geometryFreeThreshold;
+  Estimator.m_CycleSlipControl.geometryFreeThresholdRate = opt.m_CycleSlipOptions.geometryFreeThresholdRate;
+  Estimator.m_CycleSlipControl.geometryFreeMaxGap = opt.m_CycleSlipOptions.geometryFreeMaxGap;
 
+  if( rxDataBase != NULL )
+  {
+    // The copy of the reference station data is loaded from the shared 
+    // reference station data so it is set up like the shared object but 
+    // it is not associated with a data file.
+    pipeline.rxDataBase.SetDefaultMeasurementStdev_GPSL1(
+      opt.m_Reference.stdev_GPSL1_psr,
+      opt.m_Reference.stdev_GPSL1_doppler,
+      opt.m_Reference.stdev_GPSL1_adr 
+      );
+    if( !ConfigureReceiverData( pipeline.rxDataBase, opt, opt.m_Reference, true ) )
+    {
+      GNSS_ERROR_MSG( "Failed to initialize the reference receiver object." );
+      return false;
+    }
+  }
 
+  rxData.SetDefaultMeasurementStdev_GPSL1(
+    station.stdev_GPSL1_psr,
+    station.stdev_GPSL1_doppler,
+    station.stdev_GPSL1_adr 
+    );
 
+  if( !opt.m_Reference.isValid && opt.m_RINEXNavDataPath.length() != 0 )
+  {
+    // Stand-Alone mode
+    result = rxData.Initialize( station.DataPath.c_str(), isValidPath, station.DataType, opt.m_RINEXNavDataPath.c_str() );
+  }
+  else
+  {
+    result = rxData.Initialize( station.DataPath.c_str(), isValidPath, station.DataType, NULL );
+  }
+  if( !result )
+  {
+    GNSS_ERROR_MSG( "Failed to initialize the rover receiver object." );
+    return false;
+  }
+  // The rovers use the RINEX ephemeris already loaded by the shared reference station.
+  if( rxDataBase != NULL && rxDataBase->GetRINEXEphemerisStore() != NULL )
+  {
+    if( !rxData.SetRINEXEphemerisStore( rxDataBase->GetRINEXEphemerisStore() ) )
+    {
+      GNSS_ERROR_MSG( "rxData.SetRINEXEphemerisStore returned false." );
+      return false;
+    }
+  }
 
+  if( !ConfigureReceiverData( rxData, opt, station, false ) )
+  {
+    GNSS_ERROR_MSG( "Failed to initialize the rover receiver object." );
+    return false; 
+  }
+
+  // For comparing the computed rover position
+  if( pipeline.datum.isValid )
+  {
+    result = rxData.SetDatumPVT(
+      pipeline.datum.latitudeRads,
+      pipeline.datum.longitudeRads,
+      pipeline.datum.height );
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "Failed to initialize the rover receiver object's datum point." );
+      return false; 
+    }
+  }
+
+  return true;
+}
+
+
+bool ProcessEpoch( 
+  stRoverPipeline& pipeline, //!< The rover pipeline.
+  const double time,         //!< The time of the epoch [s].
+  bool& wasOutput            //!< Is the solution of this epoch output. It is not output until the filter is initialized.
+  )
+{
+  bool result = false;
+  bool wasPositionComputed = false;
+  bool wasVelocityComputed = false;
+  unsigned i = 0;
+  unsigned j = 0;
+  double dT = 0.0;
+  double lsq_accuracy = 0;
+  double opt_accuracy = 0;
+  char msg[256];
+  GNSS_OptionFile& opt = *pipeline.opt;
+  const GNSS_OptionFile::stStationInformation& station = pipeline.station;
+  GNSS_RxData& rxData = pipeline.rxData;
+  GNSS_RxData* rxDataBase = NULL; // NULL for stand alone processing.
+  GNSS_Estimator& Estimator = pipeline.Estimator;
+
+  wasOutput = false;
+  if( opt.m_Reference.isValid )
+    rxDataBase = &pipeline.rxDataBase;
+
+  if( pipeline.isAtFirstEpoch )
+  {
+    pipeline.isAtFirstEpoch = false;
+    dT = 0.0;
+  }
+  else
+  {
+    dT = time - pipeline.time_prev;      
+    if( dT < 0.0 )
+    {
+      // should never happen
+      GNSS_ERROR_MSG( "dT is negative." );
+      return false; 
+    }        
+  }
+  pipeline.time_prev = time;
+
+  if( !opt.m_UseDopplerMeasurements )
+  {
+    // Disable all the Doppler measurements on the rover.
+    for( i = 0; i < rxData.m_nrValidObs; i++ )
+    {
+      rxData.m_ObsArray[i].flags.isDopplerValid = false;
+      rxData.m_ObsArray[i].flags.isDopplerUsedInSolution = false;          
+    }
+
+    if( rxDataBase != NULL )
+    {
+      // Disable all the Doppler measurements on the base station.
+      for( i = 0; i < rxDataBase->m_nrValidObs; i++ )
+      {
+        rxDataBase->m_ObsArray[i].flags.isDopplerValid = false;
+        rxDataBase->m_ObsArray[i].flags.isDopplerUsedInSolution = false;            
+      }
+    }          
+  }
+    
+  // exclude satellites as indicated in the option file
+  for( j = 0; j < station.nrSatsToExclude; j++ )
+  {
+    for( i = 0; i < rxData.m_nrValidObs; i++ )
+    {
+      if( rxData.m_ObsArray[i].id == station.satsToExclude[j] )
+      {
+        rxData.m_ObsArray[i].flags.isNotUserRejected = 0;
+      }
+    }
+  } 
+
+  if( rxDataBase != NULL )
+  {
+    // exclude satellites as indicated in the option file
+    for( j = 0; j < opt.m_Reference.nrSatsToExclude; j++ )
+    {
+      for( i = 0; i < rxDataBase->m_nrValidObs; i++ )
+      {
+        if( rxDataBase->m_ObsArray[i].id == opt.m_Reference.satsToExclude[j] )
+        {
+          rxDataBase->m_ObsArray[i].flags.isNotUserRejected = 0;
+        }
+      }
+    } 
+  }
+
+  if( opt.m_RoverIsStatic )
+  {
+    // Enable cycle slip detection using the triple difference method.
+    rxData.m_isStatic = true;
+  }
+
+  // Enable constraints if any.
+  if( opt.m_isPositionFixed )
+  {
+    rxData.m_pvt_lsq.isHeightConstrained = false;
+    rxData.m_pvt.isHeightConstrained = false;        
+    rxData.m_pvt_lsq.isPositionFixed = true;
+    rxData.m_pvt.isPositionFixed = true;
+    
+    // Enable cycle slip detection using the triple difference method.
+    rxData.m_isStatic = true;
+  }
+  else if( opt.m_isHeightConstrained )
+  {
+    rxData.m_pvt_lsq.isHeightConstrained = true;
+    rxData.m_heightConstraint = station.height;
+    rxData.m_heightConstraintStdev = station.uncertaintyHeightOneSigma;
+    rxData.m_pvt.isHeightConstrained = true;
+    rxData.m_pvt_lsq.isPositionFixed = false;
+    rxData.m_pvt.isPositionFixed = false;
+  }
+
+  // Always perfom least squares.
+  {
+    GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_LEAST_SQUARES );
+    result = Estimator.PerformLeastSquares(
+      &rxData,
+      rxDataBase,
+      wasPositionComputed,
+      wasVelocityComputed );
+  }
+  if( !result )
+  {
+    sprintf( msg, "rover %u: %.1Lf %d LSQ returned false\n", pipeline.index, rxData.m_pvt_lsq.time.gps_tow, rxData.m_pvt_lsq.time.gps_week );
+    GNSS_ERROR_MSG( msg );
+    return false;
+  }        
+
+  if( pipeline.useStaticBatch && wasPositionComputed && rxData.m_pvt_lsq.didGlobalTestPassForPosition )
+  {
+    if( !AddStaticBatchEpoch( pipeline.staticBatch, Estimator, rxData ) )
+    {
+      GNSS_ERROR_MSG( "AddStaticBatchEpoch returned false." );
+      return false;
+    }
+  }
+
+  if( !pipeline.isFilterInitialized )
+  {
+    // Is there a 'valid' least squares position estimate?
+    if( !( wasPositionComputed && rxData.m_pvt_lsq.didGlobalTestPassForPosition ) )
+    {
+      return true;
+    }
+
+    if( opt.m_isPositionFixed )
+    {
+      result = rxData.UpdatePositionAndRxClock(
+        rxData.m_pvt,
+        station.latitudeRads,
+        station.longitudeRads,
+        station.height,
+        rxData.m_pvt.clockOffset,
+        station.uncertaintyLatitudeOneSigma, 
+        station.uncertaintyLongitudeOneSigma, 
+        station.uncertaintyHeightOneSigma, 
+        rxData.m_pvt.std_clk
+        );
+
+      // The least squares covariance matrix is still used to seed the filter.
+      Estimator.m_posLSQ.P.Zero();
+      Estimator.m_posLSQ.P[0][0] = station.uncertaintyLatitudeOneSigma*station.uncertaintyLatitudeOneSigma;
+      Estimator.m_posLSQ.P[1][1] = station.uncertaintyLongitudeOneSigma*station.uncertaintyLongitudeOneSigma;
+      Estimator.m_posLSQ.P[2][2] = station.uncertaintyHeightOneSigma*station.uncertaintyHeightOneSigma;
+      Estimator.m_posLSQ.P[3][3] = 2.0*rxData.m_pvt.std_clk*rxData.m_pvt.std_clk;
+    }
+    else
+    {
+      // Seed with either least squares or the option file solution
+      // whichever is more precise
+
+      lsq_accuracy  = rxData.m_pvt_lsq.std_lat*rxData.m_pvt_lsq.std_lat;
+      lsq_accuracy += rxData.m_pvt_lsq.std_lon*rxData.m_pvt_lsq.std_lon;
+      lsq_accuracy += rxData.m_pvt_lsq.std_hgt*rxData.m_pvt_lsq.std_hgt;
+      lsq_accuracy  = sqrt(lsq_accuracy);
+      opt_accuracy  = station.uncertaintyLatitudeOneSigma*station.uncertaintyLatitudeOneSigma;
+      opt_accuracy += station.uncertaintyLongitudeOneSigma*station.uncertaintyLongitudeOneSigma;
+      opt_accuracy += station.uncertaintyHeightOneSigma*station.uncertaintyHeightOneSigma;
+      opt_accuracy  = sqrt(opt_accuracy);
+
+      if( opt_accuracy <= lsq_accuracy )
+      {
+        result = rxData.UpdatePositionAndRxClock(
+          rxData.m_pvt,
+          station.latitudeRads,
+          station.longitudeRads,
+          station.height,
+          rxData.m_pvt.clockOffset,
+          station.uncertaintyLatitudeOneSigma, 
+          station.uncertaintyLongitudeOneSigma, 
+          station.uncertaintyHeightOneSigma, 
+          rxData.m_pvt.std_clk
+          );
+
+        Estimator.m_posLSQ.P.Zero();
+        Estimator.m_posLSQ.P[0][0] = station.uncertaintyLatitudeOneSigma*station.uncertaintyLatitudeOneSigma;
+        Estimator.m_posLSQ.P[1][1] = station.uncertaintyLongitudeOneSigma*station.uncertaintyLongitudeOneSigma;
+        Estimator.m_posLSQ.P[2][2] = station.uncertaintyHeightOneSigma*station.uncertaintyHeightOneSigma;
+        Estimator.m_posLSQ.P[3][3] = 2.0*rxData.m_pvt.std_clk*rxData.m_pvt.std_clk;
+      }
+      else
+      {
+        // Seed the filter with the least squares solution.
+        rxData.m_pvt = rxData.m_pvt_lsq;
+      }
+    }
+      
+    if( pipeline.useRTK )
+    {
+      result = Estimator.InitializeStateVarianceCovarianceFromLeastSquares_RTK(
+        Estimator.m_posLSQ.P,
+        Estimator.m_velLSQ.P
+        );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "Estimator.InitializeStateVarianceCovarianceFromLeastSquares_RTK returned false." );
+        return false;
+      }
+    }
+    else if( pipeline.useEKF )
+    {            
+      result = Estimator.InitializeStateVarianceCovariance_EKF(
+        Estimator.m_posLSQ.P,
+        Estimator.m_velLSQ.P
+        );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "Estimator.InitializeStateVarianceCovariance_EKF returned false." );
+        return false;
+      }
+    }
+    else if( pipeline.useTripleDiff )
+    {            
+      pipeline.skipEpochForTripleDiff = true;
+
+      // Estimator.m_posLSQ.P contains either the least squares covariance info
+      // or the option file specified covariance information.
+      Estimator.m_TD.Cx.Resize(3,3);
+      if( lsq_accuracy < opt_accuracy )
+      {
+        Estimator.m_TD.Cx[0][0] = 6.0*Estimator.m_posLSQ.P[0][0];
+        Estimator.m_TD.Cx[1][1] = 6.0*Estimator.m_posLSQ.P[1][1];
+        Estimator.m_TD.Cx[2][2] = 6.0*Estimator.m_posLSQ.P[2][2];
+      }
+      else
+      {
+        Estimator.m_TD.Cx[0][0] = Estimator.m_posLSQ.P[0][0];
+        Estimator.m_TD.Cx[1][1] = Estimator.m_posLSQ.P[1][1];
+        Estimator.m_TD.Cx[2][2] = Estimator.m_posLSQ.P[2][2];
+      }
+    }
+    else
+    {
+      GNSS_ERROR_MSG( "Unexpected." );
+      return false;
+    }
+    pipeline.isFilterInitialized = true;
+  }
+
+  if( pipeline.useTripleDiff )
+  {
+    if( !pipeline.skipEpochForTripleDiff )
+    {
+      // copy the velocity and clock drift information to the triple difference solution
+      rxData.m_pvt.clockOffset = rxData.m_pvt_lsq.clockOffset;
+      rxData.m_pvt.std_clk = rxData.m_pvt_lsq.std_clk;
+
+      rxData.UpdateVelocityAndClockDrift(
+        rxData.m_pvt, 
+        rxData.m_pvt_lsq.vn, 
+        rxData.m_pvt_lsq.ve, 
+        rxData.m_pvt_lsq.vup, 
+        rxData.m_pvt_lsq.clockDrift,
+        rxData.m_pvt_lsq.std_vn,
+        rxData.m_pvt_lsq.std_ve,
+        rxData.m_pvt_lsq.std_vup,
+        rxData.m_pvt_lsq.std_clkdrift );
+
+      rxData.m_pvt.nrDopplerObsAvailable = rxData.m_pvt_lsq.nrDopplerObsAvailable;
+      rxData.m_pvt.nrDopplerObsRejected = rxData.m_pvt_lsq.nrDopplerObsRejected;
+      rxData.m_pvt.nrDopplerObsUsed = rxData.m_pvt_lsq.nrDopplerObsUsed;
+      
+      GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_KALMAN_UPDATE );
+      result = Estimator.EstimateTripleDifferenceSolution(
+        &rxData,
+        rxDataBase,
+        wasPositionComputed
+        );
+      pipeline.skipEpochForTripleDiff = true;
+    }
+    else
+    {
+      pipeline.skipEpochForTripleDiff = false;
+    }
+  }
+  else if( pipeline.useEKF )
+  {
+    {
+      GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_PREDICT );
+      result = Estimator.PredictAhead_EKF(
+        rxData,
+        dT
+        );
+    }
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "Estimator.PredictAhead_EKF returned false." );
+      return false;
+    }
+    if( pipeline.useSmoother )
+    {
+      pipeline.smootherPredictedPVT = rxData.m_pvt;
+      if( !pipeline.smootherPredictedP.Copy( Estimator.m_EKF.P ) )
+      {
+        GNSS_ERROR_MSG( "if( !pipeline.smootherPredictedP.Copy( Estimator.m_EKF.P ) )" );
+        return false;
+      }
+    }
+
+    {
+      GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_KALMAN_UPDATE );
+      result = Estimator.Kalman_Update_EKF(
+        &rxData,
+        rxDataBase
+        );
+    }
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "Estimator.Kalman_Update_EKF returned false." );
+      return false;
+    }
+
+    if( pipeline.useSmoother )
+    {
+      // The tag is the PVT epoch index of this epoch.
+      result = pipeline.smoother.AddEpoch( pipeline.PVT.GetNrEpochs(), dT, pipeline.smootherPredictedPVT, pipeline.smootherPredictedP, Estimator.m_EKF.T, rxData.m_pvt, Estimator.m_EKF.P );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "smoother.AddEpoch returned false." );
+        return false;
+      }
+    }
+  }
+  else if( pipeline.useRTK )
+  {
+    if( rxDataBase == NULL )
+    {
+      GNSS_ERROR_MSG( "Only differential supported." );
+      return false;
+    }
+
+    if( Estimator.m_FilterType == GNSS_Estimator::GNSS_FILTER_TYPE_RTK4 )
+    {
+      // copy the velocity and clock drift information to the rtk solution
+      rxData.UpdateVelocityAndClockDrift(
+        rxData.m_pvt, 
+        rxData.m_pvt_lsq.vn, 
+        rxData.m_pvt_lsq.ve, 
+        rxData.m_pvt_lsq.vup, 
+        rxData.m_pvt_lsq.clockDrift,
+        rxData.m_pvt_lsq.std_vn,
+        rxData.m_pvt_lsq.std_ve,
+        rxData.m_pvt_lsq.std_vup,
+        rxData.m_pvt_lsq.std_clkdrift );
+
+      rxData.m_pvt.nrDopplerObsAvailable = rxData.m_pvt_lsq.nrDopplerObsAvailable;
+      rxData.m_pvt.nrDopplerObsRejected = rxData.m_pvt_lsq.nrDopplerObsRejected;
+      rxData.m_pvt.nrDopplerObsUsed = rxData.m_pvt_lsq.nrDopplerObsUsed;
+
+      // Bump the clock state using the least squares solution
+      // to reduce innovation values for the pseudoranges if
+      // the clock is not really being filtered.
+      if( opt.m_KalmanOptions.RTK4_sigmaClock > 50.0 )
+      {
+        if( rxData.m_pvt_lsq.std_clk < 50.0 )
+        {
+          rxData.m_pvt.clockOffset = rxData.m_pvt_lsq.clockOffset;
+          Estimator.m_RTK.P[3][3] = rxData.m_pvt_lsq.std_clk*rxData.m_pvt_lsq.std_clk;
+        }
+      }
+    }
+
+    {
+      GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_PREDICT );
+      result = Estimator.PredictAhead_RTK( rxData, dT );
+    }
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "Estimator.PredictAhead_RTK returned false." );
+      return false;
+    }
+    if( pipeline.useSmoother )
+    {
+      pipeline.smootherPredictedPVT = rxData.m_pvt;
+      if( !pipeline.smootherPredictedP.Copy( Estimator.m_RTK.P ) )
+      {
+        GNSS_ERROR_MSG( "if( !pipeline.smootherPredictedP.Copy( Estimator.m_RTK.P ) )" );
+        return false;
+      }
+    }
+
+    {
+      GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_KALMAN_UPDATE );
+      result = Estimator.Kalman_Update_RTK( &rxData, rxDataBase );
+    }
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "Estimator.Kalman_Update_RTK returned false." );
+      return false;
+    }
+
+    if( pipeline.useSmoother )
+    {
+      // The tag is the PVT epoch index of this epoch.
+      result = pipeline.smoother.AddEpoch( pipeline.PVT.GetNrEpochs(), dT, pipeline.smootherPredictedPVT, pipeline.smootherPredictedP, Estimator.m_RTK.T, rxData.m_pvt, Estimator.m_RTK.P );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "smoother.AddEpoch returned false." );
+        return false;
+      }
+    }
+  }
+
+  rxData.m_prev_pvt = rxData.m_pvt;
+  if( rxDataBase != NULL )
+    rxDataBase->m_prev_pvt = rxDataBase->m_pvt;
+
+  if( !pipeline.datum.isValid )
+  {
+    pipeline.datum.latitudeRads = rxData.m_pvt.latitude;
+    pipeline.datum.longitudeRads = rxData.m_pvt.longitude;
+    pipeline.datum.height = rxData.m_pvt.height;
+    pipeline.datum.isValid = true;
+  }
+  // Output the PVT results.
+  {
+    GNSS_PROFILE_SCOPE( pipeline.profiler, GNSS_PROFILE_OUTPUT );
+    if( !OutputPVT( pipeline.PVT, rxData, pipeline.datum.latitudeRads, pipeline.datum.longitudeRads, pipeline.datum.height, opt.m_RoverIsStatic ) )
+    {
+      sprintf( msg, "rover %u: %.3Lf %d OutputPVT Failed\n", pipeline.index, rxData.m_pvt.time.gps_tow, rxData.m_pvt.time.gps_week );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+
+    if( !OutputObservationData( pipeline.SatObs, 32, &rxData, true, Estimator.m_FilterType ) )
+    {
+      sprintf( msg, "rover %u: %.3Lf %d OutputObservationData returned false.\n", pipeline.index, rxData.m_pvt.time.gps_tow, rxData.m_pvt.time.gps_week );
+      GNSS_ERROR_MSG( msg );
+      return false;
+    }
+  }
+  wasOutput = true;
+  return true;
+}
+
+
+bool ProcessRoverEpoch( stRoverPipeline& pipeline )
+{
+  bool result = false;
+  bool wasOutput = false;
+  double time = 0.0;
+  double timeBase = 0.0;
+  GNSS_RxData& rxData = pipeline.rxData;
+  GNSS_RxData& rxDataBase = pipeline.rxDataBase;
+
+  if( pipeline.isFinished )
+    return true;
+
+  // The copy of the reference station data must follow every shared epoch.
+  result = rxDataBase.LoadNextFromReceiverData( *pipeline.rxDataBaseSource );
+  if( !result )
+  {
+    GNSS_ERROR_MSG( "rxDataBase.LoadNextFromReceiverData returned false." );
+    return false;
+  }
+
+  // Advance the rover to the reference station time.
+  timeBase = rxDataBase.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxDataBase.m_pvt.time.gps_tow;
+  while( true )
+  {
+    if( !pipeline.isRoverEpochPending )
+    {
+      result = rxData.LoadNext( pipeline.isFinished );
+      if( !result )
+      {
+        GNSS_ERROR_MSG( "rxData.LoadNext returned false." );
+        return false;
+      }
+      if( pipeline.isFinished )
+        return true;
+      pipeline.isRoverEpochPending = true;
+    }
+    time = rxData.m_pvt.time.gps_week*SECONDS_IN_WEEK + rxData.m_pvt.time.gps_tow;
+    if( timeBase - time < 0.020 ) 
+      break;
+    pipeline.isRoverEpochPending = false; // The rover epoch is older than the reference epoch.
+  }
+  if( fabs(timeBase - time) >= 0.020 ) // must match to 20 ms
+  {
+    return true; // The rover is ahead of the reference station, keep the rover epoch.
+  }
+  pipeline.isRoverEpochPending = false;
+
+  if( rxData.m_nrValidObs == 0 )
+    return true;
+
+  // Check that the processing time is within the processing interval.
+  if( time < pipeline.start_time )
+    return true;
+  if( time > pipeline.end_time )
+  {
+    pipeline.isFinished = true;
+    return true;
+  }
+
+  return ProcessEpoch( pipeline, time, wasOutput );
+}
+
+
+void ProcessRoverEpochTask( void* arg )
+{
+  stRoverPipeline* pipeline = (stRoverPipeline*)arg;
+  if( pipeline == NULL )
+    return;
+
+  // Exceptions must not leave the worker thread.
+  try
+  {
+    if( !ProcessRoverEpoch( *pipeline ) )
+    {
+      pipeline->isOK = false;
+      pipeline->isFinished = true;
+    }
+  }
+  catch( MatrixException& matrixException )
+  {
+    printf( "rover %u: %s", pipeline->index, matrixException.GetExceptionMessage().c_str() );
+    pipeline->isOK = false;
+    pipeline->isFinished = true;
+  }
+  catch ( ... )
+  {
+    printf( "\nrover %u: Caught unknown exception\n", pipeline->index );
+    pipeline->isOK = false;
+    pipeline->isFinished = true;
+  }
+}
+
+
+bool WriteObservationData( 
+  stRoverPipeline& pipeline //!< The rover pipeline.
+  )
+{
+  unsigned i = 0;
+  FILE *fid_obs = NULL;
+  std::string obsHeader;
+  char fname[256];
+  char msg[256];
+  GNSS_OptionFile& opt = *pipeline.opt;
+  Matrix* SatObs = pipeline.SatObs;
+
+  obsHeader = "GPS time of week(s),GPS week,ID,Channel,";
+  obsHeader += "System,Code Type,Frequency Type,";
+  obsHeader += "Elevation (deg), Azimuth (deg),";
+  obsHeader += "PSR (m), ADR (cycles), PSR-ADR (m), Doppler (Hz),C/No (dB-Hz),Lock Time (s),";
+  obsHeader += "isActive,isCodeLocked,isPhaseLocked,isParityValid,isPsrValid,isAdrValid,isDopplerValid,isGrouped,isAutoAssigned,isCarrierSmoothed,";
+  obsHeader += "isEphemerisValid,isAlmanacValid,isAboveElevationMask,isAboveCNoMask,isAboveLockTimeMask,isNotUserRejected,isNotPsrRejected,isNotAdrRejected,isNotDopplerRejected,isNoCycleSlipDetected,";
+  obsHeader += "isPsrUsedInSolution,isDopplerUsedInSolution,isAdrUsedInSolution,isDifferentialPsrAvailable,isDifferentialDopplerAvailable,isDifferentialAdrAvailable,useTropoCorrection,useBroadcastIonoCorrection,isBaseSatellite,";
+  obsHeader += "stdev PSR (m),stdev adr (cycles),stdev Doppler (Hz),";
+  obsHeader += "PSR misclosure (m), Doppler misclosure (m/s), ADR misclosure (m),";
+  obsHeader += "SD_ambiguity (m), DD_ambiguity (m), DD_fixed_ambiguity (cycles), SD ADR residual (m), DD ADR residual (m), DD ADR residual fixed (m)";
+
+  for( i = 1; i <= 32; i++ )
+  {
+    if( !SatObs[i].isEmpty() )
+    {
+      if( !SatObs[i].Inplace_Transpose() )
+      {
+        GNSS_ERROR_MSG( "if( !SatObs[i].Inplace_Transpose() )" );
+        return false;
+      }
+
+      if( opt.m_PVTOutputFormat == "COLUMNAR" )
+      {
+        sprintf( fname, "%.200sobs%.20s_%02d.mtc", opt.m_OutputPrefix.c_str(), pipeline.OutputSuffix.c_str(), i );
+        if( !SatObs[i].SaveColumnar( fname, obsHeader.c_str(), 0, opt.m_ColumnarCompression ) )
+        {
+          GNSS_ERROR_MSG( "if( !SatObs[i].SaveColumnar( fname, obsHeader.c_str(), 0, opt.m_ColumnarCompression ) )" );
+          return false;
+        }
+        continue;
+      }
+
+      sprintf( fname, "%.200sobs%.20s_%02d.csv", opt.m_OutputPrefix.c_str(), pipeline.OutputSuffix.c_str(), i );
+      fid_obs = fopen( fname, "w" );
+      if( !fid_obs )
+      {
+        printf( "Please close %s and type GO: ", fname );
+        gets( msg );
+        fid_obs = fopen( fname, "w" );
+        if( !fid_obs )
+        {
+          sprintf( msg, "Unable to open %s.", fname );
+          GNSS_ERROR_MSG( msg );
+          return false;
+        }
+      }
+      fprintf( fid_obs, "%s\n", obsHeader.c_str() );
+      fclose( fid_obs );
+
+      if( !SatObs[i].PrintDelimited( fname, 12, ',', true )  )
+      {
+        GNSS_ERROR_MSG( "if( !SatObs[i].PrintDelimited( fname, 12, ',', true )  )" );
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+int ProcessMultipleRovers( 
+  GNSS_OptionFile& opt,     //!< The options.
+  GNSS_RxData& rxDataBase   //!< The initialized reference station data.
+  )
+{
+  bool result = false;
+  bool endOfStreamBase = false;
+  unsigned i = 0;
+  unsigned nrActive = 0;
+  unsigned nrEpochs = 0;
+  int exitCode = 0;
+  char fname[64];
+  double start = 0;
+  double loadTime = 0;      // The time spent decoding the reference station data, by one thread [s].
+  double processTime = 0;   // The time spent processing the rovers, until the slowest rover of each epoch is done [s].
+  std::vector<stRoverPipeline*> pipelines;
+  GNSS_ThreadPool pool;
+
+  if( !opt.m_Reference.isValid )
+  {
+    GNSS_ERROR_MSG( "if( !opt.m_Reference.isValid )" );
+    return 1;
+  }
+
+  pipelines.push_back( new stRoverPipeline );
+  result = InitializeRoverPipeline( *pipelines[0], opt, opt.m_Rover, 1, &rxDataBase );
+  for( i = 0; result && i < opt.m_AdditionalRovers.size(); i++ )
+  {
+    pipelines.push_back( new stRoverPipeline );
+    result = InitializeRoverPipeline( *pipelines[i+1], opt, opt.m_AdditionalRovers[i], i+2, &rxDataBase );
+  }
+  for( i = 0; result && i < pipelines.size(); i++ )
+  {
+    result = OpenPVTWriter( pipelines[i]->PVT, (opt.m_OutputPrefix + "pvt" + pipelines[i]->OutputSuffix).c_str(), opt.m_PVTOutputFormat, opt.m_ColumnarCompression, opt.m_RoverIsStatic, false );
+  }
+  if( !result )
+  {
+    GNSS_ERROR_MSG( "InitializeRoverPipeline or OpenPVTWriter returned false." );
+    for( i = 0; i < pipelines.size(); i++ )
+      delete pipelines[i];
+    return 1;
+  }
+
+  if( !pool.Start( opt.m_MultiRoverNrThreads ) )
+  {
+    GNSS_ERROR_MSG( "pool.Start returned false." );
+    for( i = 0; i < pipelines.size(); i++ )
+      delete pipelines[i];
+    return 1;
+  }
+  printf( "Processing %u rovers with %u threads.\n", (unsigned)pipelines.size(), pool.GetNrThreads() );
+
+  // The reference station is decoded once per epoch and the rovers 
+  // process that epoch in parallel. The rovers only read rxDataBase.
+  // The next epoch is not decoded until every rover is done with this 
+  // one, so the decoding and the slowest rover of each epoch limit 
+  // the scaling with the number of threads.
+  while( exitCode == 0 )
+  {
+    start = GNSS_Profiler::GetTime();
+    result = rxDataBase.LoadNext( endOfStreamBase );
+    loadTime += GNSS_Profiler::GetTime() - start;
+    if( !result )
+    {
+      GNSS_ERROR_MSG( "rxDataBase.LoadNext returned false." );
+      exitCode = -1;
+      break;
+    }
+    if( endOfStreamBase )
+      break;
+
+    start = GNSS_Profiler::GetTime();
+    nrActive = 0;
+    for( i = 0; i < pipelines.size(); i++ )
+    {
+      if( !pipelines[i]->isFinished )
+      {
+        pool.Submit( ProcessRoverEpochTask, pipelines[i] );
+        nrActive++;
+      }
+    }
+    if( nrActive == 0 )
+      break;
+
+    pool.WaitForAll();
+    processTime += GNSS_Profiler::GetTime() - start;
+    nrEpochs++;
+
+    for( i = 0; i < pipelines.size(); i++ )
+    {
+      if( !pipelines[i]->isOK )
+      {
+        sprintf( fname, "Processing failed for rover %u.", pipelines[i]->index );
+        GNSS_ERROR_MSG( fname );
+        exitCode = 1;
+      }
+    }
+  }
+  printf( "Rover epochs run by a thread other than the one they were queued to: %u\n", pool.GetNrTasksStolen() );
+  printf( "Reference epochs: %u, %.3f s decoding the reference station data (one thread), %.3f s processing the rovers (each epoch waits for its slowest rover)\n", 
+    nrEpochs, loadTime, processTime );
+  pool.Stop();
+
+  for( i = 0; i < pipelines.size(); i++ )
+  {
+    if( opt.m_LeastSquaresOptions.reportIterations && pipelines[i]->Estimator.m_LSQIterationControl.nrEpochs > 0 )
+    {
+      GNSS_Estimator::stLSQIterationControl &lsqIterations = pipelines[i]->Estimator.m_LSQIterationControl;
+      printf( "Least squares iterations (rover %u): %.2f per epoch, %u maximum, %u epochs, %u warm starts, %u design matrix reuses, %u not converged\n", 
+        pipelines[i]->index,
+        (double)lsqIterations.totalNrIterations / (double)lsqIterations.nrEpochs,
+        lsqIterations.maxNrIterations,
+        lsqIterations.nrEpochs,
+        lsqIterations.nrWarmStarts,
+        lsqIterations.nrGeometryReuses,
+        lsqIterations.nrNotConverged );
+    }
+    if( !pipelines[i]->PVT.Close() )
+    {
+      GNSS_ERROR_MSG( "PVT.Close returned false." );
+      exitCode = 1;
+    }
+    if( !WriteObservationData( *pipelines[i] ) )
+    {
+      GNSS_ERROR_MSG( "WriteObservationData returned false." );
+      exitCode = 1;
+    }
+    delete pipelines[i];
+  }
+  return exitCode;
+}
+
+
+int RunBatch( int argc, char* argv[] )
+{
+  GNSS_BatchProcessor batch;
+  std::string ExecutablePath;
+  std::string SummaryPath;
+  unsigned nrWorkers = 0;
+  unsigned memoryLimitMB = 0;
+  int value = 0;
+
+  if( argc < 3 || argc > 5 )
+  {
+    GNSS_ERROR_MSG( "Invalid arguments: you must specify the batch manifest." );
+    return 1;
+  }
+  if( argc > 3 )
+  {
+    value = atoi( argv[3] );
+    if( value < 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid arguments: the number of jobs must be positive (0 for one per processor)." );
+      return 1;
+    }
+    nrWorkers = static_cast<unsigned>(value);
+  }
+  if( argc > 4 )
+  {
+    value = atoi( argv[4] );
+    if( value < 0 )
+    {
+      GNSS_ERROR_MSG( "Invalid arguments: the memory limit must be positive (0 for no limit)." );
+      return 1;
+    }
+    memoryLimitMB = static_cast<unsigned>(value);
+  }
+
+  if( !GNSS_BatchProcessor::GetExecutablePath( argv[0], ExecutablePath ) )
+  {
+    GNSS_ERROR_MSG( "GNSS_BatchProcessor::GetExecutablePath returned false." );
+    return 1;
+  }
+  if( !batch.ReadManifest( argv[2], memoryLimitMB ) )
+  {
+    GNSS_ERROR_MSG( "Invalid batch manifest." );
+    return 1;
+  }
+  if( !batch.Run( ExecutablePath.c_str(), nrWorkers ) )
+  {
+    GNSS_ERROR_MSG( "GNSS_BatchProcessor::Run returned false." );
+  }
+
+  StdStringUtils::GetDirectoryOfThisStringPath( argv[2], SummaryPath );
+  SummaryPath += "batch_summary.csv";
+  if( !batch.WriteSummary( SummaryPath.c_str() ) )
+  {
+    GNSS_ERROR_MSG( "GNSS_BatchProcessor::WriteSummary returned false." );
+    return 1;
+  }
+  if( batch.GetNrFailedJobs() != 0 )
+    return 1;
+  return 0;
+}
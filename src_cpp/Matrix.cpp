@@ -690,6 +690,40 @@ namespace Zenautics
   }
 
 
+  bool Matrix::ReadColumnar( 
+    const char *path, 
+    const unsigned *columns, 
+    const unsigned nrColumns, 
+    const bool useRange, 
+    const double startValue, 
+    const double endValue 
+    )
+  {
+    if( MTX_ReadColumnar( &m_Matrix, path, columns, nrColumns, useRange, startValue, endValue ) )
+    {
+      return true;
+    }
+    else 
+    {
+      MTX_ERROR_MSG( "MTX_ReadColumnar returned false." );
+      return false;
+    }
+  }
+
+  bool Matrix::ReadCompressedRows( const char *path, const unsigned startRow, const unsigned nrows )
+  {
+    if( MTX_ReadCompressedRows( &m_Matrix, path, startRow, nrows ) )
+    {
+      return true;
+    }
+    else 
+    {
+      MTX_ERROR_MSG( "MTX_ReadCompressedRows returned false." );
+      return false;
+    }
+  }
+
+
   bool Matrix::Copy( Matrix& src )
   {
     if( MTX_Copy( &src.m_Matrix, &m_Matrix ) )
@@ -759,6 +793,25 @@ namespace Zenautics
     return Save( path.c_str() );
   }
 
+  bool Matrix::SaveColumnar( 
+    const char* path, 
+    const char* header, 
+    const unsigned chunkLength, 
+    const bool compress, 
+    const bool append 
+    )
+  {
+    if( MTX_SaveColumnar( &m_Matrix, path, header, chunkLength, compress, append ) )
+    {
+      return true;
+    }
+    else 
+    {
+      MTX_ERROR_MSG( "MTX_SaveColumnar returned false." );
+      return false;
+    }
+  }
+
   bool Matrix::Print( const char *path, const unsigned precision, bool append )
   {
     if( MTX_PrintAutoWidth( &m_Matrix, path, precision, append ) )
@@ -415,6 +415,47 @@ namespace Zenautics
     */
     bool ReadFromFile( std::string path );
 
+    /**
+    \brief  Read selected columns of a matrix saved with SaveColumnar, optionally
+            only the rows with the first column (usually time) within a range.
+            Only the requested columns are decoded.
+
+    \code
+    Matrix A;
+    unsigned columns[3] = { 0, 11, 12 }; // time, northing, easting
+    if( !A.ReadColumnar( "pvt.mtc", columns, 3, true, 345600.0, 349200.0 ) )
+      return false;
+    \endcode
+
+    \return true if successful, false otherwise
+    */
+    bool ReadColumnar( 
+      const char *path,              //!< The file path.
+      const unsigned *columns,       //!< The column indices to read (zero based), NULL for all columns.
+      const unsigned nrColumns,      //!< The number of column indices, 0 for all columns.
+      const bool useRange = false,   //!< Read only the rows with the first column within [startValue, endValue].
+      const double startValue = 0,   //!< The start of the range of the first column.
+      const double endValue = 0      //!< The end of the range of the first column.
+      );
+
+    /**
+    \brief  Read a range of rows of a compressed binary matrix file saved with Save.
+            Only the chunks of the file that contain the rows are decoded.
+
+    \code
+    Matrix A;
+    if( !A.ReadCompressedRows( "data.mtx", 36000, 3600 ) )
+      return false;
+    \endcode
+
+    \return true if successful, false otherwise
+    */
+    bool ReadCompressedRows( 
+      const char *path,              //!< The file path.
+      const unsigned startRow,       //!< The first row to read (zero based).
+      const unsigned nrows = 0       //!< The number of rows to read, 0 to read to the last row.
+      );
+
 
     /**  
     \brief  A safe function for performing a copy of another matrix.
@@ -469,7 +510,7 @@ namespace Zenautics
 
     /**
     \brief  Saves a matrix to the specified file path (a 'c' style string)
-            using a proprietary compressed format.
+            using a lossless, chunked compressed binary format.
     \code
     Matrix A;
     A = "[1,2,3; 4,5,6; 7,8,9]";
@@ -496,6 +537,28 @@ namespace Zenautics
     \return true if successful, false otherwise
     */
     bool Save( std::string path );
+
+    /**
+    \brief  Saves a real matrix to the specified file path using a columnar format
+            (chunks of rows, each column stored as a separate block). The header 
+            has the comma delimited column names. If append is true and the file 
+            exists, the rows are added to the file.
+
+    \code
+    Matrix A(1000,3);
+    if( !A.SaveColumnar( "data.mtc", "time (s),x (m),y (m)" ) )
+      return false;
+    \endcode 
+
+    \return true if successful, false otherwise
+    */
+    bool SaveColumnar( 
+      const char* path,                //!< The file path.
+      const char* header,              //!< The comma delimited column names and units, NULL if none.
+      const unsigned chunkLength = 0,  //!< The number of rows per chunk, 0 for the default.
+      const bool compress = true,      //!< Compress the column blocks.
+      const bool append = false        //!< Append to an existing file.
+      );
     
     /**
     \brief  Print the matrix to a file with automatically determined column width 